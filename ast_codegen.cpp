@@ -3,6 +3,8 @@
 #include "runtime_object.h"
 #include "compilation_context.h"
 #include "function_compilation_manager.h"
+#include "lock_jit_integration.h"
+#include "escape_analysis.h"
 #include <iostream>
 #include <unordered_map>
 #include <cstring>
@@ -778,6 +780,200 @@ void FunctionCall::generate_code(CodeGenerator& gen, TypeInference& types) {
     }
 }
 
+// `Lock` is the runtime lock type unless the program declares its own class
+// of that name
+static bool is_builtin_lock_class(const std::string& class_name) {
+    if (class_name != "Lock") return false;
+    return !(ConstructorDecl::current_compiler_context &&
+             ConstructorDecl::current_compiler_context->get_class(class_name));
+}
+
+// WaitGroup, Semaphore, RWLock and Barrier are runtime primitives unless the
+// program declares its own class of that name
+static bool is_builtin_sync_class(const std::string& class_name) {
+    if (class_name != "WaitGroup" && class_name != "Semaphore" &&
+        class_name != "RWLock" && class_name != "Barrier") {
+        return false;
+    }
+    return !(ConstructorDecl::current_compiler_context &&
+             ConstructorDecl::current_compiler_context->get_class(class_name));
+}
+
+// Methods on the sync primitives. WaitGroup.add/done and
+// Semaphore.acquire/release are emitted inline; the rest call the runtime.
+static DataType emit_sync_method(CodeGenerator& gen, TypeInference& types, const std::string& class_name,
+                                 const std::string& object_name, const std::string& method_name,
+                                 const std::vector<std::unique_ptr<ExpressionNode>>& arguments) {
+    struct SyncMethod {
+        const char* runtime_function;  // nullptr when emitted inline
+        bool takes_argument;
+        DataType result;
+    };
+    static const std::unordered_map<std::string, SyncMethod> methods = {
+        {"WaitGroup.add", {nullptr, true, DataType::VOID}},
+        {"WaitGroup.done", {nullptr, false, DataType::VOID}},
+        {"WaitGroup.wait", {"__runtime_waitgroup_wait", false, DataType::VOID}},
+        {"Semaphore.acquire", {nullptr, false, DataType::VOID}},
+        {"Semaphore.release", {nullptr, false, DataType::VOID}},
+        {"Semaphore.try_acquire", {"__runtime_semaphore_try_acquire", false, DataType::BOOLEAN}},
+        {"Semaphore.try_acquire_for", {"__runtime_semaphore_try_acquire_for", true, DataType::BOOLEAN}},
+        {"RWLock.read_lock", {"__runtime_rwlock_read_lock", false, DataType::VOID}},
+        {"RWLock.read_unlock", {"__runtime_rwlock_read_unlock", false, DataType::VOID}},
+        {"RWLock.try_read_lock", {"__runtime_rwlock_try_read_lock", false, DataType::BOOLEAN}},
+        {"RWLock.write_lock", {"__runtime_rwlock_write_lock", false, DataType::VOID}},
+        {"RWLock.write_unlock", {"__runtime_rwlock_write_unlock", false, DataType::VOID}},
+        {"RWLock.try_write_lock", {"__runtime_rwlock_try_write_lock", false, DataType::BOOLEAN}},
+        {"Barrier.wait", {"__runtime_barrier_wait", false, DataType::BOOLEAN}},
+    };
+    
+    auto it = methods.find(class_name + "." + method_name);
+    if (it == methods.end()) {
+        throw std::runtime_error("Unknown " + class_name + " method: " + method_name);
+    }
+    const SyncMethod& method = it->second;
+    
+    if (method.takes_argument) {
+        if (arguments.empty()) {
+            gen.emit_mov_reg_imm(0, 0);
+        } else {
+            arguments[0]->generate_code(gen, types);
+        }
+        gen.emit_mov_reg_reg(6, 0);  // RSI = argument
+    }
+    gen.emit_mov_reg_mem(7, types.get_variable_offset(object_name));  // RDI = object
+    
+    if (method.runtime_function) {
+        gen.emit_call(method.runtime_function);
+        if (method.result == DataType::BOOLEAN) {
+            gen.emit_and_reg_imm(0, 1);  // bool comes back in AL only
+        }
+    } else if (method_name == "add") {
+        gen.emit_waitgroup_add(7, 6);
+    } else if (method_name == "done") {
+        gen.emit_mov_reg_imm(6, -1);
+        gen.emit_waitgroup_add(7, 6);
+    } else if (method_name == "acquire") {
+        gen.emit_semaphore_acquire(7);
+    } else {
+        gen.emit_semaphore_release(7);
+    }
+    return method.result;
+}
+
+// `Atomic<int64>` / `Atomic<float64>` are runtime cells unless the program
+// declares its own Atomic class
+static bool is_builtin_atomic_class(const std::string& class_name) {
+    if (class_name.rfind("Atomic<", 0) != 0) return false;
+    return !(ConstructorDecl::current_compiler_context &&
+             ConstructorDecl::current_compiler_context->get_class("Atomic"));
+}
+
+static bool is_float64_atomic(const std::string& class_name) {
+    if (class_name == "Atomic<int64>") return false;
+    if (class_name == "Atomic<float64>") return true;
+    throw std::runtime_error("Atomic<T> supports int64 and float64, got " + class_name);
+}
+
+// Memory orders are compile-time string arguments, seq_cst when omitted
+static MemoryOrder parse_memory_order(const std::vector<std::unique_ptr<ExpressionNode>>& arguments, size_t index) {
+    if (index >= arguments.size()) return MemoryOrder::SEQ_CST;
+    auto* literal = dynamic_cast<StringLiteral*>(arguments[index].get());
+    if (!literal) {
+        throw std::runtime_error("Atomic memory order must be a string literal");
+    }
+    if (literal->value == "relaxed") return MemoryOrder::RELAXED;
+    if (literal->value == "acquire") return MemoryOrder::ACQUIRE;
+    if (literal->value == "release") return MemoryOrder::RELEASE;
+    if (literal->value == "acq_rel") return MemoryOrder::ACQ_REL;
+    if (literal->value == "seq_cst") return MemoryOrder::SEQ_CST;
+    throw std::runtime_error("Unknown memory order: " + literal->value);
+}
+
+// Evaluates an Atomic operand into RAX in the cell's representation
+static void emit_atomic_operand(CodeGenerator& gen, TypeInference& types, ExpressionNode& operand,
+                                bool is_float, bool negate) {
+    operand.generate_code(gen, types);
+    if (negate) {
+        gen.emit_mov_reg_reg(6, 0);
+        gen.emit_mov_reg_imm(0, 0);
+        gen.emit_sub_reg_reg(0, 6);  // RAX = -value
+    }
+    if (is_float) gen.emit_int64_to_float64_bits(0);
+}
+
+// load/store/add/sub/exchange/cas on an Atomic<T> variable. Each compiles to
+// a single mov, lock xadd, xchg or lock cmpxchg on the cell (float64 add is a
+// cmpxchg loop); memory orders only decide whether a fence is needed.
+static DataType emit_atomic_method(CodeGenerator& gen, TypeInference& types, const std::string& class_name,
+                                   const std::string& object_name, const std::string& method_name,
+                                   const std::vector<std::unique_ptr<ExpressionNode>>& arguments) {
+    bool is_float = is_float64_atomic(class_name);
+    DataType value_type = is_float ? DataType::FLOAT64 : DataType::INT64;
+    int64_t cell_offset = types.get_variable_offset(object_name);
+    
+    size_t value_count = 1;
+    if (method_name == "load") value_count = 0;
+    else if (method_name == "cas") value_count = 2;
+    else if (method_name != "store" && method_name != "add" && method_name != "sub" && method_name != "exchange") {
+        throw std::runtime_error("Unknown Atomic method: " + method_name);
+    }
+    if (arguments.size() < value_count || arguments.size() > value_count + 1) {
+        throw std::runtime_error("Wrong number of arguments to Atomic." + method_name);
+    }
+    MemoryOrder order = parse_memory_order(arguments, value_count);
+    
+    if (method_name == "cas") {
+        // Keep `expected` on the stack while `desired` is evaluated
+        emit_atomic_operand(gen, types, *arguments[0], is_float, false);
+        gen.emit_sub_reg_imm(4, 8);
+        if (auto x86_gen = dynamic_cast<X86CodeGen*>(&gen)) {
+            x86_gen->emit_mov_mem_rsp_reg(0, 0);
+        } else {
+            gen.emit_mov_mem_reg(0, 0);
+        }
+        emit_atomic_operand(gen, types, *arguments[1], is_float, false);
+        gen.emit_mov_reg_reg(2, 0);  // RDX = desired
+        if (auto x86_gen = dynamic_cast<X86CodeGen*>(&gen)) {
+            x86_gen->emit_mov_reg_mem_rsp(6, 0);
+        } else {
+            gen.emit_mov_reg_mem(6, 0);
+        }
+        gen.emit_add_reg_imm(4, 8);  // RSI = expected
+        gen.emit_mov_reg_mem(7, cell_offset);
+        gen.emit_atomic_compare_exchange(7, 6, 2, 0);
+        return DataType::BOOLEAN;
+    }
+    
+    if (value_count == 1) {
+        emit_atomic_operand(gen, types, *arguments[0], is_float, method_name == "sub");
+        gen.emit_mov_reg_reg(6, 0);  // RSI = value
+    }
+    gen.emit_mov_reg_mem(7, cell_offset);  // RDI = cell
+    
+    if (method_name == "load") {
+        if (order == MemoryOrder::RELEASE || order == MemoryOrder::ACQ_REL) {
+            throw std::runtime_error("Invalid memory order for Atomic.load");
+        }
+        gen.emit_atomic_load(7, 0, static_cast<int>(order));
+    } else if (method_name == "store") {
+        if (order == MemoryOrder::ACQUIRE || order == MemoryOrder::ACQ_REL) {
+            throw std::runtime_error("Invalid memory order for Atomic.store");
+        }
+        gen.emit_atomic_store(7, 6, static_cast<int>(order));
+        return DataType::VOID;
+    } else if (method_name == "exchange") {
+        gen.emit_atomic_exchange(7, 6, 0);
+    } else if (is_float) {
+        gen.emit_atomic_fetch_add_float64(7, 6, 0);
+    } else {
+        gen.emit_atomic_fetch_add(7, 6, 0);
+    }
+    
+    // Read-modify-writes return the previous value
+    if (is_float) gen.emit_float64_bits_to_int64(0);
+    return value_type;
+}
+
 void MethodCall::generate_code(CodeGenerator& gen, TypeInference& types) {
     
     // Handle built-in methods
@@ -1189,7 +1385,32 @@ void MethodCall::generate_code(CodeGenerator& gen, TypeInference& types) {
             DataType object_type = types.get_variable_type(object_name);
             std::string class_name = types.get_variable_class_name(object_name);
             
-            if (object_type == DataType::CLASS_INSTANCE && !class_name.empty()) {
+            if (object_type == DataType::CLASS_INSTANCE && is_builtin_lock_class(class_name) &&
+                LockJITCompiler::is_lock_operation(object_name, method_name)) {
+                // Lock methods are emitted inline: lock()/unlock() become a
+                // single lock cmpxchg with a runtime call only under contention
+                LockOperation op = LockJITCompiler::get_lock_operation(method_name);
+                int64_t lock_offset = types.get_variable_offset(object_name);
+                int arg_reg = -1;
+                if (op == LockOperation::TRY_ACQUIRE_TIMEOUT) {
+                    if (arguments.size() > 0) {
+                        arguments[0]->generate_code(gen, types);
+                        gen.emit_mov_reg_reg(6, 0); // RSI = timeout_ms
+                    } else {
+                        gen.emit_mov_reg_imm(6, 0);
+                    }
+                    arg_reg = 6;
+                }
+                gen.emit_mov_reg_mem(7, lock_offset); // RDI = Lock*
+                LockJITCompiler::emit_lock_operation(gen, op, 7, arg_reg, 0);
+                
+                result_type = (op == LockOperation::ACQUIRE || op == LockOperation::RELEASE)
+                                  ? DataType::VOID : DataType::BOOLEAN;
+            } else if (object_type == DataType::CLASS_INSTANCE && is_builtin_sync_class(class_name)) {
+                result_type = emit_sync_method(gen, types, class_name, object_name, method_name, arguments);
+            } else if (object_type == DataType::CLASS_INSTANCE && is_builtin_atomic_class(class_name)) {
+                result_type = emit_atomic_method(gen, types, class_name, object_name, method_name, arguments);
+            } else if (object_type == DataType::CLASS_INSTANCE && !class_name.empty()) {
                 // Get object ID from variable
                 int64_t object_offset = types.get_variable_offset(object_name);
                 gen.emit_mov_reg_mem(0, object_offset); // RAX = object_id
@@ -1310,6 +1531,7 @@ void FunctionExpression::compile_function_body(CodeGenerator& gen, TypeInference
     // Save current stack offset state
     TypeInference local_types;
     local_types.reset_for_function();
+    GCFrameScope gc_frame(gen, local_types);
     
     // Emit function label
     gen.emit_label(func_name);
@@ -1321,12 +1543,18 @@ void FunctionExpression::compile_function_body(CodeGenerator& gen, TypeInference
         estimated_stack_size += 16 - (estimated_stack_size % 16);
     }
     
+    // Non-escaping objects get frame space (escape_analysis.h)
+    FunctionEscapeInfo escapes = EscapeAnalysis::analyze(body, parameters);
+    estimated_stack_size += escapes.frame_bytes;
+    
     // Set stack size for this function
     if (auto x86_gen = dynamic_cast<X86CodeGen*>(&gen)) {
         x86_gen->set_function_stack_size(estimated_stack_size);
     }
     
     gen.emit_prologue();
+    escapes.place(estimated_stack_size, local_types);
+    EscapeInfoScope escape_scope(local_types, escapes);
     
     // Set up parameter types and save parameters from registers to stack
     for (size_t i = 0; i < parameters.size() && i < 6; i++) {
@@ -1454,6 +1682,22 @@ void ExpressionMethodCall::generate_code(CodeGenerator& gen, TypeInference& type
                 function_name = "__gots_set_interval";
             } else if (sub_object == "timer" && method_name == "clearInterval") {
                 function_name = "__gots_clear_interval";
+            } else if (sub_object == "gc" && method_name == "heapSize") {
+                function_name = "__runtime_gc_heap_size";
+            } else if (sub_object == "gc" && method_name == "heapUsed") {
+                function_name = "__runtime_gc_heap_used";
+            } else if (sub_object == "gc" && method_name == "nextGC") {
+                function_name = "__runtime_gc_next_gc";
+            } else if (sub_object == "gc" && method_name == "setMemoryLimit") {
+                function_name = "__runtime_gc_set_memory_limit";
+            } else if (sub_object == "gc" && method_name == "writeHeapSnapshot") {
+                function_name = "__runtime_gc_write_heap_snapshot";
+            } else if (sub_object == "gc" && method_name == "setHeapProfileRate") {
+                function_name = "__runtime_gc_set_heap_profile_rate";
+            } else if (sub_object == "gc" && method_name == "writeHeapProfile") {
+                function_name = "__runtime_gc_write_heap_profile";
+            } else if (sub_object == "weak" && method_name == "registerTarget") {
+                function_name = "__runtime_weak_register";
             }
             // Add more mappings as needed
             
@@ -1489,6 +1733,16 @@ void ExpressionMethodCall::generate_code(CodeGenerator& gen, TypeInference& type
                 result_type = DataType::INT64; // Timer ID
             } else if (sub_object == "timer" && (method_name == "clearTimeout" || method_name == "clearInterval" || method_name == "clearImmediate")) {
                 result_type = DataType::BOOLEAN; // Success/failure
+            } else if (sub_object == "gc" && (method_name == "heapSize" || method_name == "heapUsed" ||
+                                              method_name == "nextGC" || method_name == "setMemoryLimit" ||
+                                              method_name == "writeHeapSnapshot" || method_name == "setHeapProfileRate" ||
+                                              method_name == "writeHeapProfile")) {
+                result_type = DataType::INT64;
+            } else if (sub_object == "weak" && (method_name == "has" || method_name == "remove" ||
+                                                method_name == "unregister")) {
+                result_type = DataType::BOOLEAN;
+            } else if (sub_object == "weak" && method_name == "size") {
+                result_type = DataType::INT64;
             } else {
                 result_type = DataType::UNKNOWN;
             }
@@ -1695,6 +1949,12 @@ void ArrayLiteral::generate_code(CodeGenerator& gen, TypeInference& types) {
     result_type = DataType::ARRAY;
 }
 
+// Values typed as numbers or booleans are never heap pointers, so storing
+// them needs no card mark
+static bool needs_card_mark(const ExpressionNode* value) {
+    return !value || !TypeInference::is_scalar_type(value->result_type);
+}
+
 void ObjectLiteral::generate_code(CodeGenerator& gen, TypeInference& types) {
     // Create an object using the existing runtime object system
     // Use a special class name for object literals
@@ -1702,10 +1962,26 @@ void ObjectLiteral::generate_code(CodeGenerator& gen, TypeInference& types) {
     // Create string literal for the object literal class name
     static const char* object_literal_class = "ObjectLiteral";
     
-    // Call __object_create with class name and property count
-    gen.emit_mov_reg_imm(7, reinterpret_cast<int64_t>(object_literal_class)); // RDI = class_name
-    gen.emit_mov_reg_imm(6, properties.size()); // RSI = property count
-    gen.emit_call("__object_create");
+    const FunctionEscapeInfo* escapes = types.get_escape_info();
+    const FrameObject* frame = escapes ? escapes->site(this) : nullptr;
+    if (frame && frame->scalar_replaced) {
+        // Scalar replacement - each field lives in its own frame slot
+        for (size_t i = 0; i < properties.size(); i++) {
+            properties[i].second->generate_code(gen, types);
+            gen.emit_mov_mem_reg(frame->field_slots[i], 0);
+        }
+        gen.emit_mov_reg_imm(0, 0);
+        result_type = DataType::CLASS_INSTANCE;
+        return;
+    }
+    
+    if (frame) {
+        // Does not escape - built in this function's frame
+        gen.emit_object_create_in_frame(object_literal_class, properties.size(), frame->header_offset);
+    } else {
+        // Allocated inline on the GC heap - same result as __object_create
+        gen.emit_object_create(object_literal_class, properties.size());
+    }
     
     // RAX now contains the object_id
     // Store it temporarily while we add properties
@@ -1744,7 +2020,7 @@ void ObjectLiteral::generate_code(CodeGenerator& gen, TypeInference& types) {
         gen.emit_mov_reg_reg(2, 0); // RDX = value (save from RAX)
         gen.emit_mov_reg_mem(7, object_offset); // RDI = object_id
         gen.emit_mov_reg_imm(6, i); // RSI = property_index
-        gen.emit_call("__object_set_property");
+        gen.emit_object_set_property(i, !frame && needs_card_mark(prop.second.get()));
     }
     
     // Return the object_id in RAX
@@ -2088,6 +2364,7 @@ void PostfixDecrement::generate_code(CodeGenerator& gen, TypeInference& types) {
 void FunctionDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
     // Reset type inference for new function to avoid offset conflicts
     types.reset_for_function();
+    GCFrameScope gc_frame(gen, types);
     
     gen.emit_label(name);
     
@@ -2099,17 +2376,26 @@ void FunctionDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
         estimated_stack_size += 16 - (estimated_stack_size % 16);
     }
     
+    // Non-escaping objects get frame space (escape_analysis.h)
+    FunctionEscapeInfo escapes = EscapeAnalysis::analyze(body, parameters);
+    estimated_stack_size += escapes.frame_bytes;
+    
     // Set stack size for this function
     if (auto x86_gen = dynamic_cast<X86CodeGen*>(&gen)) {
         x86_gen->set_function_stack_size(estimated_stack_size);
     }
     
     gen.emit_prologue();
+    escapes.place(estimated_stack_size, types);
+    EscapeInfoScope escape_scope(types, escapes);
     
     // Set up parameter types and save parameters from registers to stack
     for (size_t i = 0; i < parameters.size() && i < 6; i++) {
         const auto& param = parameters[i];
         types.set_variable_type(param.name, param.type);
+        if (!param.class_name.empty()) {
+            types.set_variable_class_type(param.name, param.class_name);
+        }
         
         // Use fixed offsets for parameters to avoid conflicts with local variables  
         int stack_offset = -(int)(i + 1) * 8;  // Start at -8, -16, -24 etc
@@ -2602,6 +2888,16 @@ void ExpressionPropertyAccess::generate_code(CodeGenerator& gen, TypeInference&
         return;
     }
     
+    // Scalar-replaced object literal (escape_analysis.h) - the field is a frame slot
+    Identifier* object_id = dynamic_cast<Identifier*>(object.get());
+    const FunctionEscapeInfo* escapes = types.get_escape_info();
+    const FrameObject* scalar = object_id && escapes ? escapes->scalar_variable(object_id->name) : nullptr;
+    if (scalar) {
+        gen.emit_mov_reg_mem(0, scalar->field_slot(property_name));
+        result_type = DataType::UNKNOWN;
+        return;
+    }
+    
     // Generate code for the object expression first
     object->generate_code(gen, types);
     DataType object_type = object->result_type;
@@ -2704,6 +3000,58 @@ void ThisExpression::generate_code(CodeGenerator& gen, TypeInference& types) {
 }
 
 void NewExpression::generate_code(CodeGenerator& gen, TypeInference& types) {
+    if (is_builtin_lock_class(class_name)) {
+        // new Lock() - a runtime Lock, its methods are inlined by MethodCall.
+        // The source position identifies the lock in contention profiles.
+        static std::unordered_map<std::string, const char*> site_pool;
+        std::string file = ConstructorDecl::current_compiler_context
+                               ? ConstructorDecl::current_compiler_context->get_current_file() : "";
+        std::string site = (file.empty() ? "<input>" : file) + ":" + std::to_string(line) + ":" + std::to_string(column);
+        auto it = site_pool.find(site);
+        if (it == site_pool.end()) {
+            char* site_copy = new char[site.length() + 1];
+            strcpy(site_copy, site.c_str());
+            it = site_pool.emplace(site, site_copy).first;
+        }
+        gen.emit_mov_reg_imm(7, reinterpret_cast<int64_t>(it->second));  // RDI = site
+        gen.emit_call("__runtime_lock_create_at");
+        result_type = DataType::CLASS_INSTANCE;
+        return;
+    }
+    
+    if (is_builtin_sync_class(class_name)) {
+        // new Semaphore(permits) / new Barrier(parties) take a count,
+        // WaitGroup and RWLock take nothing
+        if (class_name == "Semaphore" || class_name == "Barrier") {
+            if (arguments.empty()) {
+                gen.emit_mov_reg_imm(0, 1);
+            } else {
+                arguments[0]->generate_code(gen, types);
+            }
+            gen.emit_mov_reg_reg(7, 0);  // RDI = count
+            gen.emit_call(class_name == "Semaphore" ? "__runtime_semaphore_create" : "__runtime_barrier_create");
+        } else {
+            gen.emit_call(class_name == "WaitGroup" ? "__runtime_waitgroup_create" : "__runtime_rwlock_create");
+        }
+        result_type = DataType::CLASS_INSTANCE;
+        return;
+    }
+    
+    if (is_builtin_atomic_class(class_name)) {
+        // new Atomic<T>(initial) - a runtime cell operated on inline by MethodCall
+        bool is_float = is_float64_atomic(class_name);
+        if (arguments.empty()) {
+            gen.emit_mov_reg_imm(0, 0);  // 0 and 0.0 share a bit pattern
+        } else {
+            emit_atomic_operand(gen, types, *arguments[0], is_float, false);
+        }
+        gen.emit_mov_reg_reg(7, 0);  // RDI = initial bits
+        gen.emit_mov_reg_imm(6, cache_line_padded ? 1 : 0);  // RSI = padded
+        gen.emit_call("__runtime_atomic_create");
+        result_type = DataType::CLASS_INSTANCE;
+        return;
+    }
+    
     // Create object instance - get actual property count from class registry
     int64_t property_count = 1; // Default fallback
     if (ConstructorDecl::current_compiler_context) {
@@ -2725,10 +3073,15 @@ void NewExpression::generate_code(CodeGenerator& gen, TypeInference& types) {
         it = class_name_pool.find(class_name);
     }
     
-    // Set up call to __object_create
-    gen.emit_mov_reg_imm(7, reinterpret_cast<int64_t>(it->second)); // RDI = class_name
-    gen.emit_mov_reg_imm(6, property_count); // RSI = property_count
-    gen.emit_call("__object_create");
+    const FunctionEscapeInfo* escapes = types.get_escape_info();
+    const FrameObject* frame = escapes ? escapes->site(this) : nullptr;
+    if (frame) {
+        // Does not escape - built in this function's frame
+        gen.emit_object_create_in_frame(it->second, property_count, frame->header_offset);
+    } else {
+        // Allocate the instance inline on the GC heap
+        gen.emit_object_create(it->second, property_count);
+    }
     
     // __object_create returns object_id in RAX
     // Store object_id temporarily for constructor call
@@ -2772,6 +3125,7 @@ void NewExpression::generate_code(CodeGenerator& gen, TypeInference& types) {
 void ConstructorDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
     // Reset type inference for new constructor to avoid offset conflicts
     types.reset_for_function();
+    GCFrameScope gc_frame(gen, types);
     
     // Generate constructor as a function with 'this' (object_id) as first parameter, then constructor parameters
     std::string constructor_label = "__constructor_" + class_name;
@@ -2828,8 +3182,7 @@ void ConstructorDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
                     gen.emit_mov_reg_reg(2, 0);  // RDX = value (from RAX)
                     gen.emit_mov_reg_mem(7, -8); // RDI = object_id (from 'this')
                     gen.emit_mov_reg_imm(6, i);  // RSI = property_index
-                    gen.emit_call("__object_set_property");
-                    
+                    gen.emit_object_set_property(i, needs_card_mark(field.default_value.get()));
                 }
             }
         }
@@ -2847,6 +3200,7 @@ void ConstructorDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
 void MethodDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
     // Reset type inference for new method to avoid offset conflicts
     types.reset_for_function();
+    GCFrameScope gc_frame(gen, types);
     
     // Generate different labels and parameter handling for static vs instance methods
     std::string method_label = is_static ? "__static_" + name : "__method_" + name;
@@ -2860,11 +3214,17 @@ void MethodDecl::generate_code(CodeGenerator& gen, TypeInference& types) {
         estimated_stack_size += 16 - (estimated_stack_size % 16);
     }
     
+    // Non-escaping objects get frame space (escape_analysis.h)
+    FunctionEscapeInfo escapes = EscapeAnalysis::analyze(body, parameters);
+    estimated_stack_size += escapes.frame_bytes;
+    
     if (auto x86_gen = dynamic_cast<X86CodeGen*>(&gen)) {
         x86_gen->set_function_stack_size(estimated_stack_size);
     }
     
     gen.emit_prologue();
+    escapes.place(estimated_stack_size, types);
+    EscapeInfoScope escape_scope(types, escapes);
     
     if (!is_static) {
         // Instance method: first parameter (RDI) is the object_id (this)
@@ -2934,7 +3294,8 @@ void PropertyAssignment::generate_code(CodeGenerator& gen, TypeInference& types)
         gen.emit_mov_reg_reg(2, 0); // RDX = value (from RAX)
         gen.emit_mov_reg_mem(7, -8); // RDI = object_id (from 'this' parameter on stack)
         gen.emit_mov_reg_imm(6, 0);  // RSI = property_index (hardcoded for first property)
-        gen.emit_call("__object_set_property");
+        gen.emit_gc_pre_write_barrier(7, GCObjectLayout::value_offset(0));
+        gen.emit_object_set_property(0, needs_card_mark(value.get()));
         
     } else {
         // Handle regular object.property = value
@@ -2959,7 +3320,8 @@ void PropertyAssignment::generate_code(CodeGenerator& gen, TypeInference& types)
             gen.emit_mov_reg_reg(2, 0); // RDX = value (save value from RAX first)
             gen.emit_mov_reg_mem(7, obj_offset); // RDI = object_id
             gen.emit_mov_reg_imm(6, property_index);  // RSI = property_index
-            gen.emit_call("__object_set_property");
+            gen.emit_gc_pre_write_barrier(7, GCObjectLayout::value_offset(property_index));
+            gen.emit_object_set_property(property_index, needs_card_mark(value.get()));
         } else {
             // Object not found as variable - might be static property assignment (ClassName.property = value)
             // Setup string pooling for class name and property name
@@ -3194,11 +3556,15 @@ void OperatorOverloadDecl::generate_code(CodeGenerator& gen, TypeInference& type
     
     // Reset type inference for new function
     types.reset_for_function();
+    GCFrameScope gc_frame(gen, types);
     
     // Set up parameter types and save parameters from registers to stack
     for (size_t i = 0; i < parameters.size() && i < 6; i++) {
         const auto& param = parameters[i];
         types.set_variable_type(param.name, param.type);
+        if (!param.class_name.empty()) {
+            types.set_variable_class_type(param.name, param.class_name);
+        }
         
         int stack_offset = -(int)(i + 1) * 8;
         types.set_variable_offset(param.name, stack_offset);
@@ -0,0 +1,510 @@
+#include "async_file_io.h"
+#include "netpoller.h"
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+namespace gots {
+
+// Raw io_uring syscalls - liburing is not a dependency
+static int io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int io_uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+// Published once the singleton is built, so forget_fd never creates the ring
+static std::atomic<AsyncFileIO*> g_async_file_io{nullptr};
+
+AsyncFileIO& AsyncFileIO::instance() {
+    // Use heap allocation to avoid static destruction order issues
+    static AsyncFileIO* instance = [] {
+        AsyncFileIO* io = new AsyncFileIO();
+        g_async_file_io.store(io, std::memory_order_release);
+        return io;
+    }();
+    return *instance;
+}
+
+void AsyncFileIO::forget_fd(int fd) {
+    AsyncFileIO* io = g_async_file_io.load(std::memory_order_acquire);
+    if (io) io->release_fixed_slot(fd);
+}
+
+AsyncFileIO::AsyncFileIO() {
+    const char* env = std::getenv("GOTS_IO_URING");
+    bool enabled = !(env && strcmp(env, "0") == 0);
+
+    if (enabled && setup_ring()) {
+        setup_registered_buffers();
+        setup_fixed_files();
+        return;
+    }
+
+    fallback_pool_ = std::make_unique<ThreadPool>(4);
+}
+
+bool AsyncFileIO::setup_ring() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = io_uring_setup(RING_ENTRIES, &params);
+    if (fd < 0) {
+        return false;
+    }
+    ring_fd_ = fd;
+
+    // Reads/writes use the file position (offset -1), and completions must
+    // never be dropped
+    unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS;
+    if ((params.features & required) != required) {
+        teardown_ring();
+        return false;
+    }
+
+    // Make sure every opcode we issue is supported by this kernel
+    size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    std::vector<char> probe_storage(probe_size, 0);
+    auto* probe = reinterpret_cast<struct io_uring_probe*>(probe_storage.data());
+    if (io_uring_register(ring_fd_, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        teardown_ring();
+        return false;
+    }
+    for (int op : {IORING_OP_OPENAT, IORING_OP_CLOSE, IORING_OP_READ, IORING_OP_WRITE,
+                   IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            teardown_ring();
+            return false;
+        }
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    size_t ring_size = std::max(sq_ring_size_, cq_ring_size_);
+    sq_ring_size_ = cq_ring_size_ = ring_size;
+
+    sq_ring_ptr_ = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ == MAP_FAILED) {
+        sq_ring_ptr_ = nullptr;
+        teardown_ring();
+        return false;
+    }
+    cq_ring_ptr_ = sq_ring_ptr_;  // IORING_FEAT_SINGLE_MMAP
+
+    void* sqes = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        teardown_ring();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ring_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    sq_entries_ = params.sq_entries;
+    cq_entries_ = params.cq_entries;
+
+    // Completions are reaped by the netpoller thread via an eventfd
+    completion_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (completion_fd_ < 0 ||
+        io_uring_register(ring_fd_, IORING_REGISTER_EVENTFD, &completion_fd_, 1) < 0 ||
+        !NetPoller::instance().watch(completion_fd_, [this] { reap_completions(); })) {
+        teardown_ring();
+        return false;
+    }
+
+    return true;
+}
+
+void AsyncFileIO::teardown_ring() {
+    if (sqes_) {
+        munmap(sqes_, sq_entries_ * sizeof(struct io_uring_sqe));
+        sqes_ = nullptr;
+    }
+    if (sq_ring_ptr_) {
+        munmap(sq_ring_ptr_, sq_ring_size_);
+        sq_ring_ptr_ = cq_ring_ptr_ = nullptr;
+    }
+    if (completion_fd_ >= 0) {
+        NetPoller::instance().close(completion_fd_);
+        ::close(completion_fd_);
+        completion_fd_ = -1;
+    }
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+void AsyncFileIO::setup_registered_buffers() {
+    buffer_storage_.resize(REGISTERED_BUFFERS * REGISTERED_BUFFER_SIZE);
+    std::vector<struct iovec> iovecs(REGISTERED_BUFFERS);
+    for (unsigned i = 0; i < REGISTERED_BUFFERS; ++i) {
+        iovecs[i].iov_base = buffer_storage_.data() + i * REGISTERED_BUFFER_SIZE;
+        iovecs[i].iov_len = REGISTERED_BUFFER_SIZE;
+    }
+
+    // May fail under a small RLIMIT_MEMLOCK - plain READ/WRITE still work
+    if (io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, iovecs.data(), REGISTERED_BUFFERS) < 0) {
+        buffer_storage_.clear();
+        buffer_storage_.shrink_to_fit();
+        return;
+    }
+
+    for (int i = REGISTERED_BUFFERS - 1; i >= 0; --i) {
+        free_buffers_.push_back(i);
+    }
+    buffers_registered_ = true;
+}
+
+void AsyncFileIO::setup_fixed_files() {
+    // Start with an empty (sparse) table and promote hot descriptors later
+    std::vector<int> fds(FIXED_FILE_SLOTS, -1);
+    if (io_uring_register(ring_fd_, IORING_REGISTER_FILES, fds.data(), FIXED_FILE_SLOTS) < 0) {
+        return;
+    }
+
+    for (int i = FIXED_FILE_SLOTS - 1; i >= 0; --i) {
+        free_fixed_slots_.push_back(i);
+    }
+    fixed_slot_states_.resize(FIXED_FILE_SLOTS);
+    files_registered_ = true;
+}
+
+int AsyncFileIO::acquire_buffer() {
+    if (!buffers_registered_) return -1;
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (free_buffers_.empty()) return -1;
+    int index = free_buffers_.back();
+    free_buffers_.pop_back();
+    return index;
+}
+
+void AsyncFileIO::release_buffer(int index) {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    free_buffers_.push_back(index);
+}
+
+int AsyncFileIO::fixed_slot_for(int fd) {
+    if (!files_registered_) return -1;
+    std::lock_guard<std::mutex> lock(files_mutex_);
+
+    auto it = fixed_slots_.find(fd);
+    if (it != fixed_slots_.end()) {
+        fixed_slot_states_[it->second].users++;
+        return it->second;
+    }
+
+    if (++fd_use_counts_[fd] < HOT_FD_THRESHOLD || free_fixed_slots_.empty()) {
+        return -1;
+    }
+
+    int slot = free_fixed_slots_.back();
+    struct io_uring_files_update update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<unsigned>(slot);
+    update.fds = reinterpret_cast<uint64_t>(&fd);
+    if (io_uring_register(ring_fd_, IORING_REGISTER_FILES_UPDATE, &update, 1) != 1) {
+        return -1;
+    }
+
+    free_fixed_slots_.pop_back();
+    fd_use_counts_.erase(fd);
+    fixed_slots_[fd] = slot;
+    fixed_slot_states_[slot].users++;
+    return slot;
+}
+
+void AsyncFileIO::release_fixed_slot(int fd) {
+    if (!files_registered_) return;
+    std::lock_guard<std::mutex> lock(files_mutex_);
+
+    fd_use_counts_.erase(fd);
+    auto it = fixed_slots_.find(fd);
+    if (it == fixed_slots_.end()) return;
+
+    // No new request can name the slot once the mapping is gone. Requests
+    // that already did may still be waiting for the submitter's
+    // io_uring_enter, so the slot keeps the old file until they complete.
+    int slot = it->second;
+    fixed_slots_.erase(it);
+    if (fixed_slot_states_[slot].users > 0) {
+        fixed_slot_states_[slot].retiring = true;
+        return;
+    }
+    clear_fixed_slot(slot);
+}
+
+void AsyncFileIO::finish_fixed_slot_use(int slot) {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    FixedSlotState& state = fixed_slot_states_[slot];
+    if (--state.users == 0 && state.retiring) {
+        clear_fixed_slot(slot);
+    }
+}
+
+void AsyncFileIO::clear_fixed_slot(int slot) {
+    int empty = -1;
+    struct io_uring_files_update update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<unsigned>(slot);
+    update.fds = reinterpret_cast<uint64_t>(&empty);
+    io_uring_register(ring_fd_, IORING_REGISTER_FILES_UPDATE, &update, 1);
+
+    fixed_slot_states_[slot].retiring = false;
+    free_fixed_slots_.push_back(slot);
+}
+
+PromiseRef AsyncFileIO::submit(Request* request, const io_uring_sqe& sqe) {
+    PromiseRef promise = request->promise;
+    {
+        // Capping in-flight ops at the SQ size means the SQ can never be full
+        // and the CQ (twice as large) can never overflow
+        std::unique_lock<std::mutex> lock(sq_mutex_);
+        sq_space_cv_.wait(lock, [this] { return inflight_ < sq_entries_; });
+
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & *sq_mask_;
+        sqes_[index] = sqe;
+        sqes_[index].user_data = reinterpret_cast<uint64_t>(request);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        inflight_++;
+    }
+
+    // Whoever queues into an empty batch submits it, along with everything
+    // other goroutines queue while that io_uring_enter is in progress
+    if (unsubmitted_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        flush_submissions();
+    }
+    return promise;
+}
+
+void AsyncFileIO::flush_submissions() {
+    unsigned pending = unsubmitted_.load(std::memory_order_acquire);
+    while (pending > 0) {
+        int submitted = io_uring_enter(ring_fd_, pending, 0, 0);
+        if (submitted <= 0) {
+            if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                std::cerr << "ERROR: io_uring_enter failed: " << strerror(errno) << std::endl;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        pending = unsubmitted_.fetch_sub(static_cast<unsigned>(submitted), std::memory_order_acq_rel) -
+                  static_cast<unsigned>(submitted);
+    }
+}
+
+void AsyncFileIO::reap_completions() {
+    // Runs on the netpoller thread. Drain the eventfd before the CQ so a
+    // completion posted while we drain produces a fresh edge.
+    uint64_t signalled;
+    ssize_t drained = ::read(completion_fd_, &signalled, sizeof(signalled));
+    (void)drained;
+
+    std::lock_guard<std::mutex> reap_lock(reap_mutex_);
+    std::vector<std::pair<Request*, int>>& completed = reaped_;
+    completed.clear();
+    while (true) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail) break;
+
+        auto* cqes = static_cast<struct io_uring_cqe*>(cqes_);
+        for (; head != tail; ++head) {
+            struct io_uring_cqe* cqe = &cqes[head & *cq_mask_];
+            completed.emplace_back(reinterpret_cast<Request*>(cqe->user_data), cqe->res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+    if (completed.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(sq_mutex_);
+        inflight_ -= static_cast<unsigned>(completed.size());
+    }
+    sq_space_cv_.notify_all();
+
+    for (const auto& entry : completed) {
+        complete(entry.first, entry.second);
+    }
+}
+
+void AsyncFileIO::complete(Request* request, int result) {
+    if (request->buffer_index >= 0) {
+        if (request->kind == OpKind::READ && result > 0) {
+            memcpy(request->user_buffer,
+                   buffer_storage_.data() + request->buffer_index * REGISTERED_BUFFER_SIZE,
+                   static_cast<size_t>(result));
+        }
+        release_buffer(request->buffer_index);
+    }
+    if (request->fixed_slot >= 0) {
+        finish_fixed_slot_use(request->fixed_slot);
+    }
+
+    // Match the synchronous __runtime_fs_* functions: -1 on error
+    int64_t value = result < 0 ? -1 : result;
+    request->promise->resolve(value);
+    SlabAllocator<Request>::destroy(request);
+}
+
+PromiseRef AsyncFileIO::run_on_pool(std::function<int64_t()> op) {
+    auto promise = make_ref<Promise>();
+    fallback_pool_->enqueue_simple([promise, op = std::move(op)]() {
+        int64_t value = op();
+        promise->resolve(value);
+    });
+    return promise;
+}
+
+PromiseRef AsyncFileIO::open(const char* path, int flags, mode_t mode) {
+    if (!using_io_uring()) {
+        std::string owned_path(path);
+        return run_on_pool([owned_path, flags, mode]() -> int64_t {
+            return ::open(owned_path.c_str(), flags, mode);
+        });
+    }
+
+    Request* request = SlabAllocator<Request>::create();
+    request->kind = OpKind::OPEN;
+    request->promise = make_ref<Promise>();
+    request->path = path;
+
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_OPENAT;
+    sqe.fd = AT_FDCWD;
+    sqe.addr = reinterpret_cast<uint64_t>(request->path.c_str());
+    sqe.len = static_cast<uint32_t>(mode);
+    sqe.open_flags = static_cast<uint32_t>(flags);
+    return submit(request, sqe);
+}
+
+PromiseRef AsyncFileIO::read(int fd, void* buffer, size_t size) {
+    if (!using_io_uring()) {
+        return run_on_pool([fd, buffer, size]() -> int64_t {
+            return ::read(fd, buffer, size);
+        });
+    }
+
+    Request* request = SlabAllocator<Request>::create();
+    request->kind = OpKind::READ;
+    request->promise = make_ref<Promise>();
+    request->user_buffer = buffer;
+    request->size = std::min<size_t>(size, INT_MAX);
+
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.off = static_cast<uint64_t>(-1);  // Current file position
+    sqe.len = static_cast<uint32_t>(request->size);
+
+    request->fixed_slot = fixed_slot_for(fd);
+    sqe.fd = request->fixed_slot >= 0 ? request->fixed_slot : fd;
+    if (request->fixed_slot >= 0) sqe.flags |= IOSQE_FIXED_FILE;
+
+    // Small reads land in a pre-registered buffer - no page pinning per op
+    if (request->size <= REGISTERED_BUFFER_SIZE) {
+        request->buffer_index = acquire_buffer();
+    }
+    if (request->buffer_index >= 0) {
+        sqe.opcode = IORING_OP_READ_FIXED;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer_storage_.data() + request->buffer_index * REGISTERED_BUFFER_SIZE);
+        sqe.buf_index = static_cast<uint16_t>(request->buffer_index);
+    } else {
+        sqe.opcode = IORING_OP_READ;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer);
+    }
+    return submit(request, sqe);
+}
+
+PromiseRef AsyncFileIO::write(int fd, const void* buffer, size_t size) {
+    if (!using_io_uring()) {
+        return run_on_pool([fd, buffer, size]() -> int64_t {
+            return ::write(fd, buffer, size);
+        });
+    }
+
+    Request* request = SlabAllocator<Request>::create();
+    request->kind = OpKind::WRITE;
+    request->promise = make_ref<Promise>();
+    request->size = std::min<size_t>(size, INT_MAX);
+
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.off = static_cast<uint64_t>(-1);  // Current file position
+    sqe.len = static_cast<uint32_t>(request->size);
+
+    request->fixed_slot = fixed_slot_for(fd);
+    sqe.fd = request->fixed_slot >= 0 ? request->fixed_slot : fd;
+    if (request->fixed_slot >= 0) sqe.flags |= IOSQE_FIXED_FILE;
+
+    // Small writes are staged in a registered buffer, which also frees the
+    // caller's buffer as soon as this returns
+    if (request->size <= REGISTERED_BUFFER_SIZE) {
+        request->buffer_index = acquire_buffer();
+    }
+    if (request->buffer_index >= 0) {
+        char* staged = buffer_storage_.data() + request->buffer_index * REGISTERED_BUFFER_SIZE;
+        memcpy(staged, buffer, request->size);
+        sqe.opcode = IORING_OP_WRITE_FIXED;
+        sqe.addr = reinterpret_cast<uint64_t>(staged);
+        sqe.buf_index = static_cast<uint16_t>(request->buffer_index);
+    } else {
+        sqe.opcode = IORING_OP_WRITE;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer);
+    }
+    return submit(request, sqe);
+}
+
+PromiseRef AsyncFileIO::close(int fd) {
+    if (!using_io_uring()) {
+        return run_on_pool([fd]() -> int64_t {
+            return ::close(fd);
+        });
+    }
+
+    // Unmap it first so no later request names the slot; the slot itself is
+    // freed once the fd's queued ops complete
+    release_fixed_slot(fd);
+
+    Request* request = SlabAllocator<Request>::create();
+    request->kind = OpKind::CLOSE;
+    request->promise = make_ref<Promise>();
+
+    io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_CLOSE;
+    sqe.fd = fd;
+    return submit(request, sqe);
+}
+
+int64_t AsyncFileIO::await_result(const PromiseRef& promise) {
+    promise->wait();
+    return promise->await<int64_t>();
+}
+
+} // namespace gots
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "runtime.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+struct io_uring_sqe;
+
+namespace gots {
+
+// ============================================================================
+// ASYNC FILE I/O - io_uring backend with blocking thread pool fallback
+// ============================================================================
+//
+// open/read/write/close are queued on one process-wide io_uring and resolve a
+// Promise with the syscall-style result (-1 on error). Submissions from all
+// goroutines are combined: whichever caller finds the queue empty becomes the
+// submitter and flushes every SQE queued behind it in a single
+// io_uring_enter. Completions are signalled through an eventfd watched by the
+// NetPoller, so they are reaped on the same thread that drives socket
+// readiness - no dedicated completion thread.
+//
+// Small reads and writes are staged through a pool of registered buffers,
+// and descriptors that see repeated I/O are promoted into the ring's fixed
+// file table so the kernel skips the per-op fd lookup.
+//
+// Set GOTS_IO_URING=0 (or run on a kernel without io_uring) to use a blocking
+// ThreadPool instead.
+
+class AsyncFileIO {
+public:
+    static AsyncFileIO& instance();
+
+    bool using_io_uring() const { return ring_fd_ >= 0; }
+
+    PromiseRef open(const char* path, int flags, mode_t mode);
+    PromiseRef read(int fd, void* buffer, size_t size);
+    PromiseRef write(int fd, const void* buffer, size_t size);
+    PromiseRef close(int fd);
+
+    // Drop fd's fixed-file slot and use count. Every path that closes a
+    // descriptor outside close() must call this first, or the ring keeps the
+    // old file registered under an fd number the kernel is about to reuse.
+    // A no-op until the first async operation creates the ring.
+    static void forget_fd(int fd);
+
+    // Block the calling goroutine until `promise` resolves and return its result
+    static int64_t await_result(const PromiseRef& promise);
+
+    // Tunables
+    static constexpr unsigned RING_ENTRIES = 256;
+    static constexpr unsigned REGISTERED_BUFFERS = 64;
+    static constexpr size_t REGISTERED_BUFFER_SIZE = 16 * 1024;
+    static constexpr unsigned FIXED_FILE_SLOTS = 64;
+    static constexpr uint32_t HOT_FD_THRESHOLD = 8;  // Ops before an fd becomes a fixed file
+
+private:
+    AsyncFileIO();
+    AsyncFileIO(const AsyncFileIO&) = delete;
+    AsyncFileIO& operator=(const AsyncFileIO&) = delete;
+
+    enum class OpKind { OPEN, READ, WRITE, CLOSE };
+
+    // From a SlabAllocator, freed when its completion is reaped
+    struct Request {
+        OpKind kind;
+        PromiseRef promise;
+        void* user_buffer = nullptr;  // Destination for staged reads
+        size_t size = 0;
+        int buffer_index = -1;        // Registered buffer, -1 if none
+        int fixed_slot = -1;          // Fixed file the SQE names, -1 if none
+        std::string path;             // Kept alive until OPENAT completes
+    };
+
+    // Ring state (mmap'd from the kernel)
+    int ring_fd_ = -1;
+    int completion_fd_ = -1;  // eventfd signalled on every CQE
+    unsigned sq_entries_ = 0;
+    unsigned cq_entries_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    void* cqes_ = nullptr;
+    void* sq_ring_ptr_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    void* cq_ring_ptr_ = nullptr;
+    size_t cq_ring_size_ = 0;
+
+    // Submission side
+    std::mutex sq_mutex_;
+    std::condition_variable sq_space_cv_;
+    unsigned inflight_ = 0;                  // Protected by sq_mutex_
+    std::atomic<unsigned> unsubmitted_{0};   // Published SQEs not yet handed to the kernel
+    std::mutex reap_mutex_;
+    std::vector<std::pair<Request*, int>> reaped_;  // Reused by every reap, under reap_mutex_
+
+    // Registered buffers
+    std::mutex buffer_mutex_;
+    std::vector<char> buffer_storage_;
+    std::vector<int> free_buffers_;
+    bool buffers_registered_ = false;
+
+    // Fixed files for hot descriptors
+    std::mutex files_mutex_;
+    std::unordered_map<int, uint32_t> fd_use_counts_;
+    std::unordered_map<int, int> fixed_slots_;  // fd -> fixed file index
+    std::vector<int> free_fixed_slots_;
+    // A published SQE names its slot by index and only takes a file reference
+    // once the kernel consumes it, so a released slot is not reused until
+    // every request that named it has completed
+    struct FixedSlotState {
+        uint32_t users = 0;     // Requests naming this slot, not yet completed
+        bool retiring = false;  // Released while users > 0
+    };
+    std::vector<FixedSlotState> fixed_slot_states_;
+    bool files_registered_ = false;
+
+    // Fallback when io_uring is unavailable
+    std::unique_ptr<ThreadPool> fallback_pool_;
+
+    bool setup_ring();
+    void teardown_ring();
+    void setup_registered_buffers();
+    void setup_fixed_files();
+
+    int acquire_buffer();
+    void release_buffer(int index);
+    int fixed_slot_for(int fd);      // Counts the use; may promote fd
+    void release_fixed_slot(int fd);
+    void finish_fixed_slot_use(int slot);
+    void clear_fixed_slot(int slot);  // Caller holds files_mutex_
+
+    PromiseRef submit(Request* request, const io_uring_sqe& sqe);
+    void flush_submissions();
+    void reap_completions();
+    void complete(Request* request, int result);
+
+    PromiseRef run_on_pool(std::function<int64_t()> op);
+};
+
+} // namespace gots
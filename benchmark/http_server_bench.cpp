@@ -0,0 +1,145 @@
+#include "../http_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+using namespace gots;
+
+// HTTP server throughput/latency benchmark with a built-in keep-alive load
+// generator. Reports requests per second and latency percentiles.
+//
+// Build (from repo root):
+//   make && g++ -std=c++17 -O2 -pthread benchmark/http_server_bench.cpp $(ls *.o | grep -v simple_main.o) -o http_server_bench
+// Run:
+//   ./http_server_bench [connections] [seconds] [pipeline_depth]
+//   ./http_server_bench --serve 8080     # serve only, for an external generator such as wrk
+
+static const char REQUEST[] = "GET /plaintext HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+static int connect_loopback(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Consume complete responses from the front of `buffer`; returns how many
+static int consume_responses(std::string& buffer) {
+    int count = 0;
+    size_t pos = 0;
+    while (true) {
+        size_t head_end = buffer.find("\r\n\r\n", pos);
+        if (head_end == std::string::npos) break;
+        size_t length = 0;
+        size_t cl = buffer.find("Content-Length: ", pos);
+        if (cl != std::string::npos && cl < head_end) {
+            length = std::stoul(buffer.substr(cl + 16, head_end - cl - 16));
+        }
+        if (buffer.size() < head_end + 4 + length) break;
+        pos = head_end + 4 + length;
+        count++;
+    }
+    buffer.erase(0, pos);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    HttpServer server([](const HttpRequest&, HttpResponse& response) {
+        response.set_header("Content-Type", "text/plain");
+        response.send("Hello, World!");
+    });
+
+    if (argc >= 3 && strcmp(argv[1], "--serve") == 0) {
+        if (!server.listen(atoi(argv[2]), "0.0.0.0")) {
+            std::cerr << "ERROR: listen failed" << std::endl;
+            return 1;
+        }
+        std::cout << "Serving on port " << server.port() << std::endl;
+        while (true) std::this_thread::sleep_for(std::chrono::seconds(60));
+    }
+
+    int connections = argc > 1 ? atoi(argv[1]) : 64;
+    int seconds = argc > 2 ? atoi(argv[2]) : 5;
+    int pipeline = argc > 3 ? std::max(1, atoi(argv[3])) : 1;
+
+    if (!server.listen(0, "127.0.0.1")) {
+        std::cerr << "ERROR: listen failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "=== HTTP server benchmark ===" << std::endl;
+    std::cout << connections << " connections, " << seconds << "s, pipeline depth " << pipeline << std::endl;
+
+    std::atomic<bool> running{true};
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<std::thread> clients;
+    std::string batch;
+    for (int i = 0; i < pipeline; ++i) batch += REQUEST;
+
+    for (int c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c]() {
+            int fd = connect_loopback(server.port());
+            if (fd < 0) return;
+            std::string buffer;
+            char chunk[16384];
+            auto& samples = latencies[c];
+            while (running.load(std::memory_order_relaxed)) {
+                auto start = std::chrono::steady_clock::now();
+                if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) < 0) break;
+                int received = 0;
+                while (received < pipeline) {
+                    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                    if (n <= 0) { close(fd); return; }
+                    buffer.append(chunk, static_cast<size_t>(n));
+                    received += consume_responses(buffer);
+                }
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                for (int i = 0; i < pipeline; ++i) samples.push_back(us);
+            }
+            close(fd);
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running.store(false);
+    for (auto& t : clients) t.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<double> all;
+    for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    if (all.empty()) {
+        std::cerr << "ERROR: no requests completed" << std::endl;
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) {
+        return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+    };
+
+    std::cout << "Requests:     " << all.size() << std::endl;
+    std::cout << "Requests/sec: " << static_cast<int64_t>(all.size() / elapsed) << std::endl;
+    std::cout << "Latency p50:  " << percentile(0.50) << " us" << std::endl;
+    std::cout << "Latency p99:  " << percentile(0.99) << " us" << std::endl;
+    std::cout << "Latency max:  " << all.back() << " us" << std::endl;
+    return 0;
+}
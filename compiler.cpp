@@ -3,6 +3,8 @@
 #include "runtime_syscalls.h"
 #include "goroutine_system.h"
 #include "function_compilation_manager.h"
+#include "gc_memory_manager.h"
+#include "escape_analysis.h"
 
 // External console mutex for thread safety
 extern std::mutex g_console_mutex;
@@ -76,6 +78,7 @@ void GoTSCompiler::compile(const std::string& source) {
                 class_info.fields = class_decl->fields;
                 class_info.parent_class = class_decl->parent_class;
                 class_info.instance_size = class_decl->fields.size() * 8; // 8 bytes per property
+                class_info.frame_allocatable = EscapeAnalysis::constructor_keeps_this(*class_decl);
                 register_class(class_info);
                 std::cout << "Registered class: " << class_decl->name << " with " << class_decl->fields.size() << " fields";
                 if (!class_decl->parent_class.empty()) {
@@ -180,12 +183,20 @@ void GoTSCompiler::compile(const std::string& source) {
             estimated_stack_size += 16 - (estimated_stack_size % 16);
         }
         
+        // Non-escaping objects get frame space (escape_analysis.h)
+        FunctionEscapeInfo main_escapes = EscapeAnalysis::analyze(ast, {});
+        estimated_stack_size += main_escapes.frame_bytes;
+        
         // Set stack size for main function
         if (auto x86_gen = dynamic_cast<X86CodeGen*>(codegen.get())) {
             x86_gen->set_function_stack_size(estimated_stack_size);
         }
         
+        // Calls in main record stack maps for its variables
+        GCFrameScope main_frame(*codegen, type_system);
         codegen->emit_prologue();
+        main_escapes.place(estimated_stack_size, type_system);
+        EscapeInfoScope main_escape_scope(type_system, main_escapes);
         
         // Process imports first (they are hoisted like in JavaScript/TypeScript)
         for (const auto& node : ast) {
@@ -285,6 +296,16 @@ void GoTSCompiler::execute() {
             return;
         }
         
+        // Inline GC allocations restart from their first instruction if the
+        // thread is stopped for a collection part-way through
+        for (const auto& range : codegen->get_gc_restart_ranges()) {
+            GarbageCollector::instance().register_restartable_range(
+                static_cast<uint8_t*>(exec_mem) + range.first, static_cast<uint8_t*>(exec_mem) + range.second);
+        }
+        GarbageCollector::instance().register_stack_maps(exec_mem, codegen->get_gc_stack_maps());
+        GarbageCollector::instance().register_code_symbols(exec_mem, codegen->get_current_offset(),
+                                                           codegen->get_function_symbols());
+        
         // PHASE 2.5: ASSIGN FUNCTION ADDRESSES
         // Now that we have executable memory, assign addresses to all functions
         FunctionCompilationManager::instance().assign_function_addresses(exec_mem, aligned_size);
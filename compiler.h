@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <unordered_map>
 #include <memory>
 #include <cstdint>
@@ -135,6 +136,7 @@ struct Variable {
     bool is_static = false;
     std::string class_name;  // For CLASS_INSTANCE type, stores the class name
     std::shared_ptr<ExpressionNode> default_value;  // Default value for class fields
+    bool cache_line_padded = false;  // `padded` class field - its Atomic cell owns a cache line
 };
 
 struct Function {
@@ -170,6 +172,7 @@ struct ClassInfo {
     std::unordered_map<TokenType, std::vector<OperatorOverload>> operator_overloads;  // Multiple overloads per operator
     Function* constructor;
     int64_t instance_size;  // Total size needed for an instance
+    bool frame_allocatable = false;  // Constructor keeps `this` local (escape_analysis.h)
     
     ClassInfo() : constructor(nullptr), instance_size(0) {}
     ClassInfo(const std::string& n) : name(n), constructor(nullptr), instance_size(0) {}
@@ -180,6 +183,23 @@ enum class Backend {
     WASM
 };
 
+// Memory orderings accepted by emit_atomic_store/load and emit_memory_fence
+enum class MemoryOrder : int {
+    RELAXED = 0,
+    ACQUIRE = 1,
+    RELEASE = 2,
+    ACQ_REL = 3,
+    SEQ_CST = 4
+};
+
+class TypeInference;
+class FunctionEscapeInfo;
+
+// Return address offset -> RBP-relative slots holding heap references
+using GCStackMaps = std::vector<std::pair<size_t, std::vector<int32_t>>>;
+// Code offset of a function's prologue -> its label, in code order
+using FunctionSymbols = std::vector<std::pair<size_t, std::string>>;
+
 class CodeGenerator {
 public:
     virtual ~CodeGenerator() = default;
@@ -234,12 +254,60 @@ public:
     virtual void emit_lock_try_acquire(int lock_reg, int result_reg) = 0;
     virtual void emit_lock_try_acquire_timeout(int lock_reg, int timeout_reg, int result_reg) = 0;
     
+    // WaitGroup / Semaphore fast paths - one locked instruction when uncontended
+    virtual void emit_waitgroup_add(int wg_reg, int delta_reg) = 0;
+    virtual void emit_semaphore_acquire(int sem_reg) = 0;
+    virtual void emit_semaphore_release(int sem_reg) = 0;
+    
     // Atomic operations for lock implementation
     virtual void emit_atomic_compare_exchange(int ptr_reg, int expected_reg, int desired_reg, int result_reg) = 0;
     virtual void emit_atomic_fetch_add(int ptr_reg, int value_reg, int result_reg) = 0;
     virtual void emit_atomic_store(int ptr_reg, int value_reg, int memory_order) = 0;
     virtual void emit_atomic_load(int ptr_reg, int result_reg, int memory_order) = 0;
     virtual void emit_memory_fence(int fence_type) = 0;
+    virtual void emit_atomic_exchange(int ptr_reg, int value_reg, int result_reg) = 0;
+    
+    // Atomic<float64> - the cell holds IEEE-754 bits while JIT numbers are int64
+    virtual void emit_atomic_fetch_add_float64(int ptr_reg, int value_reg, int result_reg) = 0;
+    virtual void emit_int64_to_float64_bits(int reg) = 0;
+    virtual void emit_float64_bits_to_int64(int reg) = 0;
+    
+    // GC heap allocation (gc_memory_manager.h) - RAX = zeroed payload.
+    // Clobbers RCX, RDX and the argument registers
+    virtual void emit_gc_allocate(size_t payload_size, uint32_t type_id) = 0;
+    virtual void emit_object_create(const char* class_name, int64_t property_count) = 0;
+    // The same object built at [rbp + header_offset] in the current frame,
+    // flagged STACK_ALLOCATED (escape_analysis.h) - RAX = payload.
+    // Clobbers RCX and RDI
+    virtual void emit_object_create_in_frame(const char* class_name, int64_t property_count, int64_t header_offset) {
+        (void)header_offset;
+        emit_object_create(class_name, property_count);
+    }
+    
+    // SATB pre-write barrier for a reference store to [object_reg + offset]:
+    // while concurrent marking runs, the value about to be overwritten goes
+    // to the collector. Preserves RDI, RSI and RDX; clobbers RAX, RCX and R8-R11
+    virtual void emit_gc_pre_write_barrier(int object_reg, int32_t field_offset) = 0;
+    // __object_set_property(RDI = object, RSI = property_index, RDX = value).
+    // With card_mark, the object's card is marked after the store so young
+    // collections find old-to-young references - leave it out only for
+    // values that cannot be heap pointers; card-marked stores also publish
+    // goroutine-private values. Clobbers RCX, R10, R11 and, on the error
+    // and publish paths, the caller-saved registers
+    virtual void emit_object_set_property(int64_t property_index, bool card_mark) = 0;
+    
+    // Code offsets [start, end) of inline allocations - a thread stopped for
+    // GC inside one resumes at start
+    virtual std::vector<std::pair<size_t, size_t>> get_gc_restart_ranges() const { return {}; }
+    
+    // Stack maps: calls emitted while a frame is set record which of its
+    // RBP-relative slots hold heap references (see GCFrameScope)
+    virtual void set_gc_frame(const TypeInference* types) { (void)types; }
+    virtual const TypeInference* get_gc_frame() const { return nullptr; }
+    virtual GCStackMaps get_gc_stack_maps() const { return {}; }
+    
+    // Where each function starts - symbolizes JIT frames in heap profiles
+    virtual FunctionSymbols get_function_symbols() const { return {}; }
     
     virtual std::vector<uint8_t> get_code() const = 0;
     virtual void clear() = 0;
@@ -261,6 +329,12 @@ private:
     std::vector<std::pair<std::string, int64_t>> unresolved_jumps;
     int64_t current_stack_offset;
     int64_t function_stack_size;
+    std::vector<std::pair<size_t, size_t>> gc_restart_ranges;
+    const TypeInference* gc_frame = nullptr;
+    GCStackMaps gc_stack_maps;
+    FunctionSymbols function_symbols;
+    
+    void record_gc_safepoint();
     
 public:
     X86CodeGen() : current_stack_offset(0), function_stack_size(0) {}
@@ -317,6 +391,9 @@ public:
     void emit_lock_release(int lock_reg) override;
     void emit_lock_try_acquire(int lock_reg, int result_reg) override;
     void emit_lock_try_acquire_timeout(int lock_reg, int timeout_reg, int result_reg) override;
+    void emit_waitgroup_add(int wg_reg, int delta_reg) override;
+    void emit_semaphore_acquire(int sem_reg) override;
+    void emit_semaphore_release(int sem_reg) override;
     
     // Atomic operations for lock implementation
     void emit_atomic_compare_exchange(int ptr_reg, int expected_reg, int desired_reg, int result_reg) override;
@@ -324,13 +401,27 @@ public:
     void emit_atomic_store(int ptr_reg, int value_reg, int memory_order) override;
     void emit_atomic_load(int ptr_reg, int result_reg, int memory_order) override;
     void emit_memory_fence(int fence_type) override;
+    void emit_atomic_exchange(int ptr_reg, int value_reg, int result_reg) override;
+    void emit_atomic_fetch_add_float64(int ptr_reg, int value_reg, int result_reg) override;
+    void emit_int64_to_float64_bits(int reg) override;
+    void emit_float64_bits_to_int64(int reg) override;
+    void emit_gc_allocate(size_t payload_size, uint32_t type_id) override;
+    void emit_object_create(const char* class_name, int64_t property_count) override;
+    void emit_object_create_in_frame(const char* class_name, int64_t property_count, int64_t header_offset) override;
+    void emit_gc_pre_write_barrier(int object_reg, int32_t field_offset) override;
+    void emit_object_set_property(int64_t property_index, bool card_mark) override;
+    std::vector<std::pair<size_t, size_t>> get_gc_restart_ranges() const override { return gc_restart_ranges; }
+    void set_gc_frame(const TypeInference* types) override { gc_frame = types; }
+    const TypeInference* get_gc_frame() const override { return gc_frame; }
+    GCStackMaps get_gc_stack_maps() const override { return gc_stack_maps; }
+    FunctionSymbols get_function_symbols() const override { return function_symbols; }
     
     // Near-Optimal Relative Offset Calls - One LEA instruction overhead
     void emit_goroutine_spawn_with_offset(size_t function_offset);
     void emit_calculate_function_address_from_offset(size_t function_offset);
     
     std::vector<uint8_t> get_code() const override { return code; }
-    void clear() override { code.clear(); label_offsets.clear(); unresolved_jumps.clear(); }
+    void clear() override { code.clear(); label_offsets.clear(); unresolved_jumps.clear(); gc_restart_ranges.clear(); gc_stack_maps.clear(); function_symbols.clear(); }
     size_t get_current_offset() const override;
     const std::unordered_map<std::string, int64_t>& get_label_offsets() const override { return label_offsets; }
     void resolve_runtime_function_calls();  // Resolve unresolved runtime function calls
@@ -412,6 +503,9 @@ public:
     void emit_lock_release(int lock_reg) override;
     void emit_lock_try_acquire(int lock_reg, int result_reg) override;
     void emit_lock_try_acquire_timeout(int lock_reg, int timeout_reg, int result_reg) override;
+    void emit_waitgroup_add(int wg_reg, int delta_reg) override;
+    void emit_semaphore_acquire(int sem_reg) override;
+    void emit_semaphore_release(int sem_reg) override;
     
     // Atomic operations for lock implementation
     void emit_atomic_compare_exchange(int ptr_reg, int expected_reg, int desired_reg, int result_reg) override;
@@ -419,6 +513,14 @@ public:
     void emit_atomic_store(int ptr_reg, int value_reg, int memory_order) override;
     void emit_atomic_load(int ptr_reg, int result_reg, int memory_order) override;
     void emit_memory_fence(int fence_type) override;
+    void emit_atomic_exchange(int ptr_reg, int value_reg, int result_reg) override;
+    void emit_atomic_fetch_add_float64(int ptr_reg, int value_reg, int result_reg) override;
+    void emit_int64_to_float64_bits(int reg) override;
+    void emit_float64_bits_to_int64(int reg) override;
+    void emit_gc_allocate(size_t payload_size, uint32_t type_id) override;
+    void emit_object_create(const char* class_name, int64_t property_count) override;
+    void emit_gc_pre_write_barrier(int object_reg, int32_t field_offset) override;
+    void emit_object_set_property(int64_t property_index, bool card_mark) override;
     
     std::vector<uint8_t> get_code() const override { return code; }
     void clear() override { code.clear(); label_offsets.clear(); unresolved_jumps.clear(); }
@@ -433,9 +535,15 @@ private:
     std::unordered_map<std::string, int64_t> variable_offsets;
     int64_t current_offset = -8; // Start at -8 (RBP-8)
     
+    // Slots of the frame being generated -> variable, for GC stack maps
+    std::map<int64_t, std::string> frame_slots;
+    
     // Function parameter tracking for keyword arguments
     std::unordered_map<std::string, std::vector<std::string>> function_param_names;
     
+    // Escape analysis of the function being generated (escape_analysis.h)
+    const FunctionEscapeInfo* escape_info = nullptr;
+    
 public:
     DataType infer_type(const std::string& expression);
     DataType get_cast_type(DataType t1, DataType t2);
@@ -455,6 +563,16 @@ public:
     void reset_for_function();
     void reset_for_function_with_params(int param_count);
     
+    // GC stack maps - RBP offsets of this frame's heap-reference variables
+    void begin_frame();
+    std::vector<int32_t> get_reference_slots() const;
+    // Numbers and booleans - values that can never be heap pointers
+    static bool is_scalar_type(DataType type);
+    
+    // Frame allocation decisions for the current body, null outside one
+    void set_escape_info(const FunctionEscapeInfo* info) { escape_info = info; }
+    const FunctionEscapeInfo* get_escape_info() const { return escape_info; }
+    
     // Function parameter tracking for keyword arguments
     void register_function_params(const std::string& func_name, const std::vector<std::string>& param_names);
     std::vector<std::string> get_function_params(const std::string& func_name) const;
@@ -480,6 +598,22 @@ public:
     bool is_numeric_literal(const std::string& expression);
 };
 
+// Scope of one JIT function body for GC stack maps. A nested body sharing
+// the outer TypeInference leaves the rest of the outer frame unmapped (its
+// slots are then scanned conservatively)
+class GCFrameScope {
+    CodeGenerator& gen_;
+    const TypeInference* outer_;
+    
+public:
+    GCFrameScope(CodeGenerator& gen, TypeInference& types) : gen_(gen), outer_(gen.get_gc_frame()) {
+        if (outer_ == &types) outer_ = nullptr;
+        types.begin_frame();
+        gen.set_gc_frame(&types);
+    }
+    ~GCFrameScope() { gen_.set_gc_frame(outer_); }
+};
+
 struct ASTNode {
     virtual ~ASTNode() = default;
     virtual void generate_code(CodeGenerator& gen, TypeInference& types) = 0;
@@ -794,6 +928,8 @@ struct NewExpression : ExpressionNode {
     std::string class_name;
     std::vector<std::unique_ptr<ExpressionNode>> arguments;
     bool is_dart_style = false; // For new Person{name: "bob"} syntax
+    bool cache_line_padded = false; // Atomic<T> initializer of a `padded` field
+    int line = 0, column = 0;       // Source position, names `new Lock()` sites in lock profiles
     std::vector<std::pair<std::string, std::unique_ptr<ExpressionNode>>> dart_args;
     NewExpression(const std::string& name) : class_name(name) {}
     void generate_code(CodeGenerator& gen, TypeInference& types) override;
@@ -888,6 +1024,7 @@ private:
     std::vector<Token> tokens;
     size_t pos = 0;
     ErrorReporter* error_reporter = nullptr;
+    std::string last_type_class_name;  // Set by parse_type() for builtin generic types
     
     Token& current_token();
     Token& peek_token(int offset = 1);
@@ -929,6 +1066,7 @@ private:
     std::unique_ptr<SliceExpression> parse_slice_expression();
     
     DataType parse_type();
+    std::string parse_type_arguments();
     
 public:
     Parser(std::vector<Token> toks) : tokens(std::move(toks)) {}
@@ -0,0 +1,292 @@
+#include "escape_analysis.h"
+#include "gc_memory_manager.h"
+#include "runtime.h"
+#include <unordered_set>
+#include <algorithm>
+
+namespace gots {
+
+// ============================================================================
+// USE SCANNER
+// ============================================================================
+//
+// Collects how each variable name is used in a body. Field reads and writes
+// through the name are the only uses that keep an object local; every other
+// appearance - and any appearance inside a nested function - lets it escape.
+
+namespace {
+
+struct NameUses {
+    std::unordered_map<std::string, int> assignments;
+    std::unordered_map<std::string, const Assignment*> declarations;
+    std::unordered_map<std::string, std::vector<std::string>> fields;   // Read by name: p.x
+    std::unordered_set<std::string> indexed;    // Through PropertyAccess / PropertyAssignment
+    std::unordered_set<std::string> escaped;
+    bool opaque = false;    // A node the scanner does not know - nothing stays local
+};
+
+class UseScanner {
+public:
+    explicit UseScanner(NameUses& uses) : uses_(uses) {}
+
+    void scan_body(const std::vector<std::unique_ptr<ASTNode>>& body, bool nested) {
+        for (const auto& stmt : body) scan(stmt.get(), nested);
+    }
+
+    void scan(const ASTNode* node, bool nested) {
+        if (!node) return;
+
+        if (dynamic_cast<const NumberLiteral*>(node) || dynamic_cast<const StringLiteral*>(node) ||
+            dynamic_cast<const RegexLiteral*>(node) || dynamic_cast<const BreakStatement*>(node) ||
+            dynamic_cast<const SliceExpression*>(node)) {
+            return;
+        }
+        if (auto id = dynamic_cast<const Identifier*>(node)) {
+            uses_.escaped.insert(id->name);
+        } else if (auto bin = dynamic_cast<const BinaryOp*>(node)) {
+            scan(bin->left.get(), nested);
+            scan(bin->right.get(), nested);
+        } else if (auto ternary = dynamic_cast<const TernaryOperator*>(node)) {
+            scan(ternary->condition.get(), nested);
+            scan(ternary->true_expr.get(), nested);
+            scan(ternary->false_expr.get(), nested);
+        } else if (auto call = dynamic_cast<const FunctionCall*>(node)) {
+            uses_.escaped.insert(call->name);
+            scan_list(call->arguments, nested);
+        } else if (auto func = dynamic_cast<const FunctionExpression*>(node)) {
+            escape_parameters(func->parameters);
+            scan_body(func->body, true);
+        } else if (auto method = dynamic_cast<const MethodCall*>(node)) {
+            uses_.escaped.insert(method->object_name);
+            scan_list(method->arguments, nested);
+        } else if (auto method = dynamic_cast<const ExpressionMethodCall*>(node)) {
+            scan(method->object.get(), nested);
+            scan_list(method->arguments, nested);
+        } else if (auto array = dynamic_cast<const ArrayLiteral*>(node)) {
+            scan_list(array->elements, nested);
+        } else if (auto typed = dynamic_cast<const TypedArrayLiteral*>(node)) {
+            scan_list(typed->elements, nested);
+        } else if (auto object = dynamic_cast<const ObjectLiteral*>(node)) {
+            for (const auto& prop : object->properties) scan(prop.second.get(), nested);
+        } else if (auto access = dynamic_cast<const ArrayAccess*>(node)) {
+            // Slice strings are parsed again at code generation
+            if (access->is_slice_expression) uses_.opaque = true;
+            scan(access->object.get(), nested);
+            scan(access->index.get(), nested);
+        } else if (auto assign = dynamic_cast<const Assignment*>(node)) {
+            if (nested) {
+                uses_.escaped.insert(assign->variable_name);
+            } else {
+                uses_.assignments[assign->variable_name]++;
+                uses_.declarations[assign->variable_name] = assign;
+            }
+            scan(assign->value.get(), nested);
+        } else if (auto store = dynamic_cast<const PropertyAssignment*>(node)) {
+            indexed_use(store->object_name, nested);
+            scan(store->value.get(), nested);
+        } else if (auto load = dynamic_cast<const PropertyAccess*>(node)) {
+            indexed_use(load->object_name, nested);
+        } else if (auto load = dynamic_cast<const ExpressionPropertyAccess*>(node)) {
+            auto object = dynamic_cast<const Identifier*>(load->object.get());
+            if (object && !nested) {
+                uses_.fields[object->name].push_back(load->property_name);
+            } else {
+                scan(load->object.get(), nested);
+            }
+        } else if (auto inc = dynamic_cast<const PostfixIncrement*>(node)) {
+            uses_.escaped.insert(inc->variable_name);
+        } else if (auto dec = dynamic_cast<const PostfixDecrement*>(node)) {
+            uses_.escaped.insert(dec->variable_name);
+        } else if (auto decl = dynamic_cast<const FunctionDecl*>(node)) {
+            uses_.escaped.insert(decl->name);
+            escape_parameters(decl->parameters);
+            scan_body(decl->body, true);
+        } else if (auto branch = dynamic_cast<const IfStatement*>(node)) {
+            scan(branch->condition.get(), nested);
+            scan_body(branch->then_body, nested);
+            scan_body(branch->else_body, nested);
+        } else if (auto loop = dynamic_cast<const ForLoop*>(node)) {
+            scan(loop->init.get(), nested);
+            scan(loop->condition.get(), nested);
+            scan(loop->update.get(), nested);
+            scan_body(loop->body, nested);
+        } else if (auto loop = dynamic_cast<const ForEachLoop*>(node)) {
+            uses_.escaped.insert(loop->index_var_name);
+            uses_.escaped.insert(loop->value_var_name);
+            scan(loop->iterable.get(), nested);
+            scan_body(loop->body, nested);
+        } else if (auto ret = dynamic_cast<const ReturnStatement*>(node)) {
+            scan(ret->value.get(), nested);
+        } else if (auto clause = dynamic_cast<const CaseClause*>(node)) {
+            scan(clause->value.get(), nested);
+            scan_body(clause->body, nested);
+        } else if (auto sw = dynamic_cast<const SwitchStatement*>(node)) {
+            scan(sw->discriminant.get(), nested);
+            for (const auto& clause : sw->cases) scan(clause.get(), nested);
+        } else if (auto import = dynamic_cast<const ImportStatement*>(node)) {
+            for (const auto& spec : import->specifiers) uses_.escaped.insert(spec.local_name);
+            uses_.escaped.insert(import->namespace_name);
+        } else if (auto exp = dynamic_cast<const ExportStatement*>(node)) {
+            for (const auto& spec : exp->specifiers) uses_.escaped.insert(spec.local_name);
+            scan(exp->declaration.get(), nested);
+        } else if (dynamic_cast<const ThisExpression*>(node)) {
+            uses_.escaped.insert("this");
+        } else if (auto create = dynamic_cast<const NewExpression*>(node)) {
+            scan_list(create->arguments, nested);
+            for (const auto& arg : create->dart_args) scan(arg.second.get(), nested);
+        } else if (auto super_call = dynamic_cast<const SuperCall*>(node)) {
+            uses_.escaped.insert("this");
+            scan_list(super_call->arguments, nested);
+        } else if (auto super_call = dynamic_cast<const SuperMethodCall*>(node)) {
+            uses_.escaped.insert("this");
+            scan_list(super_call->arguments, nested);
+        } else if (auto cls = dynamic_cast<const ClassDecl*>(node)) {
+            uses_.escaped.insert(cls->name);
+            for (const auto& field : cls->fields) scan(field.default_value.get(), true);
+            if (cls->constructor) scan_body(cls->constructor->body, true);
+            for (const auto& m : cls->methods) scan_body(m->body, true);
+            for (const auto& op : cls->operator_overloads) scan_body(op->body, true);
+        } else {
+            uses_.opaque = true;
+        }
+    }
+
+private:
+    NameUses& uses_;
+
+    void scan_list(const std::vector<std::unique_ptr<ExpressionNode>>& list, bool nested) {
+        for (const auto& expr : list) scan(expr.get(), nested);
+    }
+
+    void escape_parameters(const std::vector<Variable>& parameters) {
+        for (const auto& param : parameters) uses_.escaped.insert(param.name);
+    }
+
+    void indexed_use(const std::string& object_name, bool nested) {
+        if (nested) {
+            uses_.escaped.insert(object_name);
+        } else {
+            uses_.indexed.insert(object_name);
+        }
+    }
+};
+
+} // namespace
+
+// ============================================================================
+// FUNCTION ESCAPE INFO
+// ============================================================================
+
+int64_t FrameObject::field_slot(const std::string& property_name) const {
+    // Of repeated names in a literal, the last one wins
+    for (size_t i = field_names.size(); i-- > 0;) {
+        if (field_names[i] == property_name) return field_slots[i];
+    }
+    return 0;
+}
+
+const FrameObject* FunctionEscapeInfo::site(const ExpressionNode* node) const {
+    auto it = sites.find(node);
+    return it != sites.end() ? &it->second : nullptr;
+}
+
+const FrameObject* FunctionEscapeInfo::scalar_variable(const std::string& name) const {
+    auto it = scalar_variables.find(name);
+    return it != scalar_variables.end() ? site(it->second) : nullptr;
+}
+
+void FunctionEscapeInfo::place(int64_t stack_size, TypeInference& types) {
+    // The prologue leaves RSP at RBP - 48 - stack_size (saved RBX, R12-R15
+    // and alignment padding); frame objects sit right above it, below the
+    // locals growing down from RBP - 48
+    static int scalar_bodies = 0;
+    int body_id = scalar_bodies++;
+    int64_t bottom = -48 - stack_size;
+    for (auto& entry : sites) {
+        if (!entry.second.scalar_replaced) entry.second.header_offset += bottom;
+    }
+    for (const auto& entry : scalar_variables) {
+        FrameObject& object = sites[entry.second];
+        for (auto& slot : object.field_slots) {
+            // Unique per body - names are shared with other functions' frames
+            std::string slot_name = "__field_" + std::to_string(body_id) + "_" + entry.first +
+                                    "_" + std::to_string(&slot - object.field_slots.data());
+            slot = types.allocate_variable(slot_name, DataType::UNKNOWN);
+        }
+    }
+}
+
+// ============================================================================
+// ESCAPE ANALYSIS
+// ============================================================================
+
+FunctionEscapeInfo EscapeAnalysis::analyze(const std::vector<std::unique_ptr<ASTNode>>& body,
+                                           const std::vector<Variable>& parameters) {
+    FunctionEscapeInfo info;
+    NameUses uses;
+    UseScanner(uses).scan_body(body, false);
+    if (uses.opaque) return info;
+    for (const auto& param : parameters) uses.escaped.insert(param.name);
+
+    GoTSCompiler* compiler = ConstructorDecl::current_compiler_context;
+    int64_t object_bytes = 0;
+    int64_t scalar_bytes = 0;
+    for (const auto& decl : uses.declarations) {
+        const std::string& name = decl.first;
+        if (uses.assignments[name] != 1 || uses.escaped.count(name) || name == "this") continue;
+
+        const ExpressionNode* value = decl.second->value.get();
+        int64_t property_count = -1;
+        if (auto literal = dynamic_cast<const ObjectLiteral*>(value)) {
+            property_count = static_cast<int64_t>(literal->properties.size());
+        } else if (auto create = dynamic_cast<const NewExpression*>(value)) {
+            ClassInfo* class_info = compiler ? compiler->get_class(create->class_name) : nullptr;
+            if (class_info && class_info->frame_allocatable && !create->is_dart_style &&
+                create->arguments.size() <= 5) {
+                property_count = static_cast<int64_t>(class_info->fields.size());
+            }
+        }
+        if (property_count < 0) continue;
+
+        FrameObject object;
+        object.property_count = property_count;
+
+        // A literal read only by the names it defines needs no object at all
+        auto literal = dynamic_cast<const ObjectLiteral*>(value);
+        bool scalar = literal && !uses.indexed.count(name);
+        if (literal) {
+            for (const auto& prop : literal->properties) object.field_names.push_back(prop.first);
+        }
+        for (const auto& property : uses.fields[name]) {
+            auto& names = object.field_names;
+            if (std::find(names.begin(), names.end(), property) == names.end()) scalar = false;
+        }
+        if (scalar) {
+            object.scalar_replaced = true;
+            object.field_slots.assign(property_count, 0);
+            scalar_bytes += property_count * 8;
+            info.scalar_variables[name] = value;
+        } else {
+            int64_t bytes = sizeof(ObjectHeader) + GCObjectLayout::payload_size(property_count);
+            if (bytes > static_cast<int64_t>(GCConfig::MAX_STACK_ALLOC_SIZE)) continue;
+            object.header_offset = object_bytes;
+            object_bytes += bytes;
+        }
+        info.sites[value] = std::move(object);
+    }
+
+    info.frame_bytes = (object_bytes + scalar_bytes + 15) & ~int64_t(15);
+    return info;
+}
+
+bool EscapeAnalysis::constructor_keeps_this(const ClassDecl& class_decl) {
+    if (!class_decl.parent_class.empty()) return false;
+
+    NameUses uses;
+    UseScanner scanner(uses);
+    for (const auto& field : class_decl.fields) scanner.scan(field.default_value.get(), false);
+    if (class_decl.constructor) scanner.scan_body(class_decl.constructor->body, false);
+    return !uses.opaque && !uses.escaped.count("this");
+}
+
+} // namespace gots
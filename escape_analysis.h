@@ -0,0 +1,85 @@
+#pragma once
+
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "compiler.h"
+
+namespace gots {
+
+// ============================================================================
+// ESCAPE ANALYSIS - frame allocation of function-local objects
+// ============================================================================
+//
+// A compile-time pass over one function body, run before its prologue. An
+// object bound by `let p = new Point(...)` or `let p = {...}` whose variable
+// is assigned nowhere else and only appears as `p.field` or `p.field = v`
+// cannot outlive the call: it is not returned, captured by a closure or
+// goroutine, stored into another object or passed to a call. Such objects
+// are built in the function's frame with ObjectHeader::STACK_ALLOCATED set
+// (up to GCConfig::MAX_STACK_ALLOC_SIZE) instead of on the GC heap. Object
+// literals whose fields are addressable at compile time are not built at
+// all - each field gets its own frame slot (scalar replacement).
+//
+// The pass is conservative: any other use of the name, any use inside a
+// nested function or class, and any node it does not know make the object
+// escape. Frame objects are covered by the conservative stack scan, so the
+// heap values in their fields stay alive; the GC never moves or frees them.
+
+struct FrameObject {
+    int64_t header_offset = 0;          // RBP offset of the ObjectHeader
+    int64_t property_count = 0;
+    bool scalar_replaced = false;       // No object - field_slots holds one RBP offset per field
+    std::vector<int64_t> field_slots;
+    std::vector<std::string> field_names;   // Object literals, in property order
+
+    // Frame slot of a scalar-replaced field, 0 if the literal has no such name
+    int64_t field_slot(const std::string& property_name) const;
+};
+
+class FunctionEscapeInfo {
+public:
+    // Allocation sites (NewExpression / ObjectLiteral) kept out of the heap
+    std::unordered_map<const ExpressionNode*, FrameObject> sites;
+    // Scalar-replaced variables -> their ObjectLiteral
+    std::unordered_map<std::string, const ExpressionNode*> scalar_variables;
+    // Bytes the frame grows by - frame objects at its bottom plus one slot
+    // per scalar-replaced field, 16-byte aligned
+    int64_t frame_bytes = 0;
+
+    const FrameObject* site(const ExpressionNode* node) const;
+    const FrameObject* scalar_variable(const std::string& name) const;
+
+    // Once the prologue for stack_size (including frame_bytes) is emitted:
+    // fix the RBP offsets of frame objects and allocate the field slots
+    void place(int64_t stack_size, TypeInference& types);
+};
+
+class EscapeAnalysis {
+public:
+    // Frame allocation decisions for one function body. Parameters are
+    // never candidates
+    static FunctionEscapeInfo analyze(const std::vector<std::unique_ptr<ASTNode>>& body,
+                                      const std::vector<Variable>& parameters);
+
+    // Instances can live in a frame only if the constructor uses `this` for
+    // field access alone - no calls on it, no super, no parent class
+    static bool constructor_keeps_this(const ClassDecl& class_decl);
+};
+
+// Installs a function's decisions on its TypeInference while its body is
+// generated (see GCFrameScope)
+class EscapeInfoScope {
+    TypeInference& types_;
+    const FunctionEscapeInfo* outer_;
+
+public:
+    EscapeInfoScope(TypeInference& types, const FunctionEscapeInfo& info)
+        : types_(types), outer_(types.get_escape_info()) {
+        types.set_escape_info(&info);
+    }
+    ~EscapeInfoScope() { types_.set_escape_info(outer_); }
+};
+
+} // namespace gots
@@ -337,6 +337,7 @@ void FunctionCompilationManager::compile_function_body(CodeGenerator& gen, TypeI
     // Set up local type context
     TypeInference local_types;
     local_types.reset_for_function();
+    GCFrameScope gc_frame(gen, local_types);
     
     // Generate function body statements
     for (size_t i = 0; i < func_expr->body.size(); i++) {
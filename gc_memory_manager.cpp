@@ -1,15 +1,22 @@
 #include "gc_memory_manager.h"
-#include "gc_concurrent_marking.h"
+#include "heap_profile.h"
+#include "heap_snapshot.h"
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <ucontext.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <iostream>
-#include <stack>
 #include <unordered_map>
-#include <cassert>
-#include <cstring>
-#include <chrono>
-#include <deque>
 
 namespace gots {
 
@@ -17,15 +24,170 @@ namespace gots {
 // GLOBAL INSTANCES
 // ============================================================================
 
+// Sent to mutator threads to stop them for a collection
+static constexpr int GC_SUSPEND_SIGNAL = SIGPWR;
+
+// Index of RBP in MutatorThread::registers
+static constexpr int SAVED_RBP = 6;
+
 static GarbageCollector* g_gc_instance = nullptr;
-thread_local TLAB* GenerationalHeap::tlab_ = nullptr;
-thread_local GarbageCollector::ThreadRootCleanup* GarbageCollector::thread_root_cleanup_ = nullptr;
-thread_local int GarbageCollector::thread_deque_index_ = -1;
-uint8_t* WriteBarrier::card_table_ = nullptr;
-size_t WriteBarrier::card_table_size_ = 0;
+thread_local TLAB GenerationalHeap::tlab_;
+static thread_local GarbageCollector::MutatorThread* t_mutator = nullptr;
+static thread_local bool t_collecting = false;
+static thread_local bool t_thread_exited = false;
+
+// Unregisters the thread from the collector when it exits
+struct GCThreadRegistration {
+    ~GCThreadRegistration() {
+        t_thread_exited = true;
+        if (t_mutator) GarbageCollector::instance().unregister_current_thread();
+    }
+};
+static thread_local GCThreadRegistration t_registration;
+
+static void futex_wait(void* word, uint32_t expected) {
+    syscall(SYS_futex, static_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+static void futex_wake(void* word, int count) {
+    syscall(SYS_futex, static_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// Growable array for use while the world is stopped. A stopped thread may
+// hold a malloc lock, so the collector gets its memory straight from mmap
+template <typename T>
+class GCBuffer {
+    T* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    void grow() {
+        size_t capacity = capacity_ ? capacity_ * 2 : 4096;
+        void* mem = mmap(nullptr, capacity * sizeof(T), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            std::cerr << "ERROR: GC work list allocation failed" << std::endl;
+            std::abort();
+        }
+        if (data_) {
+            memcpy(mem, data_, size_ * sizeof(T));
+            munmap(data_, capacity_ * sizeof(T));
+        }
+        data_ = static_cast<T*>(mem);
+        capacity_ = capacity;
+    }
+
+public:
+    void push(T value) {
+        if (size_ == capacity_) grow();
+        data_[size_++] = value;
+    }
+    T pop() { return data_[--size_]; }
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    T& operator[](size_t i) { return data_[i]; }
+    void clear() { size_ = 0; }
+    void truncate(size_t size) { size_ = size; }
+};
+
+// Collector work lists - only touched with collect_mutex_ held
+static GCBuffer<ObjectHeader*> g_mark_stack;
+static GCBuffer<ObjectHeader*> g_finalize_queue;
+static GCBuffer<void**> g_frame_slots;  // Precise JIT frame slots of this cycle
+static size_t g_marked_old_bytes;       // Live old generation found by marking
+static size_t g_promoted_bytes;         // Promoted by the last young collection
+static GCBuffer<ObjectHeader*> g_old_finalizable;  // Old objects with finalizers, as promoted
+
+// Allocation-site profiling. Samples are taken with heap_mutex_ held and
+// judged by the next young collection; the per-site counts are only
+// touched by collections
+struct AllocationSample {
+    ObjectHeader* header;
+    uint32_t site;
+};
+static GCBuffer<AllocationSample> g_allocation_samples;
+static uint32_t g_site_samples[GCConfig::MAX_ALLOCATION_SITES];
+static uint32_t g_site_survivors[GCConfig::MAX_ALLOCATION_SITES];
+static std::atomic<uint32_t> g_next_allocation_site{1};
+
+// Heap profiling - only touched with heap_mutex_ held. Stack 0 stands for
+// allocations without JIT frames, and for stacks beyond the table
+struct ProfileStack {
+    uint64_t hash;
+    uint32_t first_frame;   // Into g_profile_frames
+    uint32_t frame_count;
+    int64_t alloc_objects;
+    int64_t alloc_bytes;
+    int64_t inuse_objects;
+    int64_t inuse_bytes;
+};
+struct ProfileSample {
+    ObjectHeader* header;
+    uint32_t stack;
+    uint32_t objects;       // Estimated objects and bytes the sample stands for
+    uint64_t bytes;
+};
+static GCBuffer<uintptr_t> g_profile_frames;
+static GCBuffer<ProfileStack> g_profile_stacks;
+static GCBuffer<ProfileSample> g_profile_samples;      // Sampled objects not yet found dead
+static uint32_t g_profile_stack_slots[GCConfig::HEAP_PROFILE_STACK_SLOTS];  // Stack index + 1
+// Bytes the thread allocates before its next sample, and since its last one
+static thread_local int64_t t_profile_countdown = 0;
+static thread_local uint64_t t_profile_allocated = 0;
+static thread_local uint64_t t_profile_random = 0;
+
+// Weak containers (gc_type_registry.h) - pushed by mutators with
+// weak_mutex_ held inside the heap, otherwise only touched by collections
+struct EphemeronTable {
+    uint64_t capacity;      // Power of two
+    uint64_t used;          // Entries holding a key or a tombstone
+    uint64_t live;
+    struct Entry {
+        void* key;          // Weak, hashed by address
+        void* value;        // Any value - scanned conservatively while its key lives
+    };
+    Entry* entries() { return reinterpret_cast<Entry*>(this + 1); }
+};
+struct FinalizationCells {
+    uint64_t capacity;
+    uint64_t count;
+    void* callback;         // JIT function taking the held value
+    uint64_t reserved;
+    struct Cell {
+        void* target;       // Weak
+        void* held;         // Any value - scanned conservatively
+        void* token;        // Weak, nullptr if none
+    };
+    Cell* cells() { return reinterpret_cast<Cell*>(this + 1); }
+};
+static void* const DELETED_KEY = reinterpret_cast<void*>(1);
+struct PendingCleanup {
+    void* callback;
+    void* held;
+};
+static GCBuffer<ObjectHeader*> g_weak_containers;   // WeakRefs, ephemeron tables, finalization cells
+static GCBuffer<PendingCleanup> g_cleanup_queue;    // Dead registered targets, until run_pending_finalizers
+static GCBuffer<EphemeronTable::Entry> g_rehash_entries;
+
+// Concurrent marking - gray old objects (mark_mutex_) and the barrier
+// buffers mutators handed over (satb_mutex_)
+volatile uint8_t gc_marking_active = 0;
+uint8_t* gc_card_table_base = nullptr;
+uintptr_t gc_young_start = 0;
+uint8_t gc_young_page_owner[GCConfig::YOUNG_GEN_SIZE >> GCConfig::YOUNG_PAGE_SHIFT];
+uint8_t gc_pretenured_sites[GCConfig::MAX_ALLOCATION_SITES];
+static GCBuffer<ObjectHeader*> g_concurrent_stack;
+static GCBuffer<void*> g_satb_queue;
+
+// References a mutator overwrote while marking runs. Static TLS, like the TLAB
+struct SATBBuffer {
+    void* entries[GCConfig::SATB_BUFFER_SIZE];
+    size_t count;
+};
+static thread_local SATBBuffer t_satb;
 
 // Thread-local escape analysis data with bounded cache and LRU eviction
-thread_local struct {
+struct EscapeData {
     std::vector<std::pair<size_t, size_t>> scope_stack; // (scope_id, depth)
     std::unordered_map<size_t, EscapeAnalyzer::AnalysisResult> allocation_sites;
     std::unordered_map<size_t, std::vector<size_t>> var_to_sites;
@@ -169,7 +331,8 @@ thread_local struct {
         var_access_time[var_id] = access_counter;
     }
     
-} g_escape_data;
+};
+static thread_local EscapeData g_escape_data;
 
 // ============================================================================
 // ESCAPE ANALYZER IMPLEMENTATION
@@ -181,6 +344,8 @@ EscapeAnalyzer::AnalysisResult EscapeAnalyzer::analyze_allocation(
     size_t allocation_size,
     uint32_t type_id
 ) {
+    (void)jit_context;
+    (void)type_id;
     AnalysisResult result;
     
     // Periodic cleanup
@@ -270,905 +435,3137 @@ void EscapeAnalyzer::register_closure_capture(size_t var_id) {
     }
 }
 
+
 // ============================================================================
 // GENERATIONAL HEAP IMPLEMENTATION
 // ============================================================================
 
 void GenerationalHeap::initialize() {
-    // Allocate young generation
-    size_t young_size = GCConfig::YOUNG_GEN_SIZE;
-    young_.eden_start = static_cast<uint8_t*>(
-        mmap(nullptr, young_size, PROT_READ | PROT_WRITE, 
-             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
-    );
-    
-    if (young_.eden_start == MAP_FAILED) {
-        throw std::runtime_error("Failed to allocate young generation");
+    // Reserve young + old + large-object space in one range (plus slack to
+    // page-align the young gen) - MAP_NORESERVE, so only touched pages cost
+    // memory
+    reserved_size_ = GCConfig::YOUNG_GEN_SIZE + GCConfig::OLD_GEN_SIZE + GCConfig::LOS_SIZE;
+    size_t mapping_size = reserved_size_ + GCConfig::YOUNG_PAGE_SIZE;
+    void* mem = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to reserve " << mapping_size << " bytes for the GC heap" << std::endl;
+        std::abort();
     }
-    
-    // Split young gen: 80% eden, 10% survivor1, 10% survivor2
-    size_t eden_size = (young_size * 8) / 10;
-    size_t survivor_size = young_size / 10;
-    
-    young_.eden_current = young_.eden_start;
-    young_.eden_end = young_.eden_start + eden_size;
-    
-    young_.survivor1_start = young_.eden_end;
-    young_.survivor1_end = young_.survivor1_start + survivor_size;
-    
-    young_.survivor2_start = young_.survivor1_end;
-    young_.survivor2_end = young_.survivor2_start + survivor_size;
-    
-    young_.active_survivor = young_.survivor1_start;
-    
-    // Allocate old generation
-    old_.start = static_cast<uint8_t*>(
-        mmap(nullptr, GCConfig::OLD_GEN_SIZE, PROT_READ | PROT_WRITE, 
-             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
-    );
-    
-    if (old_.start == MAP_FAILED) {
-        munmap(young_.eden_start, young_size);
-        throw std::runtime_error("Failed to allocate old generation");
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(mem) + GCConfig::YOUNG_PAGE_SIZE - 1) &
+                        ~(GCConfig::YOUNG_PAGE_SIZE - 1);
+    reserved_start_ = reinterpret_cast<uint8_t*>(aligned);
+
+    young_.start = reserved_start_;
+    young_.end = young_.start + GCConfig::YOUNG_GEN_SIZE;
+    young_.page_count = GCConfig::YOUNG_GEN_SIZE / GCConfig::YOUNG_PAGE_SIZE;
+    young_.pages = new PageKind[young_.page_count];
+    young_.page_top = new uint8_t*[young_.page_count];
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        young_.pages[i] = PageKind::FREE;
+        young_.page_top[i] = page_start(i);
     }
-    
+    young_.eden_page = young_.page_count;
+    young_.eden_pages_used = 0;
+    // A quarter of the young gen stays free for survivors
+    young_.eden_page_limit = young_.page_count - young_.page_count / 4;
+    young_.private_pages = 0;
+    young_.private_page_limit = young_.eden_page_limit * GCConfig::PRIVATE_PAGE_PERCENT / 100;
+    std::fill(std::begin(young_.owner_used), std::end(young_.owner_used), false);
+    memset(gc_young_page_owner, 0, sizeof(gc_young_page_owner));
+    gc_young_start = reinterpret_cast<uintptr_t>(young_.start);
+
+    old_.start = young_.end;
     old_.current = old_.start;
     old_.end = old_.start + GCConfig::OLD_GEN_SIZE;
-    
-    // Initialize card table
-    WriteBarrier::card_table_size_ = GCConfig::OLD_GEN_SIZE / GCConfig::CARD_SIZE;
-    WriteBarrier::card_table_ = new uint8_t[WriteBarrier::card_table_size_]();
+    old_.gc_trigger = GCConfig::OLD_GC_TRIGGER;
+    old_.live_bytes = 0;
+    old_.used_bytes = 0;
+    old_.allocated_while_marking = 0;
+    clear_free_lists();
+    old_.sweep_cursor = old_.start;
+    old_.sweep_limit = old_.start;
+    old_.fragmentation_percent = 0;
+
+    los_.start = old_.end;
+    los_.current = los_.start;
+    los_.end = los_.start + GCConfig::LOS_SIZE;
+    void* page_objects = mmap(nullptr, (GCConfig::LOS_SIZE >> GCConfig::LOS_PAGE_SHIFT) * sizeof(ObjectHeader*),
+                              PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (page_objects == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to allocate the large-object page table" << std::endl;
+        std::abort();
+    }
+    los_.page_object = static_cast<ObjectHeader**>(page_objects);
+
+    // Large objects are found through their page table, not start bits
+    size_t bitmap_bytes = (GCConfig::YOUNG_GEN_SIZE + GCConfig::OLD_GEN_SIZE) / GCConfig::OBJECT_ALIGNMENT / 8;
+    void* bits = mmap(nullptr, bitmap_bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (bits == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to allocate the GC object-start bitmap" << std::endl;
+        std::abort();
+    }
+    start_bits_ = static_cast<uint64_t*>(bits);
+
+    // The reservation is page aligned, so cards line up with the biased base
+    void* cards = mmap(nullptr, reserved_size_ >> GCConfig::CARD_SHIFT, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (cards == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to allocate the GC card table" << std::endl;
+        std::abort();
+    }
+    card_table_ = static_cast<uint8_t*>(cards);
+    gc_card_table_base = card_table_ - (reinterpret_cast<uintptr_t>(reserved_start_) >> GCConfig::CARD_SHIFT);
 }
 
 void GenerationalHeap::shutdown() {
-    // Clean up TLABs
-    {
-        std::lock_guard<std::mutex> lock(tlabs_mutex_);
-        all_tlabs_.clear();
-    }
-    
-    // Unmap memory
-    if (young_.eden_start != MAP_FAILED) {
-        munmap(young_.eden_start, GCConfig::YOUNG_GEN_SIZE);
+    if (!reserved_start_) return;
+    munmap(start_bits_, (GCConfig::YOUNG_GEN_SIZE + GCConfig::OLD_GEN_SIZE) / GCConfig::OBJECT_ALIGNMENT / 8);
+    munmap(card_table_, reserved_size_ >> GCConfig::CARD_SHIFT);
+    munmap(los_.page_object, (GCConfig::LOS_SIZE >> GCConfig::LOS_PAGE_SHIFT) * sizeof(ObjectHeader*));
+    los_.objects.clear();
+    los_.free_spans.clear();
+    delete[] young_.pages;
+    delete[] young_.page_top;
+    // The original mapping may start up to one page earlier
+    munmap(reserved_start_, reserved_size_);
+    reserved_start_ = nullptr;
+}
+
+int32_t GenerationalHeap::tlab_tls_offset() {
+    // Static TLS sits at a fixed distance from the thread pointer
+    uintptr_t thread_pointer;
+    asm("mov %%fs:0, %0" : "=r"(thread_pointer));
+    return static_cast<int32_t>(reinterpret_cast<uintptr_t>(&tlab_) - thread_pointer);
+}
+
+size_t GenerationalHeap::take_free_page(PageKind kind) {
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        if (young_.pages[i] == PageKind::FREE) {
+            young_.pages[i] = kind;
+            young_.page_top[i] = page_start(i);
+            return i;
+        }
     }
-    
-    if (old_.start != MAP_FAILED) {
-        munmap(old_.start, GCConfig::OLD_GEN_SIZE);
+    return young_.page_count;
+}
+
+void GenerationalHeap::make_filler(uint8_t* start, size_t bytes) {
+    ObjectHeader* header = reinterpret_cast<ObjectHeader*>(start);
+    header->raw = ObjectHeader::make_raw(static_cast<uint32_t>(bytes - sizeof(ObjectHeader)), 0, TYPE_FILLER);
+    header->forward_ptr = nullptr;
+}
+
+void GenerationalHeap::retire_tlab(TLAB& tlab) {
+    // Keep the page walkable: the unused tail becomes one filler object
+    if (tlab.current_ && tlab.current_ < tlab.end_) {
+        size_t unused = tlab.end_ - tlab.current_;
+        make_filler(tlab.current_, unused);
+        allocated_bytes_.fetch_sub(unused, std::memory_order_relaxed);
     }
-    
-    delete[] WriteBarrier::card_table_;
-    WriteBarrier::card_table_ = nullptr;
+    tlab.start_ = tlab.current_ = tlab.end_ = nullptr;
 }
 
-void* GenerationalHeap::allocate_slow(size_t size, uint32_t type_id, bool is_array) {
-    // Get or create TLAB for this thread with double-checked locking
-    TLAB* local_tlab = tlab_;
-    if (!local_tlab) {
-        std::lock_guard<std::mutex> lock(GarbageCollector::instance().tlabs_mutex_);
-        
-        // Double-check after acquiring lock
-        local_tlab = tlab_;
-        if (!local_tlab) {
-            // Allocate new TLAB from eden
-            if (young_.eden_current + GCConfig::TLAB_SIZE <= young_.eden_end) {
-                auto new_tlab = std::make_unique<TLAB>(
-                    young_.eden_current, 
-                    GCConfig::TLAB_SIZE,
-                    std::hash<std::thread::id>{}(std::this_thread::get_id())
-                );
-                
-                young_.eden_current += GCConfig::TLAB_SIZE;
-                local_tlab = new_tlab.get();
-                GarbageCollector::instance().all_tlabs_.push_back(std::move(new_tlab));
-                
-                // Use atomic store to ensure visibility
-                std::atomic_thread_fence(std::memory_order_release);
-                tlab_ = local_tlab;
-            } else {
-                // Eden full, trigger GC
-                GarbageCollector::instance().request_gc(false);
-                
-                // Retry after GC
-                if (young_.eden_current + GCConfig::TLAB_SIZE <= young_.eden_end) {
-                    return allocate_slow(size, type_id, is_array);
-                }
-                
-                // Still no space, allocate directly in old gen
-                return allocate_large_slow(size, type_id, is_array);
+bool GenerationalHeap::refill_tlab(TLAB& tlab, size_t min_size) {
+    retire_tlab(tlab);
+
+    size_t want = std::max(tlab.refill_size_, min_size);
+    if (tlab.private_owner_) {
+        // The page may have been collected or published since
+        size_t page = tlab.private_page_;
+        if (page >= young_.page_count || young_.pages[page] != PageKind::PRIVATE ||
+            gc_young_page_owner[page] != tlab.private_owner_ || page_room(page) < min_size) {
+            page = young_.page_count;
+            if (young_.private_pages < young_.private_page_limit &&
+                young_.eden_pages_used < young_.eden_page_limit) {
+                page = take_free_page(PageKind::PRIVATE);
             }
+            if (page != young_.page_count) {
+                gc_young_page_owner[page] = tlab.private_owner_;
+                young_.private_pages++;
+                young_.eden_pages_used++;
+            }
+        }
+        if (page != young_.page_count) {
+            tlab.private_page_ = page;
+            carve_tlab(tlab, page, want);
+            return true;
         }
+        // Too many private pages - shared eden until a collection frees some
     }
-    
-    // Try allocation in new TLAB
-    void* result = allocate_fast(size, type_id, is_array);
-    if (result) return result;
-    
-    // Object too large for TLAB
-    return allocate_large_slow(size, type_id, is_array);
+
+    if (young_.eden_page == young_.page_count || page_room(young_.eden_page) < min_size) {
+        if (young_.eden_pages_used >= young_.eden_page_limit) return false;
+        size_t page = take_free_page(PageKind::EDEN);
+        if (page == young_.page_count) return false;
+        young_.eden_page = page;
+        young_.eden_pages_used++;
+    }
+    carve_tlab(tlab, young_.eden_page, want);
+    return true;
 }
 
-void* GenerationalHeap::allocate_large_slow(size_t size, uint32_t type_id, bool is_array) {
-    size_t total_size = size + sizeof(ObjectHeader);
-    total_size = (total_size + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1);
-    
-    std::lock_guard<std::mutex> lock(GarbageCollector::instance().heap_mutex_);
-    
-    // Try old generation
-    if (old_.current + total_size <= old_.end) {
-        void* mem = old_.current;
-        old_.current += total_size;
-        
-        // Initialize header
-        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(mem);
-        header->size = size;
-        header->flags = ObjectHeader::IN_OLD_GEN;
-        header->type_id = type_id;
-        header->forward_ptr = nullptr;
-        if (is_array) header->flags |= ObjectHeader::IS_ARRAY;
-        
-        return header->get_object_start();
+void GenerationalHeap::carve_tlab(TLAB& tlab, size_t page, size_t want) {
+    uint8_t* carve = young_.page_top[page];
+    size_t chunk = std::min(want, page_room(page));
+    memset(carve, 0, chunk);
+    young_.page_top[page] = carve + chunk;
+
+    tlab.start_ = tlab.current_ = carve;
+    tlab.end_ = carve + chunk;
+    tlab.refill_size_ = std::min(tlab.refill_size_ * 2, GCConfig::TLAB_SIZE);
+    allocated_bytes_.fetch_add(chunk, std::memory_order_relaxed);
+}
+
+ObjectHeader* GenerationalHeap::allocate_old(size_t total_size) {
+    ObjectHeader* header = take_free_block(total_size);
+    // Nothing free yet - sweep until something fits
+    while (!header && old_sweep_pending()) {
+        sweep_old_chunk();
+        header = take_free_block(total_size);
     }
-    
-    // Need full GC
-    GarbageCollector::instance().request_gc(true);
-    
-    // Retry
-    if (old_.current + total_size <= old_.end) {
-        return allocate_large_slow(size, type_id, is_array);
+    if (!header) {
+        if (static_cast<size_t>(old_.end - old_.current) < total_size) return nullptr;
+        header = reinterpret_cast<ObjectHeader*>(old_.current);
+        old_.current += total_size;
     }
-    
-    // Out of memory
-    throw std::bad_alloc();
+    // Parseable until the caller writes the real header
+    make_filler(reinterpret_cast<uint8_t*>(header), total_size);
+    set_start_bit(header);
+    old_.used_bytes += total_size;
+    if (gc_marking_active) old_.allocated_while_marking += total_size;
+    return header;
 }
 
 // ============================================================================
-// GARBAGE COLLECTOR IMPLEMENTATION
+// OLD GENERATION FREE LISTS AND SWEEPING
 // ============================================================================
 
-GarbageCollector::GarbageCollector() {
-    heap_.initialize();
-    
-    // Initialize work-stealing deques based on hardware concurrency
-    int num_deques = std::thread::hardware_concurrency();
-    mark_deques_.reserve(num_deques);
-    for (int i = 0; i < num_deques; ++i) {
-        mark_deques_.push_back(std::make_unique<MarkDeque>());
+size_t GenerationalHeap::old_size_class(size_t total_size) {
+    if (total_size <= OLD_EXACT_CLASS_LIMIT) return total_size / GCConfig::OBJECT_ALIGNMENT - 1;
+    // 513..1023 -> first power-of-two class, and so on
+    size_t log2 = 63 - __builtin_clzll(total_size);
+    size_t exact_log2 = 63 - __builtin_clzll(OLD_EXACT_CLASS_LIMIT);
+    return std::min(OLD_EXACT_CLASSES + (log2 - exact_log2), OLD_FREE_LIST_COUNT - 1);
+}
+
+void GenerationalHeap::push_free_block(uint8_t* start, size_t bytes) {
+    make_filler(start, bytes);
+    set_start_bit(start);
+    ObjectHeader*& list = old_.free_lists[old_size_class(bytes)];
+    reinterpret_cast<ObjectHeader*>(start)->forward_ptr = list;
+    list = reinterpret_cast<ObjectHeader*>(start);
+    old_.free_bytes += bytes;
+    old_.largest_free_block = std::max(old_.largest_free_block, bytes);
+}
+
+ObjectHeader* GenerationalHeap::take_free_block(size_t total_size) {
+    size_t size_class = old_size_class(total_size);
+    for (size_t c = size_class; c < OLD_FREE_LIST_COUNT; ++c) {
+        // Exact classes and larger power-of-two classes fit with their head;
+        // the request's own power-of-two class needs a first-fit search
+        ObjectHeader** link = &old_.free_lists[c];
+        if (c == size_class && c >= OLD_EXACT_CLASSES) {
+            while (*link && (*link)->total_size() < total_size) {
+                link = reinterpret_cast<ObjectHeader**>(&(*link)->forward_ptr);
+            }
+        }
+        ObjectHeader* block = *link;
+        if (!block) continue;
+
+        *link = static_cast<ObjectHeader*>(block->forward_ptr);
+        size_t block_size = block->total_size();
+        old_.free_bytes -= block_size;
+        if (block_size > total_size) {
+            push_free_block(reinterpret_cast<uint8_t*>(block) + total_size, block_size - total_size);
+        }
+        return block;
     }
+    return nullptr;
 }
 
-GarbageCollector::~GarbageCollector() {
-    shutdown();
+void GenerationalHeap::clear_free_lists() {
+    for (auto& list : old_.free_lists) list = nullptr;
+    old_.free_bytes = 0;
+    old_.largest_free_block = 0;
 }
 
-void GarbageCollector::initialize() {
-    initialize_thread_cleanup_system();
-    type_registry_.register_common_types();
-    
-    // Initialize optimized write barriers
-    OptimizedWriteBarrier::initialize(
-        heap_.young_.eden_start, 
-        GCConfig::YOUNG_GEN_SIZE + GCConfig::OLD_GEN_SIZE, 
-        GCConfig::CARD_SIZE
-    );
-    AdaptiveWriteBarriers::initialize();
-    
-    concurrent_marker_ = std::make_unique<ConcurrentMarkingCoordinator>(*this);
-    gc_thread_ = std::thread(&GarbageCollector::gc_thread_loop, this);
+void GenerationalHeap::start_old_sweep() {
+    // Every free block is swept again, together with its dead neighbours
+    clear_free_lists();
+    old_.sweep_cursor = old_.start;
+    old_.sweep_limit = old_.current;
 }
 
-void GarbageCollector::shutdown() {
-    running_.store(false);
-    gc_cv_.notify_all();
-    
-    if (gc_thread_.joinable()) {
-        gc_thread_.join();
+bool GenerationalHeap::sweep_old_chunk() {
+    if (!old_sweep_pending()) return false;
+    uint8_t* scan = old_.sweep_cursor;
+    uint8_t* chunk_end = std::min(scan + GCConfig::SWEEP_CHUNK_SIZE, old_.sweep_limit);
+
+    // Runs of dead objects (and old free blocks) become one free block each.
+    // The last object may reach past the chunk
+    uint8_t* dead_start = nullptr;
+    auto close_run = [&](uint8_t* end) {
+        if (!dead_start) return;
+        clear_start_bits(dead_start + GCConfig::OBJECT_ALIGNMENT, end);
+        if (end == old_.sweep_limit && end == old_.current) {
+            trim_old_frontier(dead_start);
+        } else {
+            push_free_block(dead_start, end - dead_start);
+            // Give the pages inside big blocks back to the OS
+            size_t page_size = sysconf(_SC_PAGESIZE);
+            uintptr_t from = (reinterpret_cast<uintptr_t>(dead_start) + sizeof(ObjectHeader) + page_size - 1) & ~(page_size - 1);
+            uintptr_t to = reinterpret_cast<uintptr_t>(end) & ~(page_size - 1);
+            if (to > from && to - from >= GCConfig::SWEEP_CHUNK_SIZE) {
+                madvise(reinterpret_cast<void*>(from), to - from, MADV_DONTNEED);
+            }
+        }
+        dead_start = nullptr;
+    };
+    while (scan < chunk_end) {
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+        scan += header->total_size();
+        if (header->flags & ObjectHeader::MARKED) {
+            close_run(reinterpret_cast<uint8_t*>(header));
+            header->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+        } else if (!dead_start) {
+            dead_start = reinterpret_cast<uint8_t*>(header);
+        }
     }
-    
-    heap_.shutdown();
-    OptimizedWriteBarrier::shutdown();
-    shutdown_thread_cleanup_system();
+    // Advance first, so trimming the frontier ends the sweep
+    old_.sweep_cursor = scan;
+    close_run(scan);
+
+    if (!old_sweep_pending()) {
+        update_old_fragmentation();
+        return false;
+    }
+    return true;
 }
 
-GarbageCollector& GarbageCollector::instance() {
-    if (!g_gc_instance) {
-        g_gc_instance = new GarbageCollector();
-        g_gc_instance->initialize();
+void GenerationalHeap::update_old_fragmentation() {
+    // Blocks are split as they are used, so the largest one is an upper bound
+    size_t largest = std::min(old_.largest_free_block, old_.free_bytes);
+    old_.fragmentation_percent = old_.free_bytes ? 100 - largest * 100 / old_.free_bytes : 0;
+}
+
+void GenerationalHeap::finish_old_sweep() {
+    while (sweep_old_chunk()) {}
+}
+
+void GenerationalHeap::trim_old_frontier(uint8_t* new_current) {
+    clear_start_bits(new_current, old_.current);
+    old_.current = new_current;
+    old_.sweep_limit = std::min(old_.sweep_limit, new_current);
+    old_.sweep_cursor = std::min(old_.sweep_cursor, old_.sweep_limit);
+
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t tail = (reinterpret_cast<uintptr_t>(new_current) + page_size - 1) & ~(page_size - 1);
+    if (tail < reinterpret_cast<uintptr_t>(old_.end)) {
+        madvise(reinterpret_cast<void*>(tail), reinterpret_cast<uintptr_t>(old_.end) - tail, MADV_DONTNEED);
     }
-    return *g_gc_instance;
 }
 
-void GarbageCollector::gc_thread_loop() {
-    while (running_.load()) {
-        std::unique_lock<std::mutex> lock(gc_mutex_);
-        
-        // Wait for GC request
-        gc_cv_.wait(lock, [this] {
-            return gc_requested_.load() || !running_.load();
-        });
-        
-        if (!running_.load()) break;
-        
-        if (gc_requested_.exchange(false)) {
-            lock.unlock();
-            
-            // Determine which GC to perform
-            size_t young_used = heap_.young_used();
-            size_t old_used = heap_.old_used();
-            
-            if (young_used > GCConfig::YOUNG_GEN_SIZE * 0.8) {
-                perform_young_gc();
-            } else if (old_used > GCConfig::OLD_GEN_SIZE * 0.8) {
-                perform_old_gc();
-            }
-        }
+// ============================================================================
+// LARGE-OBJECT SPACE
+// ============================================================================
+
+ObjectHeader* GenerationalHeap::allocate_large_object(size_t total_size) {
+    size_t span = (total_size + GCConfig::LOS_PAGE_SIZE - 1) & ~(GCConfig::LOS_PAGE_SIZE - 1);
+
+    // Lowest free span that fits, then the frontier
+    uint8_t* start = nullptr;
+    for (auto it = los_.free_spans.begin(); it != los_.free_spans.end(); ++it) {
+        if (it->second < span) continue;
+        start = it->first;
+        if (it->second > span) los_.free_spans[start + span] = it->second - span;
+        los_.free_spans.erase(it);
+        break;
     }
+    if (!start) {
+        if (static_cast<size_t>(los_.end - los_.current) < span) return nullptr;
+        start = los_.current;
+        los_.current += span;
+    }
+
+    // Freed spans were released, so every page reads as zero
+    ObjectHeader* header = reinterpret_cast<ObjectHeader*>(start);
+    size_t first = (start - los_.start) >> GCConfig::LOS_PAGE_SHIFT;
+    std::fill(los_.page_object + first, los_.page_object + first + (span >> GCConfig::LOS_PAGE_SHIFT), header);
+    los_.objects[start] = span;
+    los_.object_count.fetch_add(1, std::memory_order_relaxed);
+    los_.span_bytes.fetch_add(span, std::memory_order_relaxed);
+    old_.used_bytes += total_size;
+    if (gc_marking_active) old_.allocated_while_marking += total_size;
+    return header;
 }
 
-void GarbageCollector::perform_young_gc() {
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // Request safe point
-    wait_for_safepoint();
-    
-    // Phase 1: Concurrent marking
-    current_phase_.store(Phase::MARKING);
-    start_concurrent_marking();
-    wait_for_concurrent_marking();
-    
-    // Phase 2: Copy live objects
-    current_phase_.store(Phase::RELOCATING);
-    copy_young_survivors();
-    
-    // Phase 3: Update references
-    current_phase_.store(Phase::UPDATING_REFS);
-    update_references();
-    
-    // Reset eden
-    heap_.young_.eden_current = heap_.young_.eden_start;
-    
-    // Swap survivor spaces
-    std::swap(heap_.young_.active_survivor, 
-              heap_.young_.active_survivor == heap_.young_.survivor1_start ? 
-              heap_.young_.survivor2_start : heap_.young_.survivor1_start);
-    
-    // Clear card table
-    WriteBarrier::clear_cards();
-    
-    // Release threads
-    release_safepoint();
-    current_phase_.store(Phase::IDLE);
-    
-    heap_.young_.collections.fetch_add(1);
-    
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto pause_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        end_time - start_time).count();
-    
-    total_pause_time_ms_.fetch_add(pause_time);
-    max_pause_time_ms_.store(std::max(max_pause_time_ms_.load(), pause_time));
+ObjectHeader* GenerationalHeap::large_object_at(const uint8_t* p) const {
+    if (p < los_.start || p >= los_.current) return nullptr;
+    ObjectHeader* header = los_.page_object[(p - los_.start) >> GCConfig::LOS_PAGE_SHIFT];
+    // The span is rounded up to whole pages
+    if (!header || p >= reinterpret_cast<const uint8_t*>(header) + header->total_size()) return nullptr;
+    return header;
 }
 
-void GarbageCollector::mark_roots() {
-    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-    
-    // Mark stack roots
-    for (void** root : roots_.stack_roots) {
-        if (*root) mark_object(*root);
+void GenerationalHeap::free_large_object(uint8_t* start, size_t span) {
+    madvise(start, span, MADV_DONTNEED);
+    size_t first = (start - los_.start) >> GCConfig::LOS_PAGE_SHIFT;
+    std::fill(los_.page_object + first, los_.page_object + first + (span >> GCConfig::LOS_PAGE_SHIFT), nullptr);
+    memset(card_table_ + card_index(start), 0, span >> GCConfig::CARD_SHIFT);
+    los_.object_count.fetch_sub(1, std::memory_order_relaxed);
+    los_.span_bytes.fetch_sub(span, std::memory_order_relaxed);
+    los_.released_bytes.fetch_add(span, std::memory_order_relaxed);
+
+    // Coalesce with the free neighbours; a span reaching the frontier trims it
+    auto next = los_.free_spans.lower_bound(start);
+    if (next != los_.free_spans.end() && next->first == start + span) {
+        span += next->second;
+        next = los_.free_spans.erase(next);
     }
-    
-    // Mark global roots
-    for (void** root : roots_.global_roots) {
-        if (*root) mark_object(*root);
+    if (next != los_.free_spans.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            span += prev->second;
+            los_.free_spans.erase(prev);
+        }
     }
-    
-    // Mark register roots (from safepoint)
-    for (void** root : roots_.register_roots) {
-        if (*root) mark_object(*root);
+    if (start + span == los_.current) {
+        los_.current = start;
+    } else {
+        los_.free_spans[start] = span;
     }
 }
 
-void GarbageCollector::mark_object(void* obj) {
-    if (!obj) return;
-    
-    ObjectHeader* header = reinterpret_cast<ObjectHeader*>(
-        static_cast<uint8_t*>(obj) - sizeof(ObjectHeader)
-    );
-    
-    // Already marked?
-    if (header->is_marked()) return;
-    
-    // Mark it
-    header->set_marked(true);
-    
-    // Add to thread-local deque for processing
-    int deque_idx = get_thread_deque_index();
-    auto& deque = mark_deques_[deque_idx];
-    {
-        std::lock_guard<std::mutex> lock(deque->mutex);
-        deque->deque.push_back(obj);
-        deque->size.fetch_add(1, std::memory_order_relaxed);
+void GenerationalHeap::sweep_large_objects() {
+    for (auto it = los_.objects.begin(); it != los_.objects.end(); ) {
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(it->first);
+        if (header->flags & ObjectHeader::MARKED) {
+            header->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+            ++it;
+        } else {
+            free_large_object(it->first, it->second);
+            it = los_.objects.erase(it);
+        }
     }
 }
 
-void GarbageCollector::process_mark_stack() {
-    int deque_idx = get_thread_deque_index();
-    process_mark_deque(deque_idx);
+template <typename F>
+void GenerationalHeap::for_each_large_object(F&& f) {
+    for (const auto& object : los_.objects) f(reinterpret_cast<ObjectHeader*>(object.first));
 }
 
-void GarbageCollector::process_mark_deque(int deque_index) {
-    auto& my_deque = mark_deques_[deque_index];
-    int steal_attempts = 0;
-    const int max_steal_attempts = mark_deques_.size() * 2;
-    
-    while (true) {
-        void* obj = nullptr;
-        
-        // Try to get work from own deque
-        {
-            std::lock_guard<std::mutex> lock(my_deque->mutex);
-            if (!my_deque->deque.empty()) {
-                obj = my_deque->deque.back();
-                my_deque->deque.pop_back();
-                my_deque->size.fetch_sub(1, std::memory_order_relaxed);
-            }
+void* GenerationalHeap::allocate_slow(size_t size, uint32_t type_id, bool is_array, uint32_t site) {
+    GarbageCollector& gc = GarbageCollector::instance();
+    GenerationalHeap& heap = gc.heap_;
+    size_t total = ObjectHeader::align(sizeof(ObjectHeader) + size);
+    if (total > GCConfig::LARGE_OBJECT_SIZE) {
+        return allocate_large_slow(size, type_id, is_array);
+    }
+
+    if (!t_mutator) {
+        gc.register_current_thread();
+        // Exiting threads can no longer be scanned - keep them out of TLABs
+        if (!t_mutator) return allocate_large_slow(size, type_id, is_array);
+    }
+
+    TLAB& tlab = tlab_;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        size_t seen = heap.young_.collections.load();
+        tlab.enter_heap();
+        ObjectHeader* header = tlab.allocate(total);
+        if (!header) {
+            std::lock_guard<std::mutex> lock(heap.heap_mutex_);
+            size_t used = tlab.used();
+            if (heap.refill_tlab(tlab, total)) header = tlab.allocate(total);
+            if (header && site) g_allocation_samples.push({header, site});
+            if (header && gc.heap_profile_rate()) gc.sample_allocation(header, total, used + total);
         }
-        
-        // If no work, try to steal from others
-        if (!obj && steal_attempts < max_steal_attempts) {
-            steal_attempts++;
-            for (size_t i = 0; i < mark_deques_.size(); ++i) {
-                if (i != deque_index && steal_work(i, obj)) {
-                    steal_attempts = 0;  // Reset on successful steal
-                    break;
-                }
+        if (header) {
+            header->raw = ObjectHeader::make_raw(static_cast<uint32_t>(size),
+                                                 is_array ? ObjectHeader::IS_ARRAY : 0,
+                                                 static_cast<uint16_t>(type_id));
+            tlab.leave_heap();
+            return header->get_object_start();
+        }
+        tlab.leave_heap();
+
+        // Eden is full
+        gc.collect(false, seen);
+    }
+
+    // Survivors pinned in place left no room in the young gen
+    return allocate_large_slow(size, type_id, is_array);
+}
+
+void* GenerationalHeap::allocate_large_slow(size_t size, uint32_t type_id, bool is_array) {
+    GarbageCollector& gc = GarbageCollector::instance();
+    GenerationalHeap& heap = gc.heap_;
+    size_t total = ObjectHeader::align(sizeof(ObjectHeader) + size);
+    bool huge = total >= GCConfig::LOS_OBJECT_SIZE;
+    TLAB& tlab = tlab_;
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        size_t seen = heap.young_.collections.load();
+        if (attempt == 0) {
+            // Concurrent cycles start, and finish, in young collections -
+            // one is due now if large objects filled the old generation first
+            bool start_marking;
+            bool old_gc_due;
+            tlab.enter_heap();
+            {
+                std::lock_guard<std::mutex> lock(heap.heap_mutex_);
+                size_t used = heap.old_used() + total;
+                old_gc_due = used > heap.old_.gc_trigger;
+                start_marking = !gc_marking_active && !heap.old_sweep_pending() && !gc.should_compact_old() &&
+                                used > heap.old_.gc_trigger / 100 * GCConfig::CONCURRENT_MARK_START_PERCENT;
+            }
+            tlab.leave_heap();
+            if (old_gc_due) {
+                gc.collect(!gc_marking_active, seen);
+                seen = heap.young_.collections.load();
+            } else if (start_marking) {
+                gc.request_concurrent_mark();
+                gc.collect(false, seen);
+                seen = heap.young_.collections.load();
             }
         }
-        
-        // If still no work, we're done
-        if (!obj) {
-            break;
+
+        tlab.enter_heap();
+        ObjectHeader* header;
+        {
+            std::lock_guard<std::mutex> lock(heap.heap_mutex_);
+            header = huge ? heap.allocate_large_object(total) : heap.allocate_old(total);
+            if (header) heap.allocated_bytes_.fetch_add(total, std::memory_order_relaxed);
+            if (header && gc.heap_profile_rate()) gc.sample_allocation(header, total, total);
         }
-        
-        // Process the object
-        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(
-            static_cast<uint8_t*>(obj) - sizeof(ObjectHeader)
-        );
-        
-        // Get type info to find references
-        TypeInfo* type_info = type_registry_.get_type(header->type_id);
-        if (!type_info) continue;
-        
-        // Process all reference fields
-        for (size_t offset : type_info->ref_offsets) {
-            void** field = reinterpret_cast<void**>(
-                static_cast<uint8_t*>(obj) + offset
-            );
-            if (*field) mark_object(*field);
+        if (header) {
+            if (!huge) memset(header->get_object_start(), 0, total - sizeof(ObjectHeader));
+            header->forward_ptr = nullptr;
+            // Allocated black while the old generation is being marked
+            uint8_t flags = ObjectHeader::IN_OLD_GEN | (is_array ? ObjectHeader::IS_ARRAY : 0) |
+                            (gc_marking_active ? ObjectHeader::MARKED : 0);
+            header->raw = ObjectHeader::make_raw(static_cast<uint32_t>(size), flags,
+                                                 static_cast<uint16_t>(type_id));
+            tlab.leave_heap();
+            return header->get_object_start();
         }
+        tlab.leave_heap();
+
+        // Enough free space may exist, just not in one piece
+        if (attempt == 1 && !huge) gc.request_compaction();
+        gc.collect(true, seen);
     }
-}
 
-bool GarbageCollector::steal_work(int from_deque, void*& obj) {
-    auto& deque = mark_deques_[from_deque];
-    
-    // Only steal if they have enough work
-    if (deque->size.load(std::memory_order_relaxed) < 2) {
-        return false;
+    if (huge) {
+        std::cerr << "ERROR: GoTS heap exhausted allocating " << size << " bytes (large-object space "
+                  << heap.large_object_bytes() << " of " << GCConfig::LOS_SIZE << " bytes in use)" << std::endl;
+    } else {
+        std::cerr << "ERROR: GoTS heap exhausted allocating " << size << " bytes (old generation "
+                  << heap.old_used() << " of " << GCConfig::OLD_GEN_SIZE << " bytes in use)" << std::endl;
     }
-    
-    std::lock_guard<std::mutex> lock(deque->mutex);
-    if (!deque->deque.empty()) {
-        // Steal from front (opposite end from owner)
-        obj = deque->deque.front();
-        deque->deque.pop_front();
-        deque->size.fetch_sub(1, std::memory_order_relaxed);
-        return true;
+    std::abort();
+}
+
+void GenerationalHeap::collect_young() {
+    GarbageCollector::instance().request_gc(false);
+}
+
+void GenerationalHeap::collect_old() {
+    GarbageCollector::instance().request_gc(true);
+}
+
+void GenerationalHeap::collect_full() {
+    GarbageCollector::instance().request_gc(true);
+}
+
+ObjectHeader* GenerationalHeap::find_object(const void* addr) const {
+    const uint8_t* p = static_cast<const uint8_t*>(addr);
+    const uint8_t* lower;
+    if (in_young(p)) {
+        size_t page = page_index(p);
+        if (young_.pages[page] == PageKind::FREE || p >= young_.page_top[page]) return nullptr;
+        lower = page_start(page);
+    } else if (p >= old_.start && p < old_.current) {
+        lower = old_.start;
+    } else {
+        return large_object_at(p);
     }
-    return false;
+
+    // Nearest object start at or below the address
+    size_t found = start_bit_at_or_before(bit_index(p), bit_index(lower));
+    if (found == SIZE_MAX) return nullptr;
+
+    ObjectHeader* header = reinterpret_cast<ObjectHeader*>(reserved_start_ + found * GCConfig::OBJECT_ALIGNMENT);
+    if (p >= reinterpret_cast<const uint8_t*>(header) + header->total_size()) return nullptr;
+    if (header->type_id == TYPE_FILLER) return nullptr;
+    return header;
 }
 
-int GarbageCollector::get_thread_deque_index() {
-    if (thread_deque_index_ == -1) {
-        thread_deque_index_ = next_deque_.fetch_add(1) % mark_deques_.size();
+size_t GenerationalHeap::start_bit_at_or_before(size_t bit, size_t lower_bit) const {
+    size_t word = bit / 64;
+    uint64_t bits = start_bits_[word] & (bit % 64 == 63 ? ~uint64_t(0) : (uint64_t(1) << (bit % 64 + 1)) - 1);
+    while (bits == 0) {
+        if (word == lower_bit / 64) return SIZE_MAX;
+        bits = start_bits_[--word];
     }
-    return thread_deque_index_;
+    size_t found = word * 64 + (63 - __builtin_clzll(bits));
+    return found < lower_bit ? SIZE_MAX : found;
 }
 
-// Copy survivors from young generation
-void GarbageCollector::copy_young_survivors() {
-    // Simplified implementation - just promote marked objects
-    uint8_t* scan = heap_.young_.eden_start;
-    uint8_t* eden_end = heap_.young_.eden_current;
-    
-    while (scan < eden_end) {
-        // Bounds check: ensure we have at least space for a header
-        if (scan + sizeof(ObjectHeader) > eden_end) {
-            std::cerr << "ERROR: Incomplete object header at end of eden space\n";
-            break;
-        }
-        
-        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
-        
-        // Validate object size to prevent overflow
-        if (header->size > GCConfig::YOUNG_GEN_SIZE || 
-            header->size < sizeof(void*)) {
-            std::cerr << "ERROR: Invalid object size " << header->size << " at " << scan << "\n";
-            break;
-        }
-        
-        // Validate object header integrity
-        if (header->type_id == 0 || header->type_id > 10000) {
-            std::cerr << "ERROR: Invalid type_id " << header->type_id << " at " << scan << "\n";
-            break;
-        }
-        
-        // Validate object flags
-        if ((header->flags & ~(ObjectHeader::IS_MARKED | ObjectHeader::IS_ARRAY | 
-                              ObjectHeader::IN_OLD_GEN | ObjectHeader::STACK_ALLOCATED)) != 0) {
-            std::cerr << "ERROR: Invalid object flags " << std::hex << header->flags 
-                      << " at " << scan << "\n";
-            break;
-        }
-        
-        // Calculate next object position with overflow check
-        size_t total_object_size = sizeof(ObjectHeader) + header->size;
-        
-        // Check for integer overflow
-        if (total_object_size < header->size) {
-            std::cerr << "ERROR: Object size overflow detected\n";
-            break;
-        }
-        
-        // Ensure we don't read beyond eden space
-        if (scan + total_object_size > eden_end) {
-            std::cerr << "ERROR: Object extends beyond eden space\n";
-            break;
-        }
-        
-        if (header->is_marked()) {
-            // Promote to old generation
-            void* new_location = copy_object(header->get_object_start(), true);
-            if (new_location) {
-                header->forward_ptr = new_location;
-            }
-        }
-        
-        // Move to next object with alignment
-        scan += total_object_size;
-        scan = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(scan) + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1));
-        
-        // Final bounds check after alignment
-        if (scan > eden_end) {
-            break;
-        }
+ObjectHeader* GenerationalHeap::old_object_at_or_before(const uint8_t* p) const {
+    size_t found = start_bit_at_or_before(bit_index(p), bit_index(old_.start));
+    if (found == SIZE_MAX) return nullptr;
+    return reinterpret_cast<ObjectHeader*>(reserved_start_ + found * GCConfig::OBJECT_ALIGNMENT);
+}
+
+void GenerationalHeap::clear_start_bits(const uint8_t* from, const uint8_t* to) {
+    size_t bit = bit_index(from);
+    size_t end = bit_index(to);
+    while (bit < end && bit % 64 != 0) {
+        start_bits_[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        bit++;
+    }
+    if (end - bit >= 64) {
+        memset(&start_bits_[bit / 64], 0, (end - bit) / 64 * sizeof(uint64_t));
+        bit += (end - bit) / 64 * 64;
+    }
+    while (bit < end) {
+        start_bits_[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        bit++;
     }
 }
 
-// Copy object to new location
-void* GarbageCollector::copy_object(void* obj, bool to_old_gen) {
-    ObjectHeader* header = reinterpret_cast<ObjectHeader*>(
-        static_cast<uint8_t*>(obj) - sizeof(ObjectHeader)
-    );
-    
-    size_t total_size = sizeof(ObjectHeader) + header->size;
-    total_size = (total_size + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1);
-    
-    void* new_location = nullptr;
-    
-    if (to_old_gen) {
-        std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
-        if (heap_.old_.current + total_size <= heap_.old_.end) {
-            new_location = heap_.old_.current;
-            heap_.old_.current += total_size;
-            memcpy(new_location, header, total_size);
-            
-            ObjectHeader* new_header = reinterpret_cast<ObjectHeader*>(new_location);
-            new_header->flags |= ObjectHeader::IN_OLD_GEN;
-        }
+template <typename F>
+void GenerationalHeap::for_each_old_object(F&& f) {
+    uint8_t* scan = old_.start;
+    while (scan < old_.current) {
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+        scan += header->total_size();
+        f(header);
     }
-    
-    return new_location ? reinterpret_cast<ObjectHeader*>(new_location)->get_object_start() : nullptr;
 }
 
-// Update all references to point to new locations
-void GarbageCollector::update_references() {
-    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-    
-    auto update_ref = [](void** ref_ptr) {
-        if (*ref_ptr) {
-            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(
-                static_cast<uint8_t*>(*ref_ptr) - sizeof(ObjectHeader)
-            );
-            if (header->forward_ptr != nullptr) {
-                *ref_ptr = header->forward_ptr;
+template <typename F>
+void GenerationalHeap::for_each_dirty_old_card(F&& f) {
+    // Eight cards at a time - most of the table is clean
+    auto scan = [&](size_t first, size_t end) {
+        for (size_t card = first; card < end; card += 8) {
+            uint64_t cards;
+            memcpy(&cards, card_table_ + card, sizeof(cards));
+            if (cards == 0) continue;
+            for (size_t i = card; i < std::min(card + 8, end); ++i) {
+                if (card_table_[i]) f(i);
             }
         }
     };
-    
-    for (void** root : roots_.stack_roots) {
-        update_ref(root);
+    scan(card_index(old_.start), card_index(old_.current + GCConfig::CARD_SIZE - 1));
+    // Spans are whole cards, and the free ones between them are clean
+    for (const auto& object : los_.objects) {
+        scan(card_index(object.first), card_index(object.first + object.second));
     }
-    
-    for (void** root : roots_.global_roots) {
-        update_ref(root);
+}
+
+template <typename F>
+void GenerationalHeap::for_each_young_object(F&& f) {
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        if (young_.pages[i] == PageKind::FREE) continue;
+        uint8_t* scan = page_start(i);
+        while (scan < young_.page_top[i]) {
+            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+            scan += header->total_size();
+            f(header);
+        }
     }
 }
 
-// Safepoint implementation
-void GarbageCollector::wait_for_safepoint() {
-    safepoint_requested_.store(true, std::memory_order_release);
-    while (threads_at_safepoint_.load() < total_threads_) {
-        std::this_thread::yield();
+void GenerationalHeap::rebuild_young_start_bits() {
+    clear_start_bits(young_.start, young_.end);
+    for_each_young_object([this](ObjectHeader* header) { set_start_bit(header); });
+}
+
+size_t GenerationalHeap::young_used() const {
+    size_t used = 0;
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        if (young_.pages[i] != PageKind::FREE) used += young_.page_top[i] - page_start(i);
     }
+    return used;
 }
 
-void GarbageCollector::release_safepoint() {
-    threads_at_safepoint_.store(0);
-    safepoint_requested_.store(false, std::memory_order_release);
+size_t GenerationalHeap::old_used() const {
+    return old_.used_bytes;
 }
 
-void GarbageCollector::safepoint_slow() {
-    instance().threads_at_safepoint_.fetch_add(1);
-    while (instance().safepoint_requested_.load(std::memory_order_acquire)) {
-        std::this_thread::yield();
+size_t GenerationalHeap::heap_size() const {
+    size_t survivor_pages = 0;
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        if (young_.pages[i] == PageKind::SURVIVOR) survivor_pages++;
     }
-    instance().threads_at_safepoint_.fetch_sub(1);
+    return eden_size() + survivor_pages * GCConfig::YOUNG_PAGE_SIZE + (old_.current - old_.start) +
+           large_object_bytes();
 }
 
-// Root management
-void GarbageCollector::add_stack_root(void** root) {
-    // Initialize thread-local cleanup if needed
-    if (!thread_root_cleanup_) {
-        thread_root_cleanup_ = new ThreadRootCleanup(this);
-        
-        // Register with global thread cleanup system
-        ThreadLocalCleanup::register_thread();
-        
-        // Add this cleanup to the thread's cleanup list
-        auto* thread_data = ThreadLocalCleanup::get_thread_data();
-        if (thread_data) {
-            thread_data->root_cleanup = static_cast<void*>(thread_root_cleanup_);
+size_t GenerationalHeap::total_allocated() const {
+    return allocated_bytes_.load(std::memory_order_relaxed);
+}
+
+void GenerationalHeap::decommit_unused_memory() {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        if (young_.pages[i] == PageKind::FREE) {
+            madvise(page_start(i), GCConfig::YOUNG_PAGE_SIZE, MADV_DONTNEED);
         }
-        
-        // Register cleanup callback for thread exit
-        register_thread_cleanup_callback([](void* arg) {
-            auto* cleanup = static_cast<ThreadRootCleanup*>(arg);
-            if (cleanup) {
-                cleanup->cleanup_all_roots();
-                delete cleanup;
-            }
-        }, thread_root_cleanup_);
     }
-    
-    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-    roots_.stack_roots.push_back(root);
-    
-    // Also add to thread-local cleanup tracking
-    if (thread_root_cleanup_) {
-        thread_root_cleanup_->add_root(root);
+    uintptr_t tail = (reinterpret_cast<uintptr_t>(old_.current) + page_size - 1) & ~(page_size - 1);
+    if (tail < reinterpret_cast<uintptr_t>(old_.end)) {
+        madvise(reinterpret_cast<void*>(tail), reinterpret_cast<uintptr_t>(old_.end) - tail, MADV_DONTNEED);
     }
 }
 
+size_t GenerationalHeap::get_unused_memory() const {
+    size_t free_pages = 0;
+    for (size_t i = 0; i < young_.page_count; ++i) {
+        if (young_.pages[i] == PageKind::FREE) free_pages++;
+    }
+    return free_pages * GCConfig::YOUNG_PAGE_SIZE + (old_.end - old_.current) + old_.free_bytes;
+}
+
+void TLAB::park_pending() {
+    suspend_pending_ = 0;
+    if (t_mutator) GarbageCollector::park(t_mutator, nullptr);
+}
+
+// ============================================================================
+// GARBAGE COLLECTOR IMPLEMENTATION
+// ============================================================================
+
+GarbageCollector::GarbageCollector() {
+    g_gc_instance = this;
+    initialize();
+}
+
+GarbageCollector::~GarbageCollector() {
+    shutdown();
+}
+
+void GarbageCollector::initialize() {
+    heap_.initialize();
+    type_registry_.register_common_types();
+    started_ = std::chrono::steady_clock::now();
+    last_young_gc_ = started_;
+    const char* trace = getenv("GOTS_GCTRACE");
+    trace_ = trace && atoi(trace) > 0;
+    memory_limit_.store(default_memory_limit());
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = suspend_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(GC_SUSPEND_SIGNAL, &action, nullptr) != 0) {
+        std::cerr << "ERROR: Failed to install the GC suspend handler: " << strerror(errno) << std::endl;
+    }
+}
+
+void GarbageCollector::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        worker_stop_ = true;
+        worker_cv_.notify_one();
+    }
+    if (worker_.joinable()) worker_.join();
+    heap_.shutdown();
+}
+
+GarbageCollector& GarbageCollector::instance() {
+    // Use heap allocation to avoid static destruction order issues
+    static GarbageCollector* instance = new GarbageCollector();
+    return *instance;
+}
+
+void GarbageCollector::register_current_thread() {
+    if (t_mutator || t_thread_exited) return;
+
+    MutatorThread* thread = new MutatorThread();
+    thread->handle = pthread_self();
+    thread->tlab = &GenerationalHeap::tlab_;
+    thread->satb = &t_satb;
+    pthread_attr_t attr;
+    void* stack_addr = nullptr;
+    size_t stack_size = 0;
+    if (pthread_getattr_np(thread->handle, &attr) == 0) {
+        pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+        pthread_attr_destroy(&attr);
+    }
+    thread->stack_low = reinterpret_cast<uintptr_t>(stack_addr);
+    thread->stack_high = thread->stack_low + stack_size;
+
+    // Touch the exit hook so its destructor runs for this thread
+    (void)&t_registration;
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    threads_.push_back(thread);
+    t_mutator = thread;
+}
+
+void GarbageCollector::unregister_current_thread() {
+    MutatorThread* thread = t_mutator;
+    if (!thread) return;
+    release_private_heap();
+
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
+        heap_.retire_tlab(tlab);
+    }
+    if (t_satb.count) {
+        std::lock_guard<std::mutex> lock(satb_mutex_);
+        for (size_t i = 0; i < t_satb.count; ++i) g_satb_queue.push(t_satb.entries[i]);
+        t_satb.count = 0;
+    }
+    tlab.leave_heap();
+
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        threads_.erase(std::remove(threads_.begin(), threads_.end(), thread), threads_.end());
+        t_mutator = nullptr;
+    }
+    delete thread;
+}
+
+void GarbageCollector::register_restartable_range(const void* start, const void* end) {
+    std::lock_guard<std::mutex> lock(restart_ranges_mutex_);
+    const std::vector<CodeRange>* current = restart_ranges_.load(std::memory_order_acquire);
+    auto* next = current ? new std::vector<CodeRange>(*current) : new std::vector<CodeRange>();
+    next->push_back({reinterpret_cast<uintptr_t>(start), reinterpret_cast<uintptr_t>(end)});
+    std::sort(next->begin(), next->end(), [](const CodeRange& a, const CodeRange& b) { return a.start < b.start; });
+    // The previous table is leaked - a signal handler may still be reading it
+    restart_ranges_.store(next, std::memory_order_release);
+}
+
+uintptr_t GarbageCollector::restart_point(uintptr_t pc) const {
+    const std::vector<CodeRange>* ranges = restart_ranges_.load(std::memory_order_acquire);
+    if (!ranges || ranges->empty()) return 0;
+    auto it = std::upper_bound(ranges->begin(), ranges->end(), pc,
+                               [](uintptr_t value, const CodeRange& range) { return value < range.start; });
+    if (it == ranges->begin()) return 0;
+    --it;
+    return pc < it->end ? it->start : 0;
+}
+
+void GarbageCollector::suspend_handler(int sig, siginfo_t* info, void* context) {
+    (void)sig;
+    (void)info;
+    int saved_errno = errno;
+    MutatorThread* self = t_mutator;
+    if (self && g_gc_instance) {
+        // An inline allocation that has not committed starts over
+        ucontext_t* uc = static_cast<ucontext_t*>(context);
+        greg_t& rip = uc->uc_mcontext.gregs[REG_RIP];
+        uintptr_t restart = g_gc_instance->restart_point(static_cast<uintptr_t>(rip));
+        if (restart) rip = static_cast<greg_t>(restart);
+
+        TLAB& tlab = GenerationalHeap::tlab_;
+        if (tlab.in_heap_) {
+            tlab.suspend_pending_ = 1;
+        } else {
+            park(self, uc);
+        }
+    }
+    errno = saved_errno;
+}
+
+__attribute__((noinline)) void GarbageCollector::park(MutatorThread* self, void* context) {
+    GarbageCollector& gc = *g_gc_instance;
+    uint32_t epoch = gc.world_epoch_.load(std::memory_order_acquire);
+
+    uintptr_t sp;
+    if (context) {
+        const greg_t* gregs = static_cast<ucontext_t*>(context)->uc_mcontext.gregs;
+        static const int saved[16] = {REG_RAX, REG_RBX, REG_RCX, REG_RDX, REG_RSI, REG_RDI, REG_RBP /* SAVED_RBP */, REG_RSP,
+                                      REG_R8, REG_R9, REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15};
+        for (int i = 0; i < 16; ++i) self->registers[i] = static_cast<uintptr_t>(gregs[saved[i]]);
+        // Leaf code may keep values in the red zone below RSP
+        sp = static_cast<uintptr_t>(gregs[REG_RSP]) - 128;
+    } else {
+        // Spill callee-saved registers into this frame, which gets scanned
+        __builtin_unwind_init();
+        memset(self->registers, 0, sizeof(self->registers));
+        self->registers[SAVED_RBP] = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+        asm volatile("mov %%rsp, %0" : "=r"(sp));
+    }
+    self->stopped_sp = sp;
+
+    gc.stopped_count_.fetch_add(1, std::memory_order_acq_rel);
+    futex_wake(&gc.stopped_count_, 1);
+    while (gc.world_epoch_.load(std::memory_order_acquire) == epoch) {
+        futex_wait(&gc.world_epoch_, epoch);
+    }
+}
+
+void GarbageCollector::stop_the_world() {
+    MutatorThread* self = t_mutator;
+    stopped_count_.store(0, std::memory_order_release);
+    uint32_t expected = 0;
+    for (MutatorThread* thread : threads_) {
+        if (thread == self) continue;
+        if (pthread_kill(thread->handle, GC_SUSPEND_SIGNAL) == 0) expected++;
+    }
+    uint32_t stopped;
+    while ((stopped = stopped_count_.load(std::memory_order_acquire)) < expected) {
+        futex_wait(&stopped_count_, stopped);
+    }
+}
+
+void GarbageCollector::resume_the_world() {
+    world_epoch_.fetch_add(1, std::memory_order_acq_rel);
+    futex_wake(&world_epoch_, INT_MAX);
+}
+
+void GarbageCollector::collect(bool full, size_t seen_young_collections) {
+    // Finalizers run by the collector must not start another collection
+    if (t_collecting) return;
+    register_current_thread();
+
+    std::lock_guard<std::mutex> collect_lock(collect_mutex_);
+    if (heap_.young_.collections.load() != seen_young_collections) return;  // Someone else just collected
+    t_collecting = true;
+
+    size_t old_collections = heap_.old_.collections.load();
+    size_t concurrent_marks = concurrent_marks_.load();
+    size_t compactions = heap_.old_.compactions.load();
+    bool was_marking = gc_marking_active;
+    size_t used_before = 0;
+    size_t used_after = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        // Anything the collector needs is locked before the world stops, so
+        // no stopped thread can be holding it
+        std::lock_guard<std::mutex> roots_lock(roots_.roots_mutex);
+        std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+        std::lock_guard<std::mutex> mark_lock(mark_mutex_);
+        stop_the_world();
+        {
+            std::lock_guard<std::mutex> heap_lock(heap_.heap_mutex_);
+            for (MutatorThread* thread : threads_) {
+                heap_.retire_tlab(*thread->tlab);
+            }
+            heap_.young_.eden_page = heap_.young_.page_count;
+
+            size_t eden_used = heap_.young_.eden_pages_used * GCConfig::YOUNG_PAGE_SIZE;
+            size_t young_before = heap_.young_used();
+            used_before = young_before + heap_.old_used();
+            perform_young_gc();
+            size_t survived = heap_.young_used() + g_promoted_bytes;
+            size_t concurrent_start = heap_.old_.gc_trigger / 100 * GCConfig::CONCURRENT_MARK_START_PERCENT;
+            if (full) {
+                perform_old_gc();
+            } else if (gc_marking_active) {
+                // Remark once the marker ran dry - or now, if the old
+                // generation reached its trigger first
+                if (mark_done_ || heap_.old_used() > heap_.old_.gc_trigger) finish_concurrent_mark();
+            } else if (heap_.old_used() > heap_.old_.gc_trigger) {
+                perform_old_gc();
+            } else if (!heap_.old_sweep_pending() && !should_compact_old() &&
+                       (concurrent_mark_requested_.exchange(false) || heap_.old_used() > concurrent_start)) {
+                start_concurrent_mark();
+            }
+            size_generations(eden_used, young_before ? survived * 100 / young_before : 0);
+            update_old_trigger();
+            used_after = heap_.young_used() + heap_.old_used();
+            if (used_before > used_after) total_freed_.fetch_add(used_before - used_after);
+            live_bytes_.store(used_after);
+        }
+        resume_the_world();
+    }
+    if (gc_marking_active || heap_.old_.collections.load() != old_collections) wake_worker();
+
+    auto end = std::chrono::steady_clock::now();
+    size_t pause_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    size_t pause_ms = pause_us / 1000;
+    total_pause_time_ms_.fetch_add(pause_ms);
+    size_t max_pause = max_pause_time_ms_.load();
+    while (pause_ms > max_pause && !max_pause_time_ms_.compare_exchange_weak(max_pause, pause_ms)) {}
+    pauses_.record(pause_us);
+    promoted_bytes_.fetch_add(g_promoted_bytes, std::memory_order_relaxed);
+
+    if (trace_) {
+        const char* kind = "young";
+        if (concurrent_marks_.load() != concurrent_marks) {
+            kind = "young+remark";
+        } else if (heap_.old_.collections.load() != old_collections) {
+            kind = heap_.old_.compactions.load() != compactions ? "young+full+compact" : "young+full";
+        } else if (!was_marking && gc_marking_active) {
+            kind = "young+initial-mark";
+        }
+        size_t allocated = heap_.total_allocated();
+        constexpr double MB = 1024.0 * 1024.0;
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "gc %zu @%.3fs %s: pause %.3fms, %.1fMB -> %.1fMB, promoted %.1fMB, old %.1fMB/%.1fMB, "
+                 "los %.1fMB, eden %.1fMB, allocated %.1fMB since last",
+                 heap_.young_.collections.load(), std::chrono::duration<double>(end - started_).count(), kind,
+                 pause_us / 1000.0, used_before / MB, used_after / MB, g_promoted_bytes / MB,
+                 heap_.old_used() / MB, heap_.old_gc_trigger() / MB, heap_.large_object_bytes() / MB,
+                 heap_.eden_size() / MB, (allocated - allocated_at_last_gc_) / MB);
+        allocated_at_last_gc_ = allocated;
+        std::cerr << line << std::endl;
+    }
+
+    run_pending_finalizers();
+    t_collecting = false;
+}
+
+void GarbageCollector::request_gc(bool full) {
+    collect(full, heap_.young_.collections.load());
+}
+
+template <typename Precise, typename Conservative>
+void GarbageCollector::visit_refs(ObjectHeader* header, Precise&& precise, Conservative&& conservative) {
+    const TypeInfo* info = type_registry_.get_type(header->type_id);
+    void* payload = header->get_object_start();
+    if (!info || info->scan_conservatively) {
+        // Unknown layouts are scanned conservatively too
+        uintptr_t* words = static_cast<uintptr_t*>(payload);
+        for (size_t i = 0; i < header->size / sizeof(uintptr_t); ++i) {
+            conservative(words[i]);
+        }
+        return;
+    }
+    iterate_refs(payload, info, precise);
+}
+
+template <typename Precise, typename Conservative>
+void GarbageCollector::visit_card_refs(size_t card, Precise&& precise, Conservative&& conservative) {
+    uint8_t* low = heap_.card_start(card);
+    uint8_t* high = low + GCConfig::CARD_SIZE;
+    auto on_card = [&](const void* slot) { return slot >= low && slot < high; };
+    auto visit = [&](ObjectHeader* header) {
+        const TypeInfo* info = type_registry_.get_type(header->type_id);
+        if (!info || info->scan_conservatively) {
+            uintptr_t* words = static_cast<uintptr_t*>(header->get_object_start());
+            uintptr_t* end = words + header->size / sizeof(uintptr_t);
+            for (uintptr_t* word = std::max(words, reinterpret_cast<uintptr_t*>(low));
+                 word < end && on_card(word); ++word) {
+                conservative(word);
+            }
+        } else {
+            iterate_refs(header->get_object_start(), info, [&](void** slot) {
+                if (on_card(slot)) precise(slot);
+            });
+        }
+    };
+
+    // A large object's card belongs to it alone
+    if (heap_.in_large_object_space(low)) {
+        if (ObjectHeader* header = heap_.large_object_at(low)) visit(header);
+        return;
+    }
+
+    // Objects are parseable from the one the card starts in
+    high = std::min(high, heap_.old_.current);
+    uint8_t* scan = reinterpret_cast<uint8_t*>(heap_.old_object_at_or_before(low));
+    while (scan < high) {
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+        scan += header->total_size();
+        if (heap_.is_live_old(header)) visit(header);
+    }
+}
+
+void GarbageCollector::mark_object(ObjectHeader* header, bool pin) {
+    if (pin) header->flags |= ObjectHeader::PINNED;
+    if (!(header->flags & ObjectHeader::MARKED)) {
+        header->flags |= ObjectHeader::MARKED;
+        if (header->flags & ObjectHeader::IN_OLD_GEN) {
+            g_marked_old_bytes += header->total_size();
+            // Traced by the concurrent marker, across pauses
+            if (gc_marking_active) {
+                g_concurrent_stack.push(header);
+                return;
+            }
+        }
+        g_mark_stack.push(header);
+    }
+}
+
+void GarbageCollector::mark_conservative(uintptr_t word, MarkScope scope) {
+    void* ptr = reinterpret_cast<void*>(word);
+    if (!in_scope(ptr, scope)) return;
+    ObjectHeader* header = heap_.find_object(ptr);
+    if (header) mark_object(header, true);
+}
+
+void GarbageCollector::scan_range_conservatively(uintptr_t from, uintptr_t to, MarkScope scope,
+                                                 void*** skip, size_t skip_count) {
+    // skip is sorted - precise slots handled elsewhere
+    size_t next_skip = 0;
+    from = (from + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+    for (uintptr_t addr = from; addr + sizeof(uintptr_t) <= to; addr += sizeof(uintptr_t)) {
+        while (next_skip < skip_count && reinterpret_cast<uintptr_t>(skip[next_skip]) < addr) next_skip++;
+        if (next_skip < skip_count && reinterpret_cast<uintptr_t>(skip[next_skip]) == addr) continue;
+        mark_conservative(*reinterpret_cast<uintptr_t*>(addr), scope);
+    }
+}
+
+void GarbageCollector::register_stack_maps(const void* code_base,
+                                           const std::vector<std::pair<size_t, std::vector<int32_t>>>& maps) {
+    if (maps.empty()) return;
+    std::lock_guard<std::mutex> lock(restart_ranges_mutex_);
+
+    // Merge with the installed maps, sorted by return address
+    std::vector<std::pair<uintptr_t, std::vector<int32_t>>> entries;
+    if (const StackMaps* current = stack_maps_.load(std::memory_order_acquire)) {
+        for (size_t i = 0; i < current->return_addresses.size(); ++i) {
+            entries.push_back({current->return_addresses[i],
+                               std::vector<int32_t>(current->slots.begin() + current->slots_begin[i],
+                                                    current->slots.begin() + current->slots_begin[i + 1])});
+        }
+    }
+    uintptr_t base = reinterpret_cast<uintptr_t>(code_base);
+    for (const auto& map : maps) entries.push_back({base + map.first, map.second});
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto* next = new StackMaps();
+    for (const auto& entry : entries) {
+        next->return_addresses.push_back(entry.first);
+        next->slots_begin.push_back(static_cast<uint32_t>(next->slots.size()));
+        next->slots.insert(next->slots.end(), entry.second.begin(), entry.second.end());
+    }
+    next->slots_begin.push_back(static_cast<uint32_t>(next->slots.size()));
+    // Like the restart ranges, the previous table is never freed
+    stack_maps_.store(next, std::memory_order_release);
+}
+
+void GarbageCollector::register_code_symbols(const void* code_base, size_t code_size,
+                                             const std::vector<std::pair<size_t, std::string>>& functions) {
+    if (!code_size) return;
+    std::lock_guard<std::mutex> lock(restart_ranges_mutex_);
+
+    auto* next = new CodeSymbols();
+    std::vector<std::pair<uintptr_t, std::string>> entries;
+    if (const CodeSymbols* current = code_symbols_.load(std::memory_order_acquire)) {
+        next->code = current->code;
+        for (size_t i = 0; i < current->starts.size(); ++i) entries.push_back({current->starts[i], current->names[i]});
+    }
+    uintptr_t base = reinterpret_cast<uintptr_t>(code_base);
+    next->code.push_back({base, base + code_size});
+    std::sort(next->code.begin(), next->code.end(),
+              [](const CodeRange& a, const CodeRange& b) { return a.start < b.start; });
+    for (const auto& function : functions) entries.push_back({base + function.first, function.second});
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto& entry : entries) {
+        next->starts.push_back(entry.first);
+        next->names.push_back(std::move(entry.second));
+    }
+    // Like the stack maps, the previous table is never freed
+    code_symbols_.store(next, std::memory_order_release);
+}
+
+void GarbageCollector::collect_frame_slots(uintptr_t rbp, uintptr_t low, uintptr_t high) {
+    const StackMaps* maps = stack_maps_.load(std::memory_order_acquire);
+    if (!maps) return;
+
+    // Each frame-pointer frame holds [saved RBP][return address]. When the
+    // return address is a JIT call site, the saved RBP is the frame of the
+    // JIT function that made the call
+    while (rbp >= low && rbp + 2 * sizeof(uintptr_t) <= high && (rbp & (sizeof(uintptr_t) - 1)) == 0) {
+        uintptr_t caller_rbp = reinterpret_cast<uintptr_t*>(rbp)[0];
+        uintptr_t return_address = reinterpret_cast<uintptr_t*>(rbp)[1];
+        if (caller_rbp <= rbp || caller_rbp >= high) break;
+
+        auto it = std::lower_bound(maps->return_addresses.begin(), maps->return_addresses.end(), return_address);
+        if (it != maps->return_addresses.end() && *it == return_address) {
+            size_t entry = it - maps->return_addresses.begin();
+            for (uint32_t i = maps->slots_begin[entry]; i < maps->slots_begin[entry + 1]; ++i) {
+                uintptr_t slot = caller_rbp + maps->slots[i];
+                // Only slots above the callee's frame belong to the caller
+                if (slot >= rbp + 2 * sizeof(uintptr_t) && slot < caller_rbp) {
+                    g_frame_slots.push(reinterpret_cast<void**>(slot));
+                }
+            }
+        }
+        rbp = caller_rbp;
+    }
+}
+
+void GarbageCollector::mark_precise_slot(void** slot, MarkScope scope) {
+    void* ptr = *slot;
+    if (!ptr || !in_scope(ptr, scope)) return;
+    ObjectHeader* header = heap_.find_object(ptr);
+    // An interior pointer cannot be updated - keep its target in place
+    if (header) mark_object(header, header->get_object_start() != ptr);
+}
+
+void GarbageCollector::mark_roots(MarkScope scope) {
+    g_frame_slots.clear();
+
+    // Mutator stacks and registers
+    for (MutatorThread* thread : threads_) {
+        uintptr_t sp;
+        uintptr_t rbp;
+        if (thread == t_mutator) {
+            __builtin_unwind_init();
+            asm volatile("mov %%rsp, %0" : "=r"(sp));
+            rbp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+        } else {
+            sp = thread->stopped_sp;
+            rbp = thread->registers[SAVED_RBP];
+            for (uintptr_t reg : thread->registers) mark_conservative(reg, scope);
+        }
+        if (sp < thread->stack_low || sp >= thread->stack_high) sp = thread->stack_low;
+
+        size_t first = g_frame_slots.size();
+        collect_frame_slots(rbp, sp, thread->stack_high);
+        size_t count = g_frame_slots.size() - first;
+        void*** slots = count ? &g_frame_slots[first] : nullptr;
+        std::sort(slots, slots + count);
+        scan_range_conservatively(sp, thread->stack_high, scope, slots, count);
+    }
+    for (size_t i = 0; i < g_frame_slots.size(); ++i) {
+        mark_precise_slot(g_frame_slots[i], scope);
+    }
+
+    // Objects retained by runtime C++ state
+    for (const auto& entry : roots_.pinned) {
+        mark_conservative(reinterpret_cast<uintptr_t>(entry.first), scope);
+    }
+
+    // Registered slots - these may be updated, so their targets can move
+    for (void** slot : roots_.stack_roots) mark_precise_slot(slot, scope);
+    for (void** slot : roots_.global_roots) mark_precise_slot(slot, scope);
+}
+
+void GarbageCollector::process_mark_stack(MarkScope scope, size_t budget) {
+    auto precise = [&](void** slot) {
+        void* ptr = *slot;
+        if (!in_scope(ptr, scope)) return;
+        ObjectHeader* header = heap_.find_object(ptr);
+        if (header) mark_object(header, header->get_object_start() != ptr);
+    };
+    auto conservative = [&](uintptr_t word) { mark_conservative(word, scope); };
+    GCBuffer<ObjectHeader*>& stack = scope == MarkScope::OLD ? g_concurrent_stack : g_mark_stack;
+    for (; budget && !stack.empty(); --budget) {
+        visit_refs(stack.pop(), precise, conservative);
+    }
+}
+
+void GarbageCollector::queue_unreachable_finalizers(MarkScope scope) {
+    // Unreachable objects with finalizers survive this cycle so the
+    // finalizer can still read them
+    auto queue = [&](ObjectHeader* header) {
+        if ((header->flags & (ObjectHeader::HAS_FINALIZER | ObjectHeader::MARKED)) == ObjectHeader::HAS_FINALIZER &&
+            header->type_id != TYPE_FILLER) {
+            g_finalize_queue.push(header);
+            mark_object(header, false);
+            return true;
+        }
+        return false;
+    };
+    if (scope == MarkScope::YOUNG) {
+        heap_.for_each_young_object(queue);
+    } else {
+        // Old ones come from a list rather than a heap walk, which would make
+        // a remark pause grow with the old generation. Queued objects leave it
+        size_t kept = 0;
+        for (size_t i = 0; i < g_old_finalizable.size(); ++i) {
+            ObjectHeader* header = g_old_finalizable[i];
+            if (!queue(header)) g_old_finalizable[kept++] = header;
+        }
+        g_old_finalizable.truncate(kept);
+    }
+    process_mark_stack(scope);
+}
+
+void GarbageCollector::perform_young_gc() {
+    current_phase_ = Phase::MARKING;
+    heap_.rebuild_young_start_bits();
+
+    // Old-to-young references, from dirty cards - every old object counts as live
+    auto precise = [&](void** slot) {
+        void* ptr = *slot;
+        if (!heap_.in_young(ptr)) return;
+        ObjectHeader* header = heap_.find_object(ptr);
+        if (header) mark_object(header, header->get_object_start() != ptr);
+    };
+    auto conservative = [&](uintptr_t* word) { mark_conservative(*word, MarkScope::YOUNG); };
+    heap_.for_each_dirty_old_card([&](size_t card) { visit_card_refs(card, precise, conservative); });
+
+    mark_roots(MarkScope::YOUNG);
+    process_mark_stack(MarkScope::YOUNG);
+    trace_ephemerons(MarkScope::YOUNG);
+    clear_weak_references(MarkScope::YOUNG);
+    judge_allocation_samples(false);
+    queue_unreachable_finalizers(MarkScope::YOUNG);
+    sweep_weak_containers(MarkScope::YOUNG);
+    sweep_profile_samples(MarkScope::YOUNG, false);
+
+    current_phase_ = Phase::RELOCATING;
+    copy_young_survivors();
+
+    current_phase_ = Phase::UPDATING_REFS;
+    update_references();
+    forward_weak_references(MarkScope::YOUNG);
+    forward_profile_samples(MarkScope::YOUNG);
+
+    // Evacuated pages are free again; kept and to-space pages are survivors.
+    // Private pages are gone either way - their survivors are shared now
+    auto& young = heap_.young_;
+    for (size_t i = 0; i < young.page_count; ++i) {
+        gc_young_page_owner[i] = 0;
+        if (young.pages[i] == GenerationalHeap::PageKind::TO_SPACE) {
+            young.pages[i] = GenerationalHeap::PageKind::SURVIVOR;
+        } else if (young.pages[i] != GenerationalHeap::PageKind::FREE) {
+            young.pages[i] = GenerationalHeap::PageKind::FREE;
+            young.page_top[i] = heap_.page_start(i);
+        }
+    }
+    young.eden_page = young.page_count;
+    young.eden_pages_used = 0;
+    young.private_pages = 0;
+    young.collections.fetch_add(1);
+    current_phase_ = Phase::IDLE;
+}
+
+// State of the page receiving young survivors during copy_young_survivors()
+static size_t g_to_page;
+
+void* GarbageCollector::copy_object(ObjectHeader* header, bool to_old_gen) {
+    size_t total = header->total_size();
+    auto& young = heap_.young_;
+    ObjectHeader* copy = nullptr;
+
+    if (!to_old_gen) {
+        if (g_to_page == young.page_count ||
+            static_cast<size_t>(heap_.page_start(g_to_page) + GCConfig::YOUNG_PAGE_SIZE -
+                                young.page_top[g_to_page]) < total) {
+            g_to_page = heap_.take_free_page(GenerationalHeap::PageKind::TO_SPACE);
+        }
+        if (g_to_page != young.page_count) {
+            copy = reinterpret_cast<ObjectHeader*>(young.page_top[g_to_page]);
+            young.page_top[g_to_page] += total;
+        }
+    }
+    if (!copy) {
+        // Promotion - or survivor space overflowed
+        copy = heap_.allocate_old(total);
+        if (!copy) {
+            std::cerr << "ERROR: GoTS heap exhausted while promoting young objects" << std::endl;
+            std::abort();
+        }
+        to_old_gen = true;
+        g_promoted_bytes += total;
+    }
+
+    memcpy(copy, header, total);
+    copy->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+    if (to_old_gen) {
+        // Its references are still young until update_references() runs
+        heap_.dirty_cards(copy, total);
+        copy->flags |= ObjectHeader::IN_OLD_GEN;
+        if (copy->flags & ObjectHeader::HAS_FINALIZER) g_old_finalizable.push(copy);
+        // Promoted black: whatever it references was reachable when marking
+        // started, or was allocated black since
+        if (gc_marking_active) copy->flags |= ObjectHeader::MARKED;
+    }
+    if (copy->age < 255) copy->age++;
+    copy->forward_ptr = nullptr;
+
+    header->forward_ptr = copy->get_object_start();
+    return header->forward_ptr;
+}
+
+void GarbageCollector::copy_young_survivors() {
+    auto& young = heap_.young_;
+    g_to_page = young.page_count;
+    g_promoted_bytes = 0;
+
+    for (size_t i = 0; i < young.page_count; ++i) {
+        if (young.pages[i] != GenerationalHeap::PageKind::EDEN &&
+            young.pages[i] != GenerationalHeap::PageKind::SURVIVOR &&
+            young.pages[i] != GenerationalHeap::PageKind::PRIVATE) continue;
+
+        uint8_t* begin = heap_.page_start(i);
+        uint8_t* top = young.page_top[i];
+        bool pinned = false;
+        for (uint8_t* scan = begin; scan < top && !pinned; ) {
+            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+            pinned = header->flags & ObjectHeader::PINNED;
+            scan += header->total_size();
+        }
+
+        if (!pinned) {
+            for (uint8_t* scan = begin; scan < top; ) {
+                ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+                scan += header->total_size();
+                if (header->flags & ObjectHeader::MARKED) {
+                    copy_object(header, header->age + 1u >= GCConfig::TENURING_THRESHOLD);
+                }
+            }
+            continue;
+        }
+
+        // Something on a stack or in an untyped slot points into this page:
+        // keep it where it is and turn the dead objects into filler
+        uint8_t* dead_start = nullptr;
+        for (uint8_t* scan = begin; scan < top; ) {
+            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+            scan += header->total_size();
+            if (header->flags & ObjectHeader::MARKED) {
+                if (dead_start) heap_.make_filler(dead_start, reinterpret_cast<uint8_t*>(header) - dead_start);
+                dead_start = nullptr;
+                header->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+                if (header->age < 255) header->age++;
+            } else if (!dead_start) {
+                dead_start = reinterpret_cast<uint8_t*>(header);
+            }
+        }
+        if (dead_start) heap_.make_filler(dead_start, top - dead_start);
+        young.pages[i] = GenerationalHeap::PageKind::TO_SPACE;
+    }
+}
+
+void GarbageCollector::update_references() {
+    auto forward = [&](void** slot) {
+        void* ptr = *slot;
+        if (!ptr || !heap_.in_young(ptr)) return;
+        ObjectHeader* header = heap_.find_object(ptr);
+        if (header && header->forward_ptr && header->get_object_start() == ptr) {
+            *slot = header->forward_ptr;
+        }
+    };
+    auto ignore = [](uintptr_t) {};
+
+    for (void** slot : roots_.stack_roots) forward(slot);
+    for (void** slot : roots_.global_roots) forward(slot);
+    for (size_t i = 0; i < g_frame_slots.size(); ++i) forward(g_frame_slots[i]);
+
+    // Old objects on dirty cards - including everything just promoted. A
+    // card stays dirty only while something on it still points into the
+    // young generation
+    heap_.for_each_dirty_old_card([&](size_t card) {
+        bool young_refs = false;
+        visit_card_refs(card,
+            [&](void** slot) { forward(slot); young_refs |= heap_.in_young(*slot); },
+            [&](uintptr_t* word) { young_refs |= heap_.in_young(reinterpret_cast<void*>(*word)); });
+        if (!young_refs) heap_.card_table_[card] = 0;
+    });
+
+    // Survivor copies and pages kept in place
+    auto& young = heap_.young_;
+    for (size_t i = 0; i < young.page_count; ++i) {
+        if (young.pages[i] != GenerationalHeap::PageKind::TO_SPACE) continue;
+        for (uint8_t* scan = heap_.page_start(i); scan < young.page_top[i]; ) {
+            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+            scan += header->total_size();
+            if (header->type_id != TYPE_FILLER) visit_refs(header, forward, ignore);
+        }
+    }
+
+    for (size_t i = 0; i < g_finalize_queue.size(); ++i) {
+        ObjectHeader* header = g_finalize_queue[i];
+        if (header->forward_ptr) g_finalize_queue[i] = ObjectHeader::from_object(header->forward_ptr);
+    }
+}
+
+void GarbageCollector::perform_old_gc() {
+    current_phase_ = Phase::MARKING;
+    // Mark bits left from the last cycle must be gone before marking again
+    abandon_concurrent_mark();
+    heap_.finish_old_sweep();
+    heap_.rebuild_young_start_bits();
+    g_marked_old_bytes = 0;
+    mark_roots(MarkScope::FULL);
+    process_mark_stack(MarkScope::FULL);
+    trace_ephemerons(MarkScope::FULL);
+    clear_weak_references(MarkScope::FULL);
+    queue_unreachable_finalizers(MarkScope::FULL);
+    sweep_weak_containers(MarkScope::FULL);
+    sweep_profile_samples(MarkScope::FULL, false);
+    heap_.old_.used_bytes = g_marked_old_bytes;
+    heap_.sweep_large_objects();
+
+    if (should_compact_old()) {
+        current_phase_ = Phase::RELOCATING;
+        compact_old_generation();
+    } else {
+        // Dead objects are reclaimed later, by the sweeper or by allocation
+        heap_.start_old_sweep();
+    }
+
+    heap_.for_each_young_object([](ObjectHeader* header) {
+        header->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+    });
+
+    heap_.old_.collections.fetch_add(1);
+    heap_.decommit_unused_memory();
+    heap_.old_.live_bytes = heap_.old_.used_bytes;
+    update_old_trigger();
+    current_phase_ = Phase::IDLE;
+}
+
+void GarbageCollector::perform_full_gc() {
+    perform_young_gc();
+    perform_old_gc();
+}
+
+bool GarbageCollector::should_compact_old() const {
+    if (compaction_requested_.load()) return true;
+    // Free space the last sweep found scattered in pieces
+    return heap_.old_.free_bytes >= GCConfig::COMPACT_MIN_FREE_BYTES &&
+           heap_.old_.fragmentation_percent >= GCConfig::COMPACT_FRAGMENTATION_PERCENT;
+}
+
+void GarbageCollector::compact_old_generation() {
+    // Sliding (LISP2) compaction of the marked old generation. Pinned objects
+    // stay put; everything else slides down, filling the gaps in front of it
+    auto& old = heap_.old_;
+    compaction_requested_.store(false);
+
+    // 1. Forwarding addresses
+    uint8_t* to = old.start;
+    heap_.for_each_old_object([&](ObjectHeader* header) {
+        if (!(header->flags & ObjectHeader::MARKED)) return;
+        uint8_t* at = reinterpret_cast<uint8_t*>(header);
+        if (header->flags & ObjectHeader::PINNED) {
+            header->forward_ptr = nullptr;
+            to = at + header->total_size();
+            return;
+        }
+        header->forward_ptr = to == at ? nullptr : to + sizeof(ObjectHeader);
+        to += header->total_size();
+    });
+
+    // 2. References to moving objects - the start bitmap still describes
+    // the old positions. Conservative references only ever hit pinned objects
+    auto forward = [&](void** slot) {
+        uint8_t* ptr = static_cast<uint8_t*>(*slot);
+        if (ptr < old.start || ptr >= old.current) return;
+        ObjectHeader* header = heap_.find_object(ptr);
+        if (header && (header->flags & ObjectHeader::MARKED) && header->forward_ptr &&
+            header->get_object_start() == ptr) {
+            *slot = header->forward_ptr;
+        }
+    };
+    auto ignore = [](uintptr_t) {};
+    for (void** slot : roots_.stack_roots) forward(slot);
+    for (void** slot : roots_.global_roots) forward(slot);
+    for (size_t i = 0; i < g_frame_slots.size(); ++i) forward(g_frame_slots[i]);
+    heap_.for_each_old_object([&](ObjectHeader* header) {
+        if (header->flags & ObjectHeader::MARKED) visit_refs(header, forward, ignore);
+    });
+    // Already swept - every one left is live
+    heap_.for_each_large_object([&](ObjectHeader* header) { visit_refs(header, forward, ignore); });
+    heap_.for_each_young_object([&](ObjectHeader* header) {
+        if (header->type_id != TYPE_FILLER) visit_refs(header, forward, ignore);
+    });
+    for (size_t i = 0; i < g_finalize_queue.size(); ++i) {
+        ObjectHeader* header = g_finalize_queue[i];
+        if (header->forward_ptr && (header->flags & ObjectHeader::IN_OLD_GEN)) {
+            g_finalize_queue[i] = ObjectHeader::from_object(header->forward_ptr);
+        }
+    }
+    for (size_t i = 0; i < g_old_finalizable.size(); ++i) {
+        ObjectHeader* header = g_old_finalizable[i];
+        if (header->forward_ptr) g_old_finalizable[i] = ObjectHeader::from_object(header->forward_ptr);
+    }
+    forward_weak_references(MarkScope::OLD);
+    forward_profile_samples(MarkScope::OLD);
+
+    // 3. Slide. Objects only move down, so nothing ahead of the scan is
+    // overwritten; gaps left in front of pinned objects become free blocks
+    uint8_t* scan = old.start;
+    uint8_t* limit = old.current;
+    uint8_t* free = old.start;
+    heap_.clear_free_lists();
+    heap_.clear_start_bits(old.start, old.current);
+    while (scan < limit) {
+        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+        size_t total = header->total_size();
+        scan += total;
+        if (!(header->flags & ObjectHeader::MARKED)) continue;
+
+        uint8_t* dest = reinterpret_cast<uint8_t*>(header);
+        if (header->forward_ptr) {
+            dest = static_cast<uint8_t*>(header->forward_ptr) - sizeof(ObjectHeader);
+            memmove(dest, header, total);
+        } else if (dest > free) {
+            heap_.push_free_block(free, dest - free);
+        }
+        ObjectHeader* moved = reinterpret_cast<ObjectHeader*>(dest);
+        moved->forward_ptr = nullptr;
+        moved->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+        heap_.set_start_bit(dest);
+        free = dest + total;
+    }
+
+    old.current = free;
+    old.sweep_cursor = old.sweep_limit = free;
+    rebuild_old_cards(limit);
+    last_decommit_size_ = limit - free;
+    heap_.update_old_fragmentation();
+    old.compactions.fetch_add(1);
+}
+
+void GarbageCollector::rebuild_old_cards(const uint8_t* previous_current) {
+    // Objects moved away from their cards - dirty the cards of those that
+    // reference young objects now
+    auto& old = heap_.old_;
+    size_t first = heap_.card_index(old.start);
+    memset(heap_.card_table_ + first, 0, heap_.card_index(previous_current + GCConfig::CARD_SIZE - 1) - first);
+    heap_.for_each_old_object([&](ObjectHeader* header) {
+        if (header->type_id == TYPE_FILLER) return;
+        bool young_refs = false;
+        visit_refs(header, [&](void** slot) { young_refs |= heap_.in_young(*slot); },
+                   [&](uintptr_t word) { young_refs |= heap_.in_young(reinterpret_cast<void*>(word)); });
+        if (young_refs) heap_.dirty_cards(header, header->total_size());
+    });
+}
+
+void GarbageCollector::decommit_old_generation_tail() {
+    // Finishing the sweep trims trailing free space off the frontier. A
+    // mutator must not be stopped for GC while it holds heap_mutex_
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
+        uint8_t* before = heap_.old_.current;
+        heap_.finish_old_sweep();
+        last_decommit_size_ = before - heap_.old_.current;
+        heap_.decommit_unused_memory();
+    }
+    tlab.leave_heap();
+}
+
+void GarbageCollector::wake_worker() {
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    if (!worker_.joinable()) worker_ = std::thread([this]() { worker_loop(); });
+    worker_wakeup_ = true;
+    worker_cv_.notify_one();
+}
+
+void GarbageCollector::worker_loop() {
+    // Not a mutator: it never allocates. It marks under mark_mutex_ and
+    // sweeps under heap_mutex_, and a collection holds both for its pause
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(worker_mutex_);
+            auto woken = [this]() { return worker_wakeup_ || worker_stop_; };
+            if (gc_marking_active) {
+                // Ran dry - keep draining barrier buffers until the remark
+                worker_cv_.wait_for(lock, std::chrono::milliseconds(1), woken);
+            } else {
+                worker_cv_.wait(lock, woken);
+            }
+            if (worker_stop_) return;
+            worker_wakeup_ = false;
+        }
+        while (concurrent_mark_step()) {}
+
+        bool more = true;
+        while (more) {
+            std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
+            more = heap_.sweep_old_chunk();
+        }
+    }
+}
+
+// ============================================================================
+// CONCURRENT MARKING
+// ============================================================================
+
+void GarbageCollector::mark_snapshot_roots() {
+    // Old objects referenced from the roots or from young objects
+    mark_roots(MarkScope::OLD);
+    auto precise = [&](void** slot) { mark_precise_slot(slot, MarkScope::OLD); };
+    auto conservative = [&](uintptr_t word) { mark_conservative(word, MarkScope::OLD); };
+    heap_.for_each_young_object([&](ObjectHeader* header) {
+        if (header->type_id != TYPE_FILLER) visit_refs(header, precise, conservative);
+    });
+}
+
+void GarbageCollector::start_concurrent_mark() {
+    // Initial mark - world stopped, right after a young collection. The last
+    // sweep has finished, so no old object is marked
+    g_marked_old_bytes = 0;
+    heap_.old_.allocated_while_marking = 0;
+    g_concurrent_stack.clear();
+    {
+        // Left by threads that were not stopped when the last cycle ended
+        std::lock_guard<std::mutex> lock(satb_mutex_);
+        g_satb_queue.clear();
+    }
+    mark_done_ = false;
+    gc_marking_active = 1;
+    mark_snapshot_roots();
+}
+
+void GarbageCollector::finish_concurrent_mark() {
+    // Remark - world stopped, right after a young collection. Runtime C++
+    // stores do not all go through the barrier, so roots and young objects
+    // are scanned again as well
+    drain_satb_buffers(true);
+    mark_snapshot_roots();
+    process_mark_stack(MarkScope::OLD);
+    trace_ephemerons(MarkScope::OLD);
+    clear_weak_references(MarkScope::OLD);
+    queue_unreachable_finalizers(MarkScope::OLD);
+    sweep_weak_containers(MarkScope::OLD);
+    sweep_profile_samples(MarkScope::OLD, false);
+    gc_marking_active = 0;
+
+    // Objects allocated black count as live until the next cycle
+    auto& old = heap_.old_;
+    old.used_bytes = g_marked_old_bytes + old.allocated_while_marking;
+    heap_.sweep_large_objects();
+    heap_.start_old_sweep();
+    old.collections.fetch_add(1);
+    concurrent_marks_.fetch_add(1);
+    heap_.decommit_unused_memory();
+    old.live_bytes = old.used_bytes;
+    update_old_trigger();
+}
+
+void GarbageCollector::abandon_concurrent_mark() {
+    // A stop-the-world old collection starts from clear mark bits
+    if (!gc_marking_active) return;
+    drain_satb_buffers(true);
+    g_concurrent_stack.clear();
+    gc_marking_active = 0;
+    auto unmark = [](ObjectHeader* header) {
+        header->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED);
+    };
+    heap_.for_each_old_object(unmark);
+    heap_.for_each_large_object(unmark);
+}
+
+void GarbageCollector::drain_satb_buffers(bool include_threads) {
+    // Partly filled thread buffers can only be read while the world is stopped
+    if (include_threads) {
+        for (MutatorThread* thread : threads_) {
+            SATBBuffer* buffer = thread->satb;
+            for (size_t i = 0; i < buffer->count; ++i) {
+                mark_conservative(reinterpret_cast<uintptr_t>(buffer->entries[i]), MarkScope::OLD);
+            }
+            buffer->count = 0;
+        }
+    }
+    std::lock_guard<std::mutex> lock(satb_mutex_);
+    for (size_t i = 0; i < g_satb_queue.size(); ++i) {
+        mark_conservative(reinterpret_cast<uintptr_t>(g_satb_queue[i]), MarkScope::OLD);
+    }
+    g_satb_queue.clear();
+}
+
+bool GarbageCollector::concurrent_mark_step() {
+    // One batch on the worker, with the mutators running. Old objects do not
+    // move outside a pause, and no sweep runs while marking
+    std::lock_guard<std::mutex> lock(mark_mutex_);
+    if (!gc_marking_active) return false;
+    drain_satb_buffers(false);
+    process_mark_stack(MarkScope::OLD, GCConfig::CONCURRENT_MARK_BATCH);
+    mark_done_ = g_concurrent_stack.empty();
+    return !mark_done_;
+}
+
+void GarbageCollector::satb_enqueue(void* old_value) {
+    // Young objects are scanned at initial mark and again at remark
+    if (!old_value || !in_scope(old_value, MarkScope::OLD)) return;
+    if (!t_mutator) {
+        std::lock_guard<std::mutex> lock(satb_mutex_);
+        if (gc_marking_active) g_satb_queue.push(old_value);
+        return;
+    }
+
+    // Not stopped halfway - a remark reads the buffer of every stopped thread
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    if (gc_marking_active) {
+        SATBBuffer& buffer = t_satb;
+        buffer.entries[buffer.count++] = old_value;
+        if (buffer.count == GCConfig::SATB_BUFFER_SIZE) {
+            std::lock_guard<std::mutex> lock(satb_mutex_);
+            for (size_t i = 0; i < buffer.count; ++i) g_satb_queue.push(buffer.entries[i]);
+            buffer.count = 0;
+        }
+    }
+    tlab.leave_heap();
+}
+
+void GarbageCollector::run_pending_finalizers() {
+    // Still under collect_mutex_, so nothing moves while finalizers run
+    while (!g_finalize_queue.empty()) {
+        ObjectHeader* header = g_finalize_queue.pop();
+        // Queued by both halves of a full collection
+        if (!(header->flags & ObjectHeader::HAS_FINALIZER)) continue;
+        header->flags &= ~ObjectHeader::HAS_FINALIZER;
+        const TypeInfo* info = type_registry_.get_type(header->type_id);
+        if (info && info->finalizer) info->finalizer(header->get_object_start());
+    }
+
+    // Held values cannot move before the next collection, which waits for
+    // this loop - the runner retains the ones it keeps longer
+    while (!g_cleanup_queue.empty()) {
+        PendingCleanup cleanup = g_cleanup_queue.pop();
+        if (cleanup_runner_) {
+            cleanup_runner_(cleanup.callback, cleanup.held);
+        } else {
+            reinterpret_cast<void (*)(void*)>(cleanup.callback)(cleanup.held);
+        }
+    }
+}
+
+void GarbageCollector::add_stack_root(void** root) {
+    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
+    roots_.stack_roots.push_back(root);
+}
+
 void GarbageCollector::remove_stack_root(void** root) {
     std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-    auto it = std::find(roots_.stack_roots.begin(), roots_.stack_roots.end(), root);
-    if (it != roots_.stack_roots.end()) {
-        roots_.stack_roots.erase(it);
+    auto& roots = roots_.stack_roots;
+    // Scoped roots are removed in LIFO order - search from the back
+    auto it = std::find(roots.rbegin(), roots.rend(), root);
+    if (it != roots.rend()) roots.erase(std::next(it).base());
+}
+
+void GarbageCollector::add_global_root(void** root) {
+    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
+    roots_.global_roots.push_back(root);
+}
+
+void GarbageCollector::remove_global_root(void** root) {
+    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
+    auto& roots = roots_.global_roots;
+    roots.erase(std::remove(roots.begin(), roots.end(), root), roots.end());
+}
+
+void GarbageCollector::retain(void* obj) {
+    if (!obj || !heap_.contains(obj)) return;
+    // Retained objects are handed to other threads
+    publish(obj);
+    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
+    roots_.pinned[obj]++;
+}
+
+void GarbageCollector::release(void* obj) {
+    if (!obj || !heap_.contains(obj)) return;
+    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
+    auto it = roots_.pinned.find(obj);
+    if (it != roots_.pinned.end() && --it->second == 0) roots_.pinned.erase(it);
+}
+
+// ============================================================================
+// GOROUTINE-PRIVATE HEAPS
+// ============================================================================
+
+void GarbageCollector::attach_private_heap() {
+    register_current_thread();
+    TLAB& tlab = GenerationalHeap::tlab_;
+    if (!t_mutator || tlab.private_owner_) return;
+
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
+        auto& young = heap_.young_;
+        for (size_t owner = 1; owner < 256; ++owner) {
+            if (young.owner_used[owner]) continue;
+            young.owner_used[owner] = true;
+            // What was allocated before belongs to the shared heap
+            heap_.retire_tlab(tlab);
+            tlab.private_owner_ = static_cast<uint8_t>(owner);
+            tlab.private_page_ = SIZE_MAX;
+            break;
+        }
+        // All tags in use - this goroutine allocates from shared eden
+    }
+    tlab.leave_heap();
+}
+
+void GarbageCollector::release_private_heap() {
+    TLAB& tlab = GenerationalHeap::tlab_;
+    uint8_t owner = tlab.private_owner_;
+    if (!owner) return;
+
+    size_t freed = 0;
+    // Taken before entering the heap - a collector holds it while it stops
+    // the world
+    std::lock_guard<std::mutex> roots_lock(roots_.roots_mutex);
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
+        auto& young = heap_.young_;
+        heap_.retire_tlab(tlab);
+        tlab.private_page_ = SIZE_MAX;
+
+        // Stored into registered root slots without a barrier
+        auto keep = [&](void* ptr) {
+            if (gc_private_owner(ptr) == owner) publish_private_page(heap_.page_index(ptr), owner);
+        };
+        for (void** slot : roots_.global_roots) keep(*slot);
+        for (void** slot : roots_.stack_roots) keep(*slot);
+        for (const auto& entry : roots_.pinned) keep(entry.first);
+
+        // Finalizers run from young collections, which need the objects
+        for (size_t i = 0; i < young.page_count; ++i) {
+            if (young.pages[i] != GenerationalHeap::PageKind::PRIVATE || gc_young_page_owner[i] != owner) continue;
+            for (uint8_t* scan = heap_.page_start(i); scan < young.page_top[i]; ) {
+                ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+                scan += header->total_size();
+                if (header->flags & ObjectHeader::HAS_FINALIZER) {
+                    publish_private_page(i, owner);
+                    break;
+                }
+            }
+        }
+
+        // Whatever is still private is unreachable
+        for (size_t i = 0; i < young.page_count; ++i) {
+            if (young.pages[i] != GenerationalHeap::PageKind::PRIVATE || gc_young_page_owner[i] != owner) continue;
+            freed += young.page_top[i] - heap_.page_start(i);
+            young.pages[i] = GenerationalHeap::PageKind::FREE;
+            young.page_top[i] = heap_.page_start(i);
+            gc_young_page_owner[i] = 0;
+            young.private_pages--;
+            young.eden_pages_used--;
+        }
+        young.owner_used[owner] = false;
+        tlab.private_owner_ = 0;
+        judge_allocation_samples(true);
+        sweep_profile_samples(MarkScope::YOUNG, true);
+    }
+    tlab.leave_heap();
+    private_bytes_freed_.fetch_add(freed, std::memory_order_relaxed);
+    total_freed_.fetch_add(freed, std::memory_order_relaxed);
+}
+
+void GarbageCollector::publish(void* obj) {
+    TLAB& tlab = GenerationalHeap::tlab_;
+    uint8_t owner = tlab.private_owner_;
+    // Other threads cannot reach this thread's private objects - for them
+    // there is nothing to publish
+    if (!owner || gc_private_owner(obj) != owner) return;
+
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(heap_.heap_mutex_);
+        publish_private_page(heap_.page_index(obj), owner);
+    }
+    tlab.leave_heap();
+}
+
+void GarbageCollector::publish_private_page(size_t page, uint8_t owner) {
+    auto& young = heap_.young_;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    std::vector<size_t> pending{page};
+    auto reference = [&](const void* ptr) {
+        if (gc_private_owner(ptr) == owner) pending.push_back(heap_.page_index(ptr));
+    };
+
+    while (!pending.empty()) {
+        size_t i = pending.back();
+        pending.pop_back();
+        // Collected since, or already shared
+        if (young.pages[i] != GenerationalHeap::PageKind::PRIVATE || gc_young_page_owner[i] != owner) continue;
+        young.pages[i] = GenerationalHeap::PageKind::EDEN;
+        gc_young_page_owner[i] = 0;
+        young.private_pages--;
+
+        // Allocation moves on to another page, and this one becomes parseable
+        if (tlab.private_page_ == i) {
+            heap_.retire_tlab(tlab);
+            tlab.private_page_ = SIZE_MAX;
+        }
+        for (uint8_t* scan = heap_.page_start(i); scan < young.page_top[i]; ) {
+            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
+            scan += header->total_size();
+            if (header->type_id == TYPE_FILLER) continue;
+            visit_refs(header,
+                [&](void** slot) { reference(*slot); },
+                [&](uintptr_t word) { reference(reinterpret_cast<void*>(word)); });
+        }
+    }
+}
+
+GarbageCollector::Stats GarbageCollector::get_stats() const {
+    Stats stats;
+    stats.young_collections = heap_.young_.collections.load();
+    stats.old_collections = heap_.old_.collections.load();
+    stats.total_pause_time_ms = total_pause_time_ms_.load();
+    stats.max_pause_time_ms = max_pause_time_ms_.load();
+    stats.total_allocated = heap_.total_allocated();
+    stats.total_freed = total_freed_.load();
+    stats.live_objects = live_bytes_.load();
+    stats.old_compactions = heap_.old_.compactions.load();
+    stats.concurrent_marks = concurrent_marks_.load();
+    stats.private_bytes_freed = private_bytes_freed_.load();
+    stats.large_objects = heap_.large_object_count();
+    stats.large_object_bytes = heap_.large_object_bytes();
+    stats.large_object_bytes_released = heap_.large_object_bytes_released();
+
+    stats.pause_count = pauses_.count();
+    stats.pause_p50_us = pauses_.percentile(50);
+    stats.pause_p99_us = pauses_.percentile(99);
+    stats.pause_max_us = pauses_.max();
+    stats.promoted_bytes = promoted_bytes_.load(std::memory_order_relaxed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    stats.alloc_bytes_per_sec = seconds > 0 ? static_cast<size_t>(stats.total_allocated / seconds) : 0;
+    stats.promoted_bytes_per_sec = seconds > 0 ? static_cast<size_t>(stats.promoted_bytes / seconds) : 0;
+    stats.heap_size = heap_.heap_size();
+    stats.heap_used = heap_.young_used() + heap_.old_used();
+    stats.memory_limit = memory_limit();
+    stats.eden_size = heap_.eden_size();
+    stats.old_gc_trigger = heap_.old_gc_trigger();
+    stats.pretenured_sites = pretenured_sites_.load(std::memory_order_relaxed);
+    stats.pretenured_bytes = pretenured_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ============================================================================
+// ALLOCATION-SITE PRETENURING
+// ============================================================================
+
+uint32_t GarbageCollector::new_allocation_site() {
+    uint32_t site = g_next_allocation_site.fetch_add(1, std::memory_order_relaxed);
+    return site < GCConfig::MAX_ALLOCATION_SITES ? site : 0;
+}
+
+void* GarbageCollector::allocate_at_site(size_t size, uint32_t type_id, uint32_t site) {
+    if (!gc_pretenured_sites[site]) return GenerationalHeap::allocate_slow(size, type_id, false, site);
+    pretenured_bytes_.fetch_add(ObjectHeader::align(sizeof(ObjectHeader) + size), std::memory_order_relaxed);
+    return GenerationalHeap::allocate_large_slow(size, type_id, false);
+}
+
+void GarbageCollector::judge_allocation_samples(bool freed_pages_only) {
+    auto& young = heap_.young_;
+    size_t kept = 0;
+    for (size_t i = 0; i < g_allocation_samples.size(); ++i) {
+        AllocationSample sample = g_allocation_samples[i];
+        bool freed = young.pages[heap_.page_index(sample.header)] == GenerationalHeap::PageKind::FREE;
+        if (freed_pages_only && !freed) {
+            g_allocation_samples[kept++] = sample;
+            continue;
+        }
+
+        uint32_t& samples = g_site_samples[sample.site];
+        uint32_t& survivors = g_site_survivors[sample.site];
+        samples++;
+        if (!freed && (sample.header->flags & ObjectHeader::MARKED)) survivors++;
+        if (samples < GCConfig::PRETENURE_MIN_SAMPLES || gc_pretenured_sites[sample.site]) continue;
+
+        if (survivors * 100 >= samples * GCConfig::PRETENURE_SURVIVAL_PERCENT) {
+            gc_pretenured_sites[sample.site] = 1;
+            pretenured_sites_.fetch_add(1, std::memory_order_relaxed);
+        } else if (samples >= 4 * GCConfig::PRETENURE_MIN_SAMPLES) {
+            // Recent behaviour counts most - a site may settle into
+            // allocating long-lived objects later
+            samples /= 2;
+            survivors /= 2;
+        }
+    }
+    g_allocation_samples.truncate(kept);
+}
+
+// ============================================================================
+// HEAP SIZING
+// ============================================================================
+
+size_t GarbageCollector::default_memory_limit() {
+    if (const char* env = getenv("GOTS_MEMLIMIT")) {
+        // Bytes with an optional K, M or G suffix; 0 or "off" for none
+        char* end = nullptr;
+        unsigned long long bytes = strtoull(env, &end, 10);
+        switch (*end) {
+            case 'G': case 'g': bytes <<= 30; break;
+            case 'M': case 'm': bytes <<= 20; break;
+            case 'K': case 'k': bytes <<= 10; break;
+        }
+        return bytes;
+    }
+    // cgroup v2, then v1. "max" - or, in v1, a page-rounded LLONG_MAX - is no limit
+    for (const char* path : {"/sys/fs/cgroup/memory.max", "/sys/fs/cgroup/memory/memory.limit_in_bytes"}) {
+        FILE* file = fopen(path, "r");
+        if (!file) continue;
+        unsigned long long bytes = 0;
+        bool limited = fscanf(file, "%llu", &bytes) == 1 && bytes < (1ULL << 62);
+        fclose(file);
+        // Memory outside the GC heap counts against the cgroup too
+        return limited ? bytes / 100 * GCConfig::CGROUP_LIMIT_PERCENT : 0;
+    }
+    return 0;
+}
+
+size_t GarbageCollector::set_memory_limit(size_t bytes) {
+    return memory_limit_.exchange(bytes);
+}
+
+void GarbageCollector::size_generations(size_t eden_used, size_t survival_percent) {
+    auto& young = heap_.young_;
+    auto now = std::chrono::steady_clock::now();
+    double interval_ms = std::chrono::duration<double, std::milli>(now - last_young_gc_).count();
+    last_young_gc_ = now;
+
+    // As many pages as allocation fills in YOUNG_GC_INTERVAL_MS, approached
+    // halfway each collection so one odd interval does not swing it
+    size_t pages = young.eden_page_limit;
+    if (size_t fixed = fixed_eden_pages_.load(std::memory_order_relaxed)) {
+        pages = fixed;
+    } else if (eden_used && interval_ms > 0) {
+        double filled = static_cast<double>(eden_used) / GCConfig::YOUNG_PAGE_SIZE *
+                        GCConfig::YOUNG_GC_INTERVAL_MS / interval_ms;
+        pages = (pages + static_cast<size_t>(std::min(filled, double(young.page_count)))) / 2;
+    }
+
+    // Eden and the survivor pages are copied into what is left of the young
+    // generation next time - at the survival rate just seen
+    size_t survivor_pages = 0;
+    for (size_t i = 0; i < young.page_count; ++i) {
+        if (young.pages[i] == GenerationalHeap::PageKind::SURVIVOR) survivor_pages++;
+    }
+    size_t fits = young.page_count * 100 / (100 + std::min<size_t>(survival_percent, 100));
+    size_t max_pages = std::min(young.page_count - young.page_count / 4,
+                                fits > survivor_pages ? fits - survivor_pages : 0);
+
+    // Near the memory limit eden takes at most half of the room left
+    size_t limit = memory_limit();
+    if (limit) {
+        size_t used = heap_.old_used() + survivor_pages * GCConfig::YOUNG_PAGE_SIZE;
+        size_t room = limit > used ? (limit - used) / 2 : 0;
+        max_pages = std::min(max_pages, room / GCConfig::YOUNG_PAGE_SIZE);
+    }
+    pages = std::max(GCConfig::MIN_EDEN_PAGES, std::min(pages, max_pages));
+
+    bool shrunk = pages < young.eden_page_limit;
+    young.eden_page_limit = pages;
+    young.private_page_limit = pages * GCConfig::PRIVATE_PAGE_PERCENT / 100;
+    if (shrunk && limit) heap_.decommit_unused_memory();
+}
+
+void GarbageCollector::update_old_trigger() {
+    // Collect once live data doubles; below the memory limit, once the old
+    // generation reaches what eden and the survivors leave of it - but with
+    // some headroom over live data, or it would collect continuously
+    auto& old = heap_.old_;
+    size_t trigger = std::max(GCConfig::OLD_GC_TRIGGER, old.live_bytes * 2);
+    size_t limit = memory_limit();
+    if (limit) {
+        size_t young = heap_.eden_size() + heap_.young_used();
+        size_t room = limit > young ? limit - young : 0;
+        size_t floor = old.live_bytes + std::max(GCConfig::MIN_OLD_HEADROOM, old.live_bytes / 10);
+        trigger = std::min(trigger, std::max(room, floor));
+    }
+    old.gc_trigger = trigger;
+}
+
+// ============================================================================
+// WEAK REFERENCES
+// ============================================================================
+
+static size_t ephemeron_slot(const void* key, uint64_t capacity) {
+    uint64_t hash = (reinterpret_cast<uintptr_t>(key) >> 4) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> 32) & (capacity - 1);
+}
+
+static EphemeronTable::Entry* find_ephemeron(EphemeronTable* table, const void* key) {
+    EphemeronTable::Entry* entries = table->entries();
+    for (size_t slot = ephemeron_slot(key, table->capacity); entries[slot].key;
+         slot = (slot + 1) & (table->capacity - 1)) {
+        if (entries[slot].key == key) return &entries[slot];
+    }
+    return nullptr;
+}
+
+// `key` must be absent, and the table must have room for it
+static void insert_ephemeron(EphemeronTable* table, void* key, void* value) {
+    EphemeronTable::Entry* entries = table->entries();
+    size_t slot = ephemeron_slot(key, table->capacity);
+    while (entries[slot].key && entries[slot].key != DELETED_KEY) slot = (slot + 1) & (table->capacity - 1);
+    if (!entries[slot].key) table->used++;
+    entries[slot] = {key, value};
+    table->live++;
+}
+
+// Reinsert the live entries, dropping tombstones - while the world is stopped
+static void rehash_ephemerons(EphemeronTable* table) {
+    EphemeronTable::Entry* entries = table->entries();
+    g_rehash_entries.clear();
+    for (uint64_t i = 0; i < table->capacity; ++i) {
+        if (entries[i].key && entries[i].key != DELETED_KEY) g_rehash_entries.push(entries[i]);
+    }
+    memset(entries, 0, table->capacity * sizeof(EphemeronTable::Entry));
+    table->used = table->live = 0;
+    for (size_t i = 0; i < g_rehash_entries.size(); ++i) {
+        insert_ephemeron(table, g_rehash_entries[i].key, g_rehash_entries[i].value);
+    }
+}
+
+// Capacity for `live` entries at half load at most
+static uint64_t ephemeron_capacity(uint64_t live) {
+    uint64_t capacity = 8;
+    while (capacity < 2 * live) capacity *= 2;
+    return capacity;
+}
+
+// Initialized and shared - the weak containers never live on private pages
+static void* new_weak_object(size_t size, uint32_t type_id) {
+    void* object = GenerationalHeap::allocate_fast(size, type_id);
+    memset(object, 0, size);
+    GarbageCollector::instance().publish(object);
+    return object;
+}
+
+void GarbageCollector::add_weak_container(void* container) {
+    ObjectHeader* header = ObjectHeader::from_object(container);
+    header->flags |= ObjectHeader::HAS_WEAK_REFS;
+    g_weak_containers.push(header);
+}
+
+// The whole reservation is mapped, so the header in front of any aligned
+// address in it can be read - a stray pointer finds some other type there
+bool GarbageCollector::is_weak_container(void* object, uint16_t type_id) {
+    if (!object || reinterpret_cast<uintptr_t>(object) % GCConfig::OBJECT_ALIGNMENT != 0) return false;
+    ObjectHeader* header = ObjectHeader::from_object(object);
+    if (!heap_.contains(header) || !heap_.contains(object)) return false;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    bool valid = header->type_id == type_id;
+    tlab.leave_heap();
+    return valid;
+}
+
+void* GarbageCollector::new_weak_ref(void* target) {
+    register_current_thread();
+    publish(target);
+    void* ref = new_weak_object(sizeof(void*), TYPE_WEAK_REF);
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        *static_cast<void**>(ref) = target;
+        add_weak_container(ref);
     }
-    
-    // Also remove from thread-local cleanup tracking
-    if (thread_root_cleanup_) {
-        thread_root_cleanup_->remove_root(root);
+    tlab.leave_heap();
+    return ref;
+}
+
+void* GarbageCollector::weak_ref_get(void* ref) {
+    register_current_thread();
+    if (!is_weak_container(ref, TYPE_WEAK_REF)) {
+        std::cerr << "ERROR: Invalid WeakRef" << std::endl;
+        return nullptr;
+    }
+    void* target;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        target = *static_cast<void**>(ref);
     }
+    tlab.leave_heap();
+    // The marker may not have reached it yet - and may never, if the
+    // caller stores it into an object already traced
+    if (target && gc_marking_active) satb_enqueue(target);
+    return target;
 }
 
-void GarbageCollector::add_global_root(void** root) {
-    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-    roots_.global_roots.push_back(root);
+void* GarbageCollector::new_weak_map() {
+    void* map = new_weak_object(sizeof(void*), TYPE_WEAK_MAP);
+    uint64_t capacity = ephemeron_capacity(0);
+    auto* table = static_cast<EphemeronTable*>(
+        new_weak_object(sizeof(EphemeronTable) + capacity * sizeof(EphemeronTable::Entry), TYPE_EPHEMERON_TABLE));
+    table->capacity = capacity;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        *static_cast<void**>(map) = table;
+        gc_card_table_base[reinterpret_cast<uintptr_t>(map) >> GCConfig::CARD_SHIFT] = 1;
+        add_weak_container(table);
+    }
+    tlab.leave_heap();
+    return map;
 }
 
-void GarbageCollector::remove_global_root(void** root) {
-    std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-    auto it = std::find(roots_.global_roots.begin(), roots_.global_roots.end(), root);
-    if (it != roots_.global_roots.end()) {
-        roots_.global_roots.erase(it);
+void* GarbageCollector::weak_map_get(void* map, void* key) {
+    register_current_thread();
+    if (!is_weak_container(map, TYPE_WEAK_MAP)) {
+        std::cerr << "ERROR: Invalid WeakMap" << std::endl;
+        return nullptr;
+    }
+    void* value = nullptr;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        EphemeronTable::Entry* entry = find_ephemeron(*static_cast<EphemeronTable**>(map), key);
+        if (entry) value = entry->value;
     }
+    tlab.leave_heap();
+    if (value && gc_marking_active) satb_enqueue(value);
+    return value;
 }
 
-// GC triggers
-void GarbageCollector::request_gc(bool full) {
-    gc_requested_.store(true);
-    gc_cv_.notify_one();
+bool GarbageCollector::weak_map_has(void* map, void* key) {
+    register_current_thread();
+    if (!is_weak_container(map, TYPE_WEAK_MAP)) {
+        std::cerr << "ERROR: Invalid WeakMap" << std::endl;
+        return false;
+    }
+    bool found;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        found = find_ephemeron(*static_cast<EphemeronTable**>(map), key) != nullptr;
+    }
+    tlab.leave_heap();
+    return found;
 }
 
-void GarbageCollector::perform_old_gc() {
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    wait_for_safepoint();
-    current_phase_.store(Phase::MARKING);
-    mark_roots();
-    process_mark_stack();
-    
-    // Compact memory and decommit unused pages
-    decommit_old_generation_tail();
-    
-    release_safepoint();
-    current_phase_.store(Phase::IDLE);
-    
-    heap_.old_.collections.fetch_add(1);
-    
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto pause_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        end_time - start_time).count();
-    
-    total_pause_time_ms_.fetch_add(pause_time);
-    max_pause_time_ms_.store(std::max(max_pause_time_ms_.load(), static_cast<size_t>(pause_time)));
+void GarbageCollector::weak_map_set(void* map, void* key, void* value) {
+    if (!key || key == DELETED_KEY) {
+        std::cerr << "ERROR: Invalid WeakMap key" << std::endl;
+        return;
+    }
+    register_current_thread();
+    if (!is_weak_container(map, TYPE_WEAK_MAP)) {
+        std::cerr << "ERROR: Invalid WeakMap" << std::endl;
+        return;
+    }
+    publish(key);
+    publish(value);
+
+    TLAB& tlab = GenerationalHeap::tlab_;
+    EphemeronTable* replacement = nullptr;
+    for (;;) {
+        void* old_value = nullptr;
+        uint64_t needed = 0;
+        tlab.enter_heap();
+        {
+            std::lock_guard<std::mutex> lock(weak_mutex_);
+            auto* table = *static_cast<EphemeronTable**>(map);
+            if (EphemeronTable::Entry* entry = find_ephemeron(table, key)) {
+                old_value = entry->value;
+                entry->value = value;
+            } else if ((table->used + 1) * 4 <= table->capacity * 3) {
+                insert_ephemeron(table, key, value);
+            } else if (replacement && replacement->capacity >= ephemeron_capacity(table->live + 1)) {
+                // Grown, or just rehashed if tombstones took the room
+                EphemeronTable::Entry* entries = table->entries();
+                for (uint64_t i = 0; i < table->capacity; ++i) {
+                    if (entries[i].key && entries[i].key != DELETED_KEY) {
+                        insert_ephemeron(replacement, entries[i].key, entries[i].value);
+                    }
+                }
+                insert_ephemeron(replacement, key, value);
+                *static_cast<EphemeronTable**>(map) = replacement;
+                gc_card_table_base[reinterpret_cast<uintptr_t>(map) >> GCConfig::CARD_SHIFT] = 1;
+                add_weak_container(replacement);
+            } else {
+                needed = ephemeron_capacity(table->live + 1);
+            }
+        }
+        tlab.leave_heap();
+        if (!needed) {
+            if (old_value && gc_marking_active) satb_enqueue(old_value);
+            return;
+        }
+        // May collect - the table is sized again once it is installed
+        replacement = static_cast<EphemeronTable*>(
+            new_weak_object(sizeof(EphemeronTable) + needed * sizeof(EphemeronTable::Entry), TYPE_EPHEMERON_TABLE));
+        replacement->capacity = needed;
+    }
 }
 
-void GarbageCollector::perform_full_gc() {
-    wait_for_safepoint();
-    current_phase_.store(Phase::MARKING);
-    mark_roots();
-    process_mark_stack();
-    heap_.young_.eden_current = heap_.young_.eden_start;
-    release_safepoint();
-    current_phase_.store(Phase::IDLE);
+bool GarbageCollector::weak_map_delete(void* map, void* key) {
+    register_current_thread();
+    if (!is_weak_container(map, TYPE_WEAK_MAP)) {
+        std::cerr << "ERROR: Invalid WeakMap" << std::endl;
+        return false;
+    }
+    void* old_value = nullptr;
+    bool found = false;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        auto* table = *static_cast<EphemeronTable**>(map);
+        if (EphemeronTable::Entry* entry = find_ephemeron(table, key)) {
+            old_value = entry->value;
+            *entry = {DELETED_KEY, nullptr};
+            table->live--;
+            found = true;
+        }
+    }
+    tlab.leave_heap();
+    if (old_value && gc_marking_active) satb_enqueue(old_value);
+    return found;
 }
 
-// Statistics
-GarbageCollector::Stats GarbageCollector::get_stats() const {
-    Stats stats;
-    stats.young_collections = heap_.young_.collections.load();
-    stats.old_collections = heap_.old_.collections.load();
-    stats.total_pause_time_ms = total_pause_time_ms_.load();
-    stats.max_pause_time_ms = max_pause_time_ms_.load();
-    stats.total_allocated = heap_.total_allocated();
-    stats.total_freed = 0;
-    stats.live_objects = 0;
-    return stats;
+size_t GarbageCollector::weak_map_size(void* map) {
+    register_current_thread();
+    if (!is_weak_container(map, TYPE_WEAK_MAP)) {
+        std::cerr << "ERROR: Invalid WeakMap" << std::endl;
+        return 0;
+    }
+    size_t live;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        live = (*static_cast<EphemeronTable**>(map))->live;
+    }
+    tlab.leave_heap();
+    return live;
+}
+
+void* GarbageCollector::new_finalization_registry(void* callback) {
+    void* registry = new_weak_object(sizeof(void*), TYPE_FINALIZATION_REGISTRY);
+    constexpr uint64_t capacity = 8;
+    auto* cells = static_cast<FinalizationCells*>(
+        new_weak_object(sizeof(FinalizationCells) + capacity * sizeof(FinalizationCells::Cell), TYPE_FINALIZATION_CELLS));
+    cells->capacity = capacity;
+    cells->callback = callback;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        *static_cast<void**>(registry) = cells;
+        gc_card_table_base[reinterpret_cast<uintptr_t>(registry) >> GCConfig::CARD_SHIFT] = 1;
+        add_weak_container(cells);
+    }
+    tlab.leave_heap();
+    return registry;
 }
 
-// Concurrent marking methods
-void GarbageCollector::start_concurrent_marking() {
-    if (concurrent_marker_) {
-        // Collect roots
-        std::vector<void*> roots;
+void GarbageCollector::finalization_register(void* registry, void* target, void* held, void* token) {
+    if (!target) {
+        std::cerr << "ERROR: Invalid FinalizationRegistry target" << std::endl;
+        return;
+    }
+    register_current_thread();
+    if (!is_weak_container(registry, TYPE_FINALIZATION_REGISTRY)) {
+        std::cerr << "ERROR: Invalid FinalizationRegistry" << std::endl;
+        return;
+    }
+    publish(target);
+    publish(held);
+    publish(token);
+
+    TLAB& tlab = GenerationalHeap::tlab_;
+    FinalizationCells* replacement = nullptr;
+    for (;;) {
+        uint64_t needed = 0;
+        tlab.enter_heap();
         {
-            std::lock_guard<std::mutex> lock(roots_.roots_mutex);
-            for (void** root : roots_.stack_roots) {
-                if (*root) roots.push_back(*root);
+            std::lock_guard<std::mutex> lock(weak_mutex_);
+            auto* cells = *static_cast<FinalizationCells**>(registry);
+            if (cells->count == cells->capacity) {
+                if (replacement && replacement->capacity > cells->count) {
+                    memcpy(replacement->cells(), cells->cells(), cells->count * sizeof(FinalizationCells::Cell));
+                    replacement->count = cells->count;
+                    replacement->callback = cells->callback;
+                    *static_cast<FinalizationCells**>(registry) = replacement;
+                    gc_card_table_base[reinterpret_cast<uintptr_t>(registry) >> GCConfig::CARD_SHIFT] = 1;
+                    add_weak_container(replacement);
+                    cells = replacement;
+                } else {
+                    needed = cells->capacity * 2;
+                }
             }
-            for (void** root : roots_.global_roots) {
-                if (*root) roots.push_back(*root);
+            if (!needed) cells->cells()[cells->count++] = {target, held, token};
+        }
+        tlab.leave_heap();
+        if (!needed) return;
+        replacement = static_cast<FinalizationCells*>(new_weak_object(
+            sizeof(FinalizationCells) + needed * sizeof(FinalizationCells::Cell), TYPE_FINALIZATION_CELLS));
+        replacement->capacity = needed;
+    }
+}
+
+bool GarbageCollector::finalization_unregister(void* registry, void* token) {
+    if (!token) return false;
+    register_current_thread();
+    if (!is_weak_container(registry, TYPE_FINALIZATION_REGISTRY)) {
+        std::cerr << "ERROR: Invalid FinalizationRegistry" << std::endl;
+        return false;
+    }
+    bool found = false;
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    {
+        std::lock_guard<std::mutex> lock(weak_mutex_);
+        auto* cells = *static_cast<FinalizationCells**>(registry);
+        FinalizationCells::Cell* cell = cells->cells();
+        for (uint64_t i = 0; i < cells->count; ) {
+            if (cell[i].token != token) {
+                ++i;
+                continue;
             }
+            cell[i] = cell[--cells->count];
+            cell[cells->count] = {};
+            found = true;
         }
-        
-        concurrent_marker_->push_roots(roots);
-        concurrent_marker_->start_concurrent_marking();
     }
+    tlab.leave_heap();
+    return found;
 }
 
-void GarbageCollector::wait_for_concurrent_marking() {
-    if (concurrent_marker_) {
-        concurrent_marker_->wait_for_completion();
+// The collector's half. A pointer is dead if it is a heap address in scope
+// that marking did not reach - anything else is left alone
+
+void GarbageCollector::trace_ephemerons(MarkScope scope) {
+    auto live = [&](const void* ptr) {
+        if (!ptr || !in_scope(ptr, scope)) return true;
+        ObjectHeader* header = heap_.find_object(ptr);
+        return header && (header->flags & ObjectHeader::MARKED);
+    };
+    // Values are untagged like JIT values, so they are kept alive and
+    // pinned like a conservative reference
+    auto mark = [&](void* value) {
+        if (!value || !in_scope(value, scope)) return false;
+        ObjectHeader* header = heap_.find_object(value);
+        if (!header || (header->flags & ObjectHeader::MARKED)) return false;
+        mark_object(header, true);
+        return true;
+    };
+
+    // Cleanups queued by the young half of a full collection run after the old half
+    for (size_t i = 0; i < g_cleanup_queue.size(); ++i) mark(g_cleanup_queue[i].held);
+    process_mark_stack(scope);
+
+    // Marking a value can make other keys live, and other tables reachable
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (size_t i = 0; i < g_weak_containers.size(); ++i) {
+            ObjectHeader* header = g_weak_containers[i];
+            if (!live(header->get_object_start())) continue;
+            if (header->type_id == TYPE_EPHEMERON_TABLE) {
+                auto* table = static_cast<EphemeronTable*>(header->get_object_start());
+                EphemeronTable::Entry* entries = table->entries();
+                for (uint64_t j = 0; j < table->capacity; ++j) {
+                    void* key = entries[j].key;
+                    if (key && key != DELETED_KEY && live(key)) changed |= mark(entries[j].value);
+                }
+            } else if (header->type_id == TYPE_FINALIZATION_CELLS) {
+                auto* cells = static_cast<FinalizationCells*>(header->get_object_start());
+                for (uint64_t j = 0; j < cells->count; ++j) changed |= mark(cells->cells()[j].held);
+            }
+        }
+        if (changed) process_mark_stack(scope);
     }
 }
 
-// Heap usage functions
-size_t GenerationalHeap::young_used() const {
-    return young_.eden_current - young_.eden_start;
+void GarbageCollector::clear_weak_references(MarkScope scope) {
+    auto live = [&](const void* ptr) {
+        if (!ptr || !in_scope(ptr, scope)) return true;
+        ObjectHeader* header = heap_.find_object(ptr);
+        return header && (header->flags & ObjectHeader::MARKED);
+    };
+
+    for (size_t i = 0; i < g_weak_containers.size(); ++i) {
+        ObjectHeader* header = g_weak_containers[i];
+        void* payload = header->get_object_start();
+        // A container that is dead so far is emptied, in case a finalizer
+        // revives it
+        bool container_live = live(payload);
+        if (header->type_id == TYPE_WEAK_REF) {
+            void** target = static_cast<void**>(payload);
+            if (!container_live || !live(*target)) *target = nullptr;
+        } else if (header->type_id == TYPE_EPHEMERON_TABLE) {
+            auto* table = static_cast<EphemeronTable*>(payload);
+            EphemeronTable::Entry* entries = table->entries();
+            uint64_t cleared = 0;
+            for (uint64_t j = 0; j < table->capacity; ++j) {
+                void* key = entries[j].key;
+                if (key && key != DELETED_KEY && (!container_live || !live(key))) {
+                    entries[j] = {DELETED_KEY, nullptr};
+                    cleared++;
+                }
+            }
+            table->live -= cleared;
+            if (cleared) rehash_ephemerons(table);
+        } else if (header->type_id == TYPE_FINALIZATION_CELLS) {
+            auto* cells = static_cast<FinalizationCells*>(payload);
+            FinalizationCells::Cell* cell = cells->cells();
+            for (uint64_t j = 0; j < cells->count; ) {
+                if (container_live && live(cell[j].target)) {
+                    if (!live(cell[j].token)) cell[j].token = nullptr;
+                    ++j;
+                    continue;
+                }
+                // A dead registry runs no cleanups
+                if (container_live) g_cleanup_queue.push({cells->callback, cell[j].held});
+                cell[j] = cell[--cells->count];
+                cell[cells->count] = {};
+            }
+        }
+    }
 }
 
-size_t GenerationalHeap::old_used() const {
-    return old_.current - old_.start;
+void GarbageCollector::sweep_weak_containers(MarkScope scope) {
+    size_t kept = 0;
+    for (size_t i = 0; i < g_weak_containers.size(); ++i) {
+        ObjectHeader* header = g_weak_containers[i];
+        if (!in_scope(header, scope) || (header->flags & ObjectHeader::MARKED)) g_weak_containers[kept++] = header;
+    }
+    g_weak_containers.truncate(kept);
 }
 
-size_t GenerationalHeap::total_allocated() const {
-    return young_used() + old_used();
+void GarbageCollector::forward_weak_references(MarkScope scope) {
+    auto forward = [&](void** slot) {
+        void* ptr = *slot;
+        if (!ptr || ptr == DELETED_KEY || !in_scope(ptr, scope)) return false;
+        ObjectHeader* header = heap_.find_object(ptr);
+        if (!header || !header->forward_ptr || header->get_object_start() != ptr) return false;
+        *slot = header->forward_ptr;
+        return true;
+    };
+
+    for (size_t i = 0; i < g_weak_containers.size(); ++i) {
+        ObjectHeader* header = g_weak_containers[i];
+        // Young survivors were copied already - their copies are updated.
+        // Old objects slide after this, taking their updated slots along
+        if (scope == MarkScope::YOUNG && heap_.in_young(header) && header->forward_ptr) {
+            header = ObjectHeader::from_object(header->forward_ptr);
+            g_weak_containers[i] = header;
+        }
+        void* payload = header->get_object_start();
+        if (header->type_id == TYPE_WEAK_REF) {
+            forward(static_cast<void**>(payload));
+        } else if (header->type_id == TYPE_EPHEMERON_TABLE) {
+            auto* table = static_cast<EphemeronTable*>(payload);
+            EphemeronTable::Entry* entries = table->entries();
+            bool moved = false;
+            for (uint64_t j = 0; j < table->capacity; ++j) moved |= forward(&entries[j].key);
+            if (moved) rehash_ephemerons(table);
+        } else if (header->type_id == TYPE_FINALIZATION_CELLS) {
+            auto* cells = static_cast<FinalizationCells*>(payload);
+            for (uint64_t j = 0; j < cells->count; ++j) {
+                forward(&cells->cells()[j].target);
+                forward(&cells->cells()[j].token);
+            }
+        }
+        if (scope != MarkScope::YOUNG && in_scope(header, scope) && header->forward_ptr) {
+            g_weak_containers[i] = ObjectHeader::from_object(header->forward_ptr);
+        }
+    }
 }
 
-void GenerationalHeap::decommit_unused_memory() {
-    // Calculate unused memory at the end of old generation
-    size_t old_size_used = old_used();
-    size_t old_total_size = old_.end - old_.start;
-    size_t unused_size = old_total_size - old_size_used;
-    
-    // Only decommit if we have significant unused memory (at least 1MB)
-    const size_t MIN_DECOMMIT_SIZE = 1024 * 1024;
-    if (unused_size < MIN_DECOMMIT_SIZE) {
-        return;
+// ============================================================================
+// HEAP PROFILING
+// ============================================================================
+
+// Exponentially distributed, so samples do not fall into step with a
+// program's allocation pattern
+static int64_t next_profile_interval(size_t rate) {
+    uint64_t& x = t_profile_random;
+    if (!x) {
+        x = (reinterpret_cast<uintptr_t>(&x) ^
+             static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())) | 1;
     }
-    
-    // Round down to page boundary
-    size_t page_size = 4096;
-    size_t decommit_start = reinterpret_cast<uintptr_t>(old_.current);
-    decommit_start = (decommit_start + page_size - 1) & ~(page_size - 1);
-    
-    size_t decommit_end = reinterpret_cast<uintptr_t>(old_.end);
-    
-    if (decommit_start < decommit_end) {
-        // Use madvise to tell the OS it can reclaim these pages
-        void* addr = reinterpret_cast<void*>(decommit_start);
-        size_t len = decommit_end - decommit_start;
-        
-        if (madvise(addr, len, MADV_DONTNEED) == 0) {
-            // Successfully decommitted memory
-            // Note: The virtual address space is still reserved, but physical
-            // memory can be reclaimed by the OS
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    double uniform = static_cast<double>((x >> 11) + 1) / 9007199254740992.0;  // (0, 1]
+    return static_cast<int64_t>(-std::log(uniform) * static_cast<double>(rate)) + 1;
+}
+
+static uint32_t intern_profile_stack(const uintptr_t* frames, size_t depth) {
+    if (g_profile_stacks.empty()) g_profile_stacks.push(ProfileStack{});
+    if (!depth) return 0;
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < depth; ++i) {
+        hash ^= frames[i];
+        hash *= 1099511628211ULL;
+    }
+    size_t slot = hash % GCConfig::HEAP_PROFILE_STACK_SLOTS;
+    while (uint32_t entry = g_profile_stack_slots[slot]) {
+        const ProfileStack& stack = g_profile_stacks[entry - 1];
+        if (stack.hash == hash && stack.frame_count == depth &&
+            memcmp(&g_profile_frames[stack.first_frame], frames, depth * sizeof(uintptr_t)) == 0) {
+            return entry - 1;
         }
+        slot = (slot + 1) % GCConfig::HEAP_PROFILE_STACK_SLOTS;
     }
+    if (g_profile_stacks.size() >= GCConfig::HEAP_PROFILE_STACK_SLOTS / 4 * 3) return 0;
+
+    ProfileStack stack{};
+    stack.hash = hash;
+    stack.first_frame = static_cast<uint32_t>(g_profile_frames.size());
+    stack.frame_count = static_cast<uint32_t>(depth);
+    for (size_t i = 0; i < depth; ++i) g_profile_frames.push(frames[i]);
+    g_profile_stacks.push(stack);
+    g_profile_stack_slots[slot] = static_cast<uint32_t>(g_profile_stacks.size());
+    return static_cast<uint32_t>(g_profile_stacks.size() - 1);
 }
 
-size_t GenerationalHeap::get_unused_memory() const {
-    size_t young_unused = (young_.eden_end - young_.eden_current);
-    size_t old_unused = (old_.end - old_.current);
-    return young_unused + old_unused;
+size_t GarbageCollector::set_heap_profile_rate(size_t sample_rate) {
+    if (sample_rate && heap_profile_started_ == std::chrono::steady_clock::time_point{}) {
+        heap_profile_started_ = std::chrono::steady_clock::now();
+    }
+    return heap_profile_rate_.exchange(sample_rate);
+}
+
+void GarbageCollector::sample_allocation(ObjectHeader* header, size_t total_size, size_t allocated) {
+    size_t rate = heap_profile_rate();
+    if (!t_profile_random) t_profile_countdown = next_profile_interval(rate);
+    t_profile_allocated += allocated;
+    t_profile_countdown -= static_cast<int64_t>(allocated);
+    if (t_profile_countdown > 0) return;
+    uint64_t bytes = t_profile_allocated;
+    t_profile_allocated = 0;
+    t_profile_countdown = next_profile_interval(rate);
+
+    // Return addresses into JIT code along the RBP chain, innermost first.
+    // The runtime is built with frame pointers, so the chain runs through
+    // the runtime functions between here and the JIT caller
+    uintptr_t frames[GCConfig::HEAP_PROFILE_DEPTH];
+    size_t depth = 0;
+    const CodeSymbols* symbols = code_symbols_.load(std::memory_order_acquire);
+    auto in_code = [symbols](uintptr_t address) {
+        auto it = std::upper_bound(symbols->code.begin(), symbols->code.end(), address,
+                                   [](uintptr_t a, const CodeRange& range) { return a < range.start; });
+        return it != symbols->code.begin() && address < (it - 1)->end;
+    };
+    if (symbols && t_mutator) {
+        uintptr_t high = t_mutator->stack_high;
+        uintptr_t rbp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+        while (depth < GCConfig::HEAP_PROFILE_DEPTH && rbp + 2 * sizeof(uintptr_t) <= high &&
+               (rbp & (sizeof(uintptr_t) - 1)) == 0) {
+            uintptr_t caller_rbp = reinterpret_cast<uintptr_t*>(rbp)[0];
+            uintptr_t return_address = reinterpret_cast<uintptr_t*>(rbp)[1];
+            if (in_code(return_address)) frames[depth++] = return_address;
+            if (caller_rbp <= rbp || caller_rbp >= high) break;
+            rbp = caller_rbp;
+        }
+    }
+
+    uint32_t stack = intern_profile_stack(frames, depth);
+    uint32_t objects = static_cast<uint32_t>(std::max<uint64_t>(1, bytes / total_size));
+    ProfileStack& record = g_profile_stacks[stack];
+    record.alloc_objects += objects;
+    record.alloc_bytes += bytes;
+    record.inuse_objects += objects;
+    record.inuse_bytes += bytes;
+    g_profile_samples.push({header, stack, objects, bytes});
+}
+
+void GarbageCollector::sweep_profile_samples(MarkScope scope, bool freed_pages_only) {
+    auto& young = heap_.young_;
+    size_t kept = 0;
+    for (size_t i = 0; i < g_profile_samples.size(); ++i) {
+        ProfileSample sample = g_profile_samples[i];
+        bool dead = freed_pages_only
+            ? heap_.in_young(sample.header) &&
+              young.pages[heap_.page_index(sample.header)] == GenerationalHeap::PageKind::FREE
+            : in_scope(sample.header, scope) && !(sample.header->flags & ObjectHeader::MARKED);
+        if (!dead) {
+            g_profile_samples[kept++] = sample;
+            continue;
+        }
+        ProfileStack& record = g_profile_stacks[sample.stack];
+        record.inuse_objects -= sample.objects;
+        record.inuse_bytes -= sample.bytes;
+    }
+    g_profile_samples.truncate(kept);
+}
+
+void GarbageCollector::forward_profile_samples(MarkScope scope) {
+    for (size_t i = 0; i < g_profile_samples.size(); ++i) {
+        ObjectHeader* header = g_profile_samples[i].header;
+        if (in_scope(header, scope) && header->forward_ptr) {
+            g_profile_samples[i].header = ObjectHeader::from_object(header->forward_ptr);
+        }
+    }
+}
+
+bool GarbageCollector::get_heap_profile(HeapProfile& profile) {
+    if (t_collecting) return false;
+    std::vector<ProfileStack> stacks;
+    std::vector<uintptr_t> frames;
+    {
+        // No collection can start, so no thread is stopped holding the
+        // allocator's locks while the copies allocate
+        std::lock_guard<std::mutex> collect_lock(collect_mutex_);
+        std::lock_guard<std::mutex> heap_lock(heap_.heap_mutex_);
+        for (size_t i = 0; i < g_profile_stacks.size(); ++i) stacks.push_back(g_profile_stacks[i]);
+        for (size_t i = 0; i < g_profile_frames.size(); ++i) frames.push_back(g_profile_frames[i]);
+    }
+    if (stacks.empty()) return false;
+
+    profile = HeapProfile();
+    profile.sample_rate = static_cast<int64_t>(heap_profile_rate());
+    profile.duration_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - heap_profile_started_).count();
+
+    const CodeSymbols* symbols = code_symbols_.load(std::memory_order_acquire);
+    std::unordered_map<uintptr_t, uint32_t> locations;
+    auto location = [&](uintptr_t address) {
+        auto it = locations.find(address);
+        if (it != locations.end()) return it->second;
+        std::string function = "(runtime)";
+        if (address) {
+            function = "(jit)";
+            if (symbols) {
+                auto start = std::upper_bound(symbols->starts.begin(), symbols->starts.end(), address);
+                if (start != symbols->starts.begin()) function = symbols->names[start - symbols->starts.begin() - 1];
+            }
+        }
+        uint32_t index = static_cast<uint32_t>(profile.locations.size());
+        profile.locations.push_back({address, function});
+        locations[address] = index;
+        return index;
+    };
+
+    for (const ProfileStack& stack : stacks) {
+        if (!stack.alloc_objects) continue;
+        HeapProfile::Stack out;
+        if (!stack.frame_count) out.locations.push_back(location(0));
+        for (uint32_t i = 0; i < stack.frame_count; ++i) {
+            out.locations.push_back(location(frames[stack.first_frame + i]));
+        }
+        out.alloc_objects = stack.alloc_objects;
+        out.alloc_bytes = stack.alloc_bytes;
+        out.inuse_objects = stack.inuse_objects;
+        out.inuse_bytes = stack.inuse_bytes;
+        profile.stacks.push_back(std::move(out));
+    }
+    return true;
+}
+
+// ============================================================================
+// HEAP SNAPSHOTS
+// ============================================================================
+
+// Output of the snapshot child. A stopped thread may have held malloc's
+// locks when it was forked, so the buffer is static and writes are raw
+class SnapshotWriter {
+    int fd_;
+    size_t used_ = 0;
+    bool failed_ = false;
+    static uint8_t buffer_[1 << 16];
+
+public:
+    explicit SnapshotWriter(int fd) : fd_(fd) {}
+
+    void write(const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        while (bytes) {
+            if (used_ == sizeof(buffer_)) flush();
+            size_t chunk = std::min(bytes, sizeof(buffer_) - used_);
+            memcpy(buffer_ + used_, p, chunk);
+            used_ += chunk;
+            p += chunk;
+            bytes -= chunk;
+        }
+    }
+    template <typename T> void put(T value) { write(&value, sizeof(value)); }
+
+    bool flush() {
+        for (size_t done = 0; done < used_ && !failed_;) {
+            ssize_t n = ::write(fd_, buffer_ + done, used_ - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) failed_ = true;
+            else done += n;
+        }
+        used_ = 0;
+        return !failed_;
+    }
+};
+uint8_t SnapshotWriter::buffer_[1 << 16];
+
+// Name table of the snapshot child: index + 1 per type id, and class names
+// by pointer - classes beyond the table are written as their type
+static uint32_t g_snapshot_type_names[TypeRegistry::MAX_TYPES];
+static constexpr size_t SNAPSHOT_CLASS_SLOTS = 4096;
+static struct { const char* name; uint32_t index; } g_snapshot_class_names[SNAPSHOT_CLASS_SLOTS];
+
+int64_t GarbageCollector::write_heap_snapshot(const char* path) {
+    if (t_collecting || !path) return -1;
+    register_current_thread();
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "ERROR: Cannot create heap snapshot " << path << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+    // The child reports its object count here
+    void* shared = mmap(nullptr, sizeof(int64_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    int64_t* result = static_cast<int64_t*>(shared);
+    *result = -1;
+
+    long child;
+    {
+        // Locked as for a collection: the child's copy of the heap must be
+        // consistent, and it needs these with no one left to release them
+        std::lock_guard<std::mutex> collect_lock(collect_mutex_);
+        std::lock_guard<std::mutex> roots_lock(roots_.roots_mutex);
+        std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+        std::lock_guard<std::mutex> mark_lock(mark_mutex_);
+        stop_the_world();
+        {
+            std::lock_guard<std::mutex> heap_lock(heap_.heap_mutex_);
+            // Not fork(): its atfork handlers take malloc's locks, which a
+            // stopped thread may be holding
+            child = syscall(SYS_clone, SIGCHLD, nullptr, nullptr, nullptr, nullptr);
+            if (child == 0) {
+                *result = write_snapshot_objects(fd);
+                _exit(*result < 0 ? 1 : 0);
+            }
+        }
+        resume_the_world();
+    }
+    close(fd);
+
+    int64_t objects = -1;
+    if (child < 0) {
+        std::cerr << "ERROR: Cannot fork the heap snapshot writer: " << strerror(errno) << std::endl;
+    } else {
+        int status = 0;
+        pid_t waited;
+        while ((waited = waitpid(static_cast<pid_t>(child), &status, 0)) < 0 && errno == EINTR) {}
+        if (waited == child && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            objects = *result;
+        } else {
+            std::cerr << "ERROR: Heap snapshot " << path << " was not written" << std::endl;
+        }
+    }
+    munmap(shared, sizeof(int64_t));
+    return objects;
+}
+
+int64_t GarbageCollector::write_snapshot_objects(int fd) {
+    // Everything here happens in the child's private copy of the heap
+    t_collecting = true;
+    gc_marking_active = 0;
+    g_mark_stack.clear();
+    g_concurrent_stack.clear();
+    for (MutatorThread* thread : threads_) heap_.retire_tlab(*thread->tlab);
+    heap_.rebuild_young_start_bits();
+
+    // Reachability from scratch. Dead objects the old sweep has not reached
+    // become fillers, so conservative references cannot find them
+    auto unmark = [](ObjectHeader* header) { header->flags &= ~(ObjectHeader::MARKED | ObjectHeader::PINNED); };
+    heap_.for_each_young_object(unmark);
+    heap_.for_each_old_object([&](ObjectHeader* header) {
+        if (!heap_.is_live_old(header)) header->type_id = TYPE_FILLER;
+        unmark(header);
+    });
+    heap_.for_each_large_object(unmark);
+
+    // The roots are what mark_roots() pushes
+    mark_roots(MarkScope::FULL);
+    GCBuffer<ObjectHeader*> roots;
+    for (size_t i = 0; i < g_mark_stack.size(); ++i) roots.push(g_mark_stack[i]);
+    process_mark_stack(MarkScope::FULL);
+
+    GCBuffer<ObjectHeader*> objects;
+    auto gather = [&](ObjectHeader* header) {
+        if ((header->flags & ObjectHeader::MARKED) && header->type_id != TYPE_FILLER) objects.push(header);
+    };
+    heap_.for_each_young_object(gather);
+    heap_.for_each_old_object(gather);
+    heap_.for_each_large_object(gather);
+    ObjectHeader** first = objects.size() ? &objects[0] : nullptr;
+    ObjectHeader** last = first + objects.size();
+    std::sort(first, last);
+    auto index_of = [&](const void* ptr) -> uint32_t {
+        if (!heap_.contains(ptr)) return UINT32_MAX;
+        ObjectHeader* header = heap_.find_object(ptr);
+        if (!header || !(header->flags & ObjectHeader::MARKED)) return UINT32_MAX;
+        return static_cast<uint32_t>(std::lower_bound(first, last, header) - first);
+    };
+
+    // Sites are known for the objects still waiting to be judged as samples
+    AllocationSample* samples = g_allocation_samples.size() ? &g_allocation_samples[0] : nullptr;
+    AllocationSample* samples_end = samples + g_allocation_samples.size();
+    auto by_header = [](const AllocationSample& a, const AllocationSample& b) { return a.header < b.header; };
+    std::sort(samples, samples_end, by_header);
+
+    GCBuffer<const char*> names;
+    auto name_of = [&](ObjectHeader* header) -> uint32_t {
+        uint32_t& type_name = g_snapshot_type_names[header->type_id % TypeRegistry::MAX_TYPES];
+        if (!type_name) {
+            const TypeInfo* info = type_registry_.get_type(header->type_id);
+            names.push(info && info->name && *info->name ? info->name : "(unknown)");
+            type_name = static_cast<uint32_t>(names.size());
+        }
+        if (header->type_id != TYPE_OBJECT) return type_name - 1;
+
+        const char* class_name = *static_cast<const char**>(header->get_object_start());
+        if (!class_name) return type_name - 1;
+        size_t slot = (reinterpret_cast<uintptr_t>(class_name) >> 3) % SNAPSHOT_CLASS_SLOTS;
+        for (size_t probe = 0; probe < SNAPSHOT_CLASS_SLOTS; ++probe) {
+            auto& entry = g_snapshot_class_names[(slot + probe) % SNAPSHOT_CLASS_SLOTS];
+            if (entry.name == class_name) return entry.index;
+            if (!entry.name) {
+                names.push(class_name);
+                entry.name = class_name;
+                entry.index = static_cast<uint32_t>(names.size() - 1);
+                return entry.index;
+            }
+        }
+        return type_name - 1;
+    };
+
+    SnapshotWriter out(fd);
+    out.write(HeapSnapshotFormat::MAGIC, sizeof(HeapSnapshotFormat::MAGIC));
+    out.put<uint32_t>(HeapSnapshotFormat::VERSION);
+    out.put<uint32_t>(0);
+    out.put<uint64_t>(objects.size());
+    out.put<uint64_t>(roots.size());
+
+    GCBuffer<uint32_t> edges;
+    auto precise = [&](void** slot) {
+        uint32_t index = index_of(*slot);
+        if (index != UINT32_MAX) edges.push(index);
+    };
+    auto conservative = [&](uintptr_t word) {
+        uint32_t index = index_of(reinterpret_cast<const void*>(word));
+        if (index != UINT32_MAX) edges.push(index);
+    };
+    for (size_t i = 0; i < objects.size(); ++i) {
+        ObjectHeader* header = objects[i];
+        AllocationSample key{header, 0};
+        AllocationSample* sample = std::lower_bound(samples, samples_end, key, by_header);
+        edges.clear();
+        visit_refs(header, precise, conservative);
+
+        out.put<uint64_t>(reinterpret_cast<uintptr_t>(header->get_object_start()));
+        out.put<uint32_t>(static_cast<uint32_t>(header->total_size()));
+        out.put<uint32_t>(name_of(header));
+        out.put<uint32_t>(sample != samples_end && sample->header == header ? sample->site : 0);
+        out.put<uint32_t>(static_cast<uint32_t>(edges.size()));
+        if (edges.size()) out.write(&edges[0], edges.size() * sizeof(uint32_t));
+    }
+    for (size_t i = 0; i < roots.size(); ++i) {
+        out.put<uint32_t>(static_cast<uint32_t>(std::lower_bound(first, last, roots[i]) - first));
+    }
+    out.put<uint32_t>(static_cast<uint32_t>(names.size()));
+    for (size_t i = 0; i < names.size(); ++i) {
+        uint32_t length = static_cast<uint32_t>(strlen(names[i]));
+        out.put<uint32_t>(length);
+        out.write(names[i], length);
+    }
+    if (!out.flush()) return -1;
+    return static_cast<int64_t>(objects.size());
+}
+
+// ============================================================================
+// PAUSE HISTOGRAM
+// ============================================================================
+
+size_t PauseHistogram::bucket_of(uint64_t micros) {
+    if (micros < SUB_BUCKETS) return micros;
+    // The top three bits: the power of two, then which quarter of it
+    int power = 63 - __builtin_clzll(micros);
+    size_t quarter = (micros >> (power - 2)) & (SUB_BUCKETS - 1);
+    return (power - 1) * SUB_BUCKETS + quarter;
+}
+
+uint64_t PauseHistogram::bucket_limit(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    int power = static_cast<int>(bucket / SUB_BUCKETS) + 1;
+    uint64_t low = (SUB_BUCKETS + bucket % SUB_BUCKETS) << (power - 2);
+    return low + (uint64_t(1) << (power - 2)) - 1;
+}
+
+void PauseHistogram::record(uint64_t micros) {
+    buckets_[bucket_of(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(micros, std::memory_order_relaxed);
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (micros > seen && !max_.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {}
+}
+
+uint64_t PauseHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    // Rank of the percentile, 1-based
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * n + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucket_limit(i), max());
+    }
+    return max();
 }
 
 // ============================================================================
-// C API IMPLEMENTATION
+// C API FOR JIT
 // ============================================================================
 
 extern "C" {
 
 void* __gc_alloc_fast(size_t size, uint32_t type_id) {
-    return GenerationalHeap::allocate_fast(size, type_id, false);
+    return GenerationalHeap::allocate_fast(size, type_id);
 }
 
 void* __gc_alloc_array_fast(size_t element_size, size_t count, uint32_t type_id) {
-    size_t total_size = sizeof(size_t) + element_size * count; // length prefix
-    return GenerationalHeap::allocate_fast(total_size, type_id, true);
+    void* array = GenerationalHeap::allocate_fast(sizeof(size_t) + element_size * count, type_id, true);
+    *static_cast<size_t*>(array) = count;
+    return array;
+}
+
+void* __gc_alloc_slow(size_t size, uint32_t type_id, uint32_t site) {
+    return GarbageCollector::instance().allocate_at_site(size, type_id, site);
 }
 
 void* __gc_alloc_stack(size_t size, uint32_t type_id) {
-    // This is a marker - actual stack allocation is done by JIT
-    return reinterpret_cast<void*>(0xDEADBEEF);
+    // JIT will handle this inline
+    return GenerationalHeap::stack_allocate(size, type_id);
 }
 
 void __gc_write_barrier(void* obj, void* field, void* new_value) {
     WriteBarrier::write_ref(obj, field, new_value);
 }
 
-void __gc_safepoint() {
-    GarbageCollector::safepoint_poll();
+void __gc_satb_enqueue(void* old_value) {
+    if (gc_marking_active) GarbageCollector::instance().satb_enqueue(old_value);
+}
+
+void __gc_publish(void* obj) {
+    GarbageCollector::instance().publish(obj);
 }
 
 void __gc_register_roots(void** roots, size_t count) {
     auto& gc = GarbageCollector::instance();
-    // Use thread-local cleanup to ensure automatic cleanup
-    if (!GarbageCollector::thread_root_cleanup_) {
-        GarbageCollector::thread_root_cleanup_ = new GarbageCollector::ThreadRootCleanup(&gc);
-        register_thread_cleanup_callback([](void* arg) {
-            auto* cleanup = static_cast<GarbageCollector::ThreadRootCleanup*>(arg);
-            delete cleanup;
-        }, GarbageCollector::thread_root_cleanup_);
-    }
-    
     for (size_t i = 0; i < count; ++i) {
-        GarbageCollector::thread_root_cleanup_->add_root(&roots[i]);
+        gc.add_stack_root(&roots[i]);
     }
 }
 
 void __gc_unregister_roots(void** roots, size_t count) {
-    if (GarbageCollector::thread_root_cleanup_) {
-        for (size_t i = 0; i < count; ++i) {
-            GarbageCollector::thread_root_cleanup_->remove_root(&roots[i]);
-        }
+    auto& gc = GarbageCollector::instance();
+    for (size_t i = count; i > 0; --i) {
+        gc.remove_stack_root(&roots[i - 1]);
     }
 }
 
-void __gc_register_type(uint32_t type_id, size_t size, void* vtable, 
-                       uint32_t ref_offsets[], size_t ref_count) {
-    // Register type information for GC
+void __gc_register_type(uint32_t type_id, size_t size, void* vtable,
+                        uint32_t ref_offsets[], size_t ref_count) {
     TypeInfo info;
     info.type_id = type_id;
     info.size = size;
     info.vtable = vtable;
+    info.is_array = false;
+
     for (size_t i = 0; i < ref_count; ++i) {
         info.ref_offsets.push_back(ref_offsets[i]);
     }
-    
-    GarbageCollector::instance().type_registry_.register_type(info);
-}
-
-} // extern "C"
-
-// ============================================================================
-// WRITE BARRIER IMPLEMENTATION
-// ============================================================================
-
-void WriteBarrier::scan_dirty_cards(std::function<void(void*, void*)> callback) {
-    auto& gc = GarbageCollector::instance();
-    auto& heap = gc.heap_;
-    
-    OptimizedWriteBarrier::scan_dirty_cards_simd([&callback, &heap](uintptr_t card_start) {
-        uintptr_t card_end = card_start + GCConfig::CARD_SIZE;
-        
-        // Only scan if card is in old generation range
-        if (card_start < reinterpret_cast<uintptr_t>(heap.old_.start) ||
-            card_start >= reinterpret_cast<uintptr_t>(heap.old_.current)) {
-            return;
-        }
-        
-        // Walk objects in card with proper bounds checking
-        uintptr_t addr = card_start;
-        while (addr < card_end && addr < reinterpret_cast<uintptr_t>(heap.old_.current)) {
-            // Ensure we have space for header
-            if (addr + sizeof(ObjectHeader) > reinterpret_cast<uintptr_t>(heap.old_.current)) {
-                break;
-            }
-            
-            ObjectHeader* header = reinterpret_cast<ObjectHeader*>(addr);
-            
-            // Validate header
-            if (header->size == 0 || header->size > GCConfig::OLD_GEN_SIZE) {
-                break; // Invalid object, stop scanning this card
-            }
-            
-            if (header->flags & ObjectHeader::IN_OLD_GEN) {
-                callback(header->get_object_start(), nullptr);
-            }
-            
-            // Move to next object with alignment
-            size_t total_size = sizeof(ObjectHeader) + header->size;
-            total_size = (total_size + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1);
-            addr += total_size;
-        }
-    });
-}
 
-void WriteBarrier::clear_cards() {
-    // Clear the entire card table
-    if (card_table_ && card_table_size_ > 0) {
-        memset(card_table_, 0, card_table_size_);
-    }
-    OptimizedWriteBarrier::clear_cards_batch();
+    GarbageCollector::instance().get_type_registry().register_type(info);
 }
 
-void GarbageCollector::decommit_old_generation_tail() {
-    // Compact memory by finding highest used address
-    uint8_t* highest_used = heap_.old_.start;
-    
-    // Scan old generation to find highest live object
-    uint8_t* scan = heap_.old_.start;
-    while (scan < heap_.old_.current) {
-        if (scan + sizeof(ObjectHeader) > heap_.old_.current) {
-            break;
-        }
-        
-        ObjectHeader* header = reinterpret_cast<ObjectHeader*>(scan);
-        
-        // Validate header
-        if (header->size == 0 || header->size > GCConfig::OLD_GEN_SIZE) {
-            break;
-        }
-        
-        if (header->is_marked()) {
-            // This object is live, update highest used
-            highest_used = scan + sizeof(ObjectHeader) + header->size;
-        }
-        
-        // Clear mark bit for next GC
-        header->set_marked(false);
-        
-        // Move to next object
-        size_t total_size = sizeof(ObjectHeader) + header->size;
-        total_size = (total_size + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1);
-        scan += total_size;
-    }
-    
-    // Update current pointer to just after highest live object
-    highest_used = reinterpret_cast<uint8_t*>(
-        (reinterpret_cast<uintptr_t>(highest_used) + GCConfig::OBJECT_ALIGNMENT - 1) & 
-        ~(GCConfig::OBJECT_ALIGNMENT - 1)
-    );
-    
-    if (highest_used < heap_.old_.current) {
-        heap_.old_.current = highest_used;
-    }
-    
-    // Decommit unused memory
-    heap_.decommit_unused_memory();
-}
+} // extern "C"
 
-} // namespace gots
\ No newline at end of file
+} // namespace gots
@@ -1,56 +1,86 @@
 #pragma once
 
 #include <atomic>
-#include <thread>
-#include <vector>
-#include <mutex>
+#include <chrono>
 #include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <algorithm>
-#include <unordered_set>
-#include <bit>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <thread>
+#include <pthread.h>
 #include "gc_type_registry.h"
-#include "gc_thread_cleanup.h"
-#include "gc_optimized_barriers.h"
 
 namespace gots {
 
-// Forward declarations for concurrent marking
-class ConcurrentMarkingCoordinator;
+struct HeapProfile;
 
 // ============================================================================
 // GC CONFIGURATION
 // ============================================================================
 
 struct GCConfig {
-    static constexpr size_t TLAB_SIZE = 256 * 1024;           // 256KB per thread
-    static constexpr size_t YOUNG_GEN_SIZE = 32 * 1024 * 1024; // 32MB
-    static constexpr size_t OLD_GEN_SIZE = 512 * 1024 * 1024;  // 512MB
+    static constexpr size_t TLAB_SIZE = 256 * 1024;           // 256KB per thread (max)
+    static constexpr size_t MIN_TLAB_SIZE = 16 * 1024;        // First refill of a thread
+    static constexpr size_t YOUNG_GEN_SIZE = 32 * 1024 * 1024; // 32MB reserved - eden is sized within it
+    static constexpr size_t OLD_GEN_SIZE = 512 * 1024 * 1024;  // 512MB reserved
+    static constexpr size_t YOUNG_PAGE_SIZE = TLAB_SIZE;       // Unit of eden/survivor space
+    static constexpr int YOUNG_PAGE_SHIFT = 18;
+    static constexpr size_t PRIVATE_PAGE_PERCENT = 50;         // Of eden that goroutines may hold privately
+    static constexpr size_t MIN_EDEN_PAGES = 8;                // 2MB - adaptive eden never shrinks below
+    static constexpr size_t YOUNG_GC_INTERVAL_MS = 20;         // Eden is sized to fill about this often
+    static constexpr size_t LARGE_OBJECT_SIZE = YOUNG_PAGE_SIZE / 4;  // Allocated straight into old gen
+    static constexpr size_t LOS_OBJECT_SIZE = YOUNG_PAGE_SIZE;  // Own page span in the large-object space
+    static constexpr size_t LOS_SIZE = size_t(4) << 30;        // 4GB - payload sizes are 32-bit anyway
+    static constexpr size_t LOS_PAGE_SIZE = 4096;              // Span granularity
+    static constexpr int LOS_PAGE_SHIFT = 12;
+    static constexpr size_t TENURING_THRESHOLD = 3;           // Young collections before promotion
+    static constexpr size_t MAX_ALLOCATION_SITES = 65536;      // JIT sites profiled for pretenuring
+    static constexpr size_t PRETENURE_MIN_SAMPLES = 32;        // Before a site is judged
+    static constexpr size_t PRETENURE_SURVIVAL_PERCENT = 85;   // Of samples alive at their first young collection
+    static constexpr size_t HEAP_PROFILE_RATE = 512 * 1024;    // Mean bytes between heap profile samples
+    static constexpr size_t HEAP_PROFILE_DEPTH = 64;           // JIT frames kept per sample
+    static constexpr size_t HEAP_PROFILE_STACK_SLOTS = 65536;  // Distinct stacks, at most 3/4 of this
+    static constexpr size_t OLD_GC_TRIGGER = 64 * 1024 * 1024; // First old collection
+    static constexpr size_t MIN_OLD_HEADROOM = 4 * 1024 * 1024; // Above live data, even at the memory limit
+    static constexpr size_t CGROUP_LIMIT_PERCENT = 90;         // Of cgroup memory.max, the default soft limit
+    static constexpr size_t SWEEP_CHUNK_SIZE = 64 * 1024;      // Unit of lazy old-gen sweeping
+    static constexpr size_t COMPACT_FRAGMENTATION_PERCENT = 50; // Free bytes outside the largest block
+    static constexpr size_t COMPACT_MIN_FREE_BYTES = 8 * 1024 * 1024; // Too little free space to bother below this
+    static constexpr size_t CONCURRENT_MARK_START_PERCENT = 70; // Of the old-gen trigger
+    static constexpr size_t CONCURRENT_MARK_BATCH = 256;       // Objects the marker traces per lock hold
+    static constexpr size_t SATB_BUFFER_SIZE = 256;            // Per-thread pre-write barrier buffer
     static constexpr size_t CARD_SIZE = 512;                   // bytes per card
+    static constexpr int CARD_SHIFT = 9;
     static constexpr size_t OBJECT_ALIGNMENT = 16;             // 16-byte aligned
     static constexpr size_t MIN_STACK_ALLOC_SIZE = 16;         // min for stack alloc
     static constexpr size_t MAX_STACK_ALLOC_SIZE = 1024;       // max for stack alloc
 };
 
 // ============================================================================
-// OBJECT HEADER - Minimal overhead (8 bytes)
+// OBJECT HEADER - 16 bytes in front of every payload
 // ============================================================================
 
 struct ObjectHeader {
     union {
         struct {
-            uint32_t size : 24;        // Object size (16MB max per object)
-            uint32_t flags : 8;        // GC flags
-            uint32_t type_id : 16;     // Type identifier
-            uint32_t reserved : 16;    // Reserved for future use
+            uint32_t size;             // Payload size in bytes
+            uint8_t flags;             // GC flags
+            uint8_t age;               // Young collections survived
+            uint16_t type_id;          // Type identifier (gc_type_registry.h)
         };
-        uint64_t raw;
+        uint64_t raw;                  // Whole word - what the JIT stores
     };
     void* forward_ptr;  // Full forwarding pointer (during GC)
-    
+
     enum Flags : uint8_t {
         MARKED = 0x01,
-        PINNED = 0x02,
+        PINNED = 0x02,                 // Conservatively referenced - must not move this cycle
         HAS_FINALIZER = 0x04,
         IS_ARRAY = 0x08,
         IN_OLD_GEN = 0x10,
@@ -58,22 +88,43 @@ struct ObjectHeader {
         STACK_ALLOCATED = 0x40,
         ESCAPE_ANALYZED = 0x80
     };
-    
+
+    static constexpr uint64_t make_raw(uint32_t size, uint8_t flags, uint16_t type_id) {
+        return uint64_t(size) | (uint64_t(flags) << 32) | (uint64_t(type_id) << 48);
+    }
+
     bool is_marked() const { return flags & MARKED; }
-    void set_marked(bool marked) { 
-        if (marked) flags |= MARKED; 
-        else flags &= ~MARKED; 
+    void set_marked(bool marked) {
+        if (marked) flags |= MARKED;
+        else flags &= ~MARKED;
     }
-    
+
     bool is_stack_allocated() const { return flags & STACK_ALLOCATED; }
     bool has_escaped() const { return !(flags & ESCAPE_ANALYZED) || !(flags & STACK_ALLOCATED); }
-    
+
     void* get_object_start() { return reinterpret_cast<uint8_t*>(this) + sizeof(ObjectHeader); }
+    size_t total_size() const { return align(sizeof(ObjectHeader) + size); }
+
+    static ObjectHeader* from_object(void* obj) {
+        return reinterpret_cast<ObjectHeader*>(static_cast<uint8_t*>(obj) - sizeof(ObjectHeader));
+    }
+    static constexpr size_t align(size_t size) {
+        return (size + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1);
+    }
 };
 
+static_assert(sizeof(ObjectHeader) == 16, "JIT allocation sequences assume a 16-byte header");
+static_assert(size_t(1) << GCConfig::CARD_SHIFT == GCConfig::CARD_SIZE, "CARD_SHIFT must match CARD_SIZE");
+static_assert(size_t(1) << GCConfig::YOUNG_PAGE_SHIFT == GCConfig::YOUNG_PAGE_SIZE, "YOUNG_PAGE_SHIFT must match YOUNG_PAGE_SIZE");
+static_assert(size_t(1) << GCConfig::LOS_PAGE_SHIFT == GCConfig::LOS_PAGE_SIZE, "LOS_PAGE_SHIFT must match LOS_PAGE_SIZE");
+static_assert(GCConfig::LOS_PAGE_SIZE % GCConfig::CARD_SIZE == 0, "A card must not be shared by two large objects");
+
 // ============================================================================
 // ESCAPE ANALYSIS - Static analysis for stack allocation
 // ============================================================================
+//
+// Runtime registry of lifetime facts. The JIT's own stack allocation
+// decisions are made per function body by EscapeAnalysis (escape_analysis.h).
 
 class EscapeAnalyzer {
 public:
@@ -81,7 +132,7 @@ public:
         bool can_stack_allocate = false;
         size_t max_lifetime_scope = 0;
         std::vector<size_t> escape_points;
-        
+
         // Reasons for escape
         bool escapes_to_heap = false;
         bool escapes_to_closure = false;
@@ -89,7 +140,7 @@ public:
         bool escapes_to_global = false;
         bool size_too_large = false;
     };
-    
+
     // Called during JIT compilation
     static AnalysisResult analyze_allocation(
         const void* jit_context,
@@ -97,7 +148,7 @@ public:
         size_t allocation_size,
         uint32_t type_id
     );
-    
+
     // Register variable lifetime information
     static void register_scope_entry(size_t scope_id);
     static void register_scope_exit(size_t scope_id);
@@ -111,200 +162,536 @@ public:
 // ============================================================================
 // THREAD LOCAL ALLOCATION BUFFER (TLAB)
 // ============================================================================
+//
+// One per thread, in static TLS. JIT code bumps current_/end_ directly through
+// fs-relative addressing (X86CodeGen::emit_gc_allocate), so both fields sit at
+// fixed offsets and the whole struct is trivially constructible.
 
 class TLAB {
+    friend class GenerationalHeap;
+    friend class GarbageCollector;
 private:
-    uint8_t* start_;
-    uint8_t* current_;
-    uint8_t* end_;
-    size_t thread_id_;
-    std::atomic<size_t> allocated_bytes_{0};
-    
+    uint8_t* current_ = nullptr;       // Offset 0 - bump pointer
+    uint8_t* end_ = nullptr;           // Offset 8 - limit
+    uint8_t* start_ = nullptr;
+    size_t refill_size_ = GCConfig::MIN_TLAB_SIZE;
+
+    // Goroutine threads allocate from young pages tagged with their own
+    // owner (gc_young_page_owner) - 0 for every other thread
+    uint8_t private_owner_ = 0;
+    size_t private_page_ = SIZE_MAX;   // Private page being carved
+
+    // A thread is never stopped for GC while it is updating the heap. The
+    // suspend signal sets suspend_pending_ instead and leave_heap() parks
+    volatile sig_atomic_t in_heap_ = 0;
+    volatile sig_atomic_t suspend_pending_ = 0;
+
 public:
-    TLAB(uint8_t* start, size_t size, size_t thread_id) 
-        : start_(start), current_(start), end_(start + size), thread_id_(thread_id) {}
-    
-    // Fast inline allocation - no function calls!
-    inline void* allocate(size_t size) {
-        size = align_size(size);
+    static constexpr int32_t CURRENT_OFFSET = 0;
+    static constexpr int32_t END_OFFSET = 8;
+
+    // Fast inline allocation - no function calls! Returns the header
+    inline ObjectHeader* allocate(size_t total_size) {
         uint8_t* result = current_;
-        uint8_t* new_current = result + size;
-        
-        if (new_current > end_) {
+        if (!result || total_size > static_cast<size_t>(end_ - result)) {
             return nullptr; // Need slow path
         }
-        
-        current_ = new_current;
-        allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
-        return result;
-    }
-    
-    inline bool can_allocate(size_t size) const {
-        return (current_ + align_size(size)) <= end_;
-    }
-    
-    void reset(uint8_t* start, size_t size) {
-        start_ = start;
-        current_ = start;
-        end_ = start + size;
-        allocated_bytes_.store(0, std::memory_order_relaxed);
+        current_ = result + total_size;
+        return reinterpret_cast<ObjectHeader*>(result);
     }
-    
+
     size_t used() const { return current_ - start_; }
     size_t remaining() const { return end_ - current_; }
-    
-private:
-    static constexpr size_t align_size(size_t size) {
-        return (size + GCConfig::OBJECT_ALIGNMENT - 1) & ~(GCConfig::OBJECT_ALIGNMENT - 1);
+
+    inline void enter_heap() {
+        in_heap_ = 1;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
     }
+    inline void leave_heap() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        in_heap_ = 0;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        if (suspend_pending_) park_pending();
+    }
+
+private:
+    void park_pending();
 };
 
 // ============================================================================
-// WRITE BARRIER - For generational GC
+// WRITE BARRIERS - SATB for concurrent marking, card marking for young GCs
 // ============================================================================
 
+// Set while the old generation is marked concurrently with the mutators.
+// JIT code tests it inline (X86CodeGen::emit_gc_pre_write_barrier)
+extern volatile uint8_t gc_marking_active;
+
+// One byte per CARD_SIZE bytes of heap, set when a reference is stored into
+// a slot there - the slot's card, not the object's, which large objects span
+// many of. Young collections scan only the dirty old-generation cards
+// for old-to-young references; young cards are never read. Biased, so the
+// card of an address is gc_card_table_base[address >> CARD_SHIFT]
+extern uint8_t* gc_card_table_base;
+
+// Owner of each young page: nonzero for the pages private to one goroutine.
+// Nothing outside a goroutine references its private objects, so its pages
+// are freed as soon as it completes. Storing a private object anywhere but
+// into its owner's private objects publishes it first
+// (GarbageCollector::publish); the JIT checks this inline after the card mark
+extern uintptr_t gc_young_start;
+extern uint8_t gc_young_page_owner[GCConfig::YOUNG_GEN_SIZE >> GCConfig::YOUNG_PAGE_SHIFT];
+
+// Per JIT allocation site: allocate in the old generation. The inline
+// sequence (X86CodeGen::emit_gc_allocate) takes the slow path while its
+// site's byte is set
+extern uint8_t gc_pretenured_sites[GCConfig::MAX_ALLOCATION_SITES];
+
+inline uint8_t gc_private_owner(const void* ptr) {
+    uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) - gc_young_start;
+    return offset < GCConfig::YOUNG_GEN_SIZE ? gc_young_page_owner[offset >> GCConfig::YOUNG_PAGE_SHIFT] : 0;
+}
+
+extern "C" void __gc_satb_enqueue(void* old_value);
+extern "C" void __gc_publish(void* obj);
+
 class WriteBarrier {
-private:
-    static uint8_t* card_table_;
-    static size_t card_table_size_;
-    
 public:
-    // Inline write barrier - emitted by JIT (delegates to optimized barriers)
-    static inline void write_ref(void* obj, void* field, void* new_value) {
-        AdaptiveWriteBarriers::adaptive_write_barrier(obj, reinterpret_cast<void**>(field), new_value);
-    }
-    
-    // Batch card scanning
-    static void scan_dirty_cards(std::function<void(void*, void*)> callback);
-    static void clear_cards();
-    
-private:
-    static inline ObjectHeader* get_header(void* obj) {
-        if (!obj) return nullptr;
-        return reinterpret_cast<ObjectHeader*>(
-            reinterpret_cast<uint8_t*>(obj) - sizeof(ObjectHeader)
-        );
-    }
+    // While marking runs, the value a store overwrites is handed to the
+    // marker, so everything reachable when marking started gets marked.
+    // The store and its card mark are one step for the collector: a thread
+    // is never stopped between the two. A goroutine-private value stored into
+    // a shared object is published
+    static inline void write_ref(void* obj, void* field, void* new_value);
 };
 
 // ============================================================================
 // GENERATIONAL HEAP
 // ============================================================================
+//
+// One reservation: the young generation (YOUNG_PAGE_SIZE pages that serve as
+// eden or survivor space) followed by the old generation. Young collections
+// copy live objects out of their pages unless something references them
+// conservatively - such pages are kept in place as survivor pages.
+//
+// The old generation is mark-sweep. Free space is kept as filler objects on
+// size-segregated free lists, in front of a bump frontier. Sweeping is lazy:
+// an old collection only leaves everything below the frontier unswept, and
+// the background worker or an allocation that finds the free lists empty
+// sweeps it a chunk at a time, in address order. A fragmented old generation
+// is compacted by sliding live objects down instead, leaving pinned objects
+// where they are. Young collections find old-to-young references through
+// the card table the write barriers maintain.
+//
+// Objects of LOS_OBJECT_SIZE and up live in the large-object space at the end
+// of the reservation instead: each gets its own run of pages. They belong to
+// the old generation - marked, card-marked and counted with it - but never
+// move, and the pages of a dead one go back to the OS as soon as the marking
+// that found it dead ends.
+//
+// Both generations are sized at run time within their reservations. Eden
+// gets as many pages as allocation fills in about YOUNG_GC_INTERVAL_MS, less
+// what survivors of the last collection need to be copied into. The old
+// generation is collected once it doubles its live data, or earlier when
+// the heap approaches the soft memory limit - GOTS_MEMLIMIT, or by default
+// a share of the cgroup's memory.max - which also shrinks eden.
+//
+// A goroutine allocates from eden pages of its own (PRIVATE) while enough
+// are free. Publishing an object - a store into shared state, a channel
+// send, a Promise resolution, retain() - turns its page and every private
+// page it reaches into ordinary eden. When the goroutine completes, its
+// remaining private pages hold only garbage and go straight back to FREE,
+// without a collection.
 
 class GenerationalHeap {
     friend class GarbageCollector;
+    friend class WriteBarrier;
+public:
+    enum class PageKind : uint8_t {
+        FREE,
+        EDEN,          // TLABs carve from it
+        SURVIVOR,      // Survived a young collection
+        TO_SPACE,      // Receiving copies during a collection
+        PRIVATE        // Eden of one goroutine (gc_young_page_owner)
+    };
+
 private:
-    // Young generation (Eden + Survivor spaces)
+    // Young generation (eden + survivor pages)
     struct YoungGen {
-        uint8_t* eden_start;
-        uint8_t* eden_current;
-        uint8_t* eden_end;
-        
-        uint8_t* survivor1_start;
-        uint8_t* survivor1_end;
-        
-        uint8_t* survivor2_start;
-        uint8_t* survivor2_end;
-        
-        uint8_t* active_survivor;
-        
+        uint8_t* start;
+        uint8_t* end;
+        size_t page_count;
+        PageKind* pages;               // Per page
+        uint8_t** page_top;            // End of the parseable part of each page
+
+        size_t eden_page;              // Page TLABs carve from, or page_count
+        size_t eden_pages_used;
+        size_t eden_page_limit;        // Young collection when reached - adaptive
+
+        size_t private_pages;          // PRIVATE pages, counted in eden_pages_used too
+        size_t private_page_limit;
+        bool owner_used[256];          // Private heap tags handed out
+
         std::atomic<size_t> collections{0};
     };
-    
-    // Old generation
+
+    // Free lists: exact classes up to OLD_EXACT_CLASS_LIMIT bytes, then one
+    // per power of two
+    static constexpr size_t OLD_EXACT_CLASS_LIMIT = 512;
+    static constexpr size_t OLD_EXACT_CLASSES = OLD_EXACT_CLASS_LIMIT / GCConfig::OBJECT_ALIGNMENT;
+    static constexpr size_t OLD_FREE_LIST_COUNT = OLD_EXACT_CLASSES + 16;
+
+    // Old generation - free lists, then a bump frontier
     struct OldGen {
         uint8_t* start;
-        uint8_t* current;
+        uint8_t* current;              // Frontier
         uint8_t* end;
-        
+        size_t gc_trigger;             // Old collection once this much is in use
+        size_t live_bytes;             // Found live by the last old collection
+        size_t used_bytes;             // Marked by the last old collection plus allocated since
+
+        // Filler objects, linked through forward_ptr
+        ObjectHeader* free_lists[OLD_FREE_LIST_COUNT];
+        size_t free_bytes;
+        size_t largest_free_block;
+        size_t allocated_while_marking; // Allocated black during concurrent marking
+
+        // Lazy sweep - [sweep_cursor, sweep_limit) still holds the mark bits
+        // of the last old collection, and its unmarked objects are garbage
+        uint8_t* sweep_cursor;
+        uint8_t* sweep_limit;
+        size_t fragmentation_percent;  // Free bytes outside the largest block, at the last complete sweep
+
         std::atomic<size_t> collections{0};
+        std::atomic<size_t> compactions{0};
+    };
+
+    // Large-object space - one page span per object, past the old generation
+    struct LargeObjectSpace {
+        uint8_t* start;
+        uint8_t* current;              // Frontier
+        uint8_t* end;
+        std::map<uint8_t*, size_t> objects;     // Header -> span bytes, in address order
+        std::map<uint8_t*, size_t> free_spans;  // Below the frontier, coalesced
+        // Per page, the object whose span covers it - find_object reads it
+        // without locks while the concurrent marker runs
+        ObjectHeader** page_object;
+
+        std::atomic<size_t> object_count{0};
+        std::atomic<size_t> span_bytes{0};      // Pages of live spans
+        std::atomic<size_t> released_bytes{0};  // Given back to the OS so far
     };
-    
+
     YoungGen young_;
     OldGen old_;
-    
+    LargeObjectSpace los_;
+    uint8_t* reserved_start_ = nullptr;
+    size_t reserved_size_ = 0;
+
+    // One bit per 16 bytes: set at each object header. Kept up to date for
+    // the old generation; rebuilt for young pages at each collection
+    uint64_t* start_bits_ = nullptr;
+
+    // Card table (gc_card_table_base). Old-generation cards without
+    // old-to-young references are cleaned by every young collection
+    uint8_t* card_table_ = nullptr;
+
     // Thread-local allocation buffers
-    static thread_local TLAB* tlab_;
+    static thread_local TLAB tlab_;
     std::mutex heap_mutex_;
-    std::vector<std::unique_ptr<TLAB>> all_tlabs_;
-    std::mutex tlabs_mutex_;
-    
+
+    std::atomic<size_t> allocated_bytes_{0};
+
 public:
     // Initialize heap
     void initialize();
     void shutdown();
-    
-    // Fast allocation path (inlined in JIT code)
+
+    // Fast allocation path - the JIT emits the same bump inline
     static inline void* allocate_fast(size_t size, uint32_t type_id, bool is_array = false) {
-        // Try TLAB first
-        if (tlab_ && tlab_->can_allocate(size + sizeof(ObjectHeader))) {
-            void* mem = tlab_->allocate(size + sizeof(ObjectHeader));
-            if (mem) {
-                // Initialize header
-                ObjectHeader* header = reinterpret_cast<ObjectHeader*>(mem);
-                header->size = size;
-                header->flags = 0;
-                header->type_id = type_id;
-                header->forward_ptr = 0;
-                if (is_array) header->flags |= ObjectHeader::IS_ARRAY;
-                
-                return header->get_object_start();
-            }
+        TLAB& tlab = tlab_;
+        tlab.enter_heap();
+        ObjectHeader* header = tlab.allocate(ObjectHeader::align(sizeof(ObjectHeader) + size));
+        if (header) {
+            // Initialize header - TLAB memory is already zeroed
+            header->raw = ObjectHeader::make_raw(static_cast<uint32_t>(size),
+                                                 is_array ? ObjectHeader::IS_ARRAY : 0,
+                                                 static_cast<uint16_t>(type_id));
+            tlab.leave_heap();
+            return header->get_object_start();
         }
-        
+        tlab.leave_heap();
+
         // Slow path
         return allocate_slow(size, type_id, is_array);
     }
-    
+
     // Stack allocation helper (for escape analysis)
     static inline void* stack_allocate(size_t size, uint32_t type_id) {
         // This is a marker for JIT to emit stack allocation
         // Actual implementation is in JIT code generation
+        (void)size;
+        (void)type_id;
         return nullptr;
     }
-    
-    // Slow allocation path
-    static void* allocate_slow(size_t size, uint32_t type_id, bool is_array);
+
+    // Slow allocation path - refills the TLAB, collecting when eden is full
+    // A JIT allocation site's first object from a fresh TLAB is a
+    // pretenuring sample (GarbageCollector::allocate_at_site)
+    static void* allocate_slow(size_t size, uint32_t type_id, bool is_array, uint32_t site = 0);
     static void* allocate_large_slow(size_t size, uint32_t type_id, bool is_array);
-    
+
     // GC triggers
     void collect_young();
     void collect_old();
     void collect_full();
-    
+
     // Statistics
     size_t young_used() const;
     size_t old_used() const;
+    // Memory the heap spans: the young generation, the old generation up to
+    // its frontier and the large-object spans
+    size_t heap_size() const;
+    size_t eden_size() const { return young_.eden_page_limit * GCConfig::YOUNG_PAGE_SIZE; }
+    size_t old_gc_trigger() const { return old_.gc_trigger; }
+    size_t old_free_bytes() const { return old_.free_bytes; }
+    size_t old_fragmentation_percent() const { return old_.fragmentation_percent; }
+    size_t large_object_count() const { return los_.object_count.load(std::memory_order_relaxed); }
+    size_t large_object_bytes() const { return los_.span_bytes.load(std::memory_order_relaxed); }
+    size_t large_object_bytes_released() const { return los_.released_bytes.load(std::memory_order_relaxed); }
     size_t total_allocated() const;
-    
+
+    bool contains(const void* ptr) const {
+        auto p = static_cast<const uint8_t*>(ptr);
+        return p >= reserved_start_ && p < reserved_start_ + reserved_size_;
+    }
+    bool in_young(const void* ptr) const {
+        auto p = static_cast<const uint8_t*>(ptr);
+        return p >= young_.start && p < young_.end;
+    }
+
+    // Object containing an address (interior pointers included), or null
+    ObjectHeader* find_object(const void* addr) const;
+
+    bool is_card_dirty(const void* ptr) const {
+        return contains(ptr) && card_table_[card_index(ptr)];
+    }
+
+    bool in_large_object_space(const void* ptr) const {
+        auto p = static_cast<const uint8_t*>(ptr);
+        return p >= los_.start && p < los_.end;
+    }
+
+    // Walk every object in the old generation / in young pages
+    template <typename F> void for_each_old_object(F&& f);
+    // Every large object, in address order - world stopped
+    template <typename F> void for_each_large_object(F&& f);
+    template <typename F> void for_each_young_object(F&& f);
+    // Every dirty old-generation card, large objects' included, in address order
+    template <typename F> void for_each_dirty_old_card(F&& f);
+
     // Memory management
     void decommit_unused_memory();
     size_t get_unused_memory() const;
+
+    // fs-relative offset of this thread's TLAB - the same for every thread
+    static int32_t tlab_tls_offset();
+
+private:
+    void rebuild_young_start_bits();
+    bool refill_tlab(TLAB& tlab, size_t min_size);
+    void retire_tlab(TLAB& tlab);
+    ObjectHeader* allocate_old(size_t total_size);
+    void make_filler(uint8_t* start, size_t bytes);
+
+    // Large-object space - heap_mutex_ held. Spans come back zeroed
+    ObjectHeader* allocate_large_object(size_t total_size);
+    ObjectHeader* large_object_at(const uint8_t* p) const;
+    void free_large_object(uint8_t* start, size_t span);
+    // Frees the unmarked large objects and clears the marks of the rest, once
+    // an old marking is complete - world stopped
+    void sweep_large_objects();
+
+    // Old generation free lists and sweeping - heap_mutex_ held
+    static size_t old_size_class(size_t total_size);
+    void push_free_block(uint8_t* start, size_t bytes);
+    ObjectHeader* take_free_block(size_t total_size);
+    void clear_free_lists();
+    void start_old_sweep();
+    bool sweep_old_chunk();
+    void finish_old_sweep();
+    void trim_old_frontier(uint8_t* new_current);
+    void update_old_fragmentation();
+    bool old_sweep_pending() const { return old_.sweep_cursor < old_.sweep_limit; }
+    bool is_unswept(const void* ptr) const { return ptr >= old_.sweep_cursor && ptr < old_.sweep_limit; }
+    // Old object that is not dead garbage waiting for the sweeper
+    bool is_live_old(const ObjectHeader* header) const {
+        return header->type_id != TYPE_FILLER && (!is_unswept(header) || (header->flags & ObjectHeader::MARKED));
+    }
+
+    size_t page_index(const void* ptr) const {
+        return (static_cast<const uint8_t*>(ptr) - young_.start) / GCConfig::YOUNG_PAGE_SIZE;
+    }
+    uint8_t* page_start(size_t index) const { return young_.start + index * GCConfig::YOUNG_PAGE_SIZE; }
+    size_t take_free_page(PageKind kind);
+    size_t page_room(size_t index) const {
+        return page_start(index) + GCConfig::YOUNG_PAGE_SIZE - young_.page_top[index];
+    }
+    void carve_tlab(TLAB& tlab, size_t page, size_t want);
+
+    size_t bit_index(const void* ptr) const {
+        return (static_cast<const uint8_t*>(ptr) - reserved_start_) / GCConfig::OBJECT_ALIGNMENT;
+    }
+    void set_start_bit(const void* ptr) {
+        size_t bit = bit_index(ptr);
+        start_bits_[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    void clear_start_bit(const void* ptr) {
+        size_t bit = bit_index(ptr);
+        start_bits_[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+    }
+    void clear_start_bits(const uint8_t* from, const uint8_t* to);
+    // Nearest start bit at or below `bit`, not below `lower_bit`, or SIZE_MAX
+    size_t start_bit_at_or_before(size_t bit, size_t lower_bit) const;
+    // Header at or below an old-generation address - live, dead or filler
+    ObjectHeader* old_object_at_or_before(const uint8_t* p) const;
+
+    size_t card_index(const void* ptr) const {
+        return (static_cast<const uint8_t*>(ptr) - reserved_start_) >> GCConfig::CARD_SHIFT;
+    }
+    uint8_t* card_start(size_t card) const { return reserved_start_ + (card << GCConfig::CARD_SHIFT); }
+    void dirty_cards(const void* from, size_t bytes) {
+        size_t first = card_index(from);
+        size_t last = card_index(static_cast<const uint8_t*>(from) + bytes - 1);
+        memset(card_table_ + first, 1, last - first + 1);
+    }
 };
 
+inline void WriteBarrier::write_ref(void* obj, void* field, void* new_value) {
+    void** slot = reinterpret_cast<void**>(field);
+    if (gc_marking_active) __gc_satb_enqueue(*slot);
+    TLAB& tlab = GenerationalHeap::tlab_;
+    tlab.enter_heap();
+    *slot = new_value;
+    gc_card_table_base[reinterpret_cast<uintptr_t>(field) >> GCConfig::CARD_SHIFT] = 1;
+    tlab.leave_heap();
+    uint8_t owner = gc_private_owner(new_value);
+    if (owner && owner != gc_private_owner(obj)) __gc_publish(new_value);
+}
+
 // ============================================================================
 // GARBAGE COLLECTOR
 // ============================================================================
+//
+// Collections run on the allocating thread. Other mutator threads are stopped
+// with a signal. JIT frames stopped at a call are found through the RBP chain
+// and their reference slots, known from the stack maps the code generator
+// records, are scanned precisely and updated when objects move. Everything
+// else on a stack, and the registers, is scanned conservatively and anything
+// found there is pinned for the cycle. Precise roots registered through
+// add_stack_root/add_global_root are updated as well.
+//
+// The old generation is normally marked concurrently. A young collection
+// that finds it filling up also grays the old objects its roots and the
+// young generation reference (initial mark) and turns on the SATB write
+// barrier; the background worker then traces the old generation while the
+// mutators run. A later young collection drains the barrier buffers,
+// rescans roots and young objects and finishes marking (remark), then the
+// worker sweeps. Both steps ride on young pauses, when the young generation
+// is nearly empty, so they do not grow with the old generation. Explicit
+// full collections and compaction stop the world for the whole cycle.
+
+struct SATBBuffer;
+
+// Pause times in microseconds, log-bucketed: four buckets per power of two,
+// so a percentile is off by at most a quarter of its value. Recorded under
+// the collector lock, read from anywhere
+class PauseHistogram {
+public:
+    static constexpr size_t SUB_BUCKETS = 4;
+    static constexpr size_t BUCKETS = 64 * SUB_BUCKETS;
+
+    void record(uint64_t micros);
+    // Upper bound of the bucket holding the p-th percentile (0-100)
+    uint64_t percentile(double p) const;
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t total() const { return total_.load(std::memory_order_relaxed); }
+
+    static size_t bucket_of(uint64_t micros);
+    static uint64_t bucket_limit(size_t bucket);
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_{0};
+    std::atomic<uint64_t> total_{0};
+};
 
 class GarbageCollector {
+    friend class GenerationalHeap;
+    friend class TLAB;
+public:
+    struct MutatorThread {
+        pthread_t handle;
+        uintptr_t stack_low;
+        uintptr_t stack_high;
+        TLAB* tlab;
+        SATBBuffer* satb;
+
+        // Captured when the thread is parked
+        uintptr_t stopped_sp;
+        uintptr_t registers[16];
+    };
+
+    // Statistics
+    struct Stats {
+        size_t young_collections;
+        size_t old_collections;
+        size_t total_pause_time_ms;
+        size_t max_pause_time_ms;
+        size_t total_allocated;
+        size_t total_freed;
+        size_t live_objects;
+        size_t old_compactions;
+        size_t concurrent_marks;
+        size_t private_bytes_freed;    // Goroutine-private pages freed at completion
+        size_t large_objects;          // In the large-object space
+        size_t large_object_bytes;     // Pages their spans hold
+        size_t large_object_bytes_released; // Spans of dead ones returned to the OS
+
+        // Telemetry (runtime.gc.stats(), GOTS_GCTRACE)
+        size_t pause_count;
+        size_t pause_p50_us;
+        size_t pause_p99_us;
+        size_t pause_max_us;
+        size_t promoted_bytes;         // Copied from the young to the old generation
+        size_t alloc_bytes_per_sec;    // Since the collector started
+        size_t promoted_bytes_per_sec;
+        size_t heap_size;              // GenerationalHeap::heap_size()
+        size_t heap_used;              // Young plus old, at the time of the call
+
+        // Sizing
+        size_t memory_limit;           // Soft limit, 0 if none
+        size_t eden_size;              // Adaptive eden budget
+        size_t old_gc_trigger;         // Old generation occupancy that starts the next old collection
+
+        size_t pretenured_sites;       // JIT allocation sites allocating in the old generation
+        size_t pretenured_bytes;       // Allocated by them
+    };
+
 private:
     GenerationalHeap heap_;
-    std::thread gc_thread_;
-    std::atomic<bool> running_{true};
-    std::atomic<bool> gc_requested_{false};
-    std::condition_variable gc_cv_;
-    std::mutex gc_mutex_;
-    
+
     // Root set
     struct RootSet {
         std::vector<void**> stack_roots;
         std::vector<void**> global_roots;
-        std::vector<void**> register_roots;
+        std::unordered_map<void*, size_t> pinned;  // retain() counts
         std::mutex roots_mutex;
     };
-    
+
     RootSet roots_;
-    
+
     // GC state
     enum class Phase {
         IDLE,
@@ -312,147 +699,339 @@ private:
         RELOCATING,
         UPDATING_REFS
     };
-    
+
     std::atomic<Phase> current_phase_{Phase::IDLE};
-    
-    // Safe points
-    std::atomic<bool> safepoint_requested_{false};
-    std::atomic<size_t> threads_at_safepoint_{0};
-    size_t total_threads_{0};
-    
+    std::mutex collect_mutex_;
+
+    // Mutator threads and stop-the-world
+    std::vector<MutatorThread*> threads_;
+    std::mutex threads_mutex_;
+    std::atomic<uint32_t> world_epoch_{0};
+    std::atomic<uint32_t> stopped_count_{0};
+
+    // JIT allocation sequences that must restart if interrupted
+    struct CodeRange {
+        uintptr_t start;
+        uintptr_t end;
+    };
+    std::atomic<const std::vector<CodeRange>*> restart_ranges_{nullptr};
+    std::mutex restart_ranges_mutex_;
+
+    // JIT stack maps - return address -> RBP-relative reference slots,
+    // sorted by return address. slots_begin has one extra entry at the end
+    struct StackMaps {
+        std::vector<uintptr_t> return_addresses;
+        std::vector<uint32_t> slots_begin;
+        std::vector<int32_t> slots;
+    };
+    std::atomic<const StackMaps*> stack_maps_{nullptr};
+
+    // JIT function names by code address, for heap profiles - installed
+    // whole like the stack maps. starts is sorted, names parallel to it
+    struct CodeSymbols {
+        std::vector<CodeRange> code;
+        std::vector<uintptr_t> starts;
+        std::vector<std::string> names;
+    };
+    std::atomic<const CodeSymbols*> code_symbols_{nullptr};
+
+    // Background old-generation worker - concurrent marking, then sweeping.
+    // Started by the first old collection
+    std::thread worker_;
+    std::mutex worker_mutex_;
+    std::condition_variable worker_cv_;
+    bool worker_wakeup_ = false;
+    bool worker_stop_ = false;
+    std::atomic<bool> compaction_requested_{false};
+
+    // Concurrent marking. The marker traces under mark_mutex_, which every
+    // collection holds for its pause; satb_mutex_ guards the full barrier
+    // buffers handed over by mutators
+    std::mutex mark_mutex_;
+    std::mutex satb_mutex_;
+    bool mark_done_ = false;                       // Marker found nothing left to trace
+    std::atomic<bool> concurrent_mark_requested_{false};
+    std::atomic<size_t> concurrent_marks_{0};
+
     // Type registry
     TypeRegistry type_registry_;
-    
-    // Work-stealing mark deques for parallel marking
-    struct MarkDeque {
-        std::deque<void*> deque;
-        std::mutex mutex;
-        std::atomic<size_t> size{0};
-    };
-    std::vector<std::unique_ptr<MarkDeque>> mark_deques_;
-    std::atomic<size_t> next_deque_{0};
-    
-    // Thread-local deque index
-    static thread_local int thread_deque_index_;
-    
+
     // Statistics
     std::atomic<size_t> total_pause_time_ms_{0};
     std::atomic<size_t> max_pause_time_ms_{0};
-    
-    // Concurrent marking
-    std::unique_ptr<ConcurrentMarkingCoordinator> concurrent_marker_;
-    
+    std::atomic<size_t> total_freed_{0};
+    std::atomic<size_t> live_bytes_{0};
+    std::atomic<size_t> private_bytes_freed_{0};
+    std::atomic<size_t> promoted_bytes_{0};
+    PauseHistogram pauses_;
+    std::chrono::steady_clock::time_point started_;
+    bool trace_ = false;               // GOTS_GCTRACE=1 - one line per collection on stderr
+    size_t allocated_at_last_gc_ = 0;  // For the trace - collect_mutex_
+
+    // Heap sizing - memory_limit_ is read in collections, the rest is
+    // collect_mutex_
+    std::atomic<size_t> memory_limit_{0};
+    std::atomic<size_t> fixed_eden_pages_{0};
+
+    // Heap profiling - 0 when off. Samples are taken and followed with
+    // heap_mutex_ held
+    std::atomic<size_t> heap_profile_rate_{0};
+    std::chrono::steady_clock::time_point heap_profile_started_;
+
+    // Weak containers are read and updated by mutators with weak_mutex_
+    // held, inside enter_heap()/leave_heap() so a collection never finds
+    // one half-updated
+    std::mutex weak_mutex_;
+    void (*cleanup_runner_)(void* callback, void* held) = nullptr;
+
+    // Pretenuring
+    std::atomic<size_t> pretenured_sites_{0};
+    std::atomic<size_t> pretenured_bytes_{0};
+    std::chrono::steady_clock::time_point last_young_gc_;
+
 public:
     GarbageCollector();
     ~GarbageCollector();
-    
+
     // Initialize and shutdown
     void initialize();
     void shutdown();
-    
+
     // Root registration
     void add_stack_root(void** root);
     void remove_stack_root(void** root);
     void add_global_root(void** root);
     void remove_global_root(void** root);
-    
-    // Thread cleanup
-    void cleanup_thread_roots(std::thread::id thread_id);
-    
-    // Safe points (called by JIT-generated code)
-    static inline void safepoint_poll() {
-        if (instance().safepoint_requested_.load(std::memory_order_acquire)) {
-            safepoint_slow();
-        }
-    }
-    
+
+    // Keep an object reachable from C++ state the collector cannot see -
+    // counted, and the object does not move while retained
+    void retain(void* obj);
+    void release(void* obj);
+
+    // Threads whose stacks may hold heap references. Allocating registers a
+    // thread implicitly; it is unregistered when it exits
+    void register_current_thread();
+    void unregister_current_thread();
+
+    // Goroutine-private heap of the current thread. Goroutines attach when
+    // they start and release when they complete: the private pages nothing
+    // was published from are freed on the spot, the rest is left to the
+    // next young collection
+    void attach_private_heap();
+    void release_private_heap();
+
+    // `obj` becomes reachable from other threads. If it is private to the
+    // current goroutine, its page and every private page it reaches become
+    // shared eden - in place, nothing moves
+    void publish(void* obj);
+
+    // Record [start, end) of an installed inline allocation sequence
+    void register_restartable_range(const void* start, const void* end);
+
+    // Install the stack maps of code copied to code_base - pairs of return
+    // address offset and the frame's RBP-relative reference slots
+    void register_stack_maps(const void* code_base,
+                             const std::vector<std::pair<size_t, std::vector<int32_t>>>& maps);
+
+    // Install the names of the functions in code_base[0, code_size) - pairs
+    // of prologue offset and name, in code order
+    void register_code_symbols(const void* code_base, size_t code_size,
+                               const std::vector<std::pair<size_t, std::string>>& functions);
+
     // Manual GC trigger
     void request_gc(bool full = false);
-    
-    // Concurrent marking
-    void start_concurrent_marking();
-    void wait_for_concurrent_marking();
-    
+
+    // Compact the old generation at the next old collection, whatever its
+    // fragmentation
+    void request_compaction() { compaction_requested_.store(true); }
+
+    // Start concurrent marking at the next young collection, whatever the
+    // old generation's occupancy
+    void request_concurrent_mark() { concurrent_mark_requested_.store(true); }
+
+    // Out-of-line half of the SATB barrier: remember an overwritten reference
+    void satb_enqueue(void* old_value);
+
+    // JIT allocation sites - ids for X86CodeGen::emit_gc_allocate, 0 once
+    // MAX_ALLOCATION_SITES are handed out (such sites are not profiled).
+    // The first object a site allocates from a fresh TLAB is a sample, and
+    // the next young collection finds it alive or dead. A site whose samples
+    // reliably survive is pretenured: its objects go straight to the old
+    // generation instead of being copied through the survivor pages first
+    static uint32_t new_allocation_site();
+    void* allocate_at_site(size_t size, uint32_t type_id, uint32_t site);
+    bool is_pretenured(uint32_t site) const { return gc_pretenured_sites[site] != 0; }
+
+    // Soft limit on heap memory in bytes, 0 for none. Not a hard cap: as the
+    // heap approaches it, old collections start earlier and eden shrinks,
+    // from the next collection on. Returns the previous limit
+    size_t set_memory_limit(size_t bytes);
+    size_t memory_limit() const { return memory_limit_.load(std::memory_order_relaxed); }
+
+    // Pin eden at `bytes` from the next collection on, within what the
+    // young generation can hold; 0 goes back to adaptive sizing
+    void set_eden_size(size_t bytes) { fixed_eden_pages_.store(bytes / GCConfig::YOUNG_PAGE_SIZE); }
+
+    // Write the reachable object graph to `path` in the heapstat format
+    // (heap_snapshot.h). The world stops only while a child process is
+    // forked; the child walks its copy of the heap and writes the file
+    // while the program runs on. Returns the number of objects, -1 on failure
+    int64_t write_heap_snapshot(const char* path);
+
+    // Sampling heap profiler (heap_profile.h). About one allocation in
+    // every `sample_rate` bytes a thread allocates is sampled on the
+    // allocation slow path, with the JIT frames of its call stack, and
+    // followed until it dies. 0 stops sampling; what was sampled is kept.
+    // Returns the previous rate
+    size_t set_heap_profile_rate(size_t sample_rate);
+    size_t heap_profile_rate() const { return heap_profile_rate_.load(std::memory_order_relaxed); }
+    // Estimated allocated and in-use objects and bytes per stack since
+    // profiling started - false if nothing was ever sampled
+    bool get_heap_profile(HeapProfile& profile);
+
+    // Weak references. The containers live on the shared heap and are
+    // found through a list, not by tracing: the weak slots of a live
+    // container are cleared when their targets die, in the pause that ends
+    // marking. Keys and values are compared and hashed by address.
+    //  - WeakRef: weak_ref_get returns the target, or nullptr once it died
+    //  - WeakMap: an ephemeron table - a value is kept alive while its key
+    //    and the map are, and never keeps its own key alive
+    //  - FinalizationRegistry: when a registered target dies its held value
+    //    is handed to the cleanup runner with the registry's callback, after
+    //    the collection. The held value is strongly referenced until then;
+    //    the unregister token is weak
+    // Returned targets and values are kept alive through a concurrent
+    // marking cycle that is under way
+    void* new_weak_ref(void* target);
+    void* weak_ref_get(void* ref);
+    void* new_weak_map();
+    void* weak_map_get(void* map, void* key);    // nullptr if absent
+    bool weak_map_has(void* map, void* key);
+    void weak_map_set(void* map, void* key, void* value);
+    bool weak_map_delete(void* map, void* key);
+    size_t weak_map_size(void* map);
+    void* new_finalization_registry(void* callback);
+    void finalization_register(void* registry, void* target, void* held, void* token);
+    bool finalization_unregister(void* registry, void* token);  // Cells registered with `token`
+    // Runs a registry cleanup - the runtime spawns a goroutine calling
+    // callback(held). Without one the collecting thread calls it
+    void set_cleanup_runner(void (*runner)(void* callback, void* held)) { cleanup_runner_ = runner; }
+
     // Memory decommit support
     void decommit_old_generation_tail();
     size_t last_decommit_size_{0};
-    
-    // Statistics
-    struct Stats {
-        size_t young_collections;
-        size_t old_collections;
-        size_t total_pause_time_ms;
-        size_t max_pause_time_ms;
-        size_t total_allocated;
-        size_t total_freed;
-        size_t live_objects;
-    };
-    
+
     // Get type registry
     TypeRegistry& get_type_registry() { return type_registry_; }
-    
-    // Thread-local root cleanup
-    class ThreadRootCleanup {
-        std::vector<void**> thread_roots_;
-        GarbageCollector* gc_;
-    public:
-        explicit ThreadRootCleanup(GarbageCollector* gc) : gc_(gc) {}
-        ~ThreadRootCleanup() {
-            cleanup_all_roots();
-        }
-        void add_root(void** root) {
-            thread_roots_.push_back(root);
-            gc_->add_stack_root(root);
-        }
-        void remove_root(void** root) {
-            auto it = std::find(thread_roots_.begin(), thread_roots_.end(), root);
-            if (it != thread_roots_.end()) {
-                thread_roots_.erase(it);
-                gc_->remove_stack_root(root);
-            }
-        }
-        void cleanup_all_roots() {
-            for (void** root : thread_roots_) {
-                gc_->remove_stack_root(root);
-            }
-            thread_roots_.clear();
-        }
-        size_t root_count() const {
-            return thread_roots_.size();
-        }
-    };
-    
-    static thread_local ThreadRootCleanup* thread_root_cleanup_;
-    
+    GenerationalHeap& get_heap() { return heap_; }
+
     Stats get_stats() const;
-    
+
     static GarbageCollector& instance();
-    
+
 private:
-    void gc_thread_loop();
+    // Runs a collection unless another thread finished one since `seen`
+    void collect(bool full, size_t seen_young_collections);
     void perform_young_gc();
     void perform_old_gc();
     void perform_full_gc();
-    
-    static void safepoint_slow();
-    void wait_for_safepoint();
-    void release_safepoint();
-    
-    // Marking
-    void mark_roots();
-    void mark_object(void* obj);
-    void process_mark_stack();
-    void process_mark_deque(int deque_index);
-    bool steal_work(int from_deque, void*& obj);
-    int get_thread_deque_index();
-    
+    bool should_compact_old() const;
+
+    // After a collection: eden from the allocation rate and survival of the
+    // young generation, the old trigger from live data and the memory limit
+    void size_generations(size_t eden_used, size_t survival_percent);
+    void update_old_trigger();
+    static size_t default_memory_limit();
+
+    // Judge the pending allocation samples - by their mark bits in a young
+    // collection, or, for private pages just freed, as dead
+    void judge_allocation_samples(bool freed_pages_only);
+    // The forked half of write_heap_snapshot - allocates nothing
+    int64_t write_snapshot_objects(int fd);
+    void compact_old_generation();
+    void wake_worker();
+    void worker_loop();
+
+    // Concurrent marking
+    void start_concurrent_mark();
+    void finish_concurrent_mark();
+    void abandon_concurrent_mark();
+    void mark_snapshot_roots();
+    bool concurrent_mark_step();
+    void drain_satb_buffers(bool include_threads);
+
+    void stop_the_world();
+    void resume_the_world();
+    static void suspend_handler(int sig, siginfo_t* info, void* context);
+    static void park(MutatorThread* self, void* ucontext);
+    uintptr_t restart_point(uintptr_t pc) const;
+
+    // Marking - YOUNG marks young objects only, OLD old objects only (the
+    // concurrent cycle), FULL everything
+    enum class MarkScope : uint8_t { YOUNG, OLD, FULL };
+    bool in_scope(const void* ptr, MarkScope scope) const {
+        switch (scope) {
+            case MarkScope::YOUNG: return heap_.in_young(ptr);
+            case MarkScope::OLD: return heap_.contains(ptr) && !heap_.in_young(ptr);
+            default: return heap_.contains(ptr);
+        }
+    }
+    void mark_roots(MarkScope scope);
+    void collect_frame_slots(uintptr_t rbp, uintptr_t low, uintptr_t high);
+    void mark_precise_slot(void** slot, MarkScope scope);
+    void mark_conservative(uintptr_t word, MarkScope scope);
+    void mark_object(ObjectHeader* header, bool pin);
+    void process_mark_stack(MarkScope scope, size_t budget = SIZE_MAX);
+    template <typename Precise, typename Conservative>
+    void visit_refs(ObjectHeader* header, Precise&& precise, Conservative&& conservative);
+    // Reference slots of the live old objects on one card that lie on the
+    // card - both callbacks get slot addresses
+    template <typename Precise, typename Conservative>
+    void visit_card_refs(size_t card, Precise&& precise, Conservative&& conservative);
+    void rebuild_old_cards(const uint8_t* previous_current);
+    void scan_range_conservatively(uintptr_t from, uintptr_t to, MarkScope scope,
+                                   void*** skip = nullptr, size_t skip_count = 0);
+    void queue_unreachable_finalizers(MarkScope scope);
+
+    // Weak processing, once marking in `scope` is done: mark the ephemeron
+    // values of live keys and the held values of live registries until
+    // nothing changes, then clear what points to unmarked objects and
+    // queue the cleanups of dead registered targets. Finalizers are queued
+    // in between, so finalizable objects that only ephemerons reach are not
+    // finalized, and weak references are cleared before finalizers revive
+    // anything
+    void trace_ephemerons(MarkScope scope);
+    void clear_weak_references(MarkScope scope);
+    // Drop the containers in scope that stayed unmarked
+    void sweep_weak_containers(MarkScope scope);
+    // Follow moved containers and targets in scope, and rehash tables whose
+    // keys moved - after young copying, or before the old generation slides
+    void forward_weak_references(MarkScope scope);
+    // Register a new container - weak_mutex_ held, inside the heap
+    void add_weak_container(void* container);
+    // Whether a handle passed in from script code is a weak container of
+    // `type_id` - checked by its header tag. Registered, outside the heap
+    bool is_weak_container(void* object, uint16_t type_id);
+
+    // Heap profile samples - heap_mutex_ held. The thread is charged with
+    // `allocated` bytes: what it used of its last TLAB plus the object
+    void sample_allocation(ObjectHeader* header, size_t total_size, size_t allocated);
+    // Drop the samples in scope that marking found dead - or, for private
+    // pages just freed, those on free pages
+    void sweep_profile_samples(MarkScope scope, bool freed_pages_only);
+    // Follow the samples in scope that were moved
+    void forward_profile_samples(MarkScope scope);
+
     // Copying/Compacting
-    void* copy_object(void* obj, bool to_old_gen);
+    void* copy_object(ObjectHeader* header, bool to_old_gen);
+
+    // Shares a private page of `owner` and, transitively, the private pages
+    // its objects reference - heap_mutex_ held, on the owner's thread
+    void publish_private_page(size_t page, uint8_t owner);
     void update_references();
     void copy_young_survivors();
-    
-    // Card table scanning
-    void scan_card_table();
+
+    void run_pending_finalizers();
 };
 
 // ============================================================================
@@ -479,7 +1058,7 @@ public:
     ScopedGCRoot(const ScopedGCRoot&) = delete;
     ScopedGCRoot& operator=(const ScopedGCRoot&) = delete;
     // Allow moving
-    ScopedGCRoot(ScopedGCRoot&& other) noexcept 
+    ScopedGCRoot(ScopedGCRoot&& other) noexcept
         : root_(other.root_), registered_(other.registered_) {
         other.registered_ = false;
     }
@@ -490,20 +1069,27 @@ extern "C" {
     // Fast allocation (usually inlined)
     void* __gc_alloc_fast(size_t size, uint32_t type_id);
     void* __gc_alloc_array_fast(size_t element_size, size_t count, uint32_t type_id);
-    
+
+    // Out-of-line path behind the JIT's inline TLAB bump, per allocation site
+    void* __gc_alloc_slow(size_t size, uint32_t type_id, uint32_t site);
+
     // Stack allocation (always inlined by JIT)
     void* __gc_alloc_stack(size_t size, uint32_t type_id);
-    
+
     // Write barrier (always inlined)
     void __gc_write_barrier(void* obj, void* field, void* new_value);
-    
-    // Safe point (partially inlined)
-    void __gc_safepoint();
-    
+
+    // SATB barrier slow path - the JIT tests gc_marking_active inline and
+    // only calls this while concurrent marking runs
+    void __gc_satb_enqueue(void* old_value);
+
+    // A goroutine-private object escapes (GarbageCollector::publish)
+    void __gc_publish(void* obj);
+
     // Root registration (called at function entry/exit)
     void __gc_register_roots(void** roots, size_t count);
     void __gc_unregister_roots(void** roots, size_t count);
-    
+
     // Type information
     void __gc_register_type(uint32_t type_id, size_t size, void* vtable, uint32_t ref_offsets[], size_t ref_count);
 }
@@ -512,30 +1098,73 @@ extern "C" {
 // INLINE JIT CODE TEMPLATES
 // ============================================================================
 
-// These templates show what the JIT should emit for maximum performance
-
-// X86-64 fast allocation sequence (TLAB):
-// mov rax, [tlab_current]
-// lea rdx, [rax + size]
-// cmp rdx, [tlab_end]
+// X86-64 fast allocation sequence (TLAB), emitted by X86CodeGen::emit_gc_allocate.
+// Everything up to and including the store to tlab.current is a restartable
+// range: a thread stopped inside it resumes at the first instruction.
+// mov r11, &gc_pretenured_sites[site]
+// cmp byte [r11], 0
+// jne slow_path                   ; pretenured - __gc_alloc_slow allocates old
+// mov rax, fs:[tlab_current]
+// lea rdx, [rax + total]
+// cmp rdx, fs:[tlab_end]
 // ja slow_path
-// mov [tlab_current], rdx
-// mov dword [rax], header_data
-// lea rax, [rax + 8]  ; return object start
-// ret
-
-// X86-64 write barrier:
-// mov [obj + offset], new_value  ; do the write
-// test byte [obj - 8], 0x10      ; check IN_OLD_GEN flag
-// jz no_barrier
-// test byte [new_value - 8], 0x10 ; check if new_value is young
-// jnz no_barrier
-// ; Mark card
-// mov rcx, obj
-// shr rcx, 9                      ; divide by card size
-// mov byte [card_table + rcx], 1
-// no_barrier:
-
-// WebAssembly equivalents use similar patterns with linear memory
-
-} // namespace gots
\ No newline at end of file
+// mov rcx, header_word
+// mov [rax], rcx
+// mov fs:[tlab_current], rdx
+// add rax, 16                     ; return object start
+
+// X86-64 SATB pre-write barrier, emitted by X86CodeGen::emit_gc_pre_write_barrier
+// before a reference store into [obj + offset].
+// mov r11, &gc_marking_active
+// cmp byte [r11], 0
+// je done
+// test obj, obj
+// je done
+// push rdi ; push rsi ; push rdx ; sub rsp, 8
+// mov rdi, [obj + offset]         ; value about to be overwritten
+// call __gc_satb_enqueue
+// add rsp, 8 ; pop rdx ; pop rsi ; pop rdi
+// done:
+
+// X86-64 property store with card mark, emitted by
+// X86CodeGen::emit_object_set_property. Marking a young object's card is
+// harmless, so the mark needs no generation check. [restart, done) is a GC
+// restart range: a thread stopped after the store but before the mark
+// stores again, and the registers it needs were pinned as roots.
+// test rdi, rdi
+// je slow
+// cmp qword [rdi + COUNT_OFFSET], index
+// jle slow                        ; out of range - the runtime reports it
+// restart:
+// mov r11, &gc_card_table_base
+// mov r11, [r11]
+// mov [rdi + value_offset(index)], rdx
+// lea r10, [rdi + value_offset(index)]
+// shr r10, CARD_SHIFT
+// mov byte [r11 + r10], 1
+// done:
+// mov r11, [&gc_young_start]     ; value private, object not of the same owner?
+// mov r10, rdx
+// sub r10, r11
+// cmp r10, YOUNG_GEN_SIZE
+// jae join
+// shr r10, YOUNG_PAGE_SHIFT
+// movzx ecx, byte [gc_young_page_owner + r10]
+// test ecx, ecx
+// je join
+// mov r10, rdi
+// sub r10, r11
+// cmp r10, YOUNG_GEN_SIZE
+// jae publish
+// shr r10, YOUNG_PAGE_SHIFT
+// cmp cl, byte [gc_young_page_owner + r10]
+// je join
+// publish:
+// mov rdi, rdx
+// call __gc_publish
+// jmp join
+// slow:
+// call __object_set_property
+// join:
+
+} // namespace gots
@@ -2,30 +2,58 @@
 
 #include <atomic>
 #include <vector>
-#include <unordered_map>
+#include <memory>
 #include <mutex>
-#include <shared_mutex>
 #include <cstdint>
 #include <functional>
 
 namespace gots {
 
+// ============================================================================
+// BUILT-IN TYPE IDS - Fixed so the JIT can bake them into inline allocations
+// ============================================================================
+
+enum BuiltinTypeId : uint16_t {
+    TYPE_INVALID = 0,
+    TYPE_FILLER = 1,    // Dead space inside a region - skipped by heap walks
+    TYPE_STRING = 2,    // NUL-terminated bytes (the char* GoTS strings are)
+    TYPE_ARRAY = 3,     // __array_create: length, then the element slots
+    TYPE_OBJECT = 4,    // __object_create: class name, count, values, names
+    TYPE_BUFFER = 5,    // __runtime_buffer_alloc: int64 size header + bytes
+    TYPE_NUMERIC_ARRAY = 7,         // GoTS Array (GCArray): length, capacity, element storage
+    TYPE_NUMERIC_ARRAY_DATA = 8,    // A GCArray's float64 elements
+    // Weak references (GarbageCollector::new_weak_ref and friends). The
+    // marker does not follow the weak slots of these; each collection
+    // clears the ones whose targets died
+    TYPE_WEAK_REF = 9,              // target
+    TYPE_WEAK_MAP = 10,             // ephemeron table
+    TYPE_EPHEMERON_TABLE = 11,      // capacity, used, live, then key/value pairs
+    TYPE_FINALIZATION_REGISTRY = 12,    // finalization cells
+    TYPE_FINALIZATION_CELLS = 13,   // capacity, count, callback, then target/held/token triples
+    FIRST_DYNAMIC_TYPE = 64
+};
+
 // ============================================================================
 // TYPE INFORMATION - For GC object traversal
 // ============================================================================
 
 struct TypeInfo {
-    uint32_t type_id;
-    size_t size;
-    void* vtable;
+    uint32_t type_id = 0;
+    const char* name = "";
+    size_t size = 0;
+    void* vtable = nullptr;
     std::vector<size_t> ref_offsets;  // Offsets of reference fields
     std::function<void(void*)> finalizer;  // Optional finalizer
-    bool is_array;
-    bool has_weak_refs;
-    
+    bool is_array = false;
+    bool has_weak_refs = false;
+
     // For array types
-    size_t element_size;
-    bool elements_are_refs;
+    size_t element_size = 0;
+    bool elements_are_refs = false;
+
+    // JIT values are untagged int64s - every aligned word of the payload may
+    // be a reference, so targets are found conservatively and never moved
+    bool scan_conservatively = false;
 };
 
 // ============================================================================
@@ -33,90 +61,118 @@ struct TypeInfo {
 // ============================================================================
 
 class TypeRegistry {
+public:
+    static constexpr uint32_t MAX_TYPES = 4096;
+
 private:
-    std::unordered_map<uint32_t, TypeInfo> types_;
-    mutable std::shared_mutex mutex_;
-    std::atomic<uint32_t> next_type_id_{1};
-    
-    // Type ID cache for common types
-    struct CommonTypes {
-        uint32_t string_type;
-        uint32_t array_type;
-        uint32_t object_type;
-        uint32_t closure_type;
-        uint32_t promise_type;
-        uint32_t goroutine_type;
-    } common_types_;
-    
+    // Lookups happen for every object the collector visits while the world
+    // is stopped, so they must not take locks: entries are published once
+    // and never removed
+    std::atomic<const TypeInfo*> by_id_[MAX_TYPES] = {};
+    std::vector<std::unique_ptr<TypeInfo>> owned_;
+    std::mutex mutex_;
+    std::atomic<uint32_t> next_type_id_{FIRST_DYNAMIC_TYPE};
+
 public:
     TypeRegistry() = default;
     ~TypeRegistry() = default;
-    
-    // Register a new type
+
+    // Register a new type - info.type_id 0 assigns the next dynamic id
     uint32_t register_type(const TypeInfo& info) {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(mutex_);
         uint32_t id = info.type_id > 0 ? info.type_id : next_type_id_.fetch_add(1);
-        types_[id] = info;
-        types_[id].type_id = id;
+        if (id >= MAX_TYPES) return TYPE_INVALID;
+        auto entry = std::make_unique<TypeInfo>(info);
+        entry->type_id = id;
+        by_id_[id].store(entry.get(), std::memory_order_release);
+        owned_.push_back(std::move(entry));
         return id;
     }
-    
+
     // Get type information
     const TypeInfo* get_type(uint32_t type_id) const {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = types_.find(type_id);
-        return it != types_.end() ? &it->second : nullptr;
+        if (type_id >= MAX_TYPES) return nullptr;
+        return by_id_[type_id].load(std::memory_order_acquire);
     }
-    
-    // Register common types
+
+    // Register the runtime's built-in heap types under their fixed ids
     void register_common_types() {
-        // String type
+        TypeInfo filler_info;
+        filler_info.type_id = TYPE_FILLER;
+        filler_info.name = "(filler)";
+        register_type(filler_info);
+
         TypeInfo string_info;
-        string_info.size = sizeof(void*) + sizeof(size_t);  // ptr + length
-        string_info.ref_offsets = {};  // No GC refs in string
-        string_info.is_array = false;
-        common_types_.string_type = register_type(string_info);
-        
-        // Array type (generic)
+        string_info.type_id = TYPE_STRING;
+        string_info.name = "String";
+        register_type(string_info);
+
         TypeInfo array_info;
-        array_info.size = sizeof(void*) + sizeof(size_t) * 2;  // ptr + length + capacity
+        array_info.type_id = TYPE_ARRAY;
+        array_info.name = "Array";
         array_info.is_array = true;
-        array_info.elements_are_refs = true;  // Conservative
-        common_types_.array_type = register_type(array_info);
-        
-        // Object type (generic)
+        array_info.element_size = sizeof(void*);
+        array_info.elements_are_refs = true;
+        array_info.scan_conservatively = true;
+        register_type(array_info);
+
         TypeInfo object_info;
-        object_info.size = sizeof(void*) * 4;  // Placeholder
-        object_info.is_array = false;
-        common_types_.object_type = register_type(object_info);
-        
-        // Closure type
-        TypeInfo closure_info;
-        closure_info.size = sizeof(void*) * 3;  // function + env + captures
-        closure_info.ref_offsets = {sizeof(void*), sizeof(void*) * 2};  // env and captures are refs
-        common_types_.closure_type = register_type(closure_info);
-        
-        // Promise type
-        TypeInfo promise_info;
-        promise_info.size = sizeof(void*) * 4;  // state + value + callbacks + next
-        promise_info.ref_offsets = {sizeof(void*), sizeof(void*) * 2, sizeof(void*) * 3};
-        common_types_.promise_type = register_type(promise_info);
-        
-        // Goroutine type
-        TypeInfo goroutine_info;
-        goroutine_info.size = sizeof(void*) * 8;  // Complex structure
-        goroutine_info.ref_offsets = {0, sizeof(void*), sizeof(void*) * 2};  // Various refs
-        common_types_.goroutine_type = register_type(goroutine_info);
+        object_info.type_id = TYPE_OBJECT;
+        object_info.name = "Object";
+        object_info.scan_conservatively = true;
+        register_type(object_info);
+
+        TypeInfo buffer_info;
+        buffer_info.type_id = TYPE_BUFFER;
+        buffer_info.name = "Buffer";
+        register_type(buffer_info);
+
+        // Elements are plain doubles; the handle's one reference is its
+        // storage, so both are traced precisely and may move
+        TypeInfo numeric_array_info;
+        numeric_array_info.type_id = TYPE_NUMERIC_ARRAY;
+        numeric_array_info.name = "NumericArray";
+        numeric_array_info.ref_offsets = {16};
+        register_type(numeric_array_info);
+
+        TypeInfo numeric_data_info;
+        numeric_data_info.type_id = TYPE_NUMERIC_ARRAY_DATA;
+        numeric_data_info.name = "(numeric array data)";
+        register_type(numeric_data_info);
+
+        // Weak slots are not ref_offsets - only the collector's weak
+        // processing visits them
+        TypeInfo weak_ref_info;
+        weak_ref_info.type_id = TYPE_WEAK_REF;
+        weak_ref_info.name = "WeakRef";
+        weak_ref_info.has_weak_refs = true;
+        register_type(weak_ref_info);
+
+        TypeInfo weak_map_info;
+        weak_map_info.type_id = TYPE_WEAK_MAP;
+        weak_map_info.name = "WeakMap";
+        weak_map_info.ref_offsets = {0};
+        register_type(weak_map_info);
+
+        TypeInfo ephemeron_info;
+        ephemeron_info.type_id = TYPE_EPHEMERON_TABLE;
+        ephemeron_info.name = "(ephemeron table)";
+        ephemeron_info.has_weak_refs = true;
+        register_type(ephemeron_info);
+
+        TypeInfo registry_info;
+        registry_info.type_id = TYPE_FINALIZATION_REGISTRY;
+        registry_info.name = "FinalizationRegistry";
+        registry_info.ref_offsets = {0};
+        register_type(registry_info);
+
+        TypeInfo cells_info;
+        cells_info.type_id = TYPE_FINALIZATION_CELLS;
+        cells_info.name = "(finalization cells)";
+        cells_info.has_weak_refs = true;
+        register_type(cells_info);
     }
-    
-    // Get common type IDs
-    uint32_t get_string_type() const { return common_types_.string_type; }
-    uint32_t get_array_type() const { return common_types_.array_type; }
-    uint32_t get_object_type() const { return common_types_.object_type; }
-    uint32_t get_closure_type() const { return common_types_.closure_type; }
-    uint32_t get_promise_type() const { return common_types_.promise_type; }
-    uint32_t get_goroutine_type() const { return common_types_.goroutine_type; }
-    
+
     // Helper for array types
     uint32_t register_array_type(size_t element_size, bool elements_are_refs) {
         TypeInfo info;
@@ -126,12 +182,6 @@ public:
         info.size = sizeof(size_t) + sizeof(void*);  // length + data ptr
         return register_type(info);
     }
-    
-    // Clear all types (for shutdown)
-    void clear() {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        types_.clear();
-    }
 };
 
 // ============================================================================
@@ -148,39 +198,40 @@ inline void* get_array_data(void* array_obj) {
     return reinterpret_cast<void**>(static_cast<uint8_t*>(array_obj) + sizeof(size_t));
 }
 
-// Iterate over array elements that are references
+// Iterate over array element slots that hold references
 template<typename Callback>
 inline void iterate_array_refs(void* array_obj, const TypeInfo* type_info, Callback callback) {
     if (!type_info->is_array || !type_info->elements_are_refs) return;
-    
+
     size_t length = get_array_length(array_obj);
     void** elements = reinterpret_cast<void**>(get_array_data(array_obj));
-    
+
     for (size_t i = 0; i < length; ++i) {
         if (elements[i]) {
-            callback(elements[i]);
+            callback(&elements[i]);
         }
     }
 }
 
-// Iterate over object references
+// Iterate over object reference slots
 template<typename Callback>
 inline void iterate_object_refs(void* obj, const TypeInfo* type_info, Callback callback) {
     uint8_t* obj_bytes = static_cast<uint8_t*>(obj);
-    
+
     for (size_t offset : type_info->ref_offsets) {
         void** ref_ptr = reinterpret_cast<void**>(obj_bytes + offset);
         if (*ref_ptr) {
-            callback(*ref_ptr);
+            callback(ref_ptr);
         }
     }
 }
 
-// Combined iterator for any object
+// Combined iterator for any precisely-typed object - passes each slot so
+// moving collectors can update it
 template<typename Callback>
 inline void iterate_refs(void* obj, const TypeInfo* type_info, Callback callback) {
     if (!type_info) return;
-    
+
     if (type_info->is_array) {
         iterate_array_refs(obj, type_info, callback);
     } else {
@@ -188,4 +239,4 @@ inline void iterate_refs(void* obj, const TypeInfo* type_info, Callback callback
     }
 }
 
-} // namespace gots
\ No newline at end of file
+} // namespace gots
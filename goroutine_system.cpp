@@ -1,5 +1,6 @@
 #include "goroutine_system.h"
 #include "goroutine_advanced.h"
+#include "gc_memory_manager.h"
 #include <iostream>
 #include <algorithm>
 
@@ -8,9 +9,8 @@ namespace gots {
 // Thread-local current goroutine
 thread_local std::shared_ptr<Goroutine> current_goroutine = nullptr;
 
-// Global cancelled timers
-std::unordered_set<int64_t> g_cancelled_timers;
-std::mutex g_cancelled_timers_mutex;
+// Goroutine a non-goroutine thread is bound to, or -1
+static thread_local int64_t event_loop_owner_id = -1;
 
 // Global goroutine counter
 std::atomic<int64_t> g_active_goroutine_count{0};
@@ -70,6 +70,11 @@ void Goroutine::run() {
     // Set thread-local current goroutine
     current_goroutine = shared_from_this();
     
+    // The collector has to scan this thread's stack. Other goroutines
+    // allocate from a private heap that is freed when they complete
+    GarbageCollector& gc = GarbageCollector::instance();
+    gc.register_current_thread();
+    if (!is_main_goroutine_) gc.attach_private_heap();
     
     try {
         // Execute the main task
@@ -84,6 +89,9 @@ void Goroutine::run() {
     // This handles timers, children, server handles, etc.
     run_event_loop();
     
+    // Only what was published to other goroutines outlives this one
+    gc.release_private_heap();
+    
     state_ = GoroutineState::COMPLETED;
     
     // Notify parent that we're done
@@ -100,6 +108,9 @@ void Goroutine::run() {
 
 // Node.js-style event loop - handles ALL async operations
 void Goroutine::run_event_loop() {
+    // Reused across iterations, so firing timers does not allocate
+    std::vector<TimerNode*> expired;
+    std::vector<int64_t> ready_ids;
     
     while (!should_exit_.load()) {
         std::unique_lock<std::mutex> lock(event_loop_mutex_);
@@ -111,83 +122,70 @@ void Goroutine::run_event_loop() {
             break;
         }
         
-        // Clean up cancelled timers first
-        std::vector<Timer> remaining_timers;
-        while (!timer_queue_.empty()) {
-            Timer timer = timer_queue_.top();
-            timer_queue_.pop();
-            
-            {
-                std::lock_guard<std::mutex> cancel_lock(g_cancelled_timers_mutex);
-                if (g_cancelled_timers.find(timer.id) == g_cancelled_timers.end()) {
-                    remaining_timers.push_back(timer);
-                } else {
-                    g_cancelled_timers.erase(timer.id);
-                }
-            }
-        }
-        
-        // Re-add non-cancelled timers
-        for (const auto& timer : remaining_timers) {
-            timer_queue_.push(timer);
-        }
-        
-        // Find next timer time if we have any timers
-        std::chrono::steady_clock::time_point next_wake_time;
-        bool has_timer = !timer_queue_.empty();
-        if (has_timer) {
-            next_wake_time = timer_queue_.top().execute_time;
-        }
-        
-        auto now = std::chrono::steady_clock::now();
-        
-        // Check for ready timers and collect them
-        std::vector<Timer> ready_timers;
-        while (!timer_queue_.empty() && timer_queue_.top().execute_time <= now) {
-            Timer timer = timer_queue_.top();
-            timer_queue_.pop();
-            ready_timers.push_back(timer);
-        }
+        // Collect expired timers - cancelled ones were already unlinked
+        expired.clear();
+        timer_wheel_.advance(std::chrono::steady_clock::now(), expired);
         
         // Execute timers outside the lock to prevent deadlock
-        if (!ready_timers.empty()) {
+        if (!expired.empty()) {
+            ready_ids.clear();
+            for (TimerNode* node : expired) {
+                ready_ids.push_back(node->id);
+            }
             lock.unlock();
             
-            for (const auto& timer : ready_timers) {
-                
-                // Reschedule if interval timer (reacquire lock briefly)
-                if (timer.is_interval) {
-                    {
-                        std::lock_guard<std::mutex> relock(event_loop_mutex_);
-                        Timer rescheduled_timer = timer;
-                        rescheduled_timer.execute_time = now + std::chrono::milliseconds(timer.interval_ms);
-                        timer_queue_.push(rescheduled_timer);
+            for (int64_t timer_id : ready_ids) {
+                void* function_address;
+                {
+                    // An earlier callback in this batch may have cancelled it
+                    std::lock_guard<std::mutex> relock(event_loop_mutex_);
+                    auto it = timers_.find(timer_id);
+                    if (it == timers_.end()) {
+                        continue;
+                    }
+                    TimerNode* node = it->second.get();
+                    function_address = node->function_address;
+                    
+                    // Reschedule if interval timer, otherwise release the node
+                    if (node->is_interval) {
+                        timer_wheel_.schedule(node, node->interval_ms);
+                    } else {
+                        timers_.erase(it);
                     }
                 }
                 
                 try {
                     typedef void (*TimerCallback)();
-                    TimerCallback callback = reinterpret_cast<TimerCallback>(timer.function_address);
+                    TimerCallback callback = reinterpret_cast<TimerCallback>(function_address);
                     callback();
                 } catch (const std::exception& e) {
-                    std::cerr << "ERROR: Timer " << timer.id << " exception: " << e.what() << std::endl;
+                    std::cerr << "ERROR: Timer " << timer_id << " exception: " << e.what() << std::endl;
                 } catch (...) {
-                    std::cerr << "ERROR: Timer " << timer.id << " unknown exception" << std::endl;
+                    std::cerr << "ERROR: Timer " << timer_id << " unknown exception" << std::endl;
                 }
             }
             
-            lock.lock();
-            now = std::chrono::steady_clock::now();
+            // Callbacks may have added or cancelled timers - recompute
+            continue;
+        }
+        
+        bool has_timer = !timer_wheel_.empty();
+        std::chrono::steady_clock::time_point next_wake_time;
+        if (has_timer) {
+            next_wake_time = timer_wheel_.next_wake_time();
         }
         
-        // Wait for next event (timer or trigger)
+        // Wait for next event (timer or trigger). Other threads add timers
+        // too (bound handler threads), so a new one ends the wait and the
+        // wake time is recomputed
+        int64_t seen_timer_seq = next_timer_seq_;
         if (has_timer) {
-            event_loop_cv_.wait_until(lock, next_wake_time, [this] {
-                return should_exit_.load();
+            event_loop_cv_.wait_until(lock, next_wake_time, [this, seen_timer_seq] {
+                return should_exit_.load() || next_timer_seq_ != seen_timer_seq;
             });
         } else {
-            event_loop_cv_.wait(lock, [this] {
-                return should_exit_.load() || !has_active_operations();
+            event_loop_cv_.wait(lock, [this, seen_timer_seq] {
+                return should_exit_.load() || next_timer_seq_ != seen_timer_seq || !has_active_operations();
             });
         }
     }
@@ -199,6 +197,7 @@ int64_t Goroutine::add_async_operation(AsyncOpType type, void* handle_data) {
     std::lock_guard<std::mutex> lock(event_loop_mutex_);
     int64_t async_id = next_async_id_.fetch_add(1);
     async_operations_[async_id] = AsyncOperation(async_id, type, handle_data);
+    active_async_operations_++;
     
     trigger_event_loop();
     return async_id;
@@ -208,6 +207,7 @@ void Goroutine::complete_async_operation(int64_t async_id) {
     std::lock_guard<std::mutex> lock(event_loop_mutex_);
     auto it = async_operations_.find(async_id);
     if (it != async_operations_.end()) {
+        if (it->second.is_active) active_async_operations_--;
         async_operations_.erase(it);
         trigger_event_loop();
     }
@@ -217,6 +217,7 @@ void Goroutine::cancel_async_operation(int64_t async_id) {
     std::lock_guard<std::mutex> lock(event_loop_mutex_);
     auto it = async_operations_.find(async_id);
     if (it != async_operations_.end()) {
+        if (it->second.is_active) active_async_operations_--;
         it->second.is_active = false;
         trigger_event_loop();
     }
@@ -224,17 +225,13 @@ void Goroutine::cancel_async_operation(int64_t async_id) {
 
 bool Goroutine::has_active_operations() const {
     // Check timers
-    if (!timer_queue_.empty()) return true;
+    if (!timer_wheel_.empty()) return true;
     
     // Check children
     if (child_count_.load() > 0) return true;
     
     // Check async operations
-    for (const auto& op : async_operations_) {
-        if (op.second.is_active) return true;
-    }
-    
-    return false;
+    return active_async_operations_ > 0;
 }
 
 void Goroutine::trigger_event_loop() {
@@ -243,29 +240,43 @@ void Goroutine::trigger_event_loop() {
 }
 
 int64_t Goroutine::add_timer(int64_t delay_ms, void* function_address, bool is_interval) {
-    Timer timer;
-    timer.id = GoroutineScheduler::instance().get_next_timer_id();
-    timer.execute_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
-    timer.function_address = function_address;
-    timer.is_interval = is_interval;
-    timer.interval_ms = delay_ms;
-    
+    int64_t timer_id;
     {
         std::lock_guard<std::mutex> lock(event_loop_mutex_);
-        timer_queue_.push(timer);
+        timer_id = (id_ << 32) | (next_timer_seq_++ & 0xFFFFFFFF);
+        
+        TimerPtr node(SlabAllocator<TimerNode>::create());
+        node->id = timer_id;
+        node->function_address = function_address;
+        node->is_interval = is_interval;
+        node->interval_ms = delay_ms;
+        timer_wheel_.schedule(node.get(), delay_ms);
+        timers_[timer_id] = std::move(node);
     }
     
     trigger_event_loop();
-    return timer.id;
+    return timer_id;
 }
 
 bool Goroutine::cancel_timer(int64_t timer_id) {
-    std::lock_guard<std::mutex> lock(g_cancelled_timers_mutex);
-    g_cancelled_timers.insert(timer_id);
+    std::lock_guard<std::mutex> lock(event_loop_mutex_);
+    auto it = timers_.find(timer_id);
+    if (it == timers_.end()) {
+        return false;
+    }
+    
+    // O(1) unlink from the wheel - no global set, no heap rebuild
+    timer_wheel_.cancel(it->second.get());
+    timers_.erase(it);
     trigger_event_loop();
     return true;
 }
 
+void Goroutine::set_timer_slack(int64_t slack_ms) {
+    std::lock_guard<std::mutex> lock(event_loop_mutex_);
+    timer_wheel_.set_slack(slack_ms > 0 ? static_cast<uint64_t>(slack_ms) : 0);
+}
+
 void Goroutine::signal_exit() {
     should_exit_.store(true);
     trigger_event_loop();
@@ -382,69 +393,115 @@ void GoroutineScheduler::unregister_goroutine(int64_t id) {
     goroutines_.erase(id);
 }
 
+std::shared_ptr<Goroutine> GoroutineScheduler::find_goroutine(int64_t id) const {
+    std::lock_guard<std::mutex> lock(goroutines_mutex_);
+    auto it = goroutines_.find(id);
+    return it != goroutines_.end() ? it->second : nullptr;
+}
+
 size_t GoroutineScheduler::get_active_count() const {
     std::lock_guard<std::mutex> lock(goroutines_mutex_);
     return goroutines_.size();
 }
 
+void bind_event_loop_owner(int64_t goroutine_id) {
+    event_loop_owner_id = goroutine_id;
+}
+
+// The goroutine whose event loop takes this thread's timers and async
+// handles: its own, or the one it is bound to, which `bound` keeps alive.
+// The event loop methods lock, so bound threads may call them concurrently
+static Goroutine* event_loop_goroutine(std::shared_ptr<Goroutine>& bound) {
+    if (current_goroutine) return current_goroutine.get();
+    if (event_loop_owner_id >= 0) {
+        bound = GoroutineScheduler::instance().find_goroutine(event_loop_owner_id);
+    }
+    return bound.get();
+}
+
 // C interface implementation
 extern "C" {
 
 int64_t __gots_set_timeout(void* function_address, int64_t delay_ms) {
-    if (!current_goroutine) {
+    std::shared_ptr<Goroutine> bound;
+    Goroutine* goroutine = event_loop_goroutine(bound);
+    if (!goroutine) {
         std::cerr << "ERROR: setTimeout called outside goroutine context" << std::endl;
         return -1;
     }
     
-    return current_goroutine->add_timer(delay_ms, function_address, false);
+    return goroutine->add_timer(delay_ms, function_address, false);
 }
 
 int64_t __gots_set_interval(void* function_address, int64_t delay_ms) {
-    if (!current_goroutine) {
+    std::shared_ptr<Goroutine> bound;
+    Goroutine* goroutine = event_loop_goroutine(bound);
+    if (!goroutine) {
         std::cerr << "ERROR: setInterval called outside goroutine context" << std::endl;
         return -1;
     }
     
-    return current_goroutine->add_timer(delay_ms, function_address, true);
+    return goroutine->add_timer(delay_ms, function_address, true);
 }
 
 bool __gots_clear_timeout(int64_t timer_id) {
-    // Timer cancellation works globally
-    std::lock_guard<std::mutex> lock(g_cancelled_timers_mutex);
-    g_cancelled_timers.insert(timer_id);
-    return true;
+    // Timer cancellation works globally - the ID tells us which goroutine owns it
+    int64_t owner_id = Goroutine::timer_owner_id(timer_id);
+    if (current_goroutine && current_goroutine->get_id() == owner_id) {
+        return current_goroutine->cancel_timer(timer_id);
+    }
+    
+    auto owner = GoroutineScheduler::instance().find_goroutine(owner_id);
+    return owner ? owner->cancel_timer(timer_id) : false;
 }
 
 bool __gots_clear_interval(int64_t timer_id) {
     return __gots_clear_timeout(timer_id);
 }
 
+void __gots_set_timer_slack(int64_t slack_ms) {
+    std::shared_ptr<Goroutine> bound;
+    Goroutine* goroutine = event_loop_goroutine(bound);
+    if (!goroutine) {
+        std::cerr << "ERROR: set_timer_slack called outside goroutine context" << std::endl;
+        return;
+    }
+    
+    goroutine->set_timer_slack(slack_ms);
+}
+
 // Async operation C interface
 int64_t __gots_add_async_handle(int64_t type, void* handle_data) {
-    if (!current_goroutine) {
+    std::shared_ptr<Goroutine> bound;
+    Goroutine* goroutine = event_loop_goroutine(bound);
+    if (!goroutine) {
         std::cerr << "ERROR: add_async_handle called outside goroutine context" << std::endl;
         return -1;
     }
     
-    return current_goroutine->add_async_operation(static_cast<AsyncOpType>(type), handle_data);
+    return goroutine->add_async_operation(static_cast<AsyncOpType>(type), handle_data);
 }
 
 void __gots_complete_async_handle(int64_t async_id) {
-    if (!current_goroutine) {
+    std::shared_ptr<Goroutine> bound;
+    Goroutine* goroutine = event_loop_goroutine(bound);
+    if (!goroutine) {
         std::cerr << "ERROR: complete_async_handle called outside goroutine context" << std::endl;
         return;
     }
     
-    current_goroutine->complete_async_operation(async_id);
+    goroutine->complete_async_operation(async_id);
 }
 
 void __gots_cancel_async_handle(int64_t async_id) {
-    if (!current_goroutine) {
+    std::shared_ptr<Goroutine> bound;
+    Goroutine* goroutine = event_loop_goroutine(bound);
+    if (!goroutine) {
         std::cerr << "ERROR: cancel_async_handle called outside goroutine context" << std::endl;
         return;
     }
     
-    current_goroutine->cancel_async_operation(async_id);
+    goroutine->cancel_async_operation(async_id);
 }
 
 void __runtime_spawn_main_goroutine(void* function_address) {
@@ -10,7 +10,8 @@
 #include <functional>
 #include <chrono>
 #include <unordered_map>
-#include <unordered_set>
+#include "timer_wheel.h"
+#include "slab_allocator.h"
 
 namespace gots {
 
@@ -20,19 +21,6 @@ class GoroutineScheduler;
 template<typename T> class Channel;
 class SharedMemoryPool;
 
-// Timer structure using function ADDRESS as ID (not pointer)
-struct Timer {
-    int64_t id;
-    std::chrono::steady_clock::time_point execute_time;
-    void* function_address;  // Use address as stable ID, not function pointer
-    bool is_interval;
-    int64_t interval_ms;
-    
-    bool operator>(const Timer& other) const {
-        return execute_time > other.execute_time;
-    }
-};
-
 // Async operation types for event loop
 enum class AsyncOpType {
     TIMER,
@@ -71,9 +59,17 @@ private:
     GoroutineState state_;
     std::thread thread_;
     
-    // Event loop components
-    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timer_queue_;
-    std::unordered_map<int64_t, AsyncOperation> async_operations_;
+    // Event loop components. Timer nodes and the tables' entries come from
+    // slabs, so setTimeout and async handles do not malloc once warmed up
+    using TimerPtr = std::unique_ptr<TimerNode, SlabDeleter<TimerNode>>;
+    template <typename V>
+    using SlabTable = std::unordered_map<int64_t, V, std::hash<int64_t>, std::equal_to<int64_t>,
+                                         PoolAllocator<std::pair<const int64_t, V>>>;
+    TimerWheel timer_wheel_;
+    SlabTable<TimerPtr> timers_;  // Owns every live timer node
+    int64_t next_timer_seq_{1};
+    SlabTable<AsyncOperation> async_operations_;
+    size_t active_async_operations_ = 0;  // is_active entries of async_operations_
     mutable std::mutex event_loop_mutex_;
     std::condition_variable event_loop_cv_;
     std::atomic<bool> should_exit_{false};
@@ -99,9 +95,11 @@ public:
     // Start execution
     void start();
     
-    // Timer management
+    // Timer management - IDs encode the owning goroutine so any goroutine can cancel
     int64_t add_timer(int64_t delay_ms, void* function_address, bool is_interval);
     bool cancel_timer(int64_t timer_id);
+    void set_timer_slack(int64_t slack_ms);
+    static int64_t timer_owner_id(int64_t timer_id) { return timer_id >> 32; }
     
     // Async operation management - Node.js style
     int64_t add_async_operation(AsyncOpType type, void* handle_data = nullptr);
@@ -146,7 +144,6 @@ private:
     std::unordered_map<int64_t, std::shared_ptr<Goroutine>> goroutines_;
     mutable std::mutex goroutines_mutex_;
     std::atomic<int64_t> next_goroutine_id_{1};
-    std::atomic<int64_t> next_timer_id_{1};
     std::shared_ptr<Goroutine> main_goroutine_;
     
     // Main thread completion synchronization
@@ -175,27 +172,22 @@ public:
     // Signal main goroutine completion
     void signal_main_goroutine_completion();
     
-    // Get next timer ID
-    int64_t get_next_timer_id() { return next_timer_id_.fetch_add(1); }
-    
     // Register/unregister goroutines
     void register_goroutine(std::shared_ptr<Goroutine> g);
     void unregister_goroutine(int64_t id);
+    std::shared_ptr<Goroutine> find_goroutine(int64_t id) const;
     
     // Get active goroutine count
     size_t get_active_count() const;
 };
 
-// Global cancelled timers set
-extern std::unordered_set<int64_t> g_cancelled_timers;
-extern std::mutex g_cancelled_timers_mutex;
-
 // Timer and async operation functions
 extern "C" {
     int64_t __gots_set_timeout(void* function_address, int64_t delay_ms);
     int64_t __gots_set_interval(void* function_address, int64_t delay_ms);
     bool __gots_clear_timeout(int64_t timer_id);
     bool __gots_clear_interval(int64_t timer_id);
+    void __gots_set_timer_slack(int64_t slack_ms);
     
     // Async operation functions
     int64_t __gots_add_async_handle(int64_t type, void* handle_data);
@@ -210,4 +202,11 @@ extern "C" {
 // Current goroutine (thread-local)
 extern thread_local std::shared_ptr<Goroutine> current_goroutine;
 
+// Binds a thread that runs code for a goroutine without being one (an HTTP
+// handler worker) to that goroutine by id, or unbinds it with -1. Timers and
+// async handles created on the thread go to the bound goroutine's event
+// loop; current_goroutine stays unset, since several threads may be bound
+// to one goroutine at once
+void bind_event_loop_owner(int64_t goroutine_id);
+
 } // namespace gots
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "heap_profile.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace gots {
+
+// ============================================================================
+// PPROF ENCODING - the parts of profile.proto a heap profile needs
+// ============================================================================
+
+namespace {
+
+class ProtoWriter {
+    std::string out_;
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+    void key(int field, int wire_type) { varint(static_cast<uint64_t>(field) << 3 | wire_type); }
+
+public:
+    // Zero is the default and is left out, as protobuf encoders do
+    void integer(int field, int64_t value) {
+        if (value == 0) return;
+        key(field, 0);
+        varint(static_cast<uint64_t>(value));
+    }
+    void bytes(int field, const std::string& value) {
+        key(field, 2);
+        varint(value.size());
+        out_ += value;
+    }
+    void message(int field, const ProtoWriter& nested) { bytes(field, nested.out_); }
+    template <typename T> void packed(int field, const std::vector<T>& values) {
+        ProtoWriter nested;
+        for (T value : values) nested.varint(static_cast<uint64_t>(value));
+        bytes(field, nested.out_);
+    }
+    const std::string& data() const { return out_; }
+};
+
+// Profile message fields
+enum ProfileField {
+    SAMPLE_TYPE = 1, SAMPLE = 2, LOCATION = 4, FUNCTION = 5, STRING_TABLE = 6,
+    TIME_NANOS = 9, DURATION_NANOS = 10, PERIOD_TYPE = 11, PERIOD = 12, DEFAULT_SAMPLE_TYPE = 14
+};
+
+} // namespace
+
+bool HeapProfile::write_pprof(const std::string& path) const {
+    std::vector<std::string> strings = {""};
+    std::unordered_map<std::string, int64_t> string_index = {{"", 0}};
+    auto intern = [&](const std::string& s) {
+        auto it = string_index.find(s);
+        if (it != string_index.end()) return it->second;
+        int64_t index = static_cast<int64_t>(strings.size());
+        strings.push_back(s);
+        string_index[s] = index;
+        return index;
+    };
+    auto value_type = [&](const char* type, const char* unit) {
+        ProtoWriter message;
+        message.integer(1, intern(type));
+        message.integer(2, intern(unit));
+        return message;
+    };
+
+    ProtoWriter profile;
+    // The sample types of Go heap profiles, so pprof's -sample_index names work
+    profile.message(SAMPLE_TYPE, value_type("alloc_objects", "count"));
+    profile.message(SAMPLE_TYPE, value_type("alloc_space", "bytes"));
+    profile.message(SAMPLE_TYPE, value_type("inuse_objects", "count"));
+    profile.message(SAMPLE_TYPE, value_type("inuse_space", "bytes"));
+
+    for (const Stack& stack : stacks) {
+        ProtoWriter sample;
+        std::vector<uint64_t> location_ids;
+        for (uint32_t location : stack.locations) location_ids.push_back(location + 1);
+        sample.packed(1, location_ids);
+        sample.packed(2, std::vector<int64_t>{stack.alloc_objects, stack.alloc_bytes,
+                                              stack.inuse_objects, stack.inuse_bytes});
+        profile.message(SAMPLE, sample);
+    }
+
+    // One function per name
+    std::unordered_map<std::string, uint64_t> function_ids;
+    std::vector<const std::string*> functions;
+    for (size_t i = 0; i < locations.size(); ++i) {
+        const Location& location = locations[i];
+        auto inserted = function_ids.insert({location.function, function_ids.size() + 1});
+        if (inserted.second) functions.push_back(&location.function);
+
+        ProtoWriter line;
+        line.integer(1, static_cast<int64_t>(inserted.first->second));
+        ProtoWriter message;
+        message.integer(1, static_cast<int64_t>(i + 1));
+        message.integer(3, static_cast<int64_t>(location.address));
+        message.message(4, line);
+        profile.message(LOCATION, message);
+    }
+    for (size_t i = 0; i < functions.size(); ++i) {
+        ProtoWriter message;
+        int64_t name = intern(*functions[i]);
+        message.integer(1, static_cast<int64_t>(i + 1));
+        message.integer(2, name);
+        message.integer(3, name);
+        profile.message(FUNCTION, message);
+    }
+
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    profile.integer(TIME_NANOS, std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    profile.integer(DURATION_NANOS, duration_nanos);
+    profile.message(PERIOD_TYPE, value_type("space", "bytes"));
+    profile.integer(PERIOD, sample_rate);
+    profile.integer(DEFAULT_SAMPLE_TYPE, intern("inuse_space"));
+    // Last, once every string is interned
+    for (const std::string& s : strings) profile.bytes(STRING_TABLE, s);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.write(profile.data().data(), profile.data().size())) {
+        std::cerr << "ERROR: Cannot write heap profile " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace gots
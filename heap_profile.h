@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gots {
+
+// ============================================================================
+// HEAP PROFILE - sampled allocations per JIT call stack
+// ============================================================================
+//
+// Filled by GarbageCollector::get_heap_profile. Each sample stands for the
+// bytes its thread allocated since the previous one, so the counts are
+// estimates of everything allocated, not just of the sampled objects.
+// In-use counts drop as sampled objects die.
+
+struct HeapProfile {
+    struct Location {
+        uint64_t address;       // Return address into JIT code, 0 if none
+        std::string function;
+    };
+
+    struct Stack {
+        std::vector<uint32_t> locations;    // Into locations, innermost first
+        int64_t alloc_objects = 0;
+        int64_t alloc_bytes = 0;
+        int64_t inuse_objects = 0;
+        int64_t inuse_bytes = 0;
+    };
+
+    std::vector<Location> locations;
+    std::vector<Stack> stacks;
+    int64_t sample_rate = 0;
+    int64_t duration_nanos = 0;
+
+    // pprof's profile.proto, uncompressed - `pprof` reads it as it is.
+    // Reports what went wrong on std::cerr
+    bool write_pprof(const std::string& path) const;
+};
+
+} // namespace gots
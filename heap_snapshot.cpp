@@ -0,0 +1,360 @@
+#include "heap_snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+
+namespace gots {
+
+// ============================================================================
+// SNAPSHOT LOADING
+// ============================================================================
+
+namespace {
+
+class SnapshotReader {
+    const std::vector<uint8_t>& data_;
+    size_t offset_ = 0;
+
+public:
+    explicit SnapshotReader(const std::vector<uint8_t>& data) : data_(data) {}
+
+    bool read(void* out, size_t bytes) {
+        if (data_.size() - offset_ < bytes) return false;
+        memcpy(out, data_.data() + offset_, bytes);
+        offset_ += bytes;
+        return true;
+    }
+    template <typename T> bool read(T& value) { return read(&value, sizeof(T)); }
+    size_t remaining() const { return data_.size() - offset_; }
+};
+
+} // namespace
+
+bool HeapSnapshot::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ERROR: Cannot open heap snapshot " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    SnapshotReader reader(data);
+    auto truncated = [&]() {
+        std::cerr << "ERROR: Heap snapshot " << path << " is truncated" << std::endl;
+        return false;
+    };
+
+    char magic[sizeof(HeapSnapshotFormat::MAGIC)];
+    uint32_t version = 0;
+    uint32_t reserved = 0;
+    uint64_t object_count = 0;
+    uint64_t root_count = 0;
+    if (!reader.read(magic, sizeof(magic)) || memcmp(magic, HeapSnapshotFormat::MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "ERROR: " << path << " is not a heap snapshot" << std::endl;
+        return false;
+    }
+    if (!reader.read(version) || !reader.read(reserved) || !reader.read(object_count) || !reader.read(root_count)) {
+        return truncated();
+    }
+    if (version != HeapSnapshotFormat::VERSION) {
+        std::cerr << "ERROR: Heap snapshot version " << version << " is not supported" << std::endl;
+        return false;
+    }
+    // Every record takes at least 24 bytes - reject counts the file cannot hold
+    if (object_count > reader.remaining() / 24) return truncated();
+
+    objects.clear();
+    edges.clear();
+    roots.clear();
+    names.clear();
+    objects.reserve(object_count);
+    for (uint64_t i = 0; i < object_count; ++i) {
+        Object object;
+        if (!reader.read(object.address) || !reader.read(object.size) || !reader.read(object.name) ||
+            !reader.read(object.site) || !reader.read(object.edge_count)) {
+            return truncated();
+        }
+        if (object.edge_count > reader.remaining() / sizeof(uint32_t)) return truncated();
+        object.first_edge = static_cast<uint32_t>(edges.size());
+        edges.resize(edges.size() + object.edge_count);
+        reader.read(edges.data() + object.first_edge, object.edge_count * sizeof(uint32_t));
+        objects.push_back(object);
+    }
+
+    if (root_count > reader.remaining() / sizeof(uint32_t)) return truncated();
+    roots.resize(root_count);
+    reader.read(roots.data(), root_count * sizeof(uint32_t));
+
+    uint32_t name_count = 0;
+    if (!reader.read(name_count)) return truncated();
+    for (uint32_t i = 0; i < name_count; ++i) {
+        uint32_t length = 0;
+        if (!reader.read(length) || length > reader.remaining()) return truncated();
+        std::string name(length, '\0');
+        reader.read(&name[0], length);
+        names.push_back(std::move(name));
+    }
+
+    // Indices are trusted from here on
+    for (uint32_t edge : edges) {
+        if (edge >= objects.size()) {
+            std::cerr << "ERROR: Heap snapshot " << path << " references a missing object" << std::endl;
+            return false;
+        }
+    }
+    for (uint32_t root : roots) {
+        if (root >= objects.size()) {
+            std::cerr << "ERROR: Heap snapshot " << path << " has a missing root" << std::endl;
+            return false;
+        }
+    }
+    for (const Object& object : objects) {
+        if (object.name >= names.size()) {
+            std::cerr << "ERROR: Heap snapshot " << path << " has a missing name" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t HeapSnapshot::find(uint64_t address) const {
+    auto it = std::lower_bound(objects.begin(), objects.end(), address,
+                               [](const Object& object, uint64_t a) { return object.address < a; });
+    return it != objects.end() && it->address == address ? it - objects.begin() : objects.size();
+}
+
+// ============================================================================
+// DOMINATORS AND RETAINED SIZES
+// ============================================================================
+
+HeapAnalysis::HeapAnalysis(const HeapSnapshot& snapshot) {
+    // Cooper, Harvey and Kennedy's iterative algorithm over reverse postorder
+    const uint32_t root = static_cast<uint32_t>(snapshot.objects.size());
+    const size_t node_count = snapshot.objects.size() + 1;
+    auto successors = [&](uint32_t node) -> std::pair<const uint32_t*, const uint32_t*> {
+        if (node == root) return {snapshot.roots.data(), snapshot.roots.data() + snapshot.roots.size()};
+        const HeapSnapshot::Object& object = snapshot.objects[node];
+        const uint32_t* first = snapshot.edges.data() + object.first_edge;
+        return {first, first + object.edge_count};
+    };
+
+    // Depth-first postorder from the root
+    std::vector<uint32_t> postorder_number(node_count, UNREACHABLE);
+    std::vector<uint32_t> postorder;
+    std::vector<bool> visited(node_count, false);
+    std::vector<std::pair<uint32_t, const uint32_t*>> stack;
+    visited[root] = true;
+    stack.push_back({root, successors(root).first});
+    while (!stack.empty()) {
+        auto& top = stack.back();
+        const uint32_t* end = successors(top.first).second;
+        if (top.second != end) {
+            uint32_t next = *top.second++;
+            if (!visited[next]) {
+                visited[next] = true;
+                stack.push_back({next, successors(next).first});
+            }
+            continue;
+        }
+        postorder_number[top.first] = static_cast<uint32_t>(postorder.size());
+        postorder.push_back(top.first);
+        stack.pop_back();
+    }
+
+    // Predecessors of reachable nodes
+    std::vector<uint32_t> predecessor_start(node_count + 1, 0);
+    for (uint32_t node : postorder) {
+        auto range = successors(node);
+        for (const uint32_t* it = range.first; it != range.second; ++it) predecessor_start[*it + 1]++;
+    }
+    for (size_t i = 0; i < node_count; ++i) predecessor_start[i + 1] += predecessor_start[i];
+    std::vector<uint32_t> predecessors(predecessor_start[node_count]);
+    std::vector<uint32_t> fill(predecessor_start.begin(), predecessor_start.end() - 1);
+    for (uint32_t node : postorder) {
+        auto range = successors(node);
+        for (const uint32_t* it = range.first; it != range.second; ++it) predecessors[fill[*it]++] = node;
+    }
+
+    dominator.assign(node_count, UNREACHABLE);
+    dominator[root] = root;
+    auto intersect = [&](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (postorder_number[a] < postorder_number[b]) a = dominator[a];
+            while (postorder_number[b] < postorder_number[a]) b = dominator[b];
+        }
+        return a;
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = postorder.size() - 1; i-- > 0;) {
+            uint32_t node = postorder[i];
+            uint32_t idom = UNREACHABLE;
+            for (uint32_t j = predecessor_start[node]; j < predecessor_start[node + 1]; ++j) {
+                uint32_t pred = predecessors[j];
+                if (dominator[pred] == UNREACHABLE) continue;
+                idom = idom == UNREACHABLE ? pred : intersect(pred, idom);
+            }
+            if (dominator[node] != idom) {
+                dominator[node] = idom;
+                changed = true;
+            }
+        }
+    }
+    dominator[root] = UNREACHABLE;
+
+    // A dominator finishes after everything it dominates
+    retained.assign(node_count, 0);
+    for (uint32_t node : postorder) {
+        if (node == root) continue;
+        retained[node] += snapshot.objects[node].size;
+        retained[dominator[node]] += retained[node];
+    }
+}
+
+// ============================================================================
+// HEAPSTAT
+// ============================================================================
+
+namespace {
+
+struct RetainedGroup {
+    uint64_t count = 0;
+    uint64_t shallow = 0;
+    uint64_t retained = 0;   // Outermost members only - nested ones are already counted
+    uint32_t name = 0;
+};
+
+void print_groups(const std::vector<std::pair<std::string, RetainedGroup>>& groups, size_t top) {
+    std::cout << std::setw(10) << "count" << std::setw(14) << "shallow" << std::setw(14) << "retained"
+              << "  name" << std::endl;
+    for (size_t i = 0; i < groups.size() && i < top; ++i) {
+        const RetainedGroup& group = groups[i].second;
+        std::cout << std::setw(10) << group.count << std::setw(14) << group.shallow << std::setw(14)
+                  << group.retained << "  " << groups[i].first << std::endl;
+    }
+}
+
+} // namespace
+
+int heapstat_main(int argc, char* argv[]) {
+    std::string path;
+    size_t top = 20;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--top" && i + 1 < argc) {
+            top = std::stoul(argv[++i]);
+        } else if (arg.find("-") != 0) {
+            path = arg;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: gots heapstat <snapshot> [--top N]" << std::endl;
+        return 1;
+    }
+
+    HeapSnapshot snapshot;
+    if (!snapshot.load(path)) return 1;
+    HeapAnalysis analysis(snapshot);
+    const uint32_t root = static_cast<uint32_t>(snapshot.objects.size());
+
+    // Dominator tree children, walked from the root to find which objects
+    // have no dominator of their own type or site
+    std::vector<uint32_t> child_start(root + 2, 0);
+    for (uint32_t i = 0; i < root; ++i) {
+        if (analysis.dominator[i] != HeapAnalysis::UNREACHABLE) child_start[analysis.dominator[i] + 1]++;
+    }
+    for (uint32_t i = 0; i <= root; ++i) child_start[i + 1] += child_start[i];
+    std::vector<uint32_t> children(child_start[root + 1]);
+    std::vector<uint32_t> fill(child_start.begin(), child_start.end() - 1);
+    for (uint32_t i = 0; i < root; ++i) {
+        if (analysis.dominator[i] != HeapAnalysis::UNREACHABLE) children[fill[analysis.dominator[i]]++] = i;
+    }
+
+    std::vector<RetainedGroup> by_name(snapshot.names.size());
+    std::unordered_map<uint32_t, RetainedGroup> by_site;
+    std::vector<uint32_t> open_names(snapshot.names.size(), 0);
+    std::unordered_map<uint32_t, uint32_t> open_sites;
+    uint64_t total_bytes = 0;
+
+    // (node, leaving) pairs
+    std::vector<std::pair<uint32_t, bool>> stack;
+    for (uint32_t j = child_start[root]; j < child_start[root + 1]; ++j) stack.push_back({children[j], false});
+    while (!stack.empty()) {
+        auto entry = stack.back();
+        stack.pop_back();
+        const HeapSnapshot::Object& object = snapshot.objects[entry.first];
+        if (entry.second) {
+            open_names[object.name]--;
+            if (object.site) open_sites[object.site]--;
+            continue;
+        }
+
+        RetainedGroup& name_group = by_name[object.name];
+        name_group.count++;
+        name_group.shallow += object.size;
+        if (open_names[object.name]++ == 0) name_group.retained += analysis.retained[entry.first];
+        if (object.site) {
+            RetainedGroup& site_group = by_site[object.site];
+            site_group.count++;
+            site_group.shallow += object.size;
+            site_group.name = object.name;
+            if (open_sites[object.site]++ == 0) site_group.retained += analysis.retained[entry.first];
+        }
+        total_bytes += object.size;
+
+        stack.push_back({entry.first, true});
+        for (uint32_t j = child_start[entry.first]; j < child_start[entry.first + 1]; ++j) {
+            stack.push_back({children[j], false});
+        }
+    }
+
+    auto by_retained = [](const std::pair<std::string, RetainedGroup>& a,
+                          const std::pair<std::string, RetainedGroup>& b) {
+        return a.second.retained > b.second.retained;
+    };
+
+    std::cout << "Heap snapshot " << path << ": " << snapshot.objects.size() << " objects, "
+              << total_bytes << " bytes, " << snapshot.roots.size() << " roots" << std::endl;
+
+    std::vector<std::pair<std::string, RetainedGroup>> types;
+    for (size_t i = 0; i < by_name.size(); ++i) {
+        if (by_name[i].count) types.push_back({snapshot.names[i], by_name[i]});
+    }
+    std::sort(types.begin(), types.end(), by_retained);
+    std::cout << "\nRetained by type:" << std::endl;
+    print_groups(types, top);
+
+    if (!by_site.empty()) {
+        std::vector<std::pair<std::string, RetainedGroup>> sites;
+        for (const auto& site : by_site) {
+            sites.push_back({"site " + std::to_string(site.first) + " (" + snapshot.names[site.second.name] + ")",
+                             site.second});
+        }
+        std::sort(sites.begin(), sites.end(), by_retained);
+        std::cout << "\nRetained by allocation site (sampled objects):" << std::endl;
+        print_groups(sites, top);
+    }
+
+    std::vector<uint32_t> largest;
+    for (uint32_t i = 0; i < root; ++i) {
+        if (analysis.dominator[i] != HeapAnalysis::UNREACHABLE) largest.push_back(i);
+    }
+    size_t shown = std::min(top, largest.size());
+    std::partial_sort(largest.begin(), largest.begin() + shown, largest.end(),
+                      [&](uint32_t a, uint32_t b) { return analysis.retained[a] > analysis.retained[b]; });
+    std::cout << "\nLargest retainers:" << std::endl;
+    std::cout << std::setw(14) << "retained" << std::setw(10) << "shallow" << std::setw(20) << "address"
+              << "  name" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        const HeapSnapshot::Object& object = snapshot.objects[largest[i]];
+        std::cout << std::setw(14) << analysis.retained[largest[i]] << std::setw(10) << object.size
+                  << "  0x" << std::hex << std::setw(16) << std::setfill('0') << object.address
+                  << std::dec << std::setfill(' ') << "  " << snapshot.names[object.name] << std::endl;
+    }
+    return 0;
+}
+
+} // namespace gots
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gots {
+
+// ============================================================================
+// HEAP SNAPSHOT FORMAT - written by GarbageCollector::write_heap_snapshot
+// ============================================================================
+//
+// Host byte order, no padding:
+//   header   "GOTSHEAP", u32 version, u32 reserved, u64 object count, u64 root count
+//   objects  one record per reachable object, in address order:
+//            u64 address, u32 size, u32 name, u32 site, u32 edge count, u32 edges[]
+//   roots    u32 object indices
+//   names    u32 count, then per name u32 length and its bytes
+//
+// `address` is the object start the program sees and `size` the total,
+// header included. `name` indexes the name table - the object's type, or
+// the class of a TYPE_OBJECT. `site` is the JIT allocation site of objects
+// that were allocation samples, 0 for the rest. Edges are object indices;
+// references found by conservative scanning are edges too.
+
+struct HeapSnapshotFormat {
+    static constexpr char MAGIC[8] = {'G', 'O', 'T', 'S', 'H', 'E', 'A', 'P'};
+    static constexpr uint32_t VERSION = 1;
+};
+
+struct HeapSnapshot {
+    struct Object {
+        uint64_t address;
+        uint32_t size;
+        uint32_t name;
+        uint32_t site;
+        uint32_t first_edge;    // Into edges
+        uint32_t edge_count;
+    };
+
+    std::vector<Object> objects;
+    std::vector<uint32_t> edges;
+    std::vector<uint32_t> roots;
+    std::vector<std::string> names;
+
+    // Reports what is wrong with the file on std::cerr
+    bool load(const std::string& path);
+
+    // Index of the object at `address`, or objects.size()
+    size_t find(uint64_t address) const;
+};
+
+// ============================================================================
+// RETAINED SIZES - dominator tree of the snapshot
+// ============================================================================
+//
+// A virtual root (index objects.size()) references every root. An object
+// dominates another if every path from the root to it passes through it,
+// and retains the bytes of all objects it dominates: what freeing it would
+// free.
+
+struct HeapAnalysis {
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    std::vector<uint32_t> dominator;    // Immediate dominator, UNREACHABLE if none
+    std::vector<uint64_t> retained;     // Bytes, the object's own included
+
+    explicit HeapAnalysis(const HeapSnapshot& snapshot);
+};
+
+// `gots heapstat <snapshot> [--top N]` - retained sizes by type, by
+// allocation site and the largest retainers
+int heapstat_main(int argc, char* argv[]);
+
+} // namespace gots
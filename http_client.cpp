@@ -0,0 +1,670 @@
+#include "http_client.h"
+#include "netpoller.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace gots {
+
+static int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string HttpClientResponse::header(std::string_view name) const {
+    for (const auto& h : headers) {
+        if (http_iequals(h.first, name)) return h.second;
+    }
+    return std::string();
+}
+
+// One request/response pair, from dispatch until its promise resolves
+struct HttpClientExchange {
+    HttpClientRequest request;
+    std::string key;
+    std::string wire;           // Serialized request
+    bool head = false;
+    bool idempotent = false;
+    int attempts = 0;
+    PromiseRef promise;
+    HttpClientResponse response;
+    HttpResponseParser::BodyCallback sink;  // request.on_body, or append to response.body
+
+    void resolve() {
+        promise->resolve(std::move(response));
+    }
+
+    void fail(const std::string& error) {
+        response.ok = false;
+        response.error = error;
+        resolve();
+    }
+};
+
+// ============================================================================
+// HttpClientConnection
+// ============================================================================
+
+class HttpClientConnection : public std::enable_shared_from_this<HttpClientConnection> {
+public:
+    HttpClientConnection(HttpClient* client, std::string key) : client_(client), key_(std::move(key)) {}
+
+    // Start a non-blocking connect; failures surface through on_ready
+    bool start(const struct sockaddr_storage& addr, socklen_t addr_len);
+
+    // Queue (and, if connected, write) an exchange. False if this connection
+    // can no longer take requests.
+    bool enqueue(std::shared_ptr<HttpClientExchange> exchange);
+
+    // Close if still idle; used by the idle sweep
+    void close_if_idle();
+
+    size_t queued() const { return queued_.load(std::memory_order_relaxed); }
+    bool closed() const { return closed_flag_.load(std::memory_order_acquire); }
+    const std::string& key() const { return key_; }
+
+    // Protected by HttpClient::mutex_
+    int64_t idle_since_ms = 0;
+    bool in_idle_list = false;
+
+private:
+    HttpClient* client_;
+    std::string key_;
+
+    std::mutex mutex_;
+    int fd_ = -1;
+    bool connected_ = false;
+    bool closed_ = false;
+    bool accepting_ = true;     // False once the server asked to close
+    bool reused_ = false;       // At least one response completed
+    std::deque<std::shared_ptr<HttpClientExchange>> exchanges_;  // In response order
+    std::string out_;
+    size_t out_written_ = 0;
+    HttpResponseParser parser_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<bool> closed_flag_{false};
+
+    // Results gathered under mutex_ and acted on after it is released
+    struct Outcome {
+        std::vector<std::shared_ptr<HttpClientExchange>> completed;
+        std::vector<std::pair<std::shared_ptr<HttpClientExchange>, std::string>> failed;
+        std::vector<std::shared_ptr<HttpClientExchange>> retry;
+        bool closed = false;
+        bool idle = false;
+        bool connect_failed = false;
+    };
+
+    void on_ready();
+    bool flush_locked();
+    void read_locked(Outcome& outcome);
+    void close_locked(Outcome& outcome, const std::string& error);
+    void settle(Outcome& outcome);
+};
+
+bool HttpClientConnection::start(const struct sockaddr_storage& addr, socklen_t addr_len) {
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (connect(fd, reinterpret_cast<const struct sockaddr*>(&addr), addr_len) != 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fd_ = fd;
+    }
+
+    // The first writable edge reports the connect result
+    auto self = shared_from_this();
+    if (!NetPoller::instance().watch(fd, [self]() { self->on_ready(); })) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fd_ = -1;
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool HttpClientConnection::enqueue(std::shared_ptr<HttpClientExchange> exchange) {
+    Outcome outcome;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || !accepting_) return false;
+
+        if (exchanges_.empty()) {
+            parser_.reset(exchange->head);
+        }
+        out_.append(exchange->wire);
+        exchanges_.push_back(std::move(exchange));
+        queued_.fetch_add(1, std::memory_order_relaxed);
+
+        if (connected_ && !flush_locked()) {
+            close_locked(outcome, std::string("send failed: ") + strerror(errno));
+        }
+    }
+    settle(outcome);
+    return true;
+}
+
+void HttpClientConnection::close_if_idle() {
+    Outcome outcome;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || !exchanges_.empty()) return;
+        close_locked(outcome, "idle timeout");
+    }
+    // Already removed from the pool by the sweep
+}
+
+bool HttpClientConnection::flush_locked() {
+    while (out_written_ < out_.size()) {
+        ssize_t n = ::send(fd_, out_.data() + out_written_, out_.size() - out_written_, MSG_NOSIGNAL);
+        if (n > 0) {
+            out_written_ += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    out_.clear();
+    out_written_ = 0;
+    return true;
+}
+
+void HttpClientConnection::on_ready() {
+    Outcome outcome;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return;
+
+        if (!connected_) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &len);
+            if (error != 0) {
+                outcome.connect_failed = true;
+                close_locked(outcome, std::string("connect failed: ") + strerror(error));
+                goto done;
+            }
+            struct sockaddr_storage peer;
+            socklen_t peer_len = sizeof(peer);
+            if (getpeername(fd_, reinterpret_cast<struct sockaddr*>(&peer), &peer_len) != 0) {
+                goto done;  // Still connecting
+            }
+            connected_ = true;
+        }
+
+        if (!flush_locked()) {
+            close_locked(outcome, std::string("send failed: ") + strerror(errno));
+            goto done;
+        }
+
+        read_locked(outcome);
+        if (closed_) goto done;
+
+        if (exchanges_.empty()) {
+            if (!accepting_) {
+                close_locked(outcome, "connection closed by server");
+            } else {
+                outcome.idle = true;
+            }
+        }
+    }
+done:
+    settle(outcome);
+}
+
+void HttpClientConnection::read_locked(Outcome& outcome) {
+    char buffer[64 * 1024];
+    while (true) {
+        ssize_t n = recv(fd_, buffer, sizeof(buffer), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            close_locked(outcome, std::string("recv failed: ") + strerror(errno));
+            return;
+        }
+
+        if (n == 0) {
+            // A body delimited by connection close ends here
+            if (!exchanges_.empty() && parser_.started() &&
+                parser_.finish() == HttpResponseParser::Status::COMPLETE) {
+                auto exchange = exchanges_.front();
+                exchanges_.pop_front();
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                exchange->response.ok = true;
+                exchange->response.status = parser_.status_code();
+                exchange->response.headers = parser_.headers();
+                outcome.completed.push_back(std::move(exchange));
+            }
+            close_locked(outcome, "connection closed by server");
+            return;
+        }
+
+        size_t offset = 0;
+        size_t received = static_cast<size_t>(n);
+        while (offset < received) {
+            if (exchanges_.empty()) {
+                close_locked(outcome, "unexpected data from server");
+                return;
+            }
+
+            auto& exchange = exchanges_.front();
+            size_t consumed = 0;
+            auto status = parser_.feed(buffer + offset, received - offset, consumed, exchange->sink);
+            offset += consumed;
+
+            if (status == HttpResponseParser::Status::ERROR) {
+                close_locked(outcome, "malformed response");
+                return;
+            }
+            if (status == HttpResponseParser::Status::NEED_MORE) {
+                break;
+            }
+
+            exchange->response.ok = true;
+            exchange->response.status = parser_.status_code();
+            exchange->response.headers = parser_.headers();
+            outcome.completed.push_back(exchange);
+            exchanges_.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            reused_ = true;
+
+            if (!parser_.keep_alive()) {
+                // Anything pipelined behind this response was never answered
+                accepting_ = false;
+                close_locked(outcome, "connection closed by server");
+                return;
+            }
+            if (!exchanges_.empty()) {
+                parser_.reset(exchanges_.front()->head);
+            }
+        }
+    }
+}
+
+void HttpClientConnection::close_locked(Outcome& outcome, const std::string& error) {
+    if (closed_) return;
+    closed_ = true;
+    closed_flag_.store(true, std::memory_order_release);
+    outcome.closed = true;
+
+    if (fd_ >= 0) {
+        NetPoller::instance().close(fd_);
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    // A reused keep-alive connection may have been closed by the server just
+    // as we wrote to it. Requests it never started answering are safe to
+    // retry if idempotent; everything else fails.
+    bool head = true;
+    for (auto& exchange : exchanges_) {
+        bool untouched = !head || !parser_.started();
+        if (reused_ && untouched && exchange->idempotent && exchange->attempts < 2) {
+            outcome.retry.push_back(exchange);
+        } else {
+            outcome.failed.emplace_back(exchange, error);
+        }
+        head = false;
+    }
+    exchanges_.clear();
+    queued_.store(0, std::memory_order_relaxed);
+    out_.clear();
+    out_written_ = 0;
+}
+
+void HttpClientConnection::settle(Outcome& outcome) {
+    // Pool bookkeeping and promise callbacks run without our lock held. The
+    // pool is updated first so a caller woken by its response can reuse this
+    // connection for the next request.
+    auto self = shared_from_this();
+    if (outcome.connect_failed) {
+        client_->forget_address(key_);
+    }
+    if (outcome.closed) {
+        client_->connection_closed(self);
+    } else if (outcome.idle) {
+        client_->connection_idle(self);
+    }
+
+    for (auto& exchange : outcome.completed) {
+        exchange->resolve();
+    }
+    for (auto& entry : outcome.failed) {
+        entry.first->fail(entry.second);
+    }
+
+    for (auto& exchange : outcome.retry) {
+        exchange->attempts++;
+        client_->dispatch(std::move(exchange));
+    }
+}
+
+// ============================================================================
+// HttpClient
+// ============================================================================
+
+HttpClient& HttpClient::instance() {
+    // Use heap allocation to avoid static destruction order issues
+    static HttpClient* instance = new HttpClient();
+    return *instance;
+}
+
+HttpClient::HttpClient() {
+    // Without the poller, idle connections are only swept on sends
+    if (!NetPoller::instance().available()) return;
+    sweep_timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (sweep_timer_fd_ < 0) return;
+    if (!NetPoller::instance().watch(sweep_timer_fd_, [this] { on_sweep_timer(); })) {
+        ::close(sweep_timer_fd_);
+        sweep_timer_fd_ = -1;
+    }
+}
+
+std::string HttpClient::pool_key(const std::string& host, int port) {
+    return host + ":" + std::to_string(port);
+}
+
+PromiseRef HttpClient::send(HttpClientRequest request) {
+    auto exchange = std::make_shared<HttpClientExchange>();
+    exchange->promise = make_ref<Promise>();
+    exchange->key = pool_key(request.host, request.port);
+    exchange->head = request.method == "HEAD";
+    exchange->idempotent = request.method == "GET" || request.method == "HEAD" || request.method == "PUT" ||
+                           request.method == "DELETE" || request.method == "OPTIONS";
+
+    // Serialize once; pipelining just appends this to the connection's output
+    bool has_host = false;
+    bool has_length = false;
+    std::string& wire = exchange->wire;
+    wire.reserve(128 + request.body.size());
+    wire.append(request.method).append(" ").append(request.target.empty() ? "/" : request.target);
+    wire.append(" HTTP/1.1\r\n");
+    for (const auto& h : request.headers) {
+        has_host = has_host || http_iequals(h.first, "host");
+        has_length = has_length || http_iequals(h.first, "content-length");
+        wire.append(h.first).append(": ").append(h.second).append("\r\n");
+    }
+    if (!has_host) {
+        wire.append("Host: ").append(request.host);
+        if (request.port != 80) wire.append(":").append(std::to_string(request.port));
+        wire.append("\r\n");
+    }
+    if (!has_length && (!request.body.empty() || request.method == "POST" || request.method == "PUT" ||
+                        request.method == "PATCH")) {
+        wire.append("Content-Length: ").append(std::to_string(request.body.size())).append("\r\n");
+    }
+    wire.append("\r\n");
+    wire.append(request.body);
+
+    if (request.on_body) {
+        exchange->sink = request.on_body;
+    } else {
+        HttpClientResponse* response = &exchange->response;
+        exchange->sink = [response](const char* data, size_t len) { response->body.append(data, len); };
+    }
+
+    // Resolve the host here on the caller's goroutine, so connections opened
+    // later from the poller thread never block on DNS. The address is reused
+    // until it is DNS_TTL_MS old or a connect to it fails.
+    bool resolved;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int64_t resolved_at = pools_[exchange->key].resolved_at_ms;
+        resolved = resolved_at && now_ms() - resolved_at < DNS_TTL_MS;
+    }
+    if (!resolved) {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* result = nullptr;
+        std::string port = std::to_string(request.port);
+        if (getaddrinfo(request.host.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+            exchange->request = std::move(request);
+            exchange->fail("could not resolve host " + exchange->request.host);
+            return exchange->promise;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            HostPool& pool = pools_[exchange->key];
+            memcpy(&pool.addr, result->ai_addr, result->ai_addrlen);
+            pool.addr_len = result->ai_addrlen;
+            pool.resolved_at_ms = now_ms();
+        }
+        freeaddrinfo(result);
+    }
+
+    exchange->request = std::move(request);
+    auto promise = exchange->promise;
+    dispatch(std::move(exchange));
+    return promise;
+}
+
+HttpClientResponse HttpClient::request(HttpClientRequest request) {
+    auto promise = send(std::move(request));
+    promise->wait();
+    return std::move(promise->result<HttpClientResponse>());
+}
+
+void HttpClient::dispatch(std::shared_ptr<HttpClientExchange> exchange) {
+    maybe_sweep();
+
+    while (true) {
+        std::shared_ptr<HttpClientConnection> connection;
+        bool created = false;
+        struct sockaddr_storage addr;
+        socklen_t addr_len = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            HostPool& pool = pools_[exchange->key];
+
+            // Most recently used first - it is the least likely to have been
+            // closed by the server
+            while (!pool.idle.empty() && !connection) {
+                auto candidate = pool.idle.back();
+                pool.idle.pop_back();
+                candidate->in_idle_list = false;
+                if (!candidate->closed()) connection = candidate;
+            }
+
+            if (!connection && pool.connections.size() < max_connections_per_host_.load()) {
+                connection = std::make_shared<HttpClientConnection>(this, exchange->key);
+                pool.connections.push_back(connection);
+                addr = pool.addr;
+                addr_len = pool.addr_len;
+                created = true;
+            }
+
+            if (!connection && exchange->idempotent) {
+                // At the per-host limit: pipeline onto the least-loaded connection
+                size_t best_depth = MAX_PIPELINE_DEPTH;
+                for (auto& candidate : pool.connections) {
+                    size_t depth = candidate->queued();
+                    if (!candidate->closed() && depth < best_depth) {
+                        best_depth = depth;
+                        connection = candidate;
+                    }
+                }
+            }
+
+            if (!connection) {
+                pool.waiting.push_back(std::move(exchange));
+                return;
+            }
+        }
+
+        if (created) {
+            // Queue before connecting so a fast connect failure fails this
+            // exchange instead of bouncing it to yet another connection
+            connection->enqueue(exchange);
+            if (!connection->start(addr, addr_len)) {
+                forget_address(exchange->key);
+                exchange->fail("connect failed");
+                connection_closed(connection);
+            }
+            return;
+        }
+
+        if (connection->enqueue(exchange)) return;
+        // Closed underneath us - pick again
+    }
+}
+
+void HttpClient::connection_idle(const std::shared_ptr<HttpClientConnection>& connection) {
+    std::shared_ptr<HttpClientExchange> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pools_.find(connection->key());
+        if (it == pools_.end()) return;
+        HostPool& pool = it->second;
+
+        if (!pool.waiting.empty()) {
+            next = std::move(pool.waiting.front());
+            pool.waiting.pop_front();
+        } else if (!connection->in_idle_list && connection->queued() == 0 && !connection->closed()) {
+            connection->idle_since_ms = now_ms();
+            connection->in_idle_list = true;
+            pool.idle.push_back(connection);
+            arm_sweep_locked(connection->idle_since_ms + idle_timeout_ms_.load());
+        }
+    }
+
+    if (next && !connection->enqueue(next)) {
+        dispatch(std::move(next));
+    }
+}
+
+void HttpClient::connection_closed(const std::shared_ptr<HttpClientConnection>& connection) {
+    std::shared_ptr<HttpClientExchange> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pools_.find(connection->key());
+        if (it == pools_.end()) return;
+        HostPool& pool = it->second;
+
+        pool.connections.erase(std::remove(pool.connections.begin(), pool.connections.end(), connection),
+                               pool.connections.end());
+        if (connection->in_idle_list) {
+            pool.idle.erase(std::remove(pool.idle.begin(), pool.idle.end(), connection), pool.idle.end());
+            connection->in_idle_list = false;
+        }
+
+        // A slot opened up for anything waiting on the connection limit
+        if (!pool.waiting.empty()) {
+            next = std::move(pool.waiting.front());
+            pool.waiting.pop_front();
+        }
+    }
+
+    if (next) {
+        dispatch(std::move(next));
+    }
+}
+
+void HttpClient::forget_address(const std::string& key) {
+    // The host may have moved - the next send() resolves it again
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pools_.find(key);
+    if (it != pools_.end()) it->second.resolved_at_ms = 0;
+}
+
+void HttpClient::maybe_sweep() {
+    if (sweep_timer_fd_ >= 0) return;  // The timer does it
+    int64_t now = now_ms();
+    int64_t last = last_sweep_ms_.load(std::memory_order_relaxed);
+    if (now - last >= 1000 && last_sweep_ms_.compare_exchange_strong(last, now)) {
+        sweep_idle();
+    }
+}
+
+void HttpClient::arm_sweep_locked(int64_t deadline_ms) {
+    if (sweep_timer_fd_ < 0) return;
+    if (sweep_deadline_ms_ && sweep_deadline_ms_ <= deadline_ms) return;
+
+    // A zero it_value would disarm the timer
+    int64_t delay_ms = std::max<int64_t>(deadline_ms - now_ms(), 1);
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = delay_ms / 1000;
+    spec.it_value.tv_nsec = (delay_ms % 1000) * 1000000;
+    if (timerfd_settime(sweep_timer_fd_, 0, &spec, nullptr) == 0) {
+        sweep_deadline_ms_ = deadline_ms;
+    }
+}
+
+void HttpClient::on_sweep_timer() {
+    // Edge-triggered - drain the expiration count
+    uint64_t expirations;
+    while (::read(sweep_timer_fd_, &expirations, sizeof(expirations)) > 0) {}
+
+    sweep_idle();
+
+    // Re-arm for the connection that goes stale next, if any are left
+    std::lock_guard<std::mutex> lock(mutex_);
+    sweep_deadline_ms_ = 0;
+    int64_t timeout = idle_timeout_ms_.load();
+    int64_t next = 0;
+    for (auto& entry : pools_) {
+        for (auto& connection : entry.second.idle) {
+            int64_t deadline = connection->idle_since_ms + timeout;
+            if (!next || deadline < next) next = deadline;
+        }
+    }
+    if (next) arm_sweep_locked(next);
+}
+
+void HttpClient::sweep_idle() {
+    std::vector<std::shared_ptr<HttpClientConnection>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int64_t now = now_ms();
+        int64_t timeout = idle_timeout_ms_.load();
+        for (auto& entry : pools_) {
+            HostPool& pool = entry.second;
+            auto keep = std::partition(pool.idle.begin(), pool.idle.end(),
+                [now, timeout](const std::shared_ptr<HttpClientConnection>& c) {
+                    return now - c->idle_since_ms < timeout;
+                });
+            for (auto it = keep; it != pool.idle.end(); ++it) {
+                (*it)->in_idle_list = false;
+                pool.connections.erase(std::remove(pool.connections.begin(), pool.connections.end(), *it),
+                                       pool.connections.end());
+                expired.push_back(*it);
+            }
+            pool.idle.erase(keep, pool.idle.end());
+        }
+    }
+
+    for (auto& connection : expired) {
+        connection->close_if_idle();
+    }
+}
+
+size_t HttpClient::open_connections(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pools_.find(pool_key(host, port));
+    return it == pools_.end() ? 0 : it->second.connections.size();
+}
+
+size_t HttpClient::idle_connections(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pools_.find(pool_key(host, port));
+    return it == pools_.end() ? 0 : it->second.idle.size();
+}
+
+} // namespace gots
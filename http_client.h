@@ -0,0 +1,129 @@
+#pragma once
+
+#include "http_parser.h"
+#include "runtime.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+
+namespace gots {
+
+// ============================================================================
+// HTTP CLIENT - Pooled HTTP/1.1 client driven by the NetPoller
+// ============================================================================
+//
+// Every outbound connection is a non-blocking socket watched by the
+// NetPoller; connecting, writing the request and parsing the response all
+// happen in readiness callbacks, so an in-flight request costs no thread.
+// send() returns a Promise immediately and thousands can be outstanding.
+//
+// Connections are pooled per host:port. A finished keep-alive connection goes
+// back to its pool and is reused by the next request; idle connections are
+// closed after idle_timeout_ms. When a host already has its maximum number
+// of connections open, further idempotent requests are pipelined onto the
+// least-loaded connection and the rest wait for one to free up. A pool's
+// address is resolved again after DNS_TTL_MS, or after a connect to it fails.
+//
+// Bodies are streamed: with an on_body callback the response body is handed
+// over (de-chunked) as it arrives and never accumulated.
+
+struct HttpClientResponse {
+    bool ok = false;            // False on connect/protocol errors
+    std::string error;
+    int status = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;           // Empty when an on_body callback was supplied
+
+    // Case-insensitive lookup; empty string if absent
+    std::string header(std::string_view name) const;
+};
+
+struct HttpClientRequest {
+    std::string method = "GET";
+    std::string host;
+    int port = 80;
+    std::string target = "/";   // Path and query
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    // Called for each piece of the body as it arrives, on the poller
+    // thread - must not block
+    HttpResponseParser::BodyCallback on_body;
+};
+
+class HttpClientConnection;
+struct HttpClientExchange;
+
+class HttpClient {
+public:
+    static HttpClient& instance();
+
+    // Issue a request; the promise resolves with an HttpClientResponse
+    PromiseRef send(HttpClientRequest request);
+
+    // Issue a request and block the calling goroutine until it completes
+    HttpClientResponse request(HttpClientRequest request);
+
+    void set_idle_timeout_ms(int64_t timeout_ms) { idle_timeout_ms_.store(timeout_ms); }
+    void set_max_connections_per_host(size_t max) { max_connections_per_host_.store(max); }
+
+    // Pool introspection
+    size_t open_connections(const std::string& host, int port);
+    size_t idle_connections(const std::string& host, int port);
+
+    // Close idle connections past their timeout. Runs on its own from a
+    // NetPoller-watched timer while any pool has idle connections, and on
+    // sends when the poller is unavailable.
+    void sweep_idle();
+
+    static constexpr int64_t DEFAULT_IDLE_TIMEOUT_MS = 30000;
+    static constexpr size_t DEFAULT_MAX_CONNECTIONS_PER_HOST = 64;
+    static constexpr size_t MAX_PIPELINE_DEPTH = 16;
+    static constexpr int64_t DNS_TTL_MS = 60000;
+
+private:
+    friend class HttpClientConnection;
+
+    HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    struct HostPool {
+        std::vector<std::shared_ptr<HttpClientConnection>> connections;  // All open connections
+        std::vector<std::shared_ptr<HttpClientConnection>> idle;         // Most recently used last
+        std::deque<std::shared_ptr<HttpClientExchange>> waiting;         // Blocked on a free connection
+        struct sockaddr_storage addr;
+        socklen_t addr_len = 0;
+        int64_t resolved_at_ms = 0;  // 0 until resolved, and after a connect fails
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, HostPool> pools_;
+    std::atomic<int64_t> idle_timeout_ms_{DEFAULT_IDLE_TIMEOUT_MS};
+    std::atomic<size_t> max_connections_per_host_{DEFAULT_MAX_CONNECTIONS_PER_HOST};
+    std::atomic<int64_t> last_sweep_ms_{0};
+
+    // Idle sweep timer - a timerfd watched by the NetPoller
+    int sweep_timer_fd_ = -1;
+    int64_t sweep_deadline_ms_ = 0;  // When the timer fires, 0 if disarmed. Protected by mutex_
+
+    static std::string pool_key(const std::string& host, int port);
+
+    void dispatch(std::shared_ptr<HttpClientExchange> exchange);
+    void connection_idle(const std::shared_ptr<HttpClientConnection>& connection);
+    void connection_closed(const std::shared_ptr<HttpClientConnection>& connection);
+    void forget_address(const std::string& key);
+    void maybe_sweep();
+    void arm_sweep_locked(int64_t deadline_ms);
+    void on_sweep_timer();
+};
+
+} // namespace gots
@@ -0,0 +1,438 @@
+#include "http_parser.h"
+#include <algorithm>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace gots {
+
+const char* http_find_char(const char* data, size_t len, char c) {
+#ifdef __SSE2__
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0) {
+            return data + i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < len; ++i) {
+        if (data[i] == c) return data + i;
+    }
+    return nullptr;
+#else
+    return static_cast<const char*>(memchr(data, c, len));
+#endif
+}
+
+static inline char ascii_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+bool http_iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (ascii_lower(a[i]) != ascii_lower(b[i])) return false;
+    }
+    return true;
+}
+
+static std::string_view trim_ows(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// True if comma-separated `list` contains `token` (case-insensitive)
+static bool has_token(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view item = trim_ows(list.substr(0, comma));
+        if (http_iequals(item, token)) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (const auto& h : headers) {
+        if (http_iequals(h.name, name)) return h.value;
+    }
+    return {};
+}
+
+void HttpRequest::clear() {
+    method = target = path = query = body = {};
+    version_minor = 1;
+    headers.clear();  // Keeps capacity across requests on a connection
+    keep_alive = true;
+}
+
+void HttpRequestParser::reset() {
+    scanned_ = 0;
+    header_end_ = 0;
+    content_length_ = 0;
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status) {
+    error_status_ = status;
+    reset();
+    return Status::ERROR;
+}
+
+HttpRequestParser::Status HttpRequestParser::parse(const char* data, size_t len, HttpRequest& request, size_t& consumed) {
+    if (header_end_ == 0) {
+        // Resume a few bytes back in case the terminator straddles the old end
+        size_t from = scanned_ > 3 ? scanned_ - 3 : 0;
+        const char* end = data + len;
+        const char* p = data + from;
+        while (p < end) {
+            const char* cr = http_find_char(p, static_cast<size_t>(end - p), '\r');
+            if (!cr || end - cr < 4) break;
+            if (cr[1] == '\n' && cr[2] == '\r' && cr[3] == '\n') {
+                header_end_ = static_cast<size_t>(cr - data) + 4;
+                break;
+            }
+            p = cr + 1;
+        }
+
+        if (header_end_ == 0) {
+            scanned_ = len;
+            if (len > MAX_HEADER_BYTES) return fail(431);
+            return Status::INCOMPLETE;
+        }
+        if (header_end_ > MAX_HEADER_BYTES) return fail(431);
+    }
+
+    // Views are rebuilt on every call since the caller's buffer may have moved
+    request.clear();
+    if (!parse_head(data, header_end_, request)) {
+        return fail(error_status_);
+    }
+
+    if (len < header_end_ + content_length_) {
+        return Status::INCOMPLETE;
+    }
+
+    request.body = std::string_view(data + header_end_, content_length_);
+    consumed = header_end_ + content_length_;
+    reset();
+    return Status::COMPLETE;
+}
+
+bool HttpRequestParser::parse_head(const char* data, size_t head_len, HttpRequest& request) {
+    error_status_ = 400;
+    const char* end = data + head_len - 2;  // Stop before the final blank line
+
+    // Request line: METHOD SP request-target SP HTTP-version CRLF
+    const char* line_end = http_find_char(data, static_cast<size_t>(end - data), '\r');
+    if (!line_end) return false;
+    std::string_view line(data, static_cast<size_t>(line_end - data));
+
+    size_t sp1 = line.find(' ');
+    if (sp1 == std::string_view::npos || sp1 == 0) return false;
+    size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos || sp2 == sp1 + 1) return false;
+
+    request.method = line.substr(0, sp1);
+    request.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string_view version = line.substr(sp2 + 1);
+    if (version.size() != 8 || version.substr(0, 7) != "HTTP/1.") {
+        if (version.substr(0, 5) == "HTTP/") error_status_ = 505;
+        return false;
+    }
+    if (version[7] == '0') {
+        request.version_minor = 0;
+    } else if (version[7] == '1') {
+        request.version_minor = 1;
+    } else {
+        error_status_ = 505;
+        return false;
+    }
+
+    size_t question = request.target.find('?');
+    request.path = request.target.substr(0, question);
+    if (question != std::string_view::npos) {
+        request.query = request.target.substr(question + 1);
+    }
+
+    // Header fields
+    bool has_content_length = false;
+    bool connection_close = false;
+    bool connection_keep_alive = false;
+    content_length_ = 0;
+
+    const char* p = line_end + 2;
+    while (p < end) {
+        line_end = http_find_char(p, static_cast<size_t>(end - p), '\r');
+        if (!line_end) line_end = end;
+        if (line_end + 1 >= data + head_len || line_end[1] != '\n') return false;
+        if (http_find_char(p, static_cast<size_t>(line_end - p), '\n')) return false;  // Bare LF
+
+        const char* colon = http_find_char(p, static_cast<size_t>(line_end - p), ':');
+        if (!colon || colon == p) return false;
+        std::string_view name(p, static_cast<size_t>(colon - p));
+        if (name.back() == ' ' || name.back() == '\t') return false;  // No space before ':'
+        std::string_view value = trim_ows(std::string_view(colon + 1, static_cast<size_t>(line_end - colon - 1)));
+
+        if (request.headers.size() >= MAX_HEADERS) {
+            error_status_ = 431;
+            return false;
+        }
+        request.headers.push_back({name, value});
+
+        if (http_iequals(name, "content-length")) {
+            if (value.empty()) return false;
+            size_t length = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') return false;
+                length = length * 10 + static_cast<size_t>(c - '0');
+                if (length > MAX_BODY_BYTES) {
+                    error_status_ = 413;
+                    return false;
+                }
+            }
+            if (has_content_length && length != content_length_) return false;
+            has_content_length = true;
+            content_length_ = length;
+        } else if (http_iequals(name, "transfer-encoding")) {
+            // Chunked request bodies are not accepted
+            error_status_ = 501;
+            return false;
+        } else if (http_iequals(name, "connection")) {
+            connection_close = connection_close || has_token(value, "close");
+            connection_keep_alive = connection_keep_alive || has_token(value, "keep-alive");
+        }
+
+        p = line_end + 2;
+    }
+
+    if (connection_close) {
+        request.keep_alive = false;
+    } else {
+        request.keep_alive = request.version_minor == 1 || connection_keep_alive;
+    }
+    return true;
+}
+
+// ============================================================================
+// HttpResponseParser
+// ============================================================================
+
+void HttpResponseParser::reset(bool head_request) {
+    state_ = State::HEAD;
+    head_request_ = head_request;
+    head_buf_.clear();
+    line_buf_.clear();
+    remaining_ = 0;
+    status_code_ = 0;
+    keep_alive_ = true;
+    headers_.clear();
+}
+
+bool HttpResponseParser::take_line(const char* data, size_t len, size_t& pos, std::string& line) {
+    const char* lf = http_find_char(data + pos, len - pos, '\n');
+    if (!lf) {
+        line.append(data + pos, len - pos);
+        pos = len;
+        return false;
+    }
+    size_t end = static_cast<size_t>(lf - data);
+    line.append(data + pos, end - pos);
+    pos = end + 1;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return true;
+}
+
+HttpResponseParser::Status HttpResponseParser::feed(const char* data, size_t len, size_t& consumed,
+                                                    const BodyCallback& on_body) {
+    size_t pos = 0;
+    while (state_ != State::DONE && state_ != State::FAILED && pos < len) {
+        switch (state_) {
+            case State::HEAD: {
+                // Resume the terminator search where the previous feed stopped
+                size_t old_size = head_buf_.size();
+                head_buf_.append(data + pos, len - pos);
+                size_t from = old_size > 3 ? old_size - 3 : 0;
+                size_t term = head_buf_.find("\r\n\r\n", from);
+                if (term == std::string::npos) {
+                    pos = len;
+                    if (head_buf_.size() > MAX_HEADER_BYTES) state_ = State::FAILED;
+                    break;
+                }
+                size_t head_len = term + 4;
+                pos += head_len - old_size;
+                head_buf_.resize(head_len);
+                if (!parse_head()) {
+                    state_ = State::FAILED;
+                    break;
+                }
+                if (status_code_ >= 100 && status_code_ < 200) {
+                    // Interim response (100 Continue) - the real one follows
+                    reset(head_request_);
+                }
+                break;
+            }
+
+            case State::BODY_LENGTH: {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(remaining_, len - pos));
+                if (n > 0 && on_body) on_body(data + pos, n);
+                pos += n;
+                remaining_ -= n;
+                if (remaining_ == 0) state_ = State::DONE;
+                break;
+            }
+
+            case State::BODY_UNTIL_CLOSE:
+                if (on_body) on_body(data + pos, len - pos);
+                pos = len;
+                break;
+
+            case State::CHUNK_SIZE: {
+                if (!take_line(data, len, pos, line_buf_)) {
+                    if (line_buf_.size() > 1024) state_ = State::FAILED;
+                    break;
+                }
+                uint64_t size = 0;
+                size_t digits = 0;
+                for (char c : line_buf_) {
+                    int v;
+                    if (c >= '0' && c <= '9') v = c - '0';
+                    else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+                    else break;  // Chunk extensions are ignored
+                    if (++digits > 15) {
+                        state_ = State::FAILED;
+                        break;
+                    }
+                    size = size * 16 + static_cast<uint64_t>(v);
+                }
+                line_buf_.clear();
+                if (state_ == State::FAILED) break;
+                if (digits == 0) {
+                    state_ = State::FAILED;
+                } else if (size == 0) {
+                    state_ = State::TRAILERS;
+                } else {
+                    remaining_ = size;
+                    state_ = State::CHUNK_DATA;
+                }
+                break;
+            }
+
+            case State::CHUNK_DATA: {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(remaining_, len - pos));
+                if (n > 0 && on_body) on_body(data + pos, n);
+                pos += n;
+                remaining_ -= n;
+                if (remaining_ == 0) state_ = State::CHUNK_DATA_END;
+                break;
+            }
+
+            case State::CHUNK_DATA_END:
+                if (!take_line(data, len, pos, line_buf_)) break;
+                state_ = line_buf_.empty() ? State::CHUNK_SIZE : State::FAILED;
+                line_buf_.clear();
+                break;
+
+            case State::TRAILERS:
+                if (!take_line(data, len, pos, line_buf_)) {
+                    if (line_buf_.size() > MAX_HEADER_BYTES) state_ = State::FAILED;
+                    break;
+                }
+                if (line_buf_.empty()) state_ = State::DONE;
+                line_buf_.clear();
+                break;
+
+            default:
+                break;
+        }
+    }
+    consumed = pos;
+    if (state_ == State::FAILED) return Status::ERROR;
+    return state_ == State::DONE ? Status::COMPLETE : Status::NEED_MORE;
+}
+
+HttpResponseParser::Status HttpResponseParser::finish() {
+    if (state_ == State::BODY_UNTIL_CLOSE || state_ == State::DONE) {
+        state_ = State::DONE;
+        return Status::COMPLETE;
+    }
+    state_ = State::FAILED;
+    return Status::ERROR;
+}
+
+bool HttpResponseParser::parse_head() {
+    std::string_view head(head_buf_);
+    head.remove_suffix(2);  // Final blank line
+
+    // Status line: HTTP/1.x SP status-code SP reason
+    size_t line_end = head.find("\r\n");
+    std::string_view line = head.substr(0, line_end);
+    if (line.size() < 12 || line.substr(0, 7) != "HTTP/1." || line[8] != ' ') return false;
+    int version_minor = line[7] - '0';
+    status_code_ = 0;
+    for (size_t i = 9; i < 12; ++i) {
+        if (line[i] < '0' || line[i] > '9') return false;
+        status_code_ = status_code_ * 10 + (line[i] - '0');
+    }
+
+    bool chunked = false;
+    bool has_length = false;
+    uint64_t length = 0;
+    bool connection_close = false;
+    bool connection_keep_alive = false;
+
+    headers_.clear();
+    size_t pos = line_end + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == std::string_view::npos) end = head.size();
+        std::string_view field = head.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = field.find(':');
+        if (colon == std::string_view::npos || colon == 0) return false;
+        std::string_view name = field.substr(0, colon);
+        std::string_view value = trim_ows(field.substr(colon + 1));
+        headers_.emplace_back(std::string(name), std::string(value));
+
+        if (http_iequals(name, "transfer-encoding")) {
+            chunked = has_token(value, "chunked");
+        } else if (http_iequals(name, "content-length")) {
+            if (value.empty()) return false;
+            if (value.size() > 18) return false;
+            length = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') return false;
+                length = length * 10 + static_cast<uint64_t>(c - '0');
+            }
+            has_length = true;
+        } else if (http_iequals(name, "connection")) {
+            connection_close = connection_close || has_token(value, "close");
+            connection_keep_alive = connection_keep_alive || has_token(value, "keep-alive");
+        }
+    }
+
+    keep_alive_ = !connection_close && (version_minor >= 1 || connection_keep_alive);
+
+    // Body framing, RFC 9112 section 6.3
+    if (head_request_ || status_code_ == 204 || status_code_ == 304 ||
+        (status_code_ >= 100 && status_code_ < 200)) {
+        state_ = State::DONE;
+    } else if (chunked) {
+        state_ = State::CHUNK_SIZE;
+    } else if (has_length) {
+        remaining_ = length;
+        state_ = length == 0 ? State::DONE : State::BODY_LENGTH;
+    } else {
+        state_ = State::BODY_UNTIL_CLOSE;
+        keep_alive_ = false;
+    }
+    return true;
+}
+
+} // namespace gots
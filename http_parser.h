@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace gots {
+
+// ============================================================================
+// HTTP/1.1 PARSER - Incremental request and response parsing
+// ============================================================================
+//
+// The parser never copies: every field of an HttpRequest is a view into the
+// caller's receive buffer and is valid until that buffer is modified. It is
+// incremental - when a request arrives in pieces it remembers how far it has
+// already scanned, so each byte is searched for the end of the header block
+// only once. The scan itself looks for CR 16 bytes at a time with SSE2.
+//
+// HttpResponseParser is the client-side counterpart. It is fed whatever
+// arrived from the socket and hands body bytes (de-chunked) to a callback as
+// they arrive, so a response never has to be buffered whole.
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;     // Full request-target, e.g. "/a/b?x=1"
+    std::string_view path;       // Target up to '?'
+    std::string_view query;      // After '?', without it
+    int version_minor = 1;       // HTTP/1.x
+    std::vector<HttpHeader> headers;
+    std::string_view body;
+    bool keep_alive = true;
+
+    // Case-insensitive lookup; empty view if absent
+    std::string_view header(std::string_view name) const;
+
+    void clear();
+};
+
+// Locate `c` in [data, data + len) - SSE2 when available
+const char* http_find_char(const char* data, size_t len, char c);
+
+// Case-insensitive ASCII comparison for header names and tokens
+bool http_iequals(std::string_view a, std::string_view b);
+
+class HttpRequestParser {
+public:
+    enum class Status {
+        COMPLETE,     // `request` is filled in, `consumed` bytes belong to it
+        INCOMPLETE,   // Need more data - call again with the grown buffer
+        ERROR         // Malformed; error_status() is the response code to send
+    };
+
+    // Limits
+    static constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+    static constexpr size_t MAX_BODY_BYTES = 16 * 1024 * 1024;
+    static constexpr size_t MAX_HEADERS = 100;
+
+    // Parse the request at the start of [data, data + len). On COMPLETE the
+    // caller drops `consumed` bytes and calls again for the next pipelined
+    // request.
+    Status parse(const char* data, size_t len, HttpRequest& request, size_t& consumed);
+
+    // Forget any partial progress (the buffer was discarded)
+    void reset();
+
+    int error_status() const { return error_status_; }
+
+private:
+    size_t scanned_ = 0;        // Bytes already searched for the header terminator
+    size_t header_end_ = 0;     // Offset just past "\r\n\r\n", 0 until found
+    size_t content_length_ = 0;
+    int error_status_ = 400;
+
+    Status fail(int status);
+    bool parse_head(const char* data, size_t head_len, HttpRequest& request);
+};
+
+class HttpResponseParser {
+public:
+    enum class Status {
+        NEED_MORE,    // Everything offered was consumed; feed more
+        COMPLETE,     // Response finished; bytes past `consumed` belong to the next one
+        ERROR
+    };
+
+    using BodyCallback = std::function<void(const char* data, size_t len)>;
+
+    static constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+
+    // Prepare for the next response. HEAD responses never carry a body.
+    void reset(bool head_request);
+
+    Status feed(const char* data, size_t len, size_t& consumed, const BodyCallback& on_body);
+
+    // The peer closed the connection; completes a read-until-close body
+    Status finish();
+
+    bool started() const { return state_ != State::HEAD || !head_buf_.empty(); }
+    bool headers_complete() const { return state_ != State::HEAD; }
+    int status_code() const { return status_code_; }
+    bool keep_alive() const { return keep_alive_; }
+    const std::vector<std::pair<std::string, std::string>>& headers() const { return headers_; }
+
+private:
+    enum class State {
+        HEAD,
+        BODY_LENGTH,
+        BODY_UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILERS,
+        DONE,
+        FAILED
+    };
+
+    State state_ = State::HEAD;
+    bool head_request_ = false;
+    std::string head_buf_;      // Status line + headers, accumulated across feeds
+    std::string line_buf_;      // Partial chunk-size / trailer line
+    uint64_t remaining_ = 0;    // Body or chunk bytes still expected
+    int status_code_ = 0;
+    bool keep_alive_ = true;
+    std::vector<std::pair<std::string, std::string>> headers_;
+
+    bool parse_head();
+    bool take_line(const char* data, size_t len, size_t& pos, std::string& line);
+};
+
+} // namespace gots
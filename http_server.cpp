@@ -0,0 +1,752 @@
+#include "http_server.h"
+#include "goroutine_system.h"
+#include "netpoller.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <csignal>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+namespace gots {
+
+static int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The poller thread copies a callback out before running it, so a callback
+// can still be running after NetPoller::close(). Callbacks reach the server
+// only through this link; the destructor waits for `active` to drain and then
+// clears `server`, after which late callbacks do nothing.
+struct HttpServerLink {
+    std::mutex mutex;
+    std::condition_variable drained_cv;
+    HttpServer* server = nullptr;
+    bool accepting = false;  // Listener callbacks only run while set
+    int active = 0;          // Callbacks currently using `server`
+};
+
+template <typename F>
+static void with_server(const std::shared_ptr<HttpServerLink>& link, bool needs_listener, F&& f) {
+    {
+        std::lock_guard<std::mutex> lock(link->mutex);
+        if (!link->server || (needs_listener && !link->accepting)) return;
+        link->active++;
+    }
+    f(link->server);
+    std::lock_guard<std::mutex> lock(link->mutex);
+    if (--link->active == 0) link->drained_cv.notify_all();
+}
+
+// Wait for running callbacks, then apply `update` before any other starts
+template <typename F>
+static void quiesce_link(const std::shared_ptr<HttpServerLink>& link, F&& update) {
+    std::unique_lock<std::mutex> lock(link->mutex);
+    link->drained_cv.wait(lock, [&] { return link->active == 0; });
+    update(*link);
+}
+
+static const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+static const char* content_type_for(const std::string& path) {
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos) return "application/octet-stream";
+    std::string_view ext(path.c_str() + dot + 1);
+    if (ext == "html" || ext == "htm") return "text/html; charset=utf-8";
+    if (ext == "css") return "text/css; charset=utf-8";
+    if (ext == "js") return "application/javascript";
+    if (ext == "json") return "application/json";
+    if (ext == "txt") return "text/plain; charset=utf-8";
+    if (ext == "svg") return "image/svg+xml";
+    if (ext == "png") return "image/png";
+    if (ext == "jpg" || ext == "jpeg") return "image/jpeg";
+    if (ext == "gif") return "image/gif";
+    if (ext == "wasm") return "application/wasm";
+    return "application/octet-stream";
+}
+
+// ============================================================================
+// HttpResponse
+// ============================================================================
+
+HttpResponse::~HttpResponse() {
+    if (file_fd_ >= 0) ::close(file_fd_);
+}
+
+void HttpResponse::reset(int status) {
+    if (file_fd_ >= 0) ::close(file_fd_);
+    file_fd_ = -1;
+    file_size_ = 0;
+    headers_.clear();
+    body_.clear();
+    has_content_type_ = false;
+    status_ = status;
+}
+
+void HttpResponse::set_header(std::string_view name, std::string_view value) {
+    if (http_iequals(name, "content-type")) has_content_type_ = true;
+    headers_.append(name.data(), name.size());
+    headers_.append(": ", 2);
+    headers_.append(value.data(), value.size());
+    headers_.append("\r\n", 2);
+}
+
+void HttpResponse::send(std::string body) {
+    body_ = std::move(body);
+}
+
+bool HttpResponse::send_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        if (fd >= 0) ::close(fd);
+        status_ = 404;
+        return false;
+    }
+
+    if (file_fd_ >= 0) ::close(file_fd_);
+    file_fd_ = fd;
+    file_size_ = static_cast<size_t>(st.st_size);
+    body_.clear();
+    if (!has_content_type_) {
+        set_header("Content-Type", content_type_for(path));
+    }
+    return true;
+}
+
+// ============================================================================
+// HttpConnection
+// ============================================================================
+
+class HttpConnection : public std::enable_shared_from_this<HttpConnection> {
+public:
+    HttpConnection(HttpServer* server, int fd) : server_(server), fd_(fd), last_active_ms_(now_ms()) {
+        in_.resize(HttpServer::READ_CHUNK);
+    }
+
+    ~HttpConnection() {
+        for (auto& chunk : out_) {
+            if (chunk.file_fd >= 0) ::close(chunk.file_fd);
+        }
+    }
+
+    // Called on the poller thread for every readiness edge
+    void schedule();
+
+    // Close on the worker if nothing was read or written since `seen_ms`
+    void expire_if_idle_since(int64_t seen_ms);
+    // Flush what can go out without blocking, then close
+    void stop();
+
+    int64_t last_active_ms() const { return last_active_ms_.load(std::memory_order_relaxed); }
+
+private:
+    // One pending piece of output: either bytes or a file range for sendfile
+    struct OutChunk {
+        std::string data;
+        int file_fd = -1;
+        off_t file_offset = 0;
+        size_t file_remaining = 0;
+    };
+
+    enum : int { IDLE = 0, RUNNING = 1, RERUN = 2 };
+
+    HttpServer* server_;
+    int fd_;
+    std::atomic<int> state_{IDLE};
+    std::atomic<int64_t> last_active_ms_;   // Last read or write
+    std::atomic<int64_t> expire_seen_ms_{0};  // Pending idle close, 0 if none
+    std::atomic<bool> stop_requested_{false};
+
+    // Only touched by the worker currently running this connection
+    bool closed_ = false;
+    bool peer_closed_ = false;
+    bool close_after_flush_ = false;
+    std::vector<char> in_;
+    size_t in_start_ = 0;   // First unparsed byte
+    size_t in_end_ = 0;     // End of received data
+    HttpRequestParser parser_;
+    HttpRequest request_;
+    std::deque<OutChunk> out_;
+    size_t out_front_written_ = 0;
+    size_t out_bytes_ = 0;
+
+    void run();
+    void process();
+    void handle_buffered_requests();
+    void queue_response(const HttpRequest* request, HttpResponse& response, bool keep_alive);
+    void queue_error(int status);
+    bool read_some(bool& would_block);
+    bool flush();
+    void shutdown();
+};
+
+void HttpConnection::schedule() {
+    int state = state_.load(std::memory_order_acquire);
+    while (true) {
+        if (state == IDLE) {
+            if (state_.compare_exchange_weak(state, RUNNING, std::memory_order_acq_rel)) {
+                auto self = shared_from_this();
+                server_->workers_->enqueue_simple([self]() { self->run(); });
+                return;
+            }
+        } else if (state == RUNNING) {
+            // The running worker will go round again before going idle
+            if (state_.compare_exchange_weak(state, RERUN, std::memory_order_acq_rel)) return;
+        } else {
+            return;
+        }
+    }
+}
+
+void HttpConnection::expire_if_idle_since(int64_t seen_ms) {
+    expire_seen_ms_.store(seen_ms, std::memory_order_relaxed);
+    schedule();
+}
+
+void HttpConnection::stop() {
+    stop_requested_.store(true, std::memory_order_release);
+    schedule();
+}
+
+void HttpConnection::run() {
+    while (true) {
+        process();
+        int expected = RUNNING;
+        if (state_.compare_exchange_strong(expected, IDLE, std::memory_order_acq_rel)) return;
+        state_.store(RUNNING, std::memory_order_release);
+    }
+}
+
+void HttpConnection::process() {
+    if (closed_) return;
+
+    if (stop_requested_.load(std::memory_order_acquire)) {
+        flush();
+        shutdown();
+        return;
+    }
+    // Traffic since the sweep saw the connection idle cancels the close
+    int64_t expire_seen = expire_seen_ms_.exchange(0, std::memory_order_relaxed);
+    if (expire_seen && last_active_ms() == expire_seen) {
+        shutdown();
+        return;
+    }
+
+    if (!flush()) {
+        shutdown();
+        return;
+    }
+
+    // Don't read more while the peer isn't draining what we already owe it
+    while (!close_after_flush_ && !peer_closed_ && out_bytes_ < HttpServer::OUTPUT_HIGH_WATER) {
+        bool would_block = false;
+        if (!read_some(would_block)) {
+            shutdown();
+            return;
+        }
+        handle_buffered_requests();
+        if (would_block) break;
+
+        if (out_bytes_ >= HttpServer::OUTPUT_HIGH_WATER && !flush()) {
+            shutdown();
+            return;
+        }
+    }
+
+    if (!flush()) {
+        shutdown();
+        return;
+    }
+    if ((close_after_flush_ || peer_closed_) && out_.empty()) {
+        shutdown();
+    }
+}
+
+bool HttpConnection::read_some(bool& would_block) {
+    // Make room: compact consumed bytes first, grow only if still short
+    if (in_.size() - in_end_ < HttpServer::READ_CHUNK / 4) {
+        if (in_start_ > 0) {
+            memmove(in_.data(), in_.data() + in_start_, in_end_ - in_start_);
+            in_end_ -= in_start_;
+            in_start_ = 0;
+        }
+        if (in_.size() - in_end_ < HttpServer::READ_CHUNK / 4) {
+            in_.resize(in_.size() * 2);
+        }
+    }
+
+    while (true) {
+        ssize_t n = recv(fd_, in_.data() + in_end_, in_.size() - in_end_, 0);
+        if (n > 0) {
+            in_end_ += static_cast<size_t>(n);
+            last_active_ms_.store(now_ms(), std::memory_order_relaxed);
+            return true;
+        }
+        if (n == 0) {
+            peer_closed_ = true;
+            would_block = true;
+            return true;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            would_block = true;
+            return true;
+        }
+        return false;
+    }
+}
+
+void HttpConnection::handle_buffered_requests() {
+    while (!close_after_flush_ && in_start_ < in_end_) {
+        size_t consumed = 0;
+        auto status = parser_.parse(in_.data() + in_start_, in_end_ - in_start_, request_, consumed);
+        if (status == HttpRequestParser::Status::INCOMPLETE) {
+            return;
+        }
+        if (status == HttpRequestParser::Status::ERROR) {
+            queue_error(parser_.error_status());
+            return;
+        }
+
+        HttpResponse response;
+        try {
+            server_->handler_(request_, response);
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: HTTP handler threw: " << e.what() << std::endl;
+            response.reset(500);
+        } catch (...) {
+            std::cerr << "ERROR: HTTP handler threw unknown exception" << std::endl;
+            response.reset(500);
+        }
+
+        bool keep_alive = request_.keep_alive && !response.close_;
+        queue_response(&request_, response, keep_alive);
+        in_start_ += consumed;
+        server_->requests_.fetch_add(1, std::memory_order_relaxed);
+        if (!keep_alive) close_after_flush_ = true;
+    }
+
+    if (in_start_ == in_end_) {
+        in_start_ = in_end_ = 0;
+    }
+}
+
+void HttpConnection::queue_response(const HttpRequest* request, HttpResponse& response, bool keep_alive) {
+    bool is_head = request && request->method == "HEAD";
+    bool http10 = request && request->version_minor == 0;
+    int status = response.status_;
+    bool bodyless = status == 204 || status == 304 || (status >= 100 && status < 200);
+    size_t body_size = response.file_fd_ >= 0 ? response.file_size_ : response.body_.size();
+
+    std::string head;
+    head.reserve(128 + response.headers_.size());
+    head.append(http10 ? "HTTP/1.0 " : "HTTP/1.1 ");
+    head.append(std::to_string(status));
+    head.push_back(' ');
+    head.append(status_text(status));
+    head.append("\r\n");
+    head.append(response.headers_);
+    if (!bodyless) {
+        head.append("Content-Length: ");
+        head.append(std::to_string(body_size));
+        head.append("\r\n");
+    }
+    if (!keep_alive) {
+        head.append("Connection: close\r\n");
+    } else if (http10) {
+        head.append("Connection: keep-alive\r\n");
+    }
+    head.append("\r\n");
+
+    out_bytes_ += head.size();
+    out_.push_back(OutChunk{std::move(head)});
+
+    if (bodyless || is_head) {
+        if (response.file_fd_ >= 0) {
+            ::close(response.file_fd_);
+            response.file_fd_ = -1;
+        }
+        return;
+    }
+
+    // Header and body stay separate buffers - flush() gathers them
+    if (response.file_fd_ >= 0) {
+        OutChunk chunk;
+        chunk.file_fd = response.file_fd_;
+        chunk.file_remaining = response.file_size_;
+        response.file_fd_ = -1;
+        out_bytes_ += chunk.file_remaining;
+        if (chunk.file_remaining > 0) {
+            out_.push_back(std::move(chunk));
+        } else {
+            ::close(chunk.file_fd);
+        }
+    } else if (!response.body_.empty()) {
+        out_bytes_ += response.body_.size();
+        out_.push_back(OutChunk{std::move(response.body_)});
+    }
+}
+
+void HttpConnection::queue_error(int status) {
+    HttpResponse response;
+    response.set_status(status);
+    queue_response(nullptr, response, false);
+    close_after_flush_ = true;
+}
+
+bool HttpConnection::flush() {
+    constexpr int MAX_IOV = 64;
+
+    while (!out_.empty()) {
+        OutChunk& front = out_.front();
+
+        if (front.file_fd >= 0) {
+            ssize_t n = sendfile(fd_, front.file_fd, &front.file_offset, front.file_remaining);
+            if (n > 0) {
+                last_active_ms_.store(now_ms(), std::memory_order_relaxed);
+                front.file_remaining -= static_cast<size_t>(n);
+                out_bytes_ -= static_cast<size_t>(n);
+                if (front.file_remaining == 0) {
+                    ::close(front.file_fd);
+                    out_.pop_front();
+                }
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            return false;  // Error, or the file shrank underneath us
+        }
+
+        // Gather consecutive byte chunks into one writev
+        struct iovec iov[MAX_IOV];
+        int count = 0;
+        for (size_t i = 0; i < out_.size() && count < MAX_IOV && out_[i].file_fd < 0; ++i) {
+            size_t skip = (i == 0) ? out_front_written_ : 0;
+            iov[count].iov_base = const_cast<char*>(out_[i].data.data()) + skip;
+            iov[count].iov_len = out_[i].data.size() - skip;
+            count++;
+        }
+
+        ssize_t n = writev(fd_, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            return false;
+        }
+
+        size_t written = static_cast<size_t>(n);
+        if (written > 0) last_active_ms_.store(now_ms(), std::memory_order_relaxed);
+        out_bytes_ -= written;
+        while (written > 0) {
+            size_t left = out_.front().data.size() - out_front_written_;
+            if (written < left) {
+                out_front_written_ += written;
+                break;
+            }
+            written -= left;
+            out_front_written_ = 0;
+            out_.pop_front();
+        }
+        // Drop empty leftovers so the loop never spins on a zero-length write
+        while (!out_.empty() && out_.front().file_fd < 0 && out_.front().data.size() == out_front_written_) {
+            out_front_written_ = 0;
+            out_.pop_front();
+        }
+    }
+    return true;
+}
+
+void HttpConnection::shutdown() {
+    if (closed_) return;
+    closed_ = true;
+
+    // Clears our on_ready callback, dropping the poller's reference to us
+    NetPoller::instance().close(fd_);
+    ::close(fd_);
+    server_->connection_closed(this);
+}
+
+// ============================================================================
+// HttpServer
+// ============================================================================
+
+HttpServer::HttpServer(HttpHandler handler, size_t worker_threads)
+    : handler_(std::move(handler)),
+      workers_(std::make_unique<ThreadPool>(worker_threads)),
+      link_(std::make_shared<HttpServerLink>()) {
+    link_->server = this;
+}
+
+HttpServer::~HttpServer() {
+    close();
+
+    // Each connection closes on its own worker, after any handler in progress
+    std::vector<std::shared_ptr<HttpConnection>> live;
+    {
+        std::lock_guard<std::mutex> lock(live_mutex_);
+        for (auto& entry : live_) live.push_back(entry.second);
+    }
+    for (auto& connection : live) connection->stop();
+    {
+        std::unique_lock<std::mutex> lock(live_mutex_);
+        live_drained_cv_.wait(lock, [this] { return live_.empty(); });
+    }
+
+    quiesce_link(link_, [](HttpServerLink& link) { link.server = nullptr; });
+    if (timer_fd_ >= 0) {
+        NetPoller::instance().close(timer_fd_);
+        ::close(timer_fd_);
+    }
+    // workers_ joins its threads as it is destroyed
+}
+
+bool HttpServer::listen(int port, const std::string& host) {
+    if (listen_fd_ >= 0) return false;
+    if (!NetPoller::instance().available()) {
+        std::cerr << "ERROR: HTTP server requires the netpoller" << std::endl;
+        return false;
+    }
+
+    // A peer resetting mid-sendfile/writev must not kill the process
+    signal(SIGPIPE, SIG_IGN);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (host.empty() || host == "0.0.0.0") {
+        addr.sin_addr.s_addr = INADDR_ANY;
+    } else if (host == "localhost") {
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    } else if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        ::close(fd);
+        return false;
+    }
+
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    port_ = ntohs(addr.sin_port);
+    listen_fd_ = fd;
+
+    // The timer outlives close() - it keeps sweeping idle connections
+    if (timer_fd_ < 0) {
+        timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        auto link = link_;
+        if (timer_fd_ >= 0 && !NetPoller::instance().watch(timer_fd_, [link]() {
+                with_server(link, false, [](HttpServer* server) { server->on_timer(); });
+            })) {
+            ::close(timer_fd_);
+            timer_fd_ = -1;
+        }
+        if (timer_fd_ < 0) {
+            ::close(fd);
+            listen_fd_ = -1;
+            return false;
+        }
+    }
+
+    quiesce_link(link_, [](HttpServerLink& link) { link.accepting = true; });
+    auto link = link_;
+    if (!NetPoller::instance().watch(fd, [link]() {
+            with_server(link, true, [](HttpServer* server) { server->accept_ready(); });
+        })) {
+        quiesce_link(link_, [](HttpServerLink& link) { link.accepting = false; });
+        ::close(fd);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    // Like Node, a listening server keeps its goroutine's event loop running
+    if (current_goroutine) {
+        owner_goroutine_id_ = current_goroutine->get_id();
+        owner_async_id_ = current_goroutine->add_async_operation(AsyncOpType::SERVER_HANDLE, this);
+    }
+    return true;
+}
+
+void HttpServer::close() {
+    if (listen_fd_ < 0) return;
+
+    // No accept may be running once the fd number is released
+    NetPoller::instance().close(listen_fd_);
+    quiesce_link(link_, [](HttpServerLink& link) { link.accepting = false; });
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+
+    if (owner_async_id_ >= 0) {
+        if (auto owner = GoroutineScheduler::instance().find_goroutine(owner_goroutine_id_)) {
+            owner->complete_async_operation(owner_async_id_);
+        }
+        owner_async_id_ = -1;
+    }
+}
+
+void HttpServer::accept_ready() {
+    // Runs on the poller thread; edge-triggered, so drain the backlog
+    int listen_fd = listen_fd_;
+    while (listen_fd >= 0) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                // The queued connections won't produce another edge, so
+                // come back for them once some descriptors are released
+                if (!accept_paused_) {
+                    std::cerr << "WARNING: HTTP accept out of descriptors, retrying in "
+                              << ACCEPT_RETRY_MS << "ms" << std::endl;
+                }
+                accept_paused_ = true;
+                arm_timer(now_ms() + ACCEPT_RETRY_MS);
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EBADF) {
+                std::cerr << "ERROR: HTTP accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        accept_paused_ = false;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto connection = std::make_shared<HttpConnection>(this, fd);
+        {
+            std::lock_guard<std::mutex> lock(live_mutex_);
+            live_[connection.get()] = connection;
+        }
+        connections_.fetch_add(1, std::memory_order_relaxed);
+        arm_timer(connection->last_active_ms() + idle_timeout_ms_.load());
+
+        // Registering reports any data that already arrived as the first edge
+        auto link = link_;
+        HttpConnection* raw = connection.get();
+        if (!NetPoller::instance().watch(fd, [link, raw]() {
+                with_server(link, false, [raw](HttpServer* server) {
+                    std::shared_ptr<HttpConnection> live;
+                    {
+                        std::lock_guard<std::mutex> lock(server->live_mutex_);
+                        auto it = server->live_.find(raw);
+                        if (it != server->live_.end()) live = it->second;
+                    }
+                    if (live) live->schedule();
+                });
+            })) {
+            ::close(fd);
+            connection_closed(raw);
+        }
+    }
+}
+
+void HttpServer::connection_closed(HttpConnection* connection) {
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(live_mutex_);
+    live_.erase(connection);
+    if (live_.empty()) live_drained_cv_.notify_all();
+}
+
+void HttpServer::arm_timer(int64_t deadline_ms) {
+    if (timer_fd_ < 0) return;
+    if (timer_deadline_ms_ && timer_deadline_ms_ <= deadline_ms) return;
+
+    // A zero it_value would disarm the timer
+    int64_t delay_ms = std::max<int64_t>(deadline_ms - now_ms(), 1);
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = delay_ms / 1000;
+    spec.it_value.tv_nsec = (delay_ms % 1000) * 1000000;
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) == 0) {
+        timer_deadline_ms_ = deadline_ms;
+    }
+}
+
+void HttpServer::on_timer() {
+    // Edge-triggered - drain the expiration count
+    uint64_t expirations;
+    while (::read(timer_fd_, &expirations, sizeof(expirations)) > 0) {}
+    timer_deadline_ms_ = 0;
+
+    if (accept_paused_) {
+        with_server(link_, true, [](HttpServer* server) { server->accept_ready(); });
+    }
+    sweep_idle();
+}
+
+void HttpServer::sweep_idle() {
+    // Re-arms the timer for the connection that goes stale next
+    int64_t now = now_ms();
+    int64_t timeout = idle_timeout_ms_.load();
+    std::vector<std::pair<std::shared_ptr<HttpConnection>, int64_t>> expired;
+    int64_t next = 0;
+    {
+        std::lock_guard<std::mutex> lock(live_mutex_);
+        for (auto& entry : live_) {
+            int64_t last_active = entry.second->last_active_ms();
+            int64_t deadline = last_active + timeout;
+            if (deadline <= now) {
+                expired.emplace_back(entry.second, last_active);
+            } else if (!next || deadline < next) {
+                next = deadline;
+            }
+        }
+    }
+
+    // The worker re-checks, since a request may have arrived since
+    for (auto& entry : expired) {
+        entry.first->expire_if_idle_since(entry.second);
+    }
+    if (next) arm_timer(next);
+}
+
+} // namespace gots
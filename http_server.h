@@ -0,0 +1,148 @@
+#pragma once
+
+#include "http_parser.h"
+#include "runtime.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <sys/types.h>
+
+namespace gots {
+
+// ============================================================================
+// HTTP SERVER - HTTP/1.1 on top of the shared NetPoller
+// ============================================================================
+//
+// The listening socket and every connection are watched by the NetPoller, so
+// an idle keep-alive connection costs no thread. A readiness edge schedules
+// the connection onto a worker pool; the worker reads until EAGAIN, runs the
+// handler for every complete request in the buffer (pipelining), and queues
+// the responses in order. A connection is only ever processed by one worker
+// at a time.
+//
+// Responses are written with writev so the header block and body go out in
+// one syscall without being joined, and send_file() bodies go out with
+// sendfile. A connection stops reading once too much output is queued and
+// resumes when the socket drains. Connections that see no traffic for the
+// idle timeout are closed.
+
+class HttpConnection;
+struct HttpServerLink;
+
+class HttpResponse {
+public:
+    HttpResponse() = default;
+    ~HttpResponse();
+    HttpResponse(const HttpResponse&) = delete;
+    HttpResponse& operator=(const HttpResponse&) = delete;
+
+    void set_status(int status) { status_ = status; }
+    int status() const { return status_; }
+
+    // Adds a header line; Content-Length and Connection are managed by the server
+    void set_header(std::string_view name, std::string_view value);
+
+    // Set the body (moved, not copied, into the output queue)
+    void send(std::string body);
+
+    // Serve a file with sendfile. Returns false (and sets 404) if it can't
+    // be opened.
+    bool send_file(const std::string& path);
+
+    // Close the connection after this response
+    void close_connection() { close_ = true; }
+
+private:
+    friend class HttpConnection;
+
+    int status_ = 200;
+    std::string headers_;   // Preformatted "Name: value\r\n" lines
+    std::string body_;
+    int file_fd_ = -1;
+    size_t file_size_ = 0;
+    bool has_content_type_ = false;
+    bool close_ = false;
+
+    void reset(int status);  // Discard everything the handler set
+};
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+class HttpServer {
+public:
+    // worker_threads = 0 uses one per hardware thread
+    explicit HttpServer(HttpHandler handler, size_t worker_threads = 0);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Bind and start accepting. Port 0 picks a free port (see port()).
+    bool listen(int port, const std::string& host = "0.0.0.0");
+
+    // Stop accepting new connections; open ones finish their current requests
+    // and are closed by the idle timeout. Destroying the server also closes
+    // every open connection and waits for its workers and poller callbacks.
+    void close();
+
+    // Close keep-alive connections that see no traffic for this long
+    void set_idle_timeout_ms(int64_t timeout_ms) { idle_timeout_ms_.store(timeout_ms); }
+    int64_t idle_timeout_ms() const { return idle_timeout_ms_.load(); }
+
+    int port() const { return port_; }
+    size_t connection_count() const { return connections_.load(std::memory_order_relaxed); }
+    int64_t requests_served() const { return requests_.load(std::memory_order_relaxed); }
+
+    // Output queued beyond this stops reading from the connection
+    static constexpr size_t OUTPUT_HIGH_WATER = 256 * 1024;
+    static constexpr size_t READ_CHUNK = 16 * 1024;
+    // Delay before accepting again after running out of descriptors
+    static constexpr int64_t ACCEPT_RETRY_MS = 100;
+    static constexpr int64_t DEFAULT_IDLE_TIMEOUT_MS = 5000;
+
+private:
+    friend class HttpConnection;
+
+    HttpHandler handler_;
+    std::unique_ptr<ThreadPool> workers_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<size_t> connections_{0};
+    std::atomic<int64_t> requests_{0};
+    std::atomic<int64_t> idle_timeout_ms_{DEFAULT_IDLE_TIMEOUT_MS};
+
+    // Open connections, so the idle sweep and the destructor can reach them
+    std::mutex live_mutex_;
+    std::condition_variable live_drained_cv_;
+    std::unordered_map<HttpConnection*, std::shared_ptr<HttpConnection>> live_;
+
+    // What NetPoller callbacks hold instead of `this` - the destructor detaches
+    // it once the callbacks already running have returned
+    std::shared_ptr<HttpServerLink> link_;
+
+    // Keeps the goroutine that called listen() alive while we're listening
+    int64_t owner_goroutine_id_ = -1;
+    int64_t owner_async_id_ = -1;
+
+    // Drives the idle sweep and retries accepting after EMFILE/ENFILE - the
+    // listener is edge-triggered, so the connections already queued would
+    // otherwise wait for a new one. A timerfd watched by the NetPoller; the
+    // flags below are only touched on the poller thread.
+    int timer_fd_ = -1;
+    int64_t timer_deadline_ms_ = 0;  // When the timer fires, 0 if disarmed
+    bool accept_paused_ = false;
+
+    void accept_ready();
+    void arm_timer(int64_t deadline_ms);
+    void on_timer();
+    void sweep_idle();
+    void connection_closed(HttpConnection* connection);
+};
+
+} // namespace gots
@@ -70,15 +70,16 @@ void LockJITCompiler::emit_lock_operation(CodeGenerator& gen, LockOperation op,
             break;
             
         case LockOperation::IS_LOCKED_BY_CURRENT:
-            // Emit inline check for lock ownership
+            // Ownership check is rare enough to stay a runtime call
             if (result_reg >= 0) {
-                // Get current goroutine ID
-                gen.emit_call("__get_current_goroutine_id");
-                
-                // Compare with lock owner
-                gen.emit_mov_reg_mem(result_reg, 8); // Load owner from lock + 8 offset
-                gen.emit_compare(0, result_reg); // Compare RAX (current ID) with owner
-                gen.emit_sete(result_reg); // Set result to 1 if equal
+                if (lock_reg != 7) {
+                    gen.emit_mov_reg_reg(7, lock_reg); // RDI = lock
+                }
+                gen.emit_call("__runtime_lock_is_locked_by_current");
+                gen.emit_and_reg_imm(0, 1); // bool comes back in AL only
+                if (result_reg != 0) {
+                    gen.emit_mov_reg_reg(result_reg, 0);
+                }
             }
             break;
     }
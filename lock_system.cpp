@@ -1,8 +1,25 @@
 #include "lock_system.h"
 #include "goroutine_system.h"
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 #include <thread>
 #include <stdexcept>
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace gots {
 
@@ -15,147 +32,171 @@ std::shared_ptr<Goroutine> get_current_goroutine() {
 
 std::atomic<uint64_t> Lock::next_lock_id_{1};
 
-#ifdef GOTS_DEBUG
-thread_local std::unordered_set<uint64_t> Lock::held_locks_;
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "futex word must be a plain 32-bit integer");
+static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t), "owner must be a plain 64-bit integer");
+
+// ============================================================================
+// Futex and spin helpers
+// ============================================================================
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
 #endif
+}
+
+static inline int64_t monotonic_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Sleep while *word == expected; timeout_ns < 0 waits indefinitely.
+// Returns early on wake, signal, or if the word already changed.
+static void futex_wait(void* word, uint32_t expected, int64_t timeout_ns) {
+    struct timespec ts;
+    struct timespec* timeout = nullptr;
+    if (timeout_ns >= 0) {
+        ts.tv_sec = timeout_ns / 1000000000;
+        ts.tv_nsec = timeout_ns % 1000000000;
+        timeout = &ts;
+    }
+    syscall(SYS_futex, static_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+}
+
+static void futex_wake(void* word, int count) {
+    syscall(SYS_futex, static_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// ============================================================================
+// Lock
+// ============================================================================
+
+Lock::Lock() : Lock(nullptr) {
+}
 
-Lock::Lock() 
-    : owner_goroutine_id_(-1)
-    , lock_count_(0)
+Lock::Lock(const char* site)
+    : state_(0)
+    , recursion_(0)
+    , owner_(-1)
     , lock_id_(next_lock_id_.fetch_add(1))
-    , is_locked_(false) {
+    , spin_estimate_(0)
+    , site_(LockProfiler::enabled() ? LockProfiler::instance().site_stats(site) : nullptr)
+    , acquired_at_ns_(0) {
+    static_assert(offsetof(Lock, state_) == STATE_OFFSET, "JIT lock fast path expects the word at offset 0");
+    static_assert(offsetof(Lock, recursion_) == RECURSION_OFFSET, "JIT lock fast path expects recursion at offset 4");
+    static_assert(offsetof(Lock, owner_) == OWNER_OFFSET, "JIT lock fast path expects the owner at offset 8");
+    if (site_) {
+        site_->locks.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 Lock::~Lock() {
     // Ensure lock is not held during destruction
-    assert(!is_locked_.load());
+    assert(!(state_.load() & LOCKED));
 }
 
-void Lock::lock() {
-    auto current_goroutine = get_current_goroutine();
-    int64_t current_id;
-    if (current_goroutine) {
-        current_id = current_goroutine->get_id();
-    } else {
-        // Fallback to thread ID when no goroutine context
-        current_id = static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+int64_t Lock::current_owner_id() {
+    // Every goroutine runs on its own OS thread, so the thread identifies it
+#if defined(__x86_64__)
+    // fs:[0] holds the thread control block's own address - unique per
+    // thread and a single instruction for JIT-inlined lock fast paths
+    int64_t id;
+    asm("mov %%fs:0, %0" : "=r"(id));
+    return id;
+#else
+    // Hashing the thread id is not free - do it once per thread
+    static thread_local int64_t id =
+        static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return id;
+#endif
+}
+
+void Lock::set_owner(int64_t id) {
+    owner_.store(id, std::memory_order_relaxed);
+}
+
+// Profiling bookkeeping once the lock is ours; wait_start_ns < 0 means it
+// was taken without waiting
+void Lock::note_acquired(int64_t wait_start_ns) {
+    int64_t now = monotonic_ns();
+    site_->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (wait_start_ns >= 0) {
+        site_->contended.fetch_add(1, std::memory_order_relaxed);
+        site_->wait_ns.fetch_add(static_cast<uint64_t>(now - wait_start_ns), std::memory_order_relaxed);
     }
-    
-    #ifdef GOTS_DEBUG
-    check_for_deadlock();
-    #endif
-    
-    // Fast path: try atomic compare-exchange for uncontended case
-    bool expected = false;
-    if (is_locked_.compare_exchange_weak(expected, true, std::memory_order_acquire)) {
-        // Got the lock immediately
-        owner_goroutine_id_.store(current_id, std::memory_order_relaxed);
-        lock_count_.store(1, std::memory_order_relaxed);
-        
-        #ifdef GOTS_DEBUG
-        held_locks_.insert(lock_id_);
-        #endif
-        return;
+    acquired_at_ns_ = now;
+}
+
+void Lock::note_released() {
+    uint64_t held = static_cast<uint64_t>(monotonic_ns() - acquired_at_ns_);
+    uint64_t longest = site_->max_hold_ns.load(std::memory_order_relaxed);
+    while (held > longest &&
+           !site_->max_hold_ns.compare_exchange_weak(longest, held, std::memory_order_relaxed)) {
     }
+}
+
+void Lock::lock() {
+    int64_t current_id = current_owner_id();
     
-    // Check for recursive locking by same goroutine
-    if (owner_goroutine_id_.load(std::memory_order_relaxed) == current_id) {
-        // Recursive lock - just increment count
-        lock_count_.fetch_add(1, std::memory_order_relaxed);
+    // Fast path: uncontended lock is a single CAS
+    uint32_t expected = 0;
+    if (state_.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) {
+        set_owner(current_id);
+        if (site_) note_acquired(-1);
         return;
     }
     
-    // Slow path: need to wait
-    std::unique_lock<std::mutex> guard(internal_mutex_);
-    
-    while (is_locked_.load(std::memory_order_acquire)) {
-        // Yield to goroutine scheduler while waiting
-        yield_to_scheduler_if_needed();
-        
-        // Wait for lock to become available
-        cv_.wait(guard, [this] { 
-            return !is_locked_.load(std::memory_order_acquire); 
-        });
+    // Recursive lock - only the owner ever sees its own id here
+    if (owner_.load(std::memory_order_relaxed) == current_id) {
+        recursion_++;
+        return;
     }
     
-    // Acquire the lock
-    is_locked_.store(true, std::memory_order_relaxed);
-    owner_goroutine_id_.store(current_id, std::memory_order_relaxed);
-    lock_count_.store(1, std::memory_order_relaxed);
-    
-    #ifdef GOTS_DEBUG
-    held_locks_.insert(lock_id_);
-    #endif
+    int64_t wait_start = site_ ? monotonic_ns() : 0;
+    lock_slow(-1);
+    set_owner(current_id);
+    if (site_) note_acquired(wait_start);
 }
 
 void Lock::unlock() {
-    auto current_goroutine = get_current_goroutine();
-    int64_t current_id;
-    if (current_goroutine) {
-        current_id = current_goroutine->get_id();
-    } else {
-        // Fallback to thread ID when no goroutine context
-        current_id = static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
-    }
-    
     // Verify current goroutine owns the lock
-    if (owner_goroutine_id_.load(std::memory_order_relaxed) != current_id) {
+    if (owner_.load(std::memory_order_relaxed) != current_owner_id()) {
         throw std::runtime_error("Lock::unlock() called by non-owner goroutine");
     }
     
-    uint32_t count = lock_count_.load(std::memory_order_relaxed);
-    if (count == 0) {
-        throw std::runtime_error("Lock::unlock() called on unlocked lock");
-    }
-    
-    if (count > 1) {
+    if (recursion_ > 0) {
         // Recursive unlock - just decrement count
-        lock_count_.fetch_sub(1, std::memory_order_relaxed);
+        recursion_--;
         return;
     }
     
     // Final unlock
-    #ifdef GOTS_DEBUG
-    held_locks_.erase(lock_id_);
-    #endif
+    if (site_) note_released();
+    owner_.store(-1, std::memory_order_relaxed);
     
-    {
-        std::lock_guard<std::mutex> guard(internal_mutex_);
-        owner_goroutine_id_.store(-1, std::memory_order_relaxed);
-        lock_count_.store(0, std::memory_order_relaxed);
-        is_locked_.store(false, std::memory_order_release);
+    // Fast path: nobody waiting
+    uint32_t expected = LOCKED;
+    if (state_.compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed)) {
+        return;
     }
-    
-    // Notify waiting goroutines
-    cv_.notify_one();
-    notify_goroutine_scheduler();
+    unlock_slow();
 }
 
 bool Lock::try_lock() {
-    auto current_goroutine = get_current_goroutine();
-    int64_t current_id;
-    if (current_goroutine) {
-        current_id = current_goroutine->get_id();
-    } else {
-        // Fallback to thread ID when no goroutine context
-        current_id = static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
-    }
+    int64_t current_id = current_owner_id();
     
     // Check for recursive locking
-    if (owner_goroutine_id_.load(std::memory_order_relaxed) == current_id) {
-        lock_count_.fetch_add(1, std::memory_order_relaxed);
+    if (owner_.load(std::memory_order_relaxed) == current_id) {
+        recursion_++;
         return true;
     }
     
-    // Try to acquire lock atomically
-    bool expected = false;
-    if (is_locked_.compare_exchange_weak(expected, true, std::memory_order_acquire)) {
-        owner_goroutine_id_.store(current_id, std::memory_order_relaxed);
-        lock_count_.store(1, std::memory_order_relaxed);
-        
-        #ifdef GOTS_DEBUG
-        held_locks_.insert(lock_id_);
-        #endif
+    if (try_acquire_state()) {
+        set_owner(current_id);
+        if (site_) note_acquired(-1);
         return true;
     }
     
@@ -163,47 +204,24 @@ bool Lock::try_lock() {
 }
 
 bool Lock::try_lock_for(const std::chrono::milliseconds& timeout) {
-    auto current_goroutine = get_current_goroutine();
-    int64_t current_id;
-    if (current_goroutine) {
-        current_id = current_goroutine->get_id();
-    } else {
-        // Fallback to thread ID when no goroutine context
-        current_id = static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
-    }
+    int64_t current_id = current_owner_id();
     
     // Check for recursive locking
-    if (owner_goroutine_id_.load(std::memory_order_relaxed) == current_id) {
-        lock_count_.fetch_add(1, std::memory_order_relaxed);
+    if (owner_.load(std::memory_order_relaxed) == current_id) {
+        recursion_++;
         return true;
     }
     
-    // Try fast path first
-    bool expected = false;
-    if (is_locked_.compare_exchange_weak(expected, true, std::memory_order_acquire)) {
-        owner_goroutine_id_.store(current_id, std::memory_order_relaxed);
-        lock_count_.store(1, std::memory_order_relaxed);
-        
-        #ifdef GOTS_DEBUG
-        held_locks_.insert(lock_id_);
-        #endif
+    if (try_acquire_state()) {
+        set_owner(current_id);
+        if (site_) note_acquired(-1);
         return true;
     }
     
-    // Wait with timeout
-    std::unique_lock<std::mutex> guard(internal_mutex_);
-    
-    if (cv_.wait_for(guard, timeout, [this] { 
-        return !is_locked_.load(std::memory_order_acquire); 
-    })) {
-        // Got the lock within timeout
-        is_locked_.store(true, std::memory_order_relaxed);
-        owner_goroutine_id_.store(current_id, std::memory_order_relaxed);
-        lock_count_.store(1, std::memory_order_relaxed);
-        
-        #ifdef GOTS_DEBUG
-        held_locks_.insert(lock_id_);
-        #endif
+    int64_t wait_start = monotonic_ns();
+    if (lock_slow(wait_start + std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count())) {
+        set_owner(current_id);
+        if (site_) note_acquired(wait_start);
         return true;
     }
     
@@ -211,57 +229,575 @@ bool Lock::try_lock_for(const std::chrono::milliseconds& timeout) {
 }
 
 bool Lock::is_locked_by_current() const {
-    auto current_goroutine = get_current_goroutine();
-    int64_t current_id;
-    if (current_goroutine) {
-        current_id = current_goroutine->get_id();
-    } else {
-        // Fallback to thread ID when no goroutine context
-        current_id = static_cast<int64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return owner_.load(std::memory_order_relaxed) == current_owner_id();
+}
+
+bool Lock::try_acquire_state() {
+    // Free and not reserved for a starving waiter
+    uint32_t s = state_.load(std::memory_order_relaxed);
+    while (!(s & (LOCKED | HANDOFF))) {
+        if (state_.compare_exchange_weak(s, s | LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Lock::spin_acquire() {
+    // Spinning only helps if the owner can run at the same time
+    static const bool multicore = std::thread::hardware_concurrency() > 1;
+    if (!multicore) return false;
+    
+    // Spin a little longer than it has recently taken to get the lock; the
+    // estimate follows the observed rounds with a 1/8 moving average
+    int32_t estimate = spin_estimate_.load(std::memory_order_relaxed);
+    int32_t limit = std::min(MAX_SPIN, estimate * 2 + 10);
+    for (int32_t round = 0; round < limit; ++round) {
+        uint32_t s = state_.load(std::memory_order_relaxed);
+        if (s & HANDOFF) break;  // Owed to a starving waiter - don't barge
+        if (!(s & LOCKED) && try_acquire_state()) {
+            spin_estimate_.store(estimate + (round - estimate) / 8, std::memory_order_relaxed);
+            return true;
+        }
+        cpu_relax();
     }
+    spin_estimate_.store(estimate + (limit - estimate) / 8, std::memory_order_relaxed);
+    return false;
+}
+
+// Keeps a parked locker in the profiler's wait-for graph until it returns
+namespace {
+struct WaitForEdge {
+    bool recorded = false;
+    void record(const Lock* lock) {
+        LockProfiler::instance().begin_wait(lock);
+        recorded = true;
+    }
+    ~WaitForEdge() {
+        if (recorded) LockProfiler::instance().end_wait();
+    }
+};
+}
+
+bool Lock::lock_slow(int64_t deadline_ns) {
+    if (spin_acquire()) return true;
+    
+    // Park on the futex. Being counted in the word is what makes unlock()
+    // take its slow path and wake us.
+    state_.fetch_add(WAITER_ONE, std::memory_order_relaxed);
+    int64_t wait_start = monotonic_ns();
+    WaitForEdge edge;
     
-    return owner_goroutine_id_.load(std::memory_order_relaxed) == current_id &&
-           lock_count_.load(std::memory_order_relaxed) > 0;
+    while (true) {
+        uint32_t s = state_.load(std::memory_order_relaxed);
+        
+        if (s & HANDED) {
+            // unlock() passed the lock on without releasing it. Leave handoff
+            // mode once nobody else is waiting or waits are short again.
+            uint32_t next = (s & ~HANDED) - WAITER_ONE;
+            if ((next >> WAITER_SHIFT) == 0 || monotonic_ns() - wait_start < STARVATION_NS) {
+                next &= ~HANDOFF;
+            }
+            if (state_.compare_exchange_weak(s, next, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+            continue;
+        }
+        
+        if (!(s & (LOCKED | HANDOFF))) {
+            if (state_.compare_exchange_weak(s, (s | LOCKED) - WAITER_ONE,
+                                             std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+            continue;
+        }
+        
+        int64_t now = monotonic_ns();
+        if (!(s & HANDOFF) && now - wait_start > STARVATION_NS) {
+            // Waited too long - stop newcomers from barging in ahead of us
+            state_.compare_exchange_weak(s, s | HANDOFF, std::memory_order_relaxed);
+            continue;
+        }
+        
+        if (deadline_ns >= 0 && now >= deadline_ns) {
+            // Timed out - withdraw from the waiter count
+            if (state_.compare_exchange_weak(s, s - WAITER_ONE, std::memory_order_relaxed)) {
+                return false;
+            }
+            continue;
+        }
+        
+        // Only waits without a deadline can deadlock
+        if (site_ && deadline_ns < 0 && !edge.recorded) {
+            edge.record(this);
+        }
+        
+        futex_wait(&state_, s, deadline_ns >= 0 ? deadline_ns - now : -1);
+    }
+}
+
+void Lock::unlock_slow() {
+    uint32_t s = state_.load(std::memory_order_relaxed);
+    while (true) {
+        uint32_t waiters = s >> WAITER_SHIFT;
+        uint32_t next;
+        if (waiters == 0) {
+            next = s & ~(LOCKED | HANDOFF);
+        } else if (s & HANDOFF) {
+            next = s | HANDED;   // Stay locked; a waiter takes ownership
+        } else {
+            next = s & ~LOCKED;
+        }
+        if (state_.compare_exchange_weak(s, next, std::memory_order_release, std::memory_order_relaxed)) {
+            if (waiters > 0) {
+                futex_wake(&state_, 1);
+            }
+            return;
+        }
+    }
 }
 
-void Lock::yield_to_scheduler_if_needed() {
-    // Integrate with goroutine scheduler - yield current goroutine
-    // if we're blocking and allow other goroutines to run
-    auto current_goroutine = get_current_goroutine();
-    if (current_goroutine) {
-        // Signal that this goroutine is waiting
-        current_goroutine->trigger_event_loop();
+// ============================================================================
+// LockProfiler
+// ============================================================================
+
+static bool lock_profile_requested() {
+    const char* value = std::getenv("GOTS_LOCK_PROFILE");
+    return value && *value && std::strcmp(value, "0") != 0;
+}
+
+std::atomic<bool> LockProfiler::enabled_{lock_profile_requested()};
+
+LockProfiler& LockProfiler::instance() {
+    // Use heap allocation to avoid static destruction order issues
+    static LockProfiler* profiler = new LockProfiler();
+    return *profiler;
+}
+
+LockProfiler::LockProfiler() {
+}
+
+void LockProfiler::set_enabled(bool on) {
+    enabled_.store(on, std::memory_order_relaxed);
+}
+
+LockSiteStats* LockProfiler::site_stats(const char* site) {
+    static std::once_flag hooks_installed;
+    std::call_once(hooks_installed, install_report_hooks);
+    
+    std::lock_guard<std::mutex> guard(sites_mutex_);
+    auto& stats = sites_[site ? site : "(runtime)"];
+    if (!stats) {
+        stats = std::make_unique<LockSiteStats>();
+        stats->site = site ? site : "(runtime)";
+    }
+    return stats.get();
+}
+
+static int64_t current_goroutine_id() {
+    return current_goroutine ? current_goroutine->get_id() : 0;
+}
+
+void LockProfiler::begin_wait(const Lock* lock) {
+    int64_t me = Lock::current_owner_id();
+    std::lock_guard<std::mutex> guard(graph_mutex_);
+    Waiter self{lock, current_goroutine_id()};
+    waiting_[me] = self;
+    
+    // Follow lock -> owner -> lock that owner is parked on ... Reaching
+    // ourselves again closes a cycle. Whoever parks last in a cycle finds
+    // it, so each deadlock is reported once.
+    std::vector<std::pair<int64_t, Waiter>> chain{{me, self}};
+    const Lock* current = lock;
+    for (size_t step = 0; step <= waiting_.size(); ++step) {
+        int64_t owner = current->owner_.load(std::memory_order_relaxed);
+        if (owner == -1) return;
+        if (owner == me) {
+            report_cycle(chain);
+            return;
+        }
+        auto it = waiting_.find(owner);
+        if (it == waiting_.end()) return;
+        chain.push_back(*it);
+        current = it->second.lock;
+    }
+}
+
+void LockProfiler::end_wait() {
+    int64_t me = Lock::current_owner_id();
+    std::lock_guard<std::mutex> guard(graph_mutex_);
+    waiting_.erase(me);
+}
+
+static std::string waiter_name(int64_t owner_id, int64_t goroutine_id) {
+    std::ostringstream name;
+    if (goroutine_id > 0) {
+        name << "goroutine " << goroutine_id;
     } else {
-        // Fallback for non-goroutine threads
-        std::this_thread::yield();
+        name << "thread 0x" << std::hex << owner_id;
     }
+    return name.str();
 }
 
-void Lock::notify_goroutine_scheduler() {
-    // Notify scheduler that a lock has been released
-    // This can help the scheduler make better decisions about
-    // which goroutines to run next
-    auto current_goroutine = get_current_goroutine();
-    if (current_goroutine) {
-        current_goroutine->trigger_event_loop();
+void LockProfiler::report_cycle(const std::vector<std::pair<int64_t, Waiter>>& cycle) {
+    deadlocks_.fetch_add(1);
+    
+    std::ostringstream out;
+    out << "ERROR: Deadlock detected - " << cycle.size() << " goroutines wait on each other:" << std::endl;
+    for (size_t i = 0; i < cycle.size(); ++i) {
+        const auto& waiter = cycle[i];
+        const auto& holder = cycle[(i + 1) % cycle.size()];
+        const Lock* lock = waiter.second.lock;
+        out << "  " << waiter_name(waiter.first, waiter.second.goroutine_id)
+            << " waits for lock #" << lock->get_id()
+            << " (created at " << (lock->site_ ? lock->site_->site : "(unknown)") << ")"
+            << " held by " << waiter_name(holder.first, holder.second.goroutine_id) << std::endl;
     }
+    std::cerr << out.str();
 }
 
-#ifdef GOTS_DEBUG
-void Lock::check_for_deadlock() {
-    // Simple deadlock detection: check if we already hold this lock
-    if (held_locks_.find(lock_id_) != held_locks_.end()) {
-        throw std::runtime_error("Potential deadlock detected: recursive lock acquisition");
+void LockProfiler::report(std::ostream& out) {
+    // Snapshot first - counters keep moving while we sort
+    struct Row {
+        std::string site;
+        uint64_t locks, acquisitions, contended, wait_ns, max_hold_ns;
+    };
+    std::vector<Row> rows;
+    {
+        std::lock_guard<std::mutex> guard(sites_mutex_);
+        for (auto& entry : sites_) {
+            const LockSiteStats& stats = *entry.second;
+            rows.push_back({stats.site, stats.locks.load(), stats.acquisitions.load(), stats.contended.load(),
+                            stats.wait_ns.load(), stats.max_hold_ns.load()});
+        }
     }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.wait_ns > b.wait_ns; });
     
-    // More sophisticated deadlock detection could be added here
-    // using lock ordering, wait-for graphs, etc.
+    std::ostringstream text;
+    text << "=== Lock contention profile (by total wait) ===" << std::endl;
+    text << std::setw(12) << "wait ms" << std::setw(12) << "contended" << std::setw(12) << "acquired"
+         << std::setw(14) << "avg wait us" << std::setw(14) << "max hold us" << std::setw(8) << "locks"
+         << "  site" << std::endl;
+    text << std::fixed << std::setprecision(3);
+    for (const Row& row : rows) {
+        double avg_wait_us = row.contended ? row.wait_ns / 1e3 / row.contended : 0.0;
+        text << std::setw(12) << row.wait_ns / 1e6 << std::setw(12) << row.contended
+             << std::setw(12) << row.acquisitions << std::setw(14) << avg_wait_us
+             << std::setw(14) << row.max_hold_ns / 1e3 << std::setw(8) << row.locks
+             << "  " << row.site << std::endl;
+    }
+    if (deadlocks_.load() > 0) {
+        text << deadlocks_.load() << " deadlock(s) detected" << std::endl;
+    }
+    out << text.str() << std::flush;
+}
+
+// SIGUSR1 only writes to a pipe; a reporter thread does the actual printing
+// outside signal context
+static int report_pipe[2] = {-1, -1};
+
+static void request_lock_report(int) {
+    int saved_errno = errno;
+    char byte = 1;
+    ssize_t ignored = write(report_pipe[1], &byte, 1);
+    (void)ignored;
+    errno = saved_errno;
+}
+
+void LockProfiler::install_report_hooks() {
+    std::atexit([]() { LockProfiler::instance().report(std::cerr); });
+    
+    if (pipe2(report_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        std::cerr << "ERROR: Lock profiler could not create report pipe: " << strerror(errno) << std::endl;
+        return;
+    }
+    // Only the write end may drop bytes; the reporter blocks on reads
+    fcntl(report_pipe[0], F_SETFL, 0);
+    std::thread([]() {
+        char byte;
+        while (true) {
+            ssize_t n = read(report_pipe[0], &byte, 1);
+            if (n > 0) {
+                LockProfiler::instance().report(std::cerr);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                break;
+            }
+        }
+    }).detach();
+    
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_lock_report;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+}
+
+// Bounded busy-wait before parking, for the short waits typical of these
+// primitives; returns as soon as done() holds
+template <typename Predicate>
+static bool spin_until(Predicate done) {
+    static const bool multicore = std::thread::hardware_concurrency() > 1;
+    if (!multicore) return done();
+    for (int32_t round = 0; round < Lock::MAX_SPIN; ++round) {
+        if (done()) return true;
+        cpu_relax();
+    }
+    return done();
+}
+
+static int64_t deadline_after(const std::chrono::milliseconds& timeout) {
+    return monotonic_ns() + std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+}
+
+// ============================================================================
+// WaitGroup
+// ============================================================================
+
+WaitGroup::WaitGroup() : count_(0), waiters_(0), epoch_(0) {
+    static_assert(offsetof(WaitGroup, count_) == COUNT_OFFSET, "JIT WaitGroup fast path expects the count at offset 0");
+    static_assert(offsetof(WaitGroup, waiters_) == WAITERS_OFFSET, "JIT WaitGroup fast path expects waiters at offset 4");
+}
+
+void WaitGroup::add(int32_t delta) {
+    if (count_.fetch_add(delta) + delta <= 0) {
+        settle();
+    }
+}
+
+void WaitGroup::settle() {
+    int32_t count = count_.load();
+    if (count < 0) {
+        throw std::runtime_error("WaitGroup counter went negative");
+    }
+    // waiters_ is raised before a waiter reads the count, so either it sees
+    // zero itself or we see it here
+    if (count == 0 && waiters_.load() > 0) {
+        epoch_.fetch_add(1);
+        futex_wake(&epoch_, INT_MAX);
+    }
+}
+
+void WaitGroup::wait() {
+    wait_until(-1);
+}
+
+bool WaitGroup::wait_for(const std::chrono::milliseconds& timeout) {
+    return wait_until(deadline_after(timeout));
+}
+
+bool WaitGroup::wait_until(int64_t deadline_ns) {
+    if (spin_until([this]() { return count_.load() <= 0; })) return true;
+    
+    waiters_.fetch_add(1);
+    bool released = true;
+    while (true) {
+        // Read the epoch first: a release after this makes futex_wait return
+        uint32_t epoch = epoch_.load();
+        if (count_.load() <= 0) break;
+        int64_t now = monotonic_ns();
+        if (deadline_ns >= 0 && now >= deadline_ns) {
+            released = false;
+            break;
+        }
+        futex_wait(&epoch_, epoch, deadline_ns >= 0 ? deadline_ns - now : -1);
+    }
+    waiters_.fetch_sub(1);
+    return released;
+}
+
+// ============================================================================
+// Semaphore
+// ============================================================================
+
+Semaphore::Semaphore(int32_t permits) : permits_(permits), waiters_(0) {
+    static_assert(offsetof(Semaphore, permits_) == PERMITS_OFFSET, "JIT Semaphore fast path expects permits at offset 0");
+    static_assert(offsetof(Semaphore, waiters_) == WAITERS_OFFSET, "JIT Semaphore fast path expects waiters at offset 4");
+    if (permits < 0) {
+        throw std::invalid_argument("Semaphore permits must not be negative");
+    }
+}
+
+bool Semaphore::try_acquire() {
+    int32_t permits = permits_.load(std::memory_order_relaxed);
+    while (permits > 0) {
+        if (permits_.compare_exchange_weak(permits, permits - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Semaphore::acquire() {
+    if (!try_acquire()) {
+        acquire_slow(-1);
+    }
+}
+
+bool Semaphore::try_acquire_for(const std::chrono::milliseconds& timeout) {
+    return try_acquire() || acquire_slow(deadline_after(timeout));
+}
+
+bool Semaphore::acquire_slow(int64_t deadline_ns) {
+    if (spin_until([this]() { return try_acquire(); })) return true;
+    
+    waiters_.fetch_add(1);
+    bool acquired = false;
+    while (true) {
+        if (try_acquire()) {
+            acquired = true;
+            break;
+        }
+        int64_t now = monotonic_ns();
+        if (deadline_ns >= 0 && now >= deadline_ns) break;
+        // Only sleeps while no permits are left
+        futex_wait(&permits_, 0, deadline_ns >= 0 ? deadline_ns - now : -1);
+    }
+    waiters_.fetch_sub(1);
+    return acquired;
+}
+
+void Semaphore::release(int32_t count) {
+    permits_.fetch_add(count, std::memory_order_release);
+    if (waiters_.load() > 0) {
+        futex_wake(&permits_, count);
+    }
+}
+
+void Semaphore::wake_one() {
+    if (waiters_.load() > 0) {
+        futex_wake(&permits_, 1);
+    }
+}
+
+// ============================================================================
+// RWLock
+// ============================================================================
+
+RWLock::RWLock() : slot_mask_(0), writer_(0), drain_epoch_(0) {
+    size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    size_t slots = 1;
+    while (slots < cpus && slots < MAX_READER_SLOTS) slots <<= 1;
+    slots_.reset(new ReaderSlot[slots]);
+    slot_mask_ = slots - 1;
+}
+
+RWLock::~RWLock() {
+    assert(writer_.load() == 0 && active_readers() == 0);
+}
+
+RWLock::ReaderSlot& RWLock::my_slot() {
+    // sched_getcpu() is a vDSO read - no syscall
+    int cpu = sched_getcpu();
+    return slots_[(cpu < 0 ? 0 : cpu) & slot_mask_];
+}
+
+int64_t RWLock::active_readers() const {
+    int64_t total = 0;
+    for (size_t i = 0; i <= slot_mask_; ++i) {
+        total += slots_[i].count.load();
+    }
+    return total;
+}
+
+bool RWLock::enter_read() {
+    // Announce first, then check for a writer. The writer raises its flag
+    // first, then sums the slots, so one of the two always sees the other.
+    ReaderSlot& slot = my_slot();
+    slot.count.fetch_add(1);
+    if (writer_.load() == 0) return true;
+    
+    // A writer is pending or active - back out and let it drain
+    slot.count.fetch_sub(1);
+    drain_epoch_.fetch_add(1);
+    futex_wake(&drain_epoch_, 1);
+    return false;
+}
+
+void RWLock::read_lock() {
+    while (!enter_read()) {
+        if (!spin_until([this]() { return writer_.load() == 0; })) {
+            futex_wait(&writer_, 1, -1);
+        }
+    }
+}
+
+bool RWLock::try_read_lock() {
+    return enter_read();
+}
+
+void RWLock::read_unlock() {
+    my_slot().count.fetch_sub(1);
+    if (writer_.load() != 0) {
+        drain_epoch_.fetch_add(1);
+        futex_wake(&drain_epoch_, 1);
+    }
+}
+
+void RWLock::write_lock() {
+    writer_mutex_.lock();
+    writer_.store(1);
+    wait_for_readers();
+}
+
+bool RWLock::try_write_lock() {
+    if (!writer_mutex_.try_lock()) return false;
+    writer_.store(1);
+    if (active_readers() == 0) return true;
+    
+    write_unlock();
+    return false;
+}
+
+void RWLock::write_unlock() {
+    writer_.store(0);
+    futex_wake(&writer_, INT_MAX);
+    writer_mutex_.unlock();
+}
+
+void RWLock::wait_for_readers() {
+    if (spin_until([this]() { return active_readers() == 0; })) return;
+    
+    while (true) {
+        uint32_t epoch = drain_epoch_.load();
+        if (active_readers() == 0) return;
+        futex_wait(&drain_epoch_, epoch, -1);
+    }
+}
+
+// ============================================================================
+// Barrier
+// ============================================================================
+
+Barrier::Barrier(int32_t parties) : parties_(parties), arrived_(0), generation_(0) {
+    if (parties <= 0) {
+        throw std::invalid_argument("Barrier needs at least one party");
+    }
+}
+
+bool Barrier::wait() {
+    uint32_t generation = generation_.load();
+    if (arrived_.fetch_add(1) + 1 == parties_) {
+        // Last to arrive: reset for the next phase before releasing anyone
+        arrived_.store(0);
+        generation_.fetch_add(1);
+        futex_wake(&generation_, INT_MAX);
+        return true;
+    }
+    
+    if (!spin_until([this, generation]() { return generation_.load() != generation; })) {
+        while (generation_.load() == generation) {
+            futex_wait(&generation_, generation, -1);
+        }
+    }
+    return false;
 }
-#endif
 
 // LockFactory implementation
-std::shared_ptr<Lock> LockFactory::create_lock() {
-    return std::make_shared<Lock>();
+std::shared_ptr<Lock> LockFactory::create_lock(const char* site) {
+    return std::make_shared<Lock>(site);
 }
 
 void LockFactory::register_with_runtime() {
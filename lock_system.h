@@ -1,10 +1,13 @@
 #pragma once
 
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
+#include <cstdint>
 #include <memory>
-#include <unordered_set>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <chrono>
 
 namespace gots {
@@ -15,9 +18,37 @@ class Goroutine;
 // Simple stub for getting current goroutine (will be properly implemented later)
 std::shared_ptr<Goroutine> get_current_goroutine();
 
+struct LockSiteStats;
+
+// ============================================================================
+// LOCK - Adaptive spin-then-futex mutex
+// ============================================================================
+//
+// All lock state lives in one 32-bit word:
+//
+//   bit 0      LOCKED    held by some goroutine
+//   bit 1      HANDOFF   starvation mode - the lock is passed directly to a
+//                        waiter on unlock instead of being up for grabs
+//   bit 2      HANDED    set by unlock in HANDOFF mode; the waiter that
+//                        clears it becomes the owner
+//   bits 8-31  number of goroutines parked (or about to park) on the futex
+//
+// An uncontended lock() is one CAS and unlock() is one CAS. Under contention
+// a locker first spins with `pause` for an adaptively chosen number of rounds
+// (critical sections are usually short), then parks in futex(2). A waiter
+// that has been parked longer than STARVATION_NS switches the lock to HANDOFF
+// mode so newcomers stop barging in ahead of it.
+//
+// Ownership (owner_) is a plain relaxed store after acquisition; the
+// recursion count is only touched when the owner locks again. The field
+// offsets are part of the JIT's inline fast path and must not change.
+//
+// `site` names where the lock was created ("file.gts:12:9"); it is only
+// used by the contention profiler (see LockProfiler below).
 class Lock {
 public:
     Lock();
+    explicit Lock(const char* site);
     ~Lock();
     
     // Primary interface - matches GoTS syntax: lock.lock(), lock.unlock()
@@ -36,36 +67,61 @@ public:
     // Get lock ID for debugging
     uint64_t get_id() const { return lock_id_; }
 
+    // State word layout
+    static constexpr uint32_t LOCKED = 1u << 0;
+    static constexpr uint32_t HANDOFF = 1u << 1;
+    static constexpr uint32_t HANDED = 1u << 2;
+    static constexpr uint32_t WAITER_SHIFT = 8;
+    static constexpr uint32_t WAITER_ONE = 1u << WAITER_SHIFT;
+
+    // Tuning
+    static constexpr int32_t MAX_SPIN = 100;           // Upper bound on spin rounds
+    static constexpr int64_t STARVATION_NS = 1000000;  // 1ms parked before handoff mode
+
+    // Field offsets read and written by X86CodeGen's inline fast paths
+    static constexpr int STATE_OFFSET = 0;
+    static constexpr int RECURSION_OFFSET = 4;
+    static constexpr int OWNER_OFFSET = 8;
+
+    // Identifier stored in owner_ for the calling goroutine. On x86-64 this
+    // is the thread pointer, which JIT code loads with `mov reg, fs:[0]`.
+    static int64_t current_owner_id();
+
+    // Slow path behind an inlined unlock: owner_ is already cleared and
+    // the LOCKED -> 0 CAS failed because the word records waiters
+    void unlock_contended() { unlock_slow(); }
+
 private:
-    mutable std::mutex internal_mutex_;
-    std::condition_variable cv_;
-    
-    // Track which goroutine owns the lock
-    std::atomic<int64_t> owner_goroutine_id_;
-    std::atomic<uint32_t> lock_count_; // For recursive locking
-    
+    std::atomic<uint32_t> state_;         // Offset 0 - the lock word
+    uint32_t recursion_;                  // Offset 4 - extra acquisitions by the owner
+    std::atomic<int64_t> owner_;          // Offset 8 - owner id, -1 when free
+
     // Unique lock identifier
     uint64_t lock_id_;
     static std::atomic<uint64_t> next_lock_id_;
+
+    // Average spin rounds that led to acquisition, drives the spin budget
+    std::atomic<int32_t> spin_estimate_;
+
+    // Profiling - site_ is null unless GOTS_LOCK_PROFILE was on at creation
+    LockSiteStats* site_;
+    int64_t acquired_at_ns_;              // Written by the owner only
+
+    bool try_acquire_state();
+    bool spin_acquire();
+    bool lock_slow(int64_t deadline_ns);
+    void unlock_slow();
+    void set_owner(int64_t id);
+    void note_acquired(int64_t wait_start_ns);
+    void note_released();
     
-    // Performance optimization: fast path for uncontended locks
-    std::atomic<bool> is_locked_;
-    
-    // Integration with goroutine event loop
-    void yield_to_scheduler_if_needed();
-    void notify_goroutine_scheduler();
-    
-    // Deadlock detection (optional, for debug builds)
-    #ifdef GOTS_DEBUG
-    static thread_local std::unordered_set<uint64_t> held_locks_;
-    void check_for_deadlock();
-    #endif
+    friend class LockProfiler;
 };
 
 // Lock factory for integration with runtime system
 class LockFactory {
 public:
-    static std::shared_ptr<Lock> create_lock();
+    static std::shared_ptr<Lock> create_lock(const char* site = nullptr);
     static void register_with_runtime();
 };
 
@@ -90,4 +146,199 @@ private:
     Lock& lock_;
 };
 
+// ============================================================================
+// LOCK PROFILER - Contention statistics and deadlock detection
+// ============================================================================
+//
+// Enabled with GOTS_LOCK_PROFILE=1 (or set_enabled() before any lock is
+// created). Every Lock then reports to the statistics of its creation site:
+// acquisitions, how many of them had to wait, total wait time and the
+// longest hold. The JIT stops inlining lock fast paths in this mode so
+// every acquisition is seen.
+//
+// The report, sorted by total wait time, goes to stderr at exit and
+// whenever the process receives SIGUSR1.
+//
+// A goroutine about to park on a lock indefinitely is recorded in a
+// wait-for graph (goroutine -> lock -> owning goroutine). If following the
+// owners leads back to the parking goroutine, the cycle is a deadlock and
+// is printed with the goroutines and lock creation sites involved.
+struct LockSiteStats {
+    std::string site;
+    std::atomic<uint64_t> locks{0};
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> wait_ns{0};
+    std::atomic<uint64_t> max_hold_ns{0};
+};
+
+class LockProfiler {
+public:
+    static LockProfiler& instance();
+    
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void set_enabled(bool on);
+    
+    // Statistics slot for a creation site; null site is "(runtime)"
+    LockSiteStats* site_stats(const char* site);
+    
+    // Wait-for graph, maintained around indefinite parks in Lock::lock()
+    void begin_wait(const Lock* lock);
+    void end_wait();
+    
+    void report(std::ostream& out);
+    uint64_t deadlocks_detected() const { return deadlocks_.load(); }
+
+private:
+    LockProfiler();
+    
+    struct Waiter {
+        const Lock* lock;
+        int64_t goroutine_id;
+    };
+    
+    static std::atomic<bool> enabled_;
+    
+    std::mutex sites_mutex_;
+    std::unordered_map<std::string, std::unique_ptr<LockSiteStats>> sites_;
+    
+    std::mutex graph_mutex_;
+    std::unordered_map<int64_t, Waiter> waiting_;   // Owner id -> lock it is parked on
+    std::atomic<uint64_t> deadlocks_{0};
+    
+    void report_cycle(const std::vector<std::pair<int64_t, Waiter>>& cycle);
+    static void install_report_hooks();
+};
+
+// ============================================================================
+// WAITGROUP - Fan-in counter
+// ============================================================================
+//
+// add(n) before starting n goroutines, done() as each finishes, wait() until
+// the count reaches zero. Unlike a Promise per child nothing is allocated.
+// Goroutines are OS threads, so blocking parks the thread in futex(2) on
+// epoch_; done() only makes a syscall when the count hits zero with waiters.
+class WaitGroup {
+public:
+    WaitGroup();
+    
+    void add(int32_t delta);
+    void done() { add(-1); }
+    void wait();
+    bool wait_for(const std::chrono::milliseconds& timeout);
+    
+    int32_t count() const { return count_.load(); }
+    
+    // Slow path once the count has dropped to zero or below: wakes waiters,
+    // throws if done() was called more often than add()
+    void settle();
+    
+    // Field offsets used by X86CodeGen's inline add()/done()
+    static constexpr int COUNT_OFFSET = 0;
+    static constexpr int WAITERS_OFFSET = 4;
+
+private:
+    std::atomic<int32_t> count_;      // Offset 0 - outstanding work
+    std::atomic<uint32_t> waiters_;   // Offset 4 - goroutines in wait()
+    std::atomic<uint32_t> epoch_;     // Futex word, bumped on every release
+    
+    bool wait_until(int64_t deadline_ns);
+};
+
+// ============================================================================
+// SEMAPHORE - Counting semaphore for concurrency limits
+// ============================================================================
+//
+// acquire() takes a permit with one CAS while permits are available and
+// parks on the permit word otherwise; release() is one atomic add plus a
+// futex wake only when someone is parked.
+class Semaphore {
+public:
+    explicit Semaphore(int32_t permits);
+    
+    void acquire();
+    bool try_acquire();
+    bool try_acquire_for(const std::chrono::milliseconds& timeout);
+    void release(int32_t count = 1);
+    
+    int32_t available() const { return permits_.load(); }
+    
+    // Slow path behind an inlined release(): wake one parked acquirer
+    void wake_one();
+    
+    // Field offsets used by X86CodeGen's inline acquire()/release()
+    static constexpr int PERMITS_OFFSET = 0;
+    static constexpr int WAITERS_OFFSET = 4;
+
+private:
+    std::atomic<int32_t> permits_;    // Offset 0 - futex word
+    std::atomic<uint32_t> waiters_;   // Offset 4 - parked acquirers
+    
+    bool acquire_slow(int64_t deadline_ns);
+};
+
+// ============================================================================
+// RWLOCK - Writer-preferring reader/writer lock with per-core reader counts
+// ============================================================================
+//
+// Readers never touch a shared cache line: read_lock() increments the
+// counter slot of the CPU it is running on and only checks the writer flag.
+// A reader may unlock on a different CPU - only the sum over all slots is
+// meaningful. write_lock() raises the writer flag, which turns new readers
+// away, then waits for the sum to drain to zero. Pending writers take
+// precedence over new readers, so read-mostly workloads cannot starve
+// writers. Not recursive in either mode.
+class RWLock {
+public:
+    RWLock();
+    ~RWLock();
+    
+    void read_lock();
+    void read_unlock();
+    bool try_read_lock();
+    
+    void write_lock();
+    void write_unlock();
+    bool try_write_lock();
+    
+    static constexpr size_t MAX_READER_SLOTS = 64;
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<int64_t> count{0};
+    };
+    
+    std::unique_ptr<ReaderSlot[]> slots_;
+    size_t slot_mask_;
+    std::atomic<uint32_t> writer_;        // Futex word readers park on, 1 while a writer is pending or active
+    std::atomic<uint32_t> drain_epoch_;   // Futex word the writer parks on while readers drain
+    Lock writer_mutex_;                   // Serializes writers
+    
+    ReaderSlot& my_slot();
+    int64_t active_readers() const;
+    bool enter_read();
+    void wait_for_readers();
+};
+
+// ============================================================================
+// BARRIER - Reusable rendezvous for phased parallel algorithms
+// ============================================================================
+//
+// wait() blocks until `parties` goroutines have arrived, then releases them
+// all and resets for the next phase. Exactly one caller per phase gets
+// true back (like PTHREAD_BARRIER_SERIAL_THREAD) to run per-phase work.
+class Barrier {
+public:
+    explicit Barrier(int32_t parties);
+    
+    bool wait();
+    
+    int32_t parties() const { return parties_; }
+
+private:
+    const int32_t parties_;
+    std::atomic<int32_t> arrived_;
+    std::atomic<uint32_t> generation_;   // Futex word, bumped when a phase completes
+};
+
 } // namespace gots
\ No newline at end of file
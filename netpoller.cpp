@@ -0,0 +1,302 @@
+#include "netpoller.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+
+namespace gots {
+
+static int64_t steady_ns(TimerWheel::clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+NetPoller& NetPoller::instance() {
+    // Use heap allocation to avoid static destruction order issues
+    static NetPoller* instance = new NetPoller();
+    return *instance;
+}
+
+NetPoller::NetPoller() {
+    for (auto& chunk : chunks_) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    // Idle connections are cheap here, so don't let the fd limit be the cap
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        std::cerr << "WARNING: netpoller disabled, epoll_create1 failed: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;  // nullptr marks the wakeup eventfd
+    if (wakeup_fd_ < 0 || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) != 0) {
+        std::cerr << "WARNING: netpoller disabled, eventfd setup failed: " << strerror(errno) << std::endl;
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+        return;
+    }
+
+    poll_thread_ = std::thread(&NetPoller::poll_loop, this);
+    poll_thread_.detach();
+}
+
+PollDesc* NetPoller::slot_for(int fd) {
+    if (fd < 0) return nullptr;
+    size_t chunk_index = static_cast<size_t>(fd) >> CHUNK_BITS;
+    if (chunk_index >= MAX_CHUNKS) return nullptr;
+
+    PollDesc* chunk = chunks_[chunk_index].load(std::memory_order_acquire);
+    if (!chunk) {
+        std::lock_guard<std::mutex> lock(chunk_alloc_mutex_);
+        chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new PollDesc[CHUNK_SIZE];
+            chunks_[chunk_index].store(chunk, std::memory_order_release);
+        }
+    }
+    return &chunk[static_cast<size_t>(fd) & (CHUNK_SIZE - 1)];
+}
+
+PollDesc* NetPoller::open(int fd) {
+    return register_fd(fd, nullptr);
+}
+
+bool NetPoller::watch(int fd, std::function<void()> on_ready) {
+    return register_fd(fd, std::move(on_ready)) != nullptr;
+}
+
+PollDesc* NetPoller::register_fd(int fd, std::function<void()> on_ready) {
+    if (!available()) return nullptr;
+
+    PollDesc* desc = slot_for(fd);
+    if (!desc) return nullptr;
+
+    std::lock_guard<std::mutex> lock(desc->mutex);
+    if (desc->registered) {
+        if (on_ready) desc->on_ready = std::move(on_ready);
+        return desc;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return nullptr;
+
+    // Install the callback before epoll can report the first edge - an fd
+    // that is already readable is reported immediately on EPOLL_CTL_ADD
+    desc->on_ready = std::move(on_ready);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = desc;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        if (errno != EEXIST || epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) != 0) {
+            desc->on_ready = nullptr;
+            return nullptr;  // Not pollable - leave it blocking
+        }
+    }
+    if (!(flags & O_NONBLOCK)) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    desc->fd = fd;
+    desc->ready[0] = desc->ready[1] = false;
+    desc->timed_out[0] = desc->timed_out[1] = false;
+    desc->generation++;
+    desc->registered = true;
+    registered_count_.fetch_add(1, std::memory_order_relaxed);
+    return desc;
+}
+
+void NetPoller::close(int fd) {
+    if (!available()) return;
+
+    PollDesc* desc = slot_for(fd);
+    if (!desc) return;
+
+    std::lock_guard<std::mutex> lock(desc->mutex);
+    if (!desc->registered) return;
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    desc->on_ready = nullptr;
+    desc->registered = false;
+    desc->generation++;
+    registered_count_.fetch_sub(1, std::memory_order_relaxed);
+
+    // Parked goroutines see the generation change and bail out with CLOSED
+    desc->cv.notify_all();
+}
+
+PollResult NetPoller::wait(PollDesc* desc, PollMode mode) {
+    if (!desc) return PollResult::ERROR;
+    int m = static_cast<int>(mode);
+
+    std::unique_lock<std::mutex> lock(desc->mutex);
+    if (!desc->registered) return PollResult::CLOSED;
+
+    // An edge may already have arrived since the syscall returned EAGAIN
+    if (desc->ready[m]) {
+        desc->ready[m] = false;
+        return PollResult::READY;
+    }
+
+    uint32_t generation = desc->generation;
+    int64_t timeout_ms = desc->timeout_ms.load(std::memory_order_relaxed);
+    int64_t deadline_id = 0;
+    if (timeout_ms > 0) {
+        deadline_id = next_deadline_id_.fetch_add(1, std::memory_order_relaxed);
+        desc->armed_id[m] = deadline_id;
+        desc->timed_out[m] = false;
+        arm_deadline(desc, mode, deadline_id, timeout_ms);
+    }
+
+    desc->cv.wait(lock, [&] {
+        return desc->ready[m] || desc->timed_out[m] || desc->generation != generation;
+    });
+
+    if (deadline_id) {
+        desc->armed_id[m] = 0;
+        disarm_deadline(desc, mode);
+    }
+
+    if (desc->generation != generation) {
+        return PollResult::CLOSED;
+    }
+    if (desc->ready[m]) {
+        desc->ready[m] = false;
+        return PollResult::READY;
+    }
+    desc->timed_out[m] = false;
+    return PollResult::TIMEOUT;
+}
+
+void NetPoller::arm_deadline(PollDesc* desc, PollMode mode, int64_t id, int64_t timeout_ms) {
+    bool need_wakeup;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        PollDeadline& deadline = desc->deadline[static_cast<int>(mode)];
+        deadline.desc = desc;
+        deadline.mode = mode;
+        deadline.node.id = id;
+        deadlines_.schedule(&deadline.node, timeout_ms);
+
+        // Only interrupt epoll_wait if it would otherwise sleep past us
+        int64_t wake_ns = steady_ns(deadlines_.next_wake_time());
+        need_wakeup = poll_wake_ns_ < 0 || wake_ns < poll_wake_ns_;
+    }
+    if (need_wakeup) {
+        wakeup();
+    }
+}
+
+void NetPoller::disarm_deadline(PollDesc* desc, PollMode mode) {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    deadlines_.cancel(&desc->deadline[static_cast<int>(mode)].node);
+}
+
+void NetPoller::expire_deadlines() {
+    std::vector<std::pair<PollDeadline*, int64_t>> fired;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        if (deadlines_.empty()) return;
+
+        std::vector<TimerNode*> expired;
+        deadlines_.advance(TimerWheel::clock::now(), expired);
+        for (TimerNode* node : expired) {
+            fired.emplace_back(reinterpret_cast<PollDeadline*>(node), node->id);
+        }
+    }
+
+    for (const auto& entry : fired) {
+        PollDesc* desc = entry.first->desc;
+        int m = static_cast<int>(entry.first->mode);
+        std::lock_guard<std::mutex> lock(desc->mutex);
+        // The waiter may have woken and re-armed since the node expired
+        if (desc->armed_id[m] == entry.second) {
+            desc->timed_out[m] = true;
+            desc->cv.notify_all();
+        }
+    }
+}
+
+void NetPoller::notify_ready(PollDesc* desc, uint32_t events) {
+    std::unique_lock<std::mutex> lock(desc->mutex);
+    if (desc->on_ready) {
+        // Copy so the callback can run without holding the descriptor lock
+        std::function<void()> callback = desc->on_ready;
+        lock.unlock();
+        callback();
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        desc->ready[static_cast<int>(PollMode::READ)] = true;
+    }
+    if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+        desc->ready[static_cast<int>(PollMode::WRITE)] = true;
+    }
+    desc->cv.notify_all();
+}
+
+void NetPoller::wakeup() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeup_fd_, &one, sizeof(one));
+    (void)written;  // EAGAIN means a wakeup is already pending
+}
+
+void NetPoller::poll_loop() {
+    constexpr int MAX_EVENTS = 256;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (true) {
+        int timeout_ms = -1;
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex_);
+            if (deadlines_.empty()) {
+                poll_wake_ns_ = -1;
+            } else {
+                auto wake = deadlines_.next_wake_time();
+                poll_wake_ns_ = steady_ns(wake);
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    wake - TimerWheel::clock::now() + std::chrono::microseconds(999));
+                timeout_ms = remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+            }
+        }
+
+        int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        if (count < 0) {
+            if (errno != EINTR) {
+                std::cerr << "ERROR: netpoller epoll_wait failed: " << strerror(errno) << std::endl;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            PollDesc* desc = static_cast<PollDesc*>(events[i].data.ptr);
+            if (!desc) {
+                uint64_t value;
+                ssize_t drained = read(wakeup_fd_, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+            notify_ready(desc, events[i].events);
+        }
+
+        expire_deadlines();
+    }
+}
+
+} // namespace gots
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "timer_wheel.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace gots {
+
+// ============================================================================
+// NETPOLLER - One shared epoll instance for all goroutine socket I/O
+// ============================================================================
+//
+// Every runtime socket is non-blocking and registered once, edge-triggered,
+// with a single epoll instance. A goroutine whose syscall returns EAGAIN parks
+// on the socket's PollDesc until the poller thread sees a readiness edge, the
+// socket is closed, or the socket's deadline expires. I/O deadlines live in a
+// TimerWheel that drives the epoll_wait timeout, and an eventfd wakes the
+// poller when an earlier deadline is armed.
+//
+// An idle connection costs one PollDesc and one epoll registration - no
+// thread is parked on it until somebody actually reads from it.
+
+class NetPoller;
+struct PollDesc;
+
+enum class PollMode : int {
+    READ = 0,
+    WRITE = 1
+};
+
+// Result of NetPoller::wait
+enum class PollResult {
+    READY,      // Readiness edge seen - retry the syscall
+    TIMEOUT,    // Deadline expired
+    CLOSED,     // Descriptor closed while parked
+    ERROR       // Poller unavailable
+};
+
+// Deadline timer for one direction of a PollDesc
+struct PollDeadline {
+    TimerNode node;     // Must stay first - expired nodes are cast back
+    PollDesc* desc = nullptr;
+    PollMode mode = PollMode::READ;
+};
+
+// Per-descriptor poll state. Descriptors are never freed, only reset when
+// their fd number is reused, so a late epoll event can never touch freed
+// memory.
+struct PollDesc {
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Protected by mutex
+    bool ready[2] = {false, false};       // Readiness edges not yet consumed
+    bool timed_out[2] = {false, false};
+    int64_t armed_id[2] = {0, 0};         // Deadline currently armed by a waiter
+    uint32_t generation = 0;              // Bumped on every open/close
+    bool registered = false;
+
+    // Per-socket I/O timeout in ms (0 = none)
+    std::atomic<int64_t> timeout_ms{0};
+
+    // Run on the poller thread for each readiness edge instead of waking
+    // parked goroutines (see NetPoller::watch). Protected by mutex.
+    std::function<void()> on_ready;
+
+    // Protected by NetPoller::timer_mutex_
+    PollDeadline deadline[2];
+};
+
+class NetPoller {
+public:
+    static NetPoller& instance();
+
+    // False when epoll could not be initialized - callers fall back to
+    // ordinary blocking syscalls
+    bool available() const { return epoll_fd_ >= 0; }
+
+    // Make fd non-blocking and register it. Safe to call repeatedly - returns
+    // the existing descriptor if fd is already registered, nullptr if fd
+    // cannot be polled (e.g. a regular file).
+    PollDesc* open(int fd);
+
+    // Have the poller thread itself run `on_ready` on every readiness edge of
+    // fd. Used for completion sources such as an io_uring eventfd; the
+    // callback must drain fd since edges are only reported once.
+    bool watch(int fd, std::function<void()> on_ready);
+
+    // Wake every goroutine parked on fd and unregister it. Call before close().
+    void close(int fd);
+
+    // Park the calling goroutine until fd may be ready in `mode`
+    PollResult wait(PollDesc* desc, PollMode mode);
+
+    size_t registered_count() const { return registered_count_.load(std::memory_order_relaxed); }
+
+private:
+    NetPoller();
+    NetPoller(const NetPoller&) = delete;
+    NetPoller& operator=(const NetPoller&) = delete;
+
+    // Two-level fd table so lookups never take a lock or see a reallocation
+    static constexpr size_t CHUNK_BITS = 10;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = 1024;  // Up to ~1M descriptors
+    std::atomic<PollDesc*> chunks_[MAX_CHUNKS];
+    std::mutex chunk_alloc_mutex_;
+    PollDesc* slot_for(int fd);
+    PollDesc* register_fd(int fd, std::function<void()> on_ready);
+
+    int epoll_fd_ = -1;
+    int wakeup_fd_ = -1;
+    std::thread poll_thread_;
+    std::atomic<size_t> registered_count_{0};
+
+    // I/O deadlines - drive the epoll_wait timeout
+    std::mutex timer_mutex_;
+    TimerWheel deadlines_;
+    std::atomic<int64_t> next_deadline_id_{1};
+    int64_t poll_wake_ns_ = -1;  // steady_clock time the poller sleeps until (-1 = forever)
+
+    void poll_loop();
+    void notify_ready(PollDesc* desc, uint32_t events);
+    void arm_deadline(PollDesc* desc, PollMode mode, int64_t id, int64_t timeout_ms);
+    void disarm_deadline(PollDesc* desc, PollMode mode);
+    void expire_deadlines();
+    void wakeup();
+};
+
+} // namespace gots
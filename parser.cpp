@@ -735,6 +735,7 @@ std::unique_ptr<ExpressionNode> Parser::parse_primary() {
                 // Check for type annotation: param: type
                 if (match(TokenType::COLON)) {
                     param.type = parse_type();
+                    param.class_name = last_type_class_name;
                 }
                 
                 func_expr->parameters.push_back(param);
@@ -781,9 +782,18 @@ std::unique_ptr<ExpressionNode> Parser::parse_primary() {
         }
         
         std::string class_name = current_token().value;
+        int line = current_token().line;
+        int column = current_token().column;
         advance();
         
+        // Builtin generic types: new Atomic<int64>(0)
+        if (check(TokenType::LESS)) {
+            class_name += parse_type_arguments();
+        }
+        
         auto new_expr = std::make_unique<NewExpression>(class_name);
+        new_expr->line = line;
+        new_expr->column = column;
         
         if (match(TokenType::LBRACE)) {
             // Dart-style: new Person{name: "bob", age: 25}
@@ -913,6 +923,7 @@ std::unique_ptr<ASTNode> Parser::parse_function_declaration() {
             
             if (match(TokenType::COLON)) {
                 param.type = parse_type();
+                param.class_name = last_type_class_name;
             }
             
             func_decl->parameters.push_back(param);
@@ -1264,6 +1275,8 @@ std::unique_ptr<ASTNode> Parser::parse_expression_statement() {
 }
 
 DataType Parser::parse_type() {
+    last_type_class_name.clear();
+    
     // Handle typed array syntax like [int32], [float32], etc.
     if (match(TokenType::LBRACKET)) {
         if (!match(TokenType::IDENTIFIER)) {
@@ -1287,6 +1300,12 @@ DataType Parser::parse_type() {
     
     std::string type_name = tokens[pos - 1].value;
     
+    // Atomic<int64> / Atomic<float64> values are runtime cells like Lock
+    if (type_name == "Atomic" && check(TokenType::LESS)) {
+        last_type_class_name = type_name + parse_type_arguments();
+        return DataType::CLASS_INSTANCE;
+    }
+    
     if (type_name == "int8") return DataType::INT8;
     if (type_name == "int16") return DataType::INT16;
     if (type_name == "int32") return DataType::INT32;
@@ -1308,6 +1327,30 @@ DataType Parser::parse_type() {
     return DataType::UNKNOWN;
 }
 
+// Parses `<T, U>` after a type name and returns it in canonical form
+std::string Parser::parse_type_arguments() {
+    if (!match(TokenType::LESS)) {
+        throw std::runtime_error("Expected '<' to start type arguments");
+    }
+    
+    std::string arguments = "<";
+    while (true) {
+        if (!match(TokenType::IDENTIFIER)) {
+            throw std::runtime_error("Expected type name in type arguments");
+        }
+        arguments += tokens[pos - 1].value;
+        if (!match(TokenType::COMMA)) {
+            break;
+        }
+        arguments += ",";
+    }
+    
+    if (!match(TokenType::GREATER)) {
+        throw std::runtime_error("Expected '>' after type arguments");
+    }
+    return arguments + ">";
+}
+
 std::unique_ptr<ASTNode> Parser::parse_class_declaration() {
     if (!match(TokenType::CLASS)) {
         throw std::runtime_error("Expected 'class'");
@@ -1354,6 +1397,14 @@ std::unique_ptr<ASTNode> Parser::parse_class_declaration() {
             is_static = true;
         }
         
+        // `padded hits: Atomic<int64>` gives the field its own cache line
+        bool cache_line_padded = false;
+        if (check(TokenType::IDENTIFIER) && current_token().value == "padded" &&
+            peek_token().type == TokenType::IDENTIFIER) {
+            advance();
+            cache_line_padded = true;
+        }
+        
         if (check(TokenType::CONSTRUCTOR)) {
             if (class_decl->constructor) {
                 throw std::runtime_error("Class can only have one constructor");
@@ -1378,11 +1429,17 @@ std::unique_ptr<ASTNode> Parser::parse_class_declaration() {
                 field.type = field_type;
                 field.is_mutable = true;
                 field.is_static = is_static;
+                field.cache_line_padded = cache_line_padded;
                 
                 // Check for default value
                 if (match(TokenType::ASSIGN)) {
                     // Parse the default value expression
                     field.default_value = parse_expression();
+                    if (cache_line_padded) {
+                        if (auto* new_expr = dynamic_cast<NewExpression*>(field.default_value.get())) {
+                            new_expr->cache_line_padded = true;
+                        }
+                    }
                 }
                 
                 class_decl->fields.push_back(field);
@@ -1391,6 +1448,9 @@ std::unique_ptr<ASTNode> Parser::parse_class_declaration() {
                     // Optional semicolon
                 }
             } else if (check(TokenType::LPAREN)) {
+                if (cache_line_padded) {
+                    throw std::runtime_error("'padded' applies only to fields");
+                }
                 // Method declaration
                 pos--; // Go back to method name
                 auto method = parse_method_declaration();
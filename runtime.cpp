@@ -3,6 +3,7 @@
 #include "lexical_scope.h"
 #include "regex.h"
 #include "goroutine_system.h"
+#include "gc_memory_manager.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
@@ -13,6 +14,8 @@
 #include <cmath>
 #include <regex>
 #include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 // Forward declarations for new goroutine system
 extern "C" {
@@ -122,23 +125,6 @@ std::atomic<int64_t> next_object_id{1};
 FunctionEntry g_function_table[MAX_FUNCTIONS];
 std::atomic<uint16_t> g_next_function_id{1};  // Start at 1, 0 is reserved for "invalid"
 
-// Global promise registry for cleanup
-static std::unordered_set<void*> g_allocated_promises;
-static std::mutex g_promise_registry_mutex;
-
-// Helper function to create and track a promise
-static void* create_tracked_promise(std::shared_ptr<Promise> promise) {
-    auto* promise_ptr = new std::shared_ptr<Promise>(promise);
-    
-    // Track allocated promise for cleanup
-    {
-        std::lock_guard<std::mutex> lock(g_promise_registry_mutex);
-        g_allocated_promises.insert(promise_ptr);
-    }
-    
-    return promise_ptr;
-}
-
 // Global executable memory info for thread-safe access
 ExecutableMemoryInfo g_executable_memory = {nullptr, 0, {}};
 
@@ -225,11 +211,15 @@ void* __goroutine_spawn_fast_arg1(uint16_t func_id, int64_t arg1) {
         return nullptr;
     }
     
-    // Create a task that calls the function with one argument - minimal overhead
+    // Create a task that calls the function with one argument - minimal overhead.
+    // The closure is invisible to the GC, so heap arguments stay retained
+    GarbageCollector::instance().retain(reinterpret_cast<void*>(arg1));
     auto task = [func_ptr, arg1]() {
         typedef int64_t (*FuncType)(int64_t);
         FuncType func = reinterpret_cast<FuncType>(func_ptr);
-        return func(arg1);
+        int64_t result = func(arg1);
+        GarbageCollector::instance().release(reinterpret_cast<void*>(arg1));
+        return result;
     };
     
     GoroutineScheduler::instance().spawn(task);
@@ -244,38 +234,105 @@ void* __goroutine_spawn_fast_arg2(uint16_t func_id, int64_t arg1, int64_t arg2)
     }
     
     // Create a task that calls the function with two arguments - minimal overhead
+    GarbageCollector& gc = GarbageCollector::instance();
+    gc.retain(reinterpret_cast<void*>(arg1));
+    gc.retain(reinterpret_cast<void*>(arg2));
     auto task = [func_ptr, arg1, arg2]() {
         typedef int64_t (*FuncType)(int64_t, int64_t);
         FuncType func = reinterpret_cast<FuncType>(func_ptr);
-        return func(arg1, arg2);
+        int64_t result = func(arg1, arg2);
+        GarbageCollector::instance().release(reinterpret_cast<void*>(arg1));
+        GarbageCollector::instance().release(reinterpret_cast<void*>(arg2));
+        return result;
     };
     
     GoroutineScheduler::instance().spawn(task);
     return reinterpret_cast<void*>(1);
 }
 
-// Proper array creation that creates a GoTS TypedArray
+// Array on the GC heap: length followed by the element slots
 void* __array_create(int64_t size) {
-    
-    // Create a simple TypedArray-like structure
-    // For now, use a basic implementation that can be extended
-    struct SimpleArray {
-        int64_t size;
-        void** data;
-    };
-    
-    SimpleArray* array = new SimpleArray;
-    array->size = size;
-    array->data = size > 0 ? new void*[size] : nullptr;
-    
-    // Initialize to nullptr
-    for (int64_t i = 0; i < size; i++) {
-        array->data[i] = nullptr;
-    }
-    
+    if (size < 0) size = 0;
+    void* array = GenerationalHeap::allocate_fast(sizeof(int64_t) + size * sizeof(void*), TYPE_ARRAY, true);
+    *static_cast<int64_t*>(array) = size;
     return array;
 }
 
+// Objects on the GC heap - see GCObjectLayout
+static int64_t* object_slots(int64_t object_id, int64_t property_index) {
+    if (!object_id) return nullptr;
+    uint8_t* object = reinterpret_cast<uint8_t*>(object_id);
+    int64_t count = *reinterpret_cast<int64_t*>(object + GCObjectLayout::COUNT_OFFSET);
+    if (property_index < 0 || property_index >= count) {
+        std::cerr << "ERROR: Property index " << property_index << " out of range for object with "
+                  << count << " properties" << std::endl;
+        return nullptr;
+    }
+    return reinterpret_cast<int64_t*>(object + GCObjectLayout::VALUES_OFFSET) + property_index;
+}
+
+int64_t __object_create(const char* class_name, int64_t property_count) {
+    if (property_count < 0) property_count = 0;
+    uint8_t* object = static_cast<uint8_t*>(
+        GenerationalHeap::allocate_fast(GCObjectLayout::payload_size(property_count), TYPE_OBJECT));
+    *reinterpret_cast<const char**>(object + GCObjectLayout::CLASS_NAME_OFFSET) = class_name;
+    *reinterpret_cast<int64_t*>(object + GCObjectLayout::COUNT_OFFSET) = property_count;
+    return reinterpret_cast<int64_t>(object);
+}
+
+// Assignments after construction are preceded by the JIT's SATB barrier
+// (emit_gc_pre_write_barrier); initializing stores need none. JIT code stores
+// inline with a card mark (emit_object_set_property) and only calls this for
+// a null object or an index out of range, which is reported here
+void __object_set_property(int64_t object_id, int64_t property_index, int64_t value) {
+    if (int64_t* slot = object_slots(object_id, property_index)) *slot = value;
+}
+
+int64_t __object_get_property(int64_t object_id, int64_t property_index) {
+    int64_t* slot = object_slots(object_id, property_index);
+    return slot ? *slot : 0;
+}
+
+void __object_destroy(int64_t object_id) {
+    // Reclaimed by the GC
+    (void)object_id;
+}
+
+void __object_set_property_name(int64_t object_id, int64_t property_index, const char* property_name) {
+    int64_t* slot = object_slots(object_id, property_index);
+    if (!slot) return;
+    int64_t count = *reinterpret_cast<int64_t*>(reinterpret_cast<uint8_t*>(object_id) + GCObjectLayout::COUNT_OFFSET);
+    slot[count] = reinterpret_cast<int64_t>(property_name);
+}
+
+const char* __object_get_property_name(int64_t object_id, int64_t property_index) {
+    int64_t* slot = object_slots(object_id, property_index);
+    if (!slot) return nullptr;
+    int64_t count = *reinterpret_cast<int64_t*>(reinterpret_cast<uint8_t*>(object_id) + GCObjectLayout::COUNT_OFFSET);
+    return reinterpret_cast<const char*>(slot[count]);
+}
+
+// Property read by name when the static type is unknown (`stats.pauseP99Us`).
+// Only named TYPE_OBJECTs on the GC heap are searched - the header in front of
+// the pointer must describe an object of exactly that property count. Anything
+// else, and a name the object does not have, reads as 0
+void* __dynamic_get_property(void* object_ptr, const char* property_name) {
+    if (!object_ptr || !property_name) return nullptr;
+    if (!GarbageCollector::instance().get_heap().contains(object_ptr)) return nullptr;
+    uint8_t* object = static_cast<uint8_t*>(object_ptr);
+    const ObjectHeader* header = reinterpret_cast<const ObjectHeader*>(object - sizeof(ObjectHeader));
+    if (header->type_id != TYPE_OBJECT) return nullptr;
+    int64_t count = *reinterpret_cast<int64_t*>(object + GCObjectLayout::COUNT_OFFSET);
+    if (count < 0 || header->size != GCObjectLayout::payload_size(count)) return nullptr;
+
+    int64_t* values = reinterpret_cast<int64_t*>(object + GCObjectLayout::VALUES_OFFSET);
+    for (int64_t i = 0; i < count; ++i) {
+        const char* name = reinterpret_cast<const char*>(values[count + i]);
+        if (name && strcmp(name, property_name) == 0) return reinterpret_cast<void*>(values[i]);
+    }
+    return nullptr;
+}
+
 // Missing utility functions
 void __set_executable_memory(void* memory, size_t size) {
     // Set the global executable memory pointer
@@ -302,9 +359,17 @@ void __console_log_number(int64_t value) {
     std::cout.flush();
 }
 
+// Untagged values are printed as strings if they point at mapped memory -
+// byte counts such as runtime.gc.stats().heapSize are numbers however large
+static bool is_mapped_address(int64_t value) {
+    static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    unsigned char resident;
+    return mincore(reinterpret_cast<void*>(static_cast<uintptr_t>(value) & ~(page_size - 1)), 1, &resident) == 0;
+}
+
 void __console_log_auto(int64_t value) {
     // Check if it's a likely heap pointer (string or object)
-    if (value > 0x100000) {  // Likely a heap pointer
+    if (value > 0x100000 && is_mapped_address(value)) {  // Likely a heap pointer
         // Try to safely read the string by using the __console_log_string function
         // This way we use the existing safe string handling
         void* ptr = reinterpret_cast<void*>(value);
@@ -367,15 +432,33 @@ extern "C" int64_t __gots_set_interval(void* callback, int64_t delay_ms);
 extern "C" bool __gots_clear_timeout(int64_t timer_id);
 extern "C" bool __gots_clear_interval(int64_t timer_id);
 
-// Stub implementations for functions used by runtime_syscalls.cpp
+// Strings are NUL-terminated bytes on the GC heap
 void* __string_create(const char* str) {
-    return (void*)strdup(str);
+    size_t length = strlen(str);
+    void* result = GenerationalHeap::allocate_fast(length + 1, TYPE_STRING);
+    memcpy(result, str, length);
+    return result;
+}
+
+void* __string_create_empty() {
+    // Allocations come back zeroed
+    return GenerationalHeap::allocate_fast(1, TYPE_STRING);
 }
 
-// String interning for literals - simple implementation for now
+// String interning for literals - one immortal copy per distinct content
 void* __string_intern(const char* str) {
-    // For now, just return a copy - could optimize with interning later
-    return (void*)strdup(str);
+    static std::mutex intern_mutex;
+    // Use heap allocation to avoid static destruction order issues
+    static auto* interned = new std::unordered_map<std::string, void*>();
+    
+    std::lock_guard<std::mutex> lock(intern_mutex);
+    auto it = interned->find(str);
+    if (it != interned->end()) return it->second;
+    
+    void* result = __string_create(str);
+    GarbageCollector::instance().retain(result);
+    interned->emplace(str, result);
+    return result;
 }
 
 void __array_push(void* array, int64_t value) {
@@ -384,125 +467,180 @@ void __array_push(void* array, int64_t value) {
     (void)value;
 }
 
-// Simplified Array runtime functions
-extern "C" void* __simple_array_create(double* values, int64_t size) {
-    Array* arr = new Array();
-    for (int64_t i = 0; i < size; i++) {
-        arr->push(values[i]);
+// Simplified Array runtime functions - GCArrays on the heap (runtime.h)
+
+// Zero-filled: heap allocations come back zeroed
+static GCArray* gc_array_create(int64_t length) {
+    if (length < 0) length = 0;
+    GCArray* array = static_cast<GCArray*>(GenerationalHeap::allocate_fast(sizeof(GCArray), TYPE_NUMERIC_ARRAY));
+    if (length > 0) {
+        void* data = GenerationalHeap::allocate_fast(static_cast<size_t>(length) * sizeof(double),
+                                                     TYPE_NUMERIC_ARRAY_DATA);
+        WriteBarrier::write_ref(array, &array->data, data);
     }
-    return arr;
+    array->length = length;
+    array->capacity = length;
+    return array;
 }
 
-extern "C" void* __simple_array_zeros(int64_t size) {
-    if (size <= 0) {
-        // Create empty array
-        Array* arr = new Array();
-        return arr;
+static GCArray* gc_array_from(const Array& values) {
+    GCArray* array = gc_array_create(static_cast<int64_t>(values.size()));
+    if (array->length > 0) memcpy(array->data, values.data(), values.size() * sizeof(double));
+    return array;
+}
+
+// The Array the GCArray holds, for the operations simple_array.h implements
+static Array gc_array_copy(const GCArray* array) {
+    return Array({static_cast<size_t>(array->length)},
+                 std::vector<double>(array->data, array->data + array->length));
+}
+
+// Array's checks, with its messages
+static double& gc_array_at(GCArray* array, int64_t index) {
+    if (static_cast<uint64_t>(index) >= static_cast<uint64_t>(array->length)) {
+        throw std::runtime_error("Index out of bounds");
     }
-    std::vector<size_t> shape = {static_cast<size_t>(size)};
-    Array* arr = new Array(Array::zeros(shape));
-    return arr;
+    return array->data[index];
+}
+
+static void gc_array_require_elements(const GCArray* array, const char* what) {
+    if (array->length == 0) {
+        throw std::runtime_error(std::string("Cannot compute ") + what + " of empty array");
+    }
+}
+
+extern "C" void* __simple_array_create(double* values, int64_t size) {
+    GCArray* array = gc_array_create(size);
+    if (array->length > 0) memcpy(array->data, values, static_cast<size_t>(size) * sizeof(double));
+    return array;
+}
+
+extern "C" void* __simple_array_zeros(int64_t size) {
+    return gc_array_create(size);
 }
 
 extern "C" void* __simple_array_ones(int64_t size) {
-    std::vector<size_t> shape = {static_cast<size_t>(size)};
-    Array* arr = new Array(Array::ones(shape));
-    return arr;
+    GCArray* array = gc_array_create(size);
+    std::fill(array->data, array->data + array->length, 1.0);
+    return array;
 }
 
 extern "C" void __simple_array_push(void* array, double value) {
     if (array) {
-        static_cast<Array*>(array)->push(value);
+        GCArray* gc_array = static_cast<GCArray*>(array);
+        if (gc_array->length == gc_array->capacity) {
+            int64_t capacity = std::max<int64_t>(4, gc_array->capacity * 2);
+            void* data = GenerationalHeap::allocate_fast(static_cast<size_t>(capacity) * sizeof(double),
+                                                         TYPE_NUMERIC_ARRAY_DATA);
+            if (gc_array->length > 0) {
+                memcpy(data, gc_array->data, static_cast<size_t>(gc_array->length) * sizeof(double));
+            }
+            WriteBarrier::write_ref(gc_array, &gc_array->data, data);
+            gc_array->capacity = capacity;
+        }
+        gc_array->data[gc_array->length++] = value;
     }
 }
 
 extern "C" double __simple_array_pop(void* array) {
     if (array) {
-        return static_cast<Array*>(array)->pop();
+        GCArray* gc_array = static_cast<GCArray*>(array);
+        if (gc_array->length == 0) {
+            throw std::runtime_error("pop() only works on non-empty 1D arrays");
+        }
+        return gc_array->data[--gc_array->length];
     }
     return 0.0;
 }
 
 extern "C" double __simple_array_get(void* array, int64_t index) {
     if (array) {
-        return (*static_cast<Array*>(array))[index];
+        return gc_array_at(static_cast<GCArray*>(array), index);
     }
     return 0.0;
 }
 
 extern "C" void __simple_array_set(void* array, int64_t index, double value) {
     if (array) {
-        (*static_cast<Array*>(array))[index] = value;
+        gc_array_at(static_cast<GCArray*>(array), index) = value;
     }
 }
 
 extern "C" int64_t __simple_array_length(void* array) {
     if (array) {
-        return static_cast<int64_t>(static_cast<Array*>(array)->length());
+        return static_cast<GCArray*>(array)->length;
     }
     return 0;
 }
 
 extern "C" double __simple_array_sum(void* array) {
     if (array) {
-        return static_cast<Array*>(array)->sum();
+        const GCArray* gc_array = static_cast<GCArray*>(array);
+        double result = 0.0;
+        for (int64_t i = 0; i < gc_array->length; ++i) {
+            result += gc_array->data[i];
+        }
+        return result;
     }
     return 0.0;
 }
 
 extern "C" double __simple_array_mean(void* array) {
     if (array) {
-        return static_cast<Array*>(array)->mean();
+        const GCArray* gc_array = static_cast<GCArray*>(array);
+        gc_array_require_elements(gc_array, "mean");
+        return __simple_array_sum(array) / static_cast<double>(gc_array->length);
     }
     return 0.0;
 }
 
 extern "C" void* __simple_array_shape(void* array) {
     if (array) {
-        const std::vector<size_t>& shape = static_cast<Array*>(array)->shape();
-        std::vector<double> shape_as_doubles;
-        for (size_t dim : shape) {
-            shape_as_doubles.push_back(static_cast<double>(dim));
-        }
-        return new Array({shape_as_doubles.size()}, shape_as_doubles);
+        // Runtime arrays are 1-D
+        GCArray* shape = gc_array_create(1);
+        shape->data[0] = static_cast<double>(static_cast<GCArray*>(array)->length);
+        return shape;
     }
     return nullptr;
 }
 
 extern "C" const char* __simple_array_tostring(void* array) {
     if (array) {
-        std::string str = static_cast<Array*>(array)->toString();
-        return strdup(str.c_str());
+        std::string str = gc_array_copy(static_cast<GCArray*>(array)).toString();
+        return static_cast<const char*>(__string_create(str.c_str()));
     }
-    return strdup("Array()");
+    return static_cast<const char*>(__string_create("Array()"));
 }
 
 extern "C" void* __simple_array_slice(void* array, int64_t start, int64_t end, int64_t step) {
     if (array) {
-        Array sliced = static_cast<Array*>(array)->slice(start, end, step);
-        return new Array(sliced);
+        return gc_array_from(gc_array_copy(static_cast<GCArray*>(array)).slice(start, end, step));
     }
     return nullptr;
 }
 
 extern "C" void* __simple_array_slice_all(void* array) {
     if (array) {
-        Array sliced = static_cast<Array*>(array)->slice_all();
-        return new Array(sliced);
+        const GCArray* gc_array = static_cast<GCArray*>(array);
+        return __simple_array_create(gc_array->data, gc_array->length);
     }
     return nullptr;
 }
 
 double __simple_array_max(void* array) {
     if (array) {
-        return static_cast<Array*>(array)->max();
+        const GCArray* gc_array = static_cast<GCArray*>(array);
+        gc_array_require_elements(gc_array, "max");
+        return *std::max_element(gc_array->data, gc_array->data + gc_array->length);
     }
     return 0.0;
 }
 
 double __simple_array_min(void* array) {
     if (array) {
-        return static_cast<Array*>(array)->min();
+        const GCArray* gc_array = static_cast<GCArray*>(array);
+        gc_array_require_elements(gc_array, "min");
+        return *std::min_element(gc_array->data, gc_array->data + gc_array->length);
     }
     return 0.0;
 }
@@ -510,9 +648,9 @@ double __simple_array_min(void* array) {
 // Helper function to get first dimension from shape array
 int64_t __simple_array_get_first_dimension(void* shape_array) {
     if (shape_array) {
-        Array* arr = static_cast<Array*>(shape_array);
-        if (arr->length() > 0) {
-            return static_cast<int64_t>((*arr)[0]);
+        const GCArray* shape = static_cast<GCArray*>(shape_array);
+        if (shape->length > 0) {
+            return static_cast<int64_t>(shape->data[0]);
         }
     }
     return 0;
@@ -520,13 +658,11 @@ int64_t __simple_array_get_first_dimension(void* shape_array) {
 
 // Array static factory methods
 void* __simple_array_arange(double start, double stop, double step) {
-    Array* arr = new Array(Array::arange(start, stop, step));
-    return arr;
+    return gc_array_from(Array::arange(start, stop, step));
 }
 
 void* __simple_array_linspace(double start, double stop, int64_t num) {
-    Array* arr = new Array(Array::linspace(start, stop, static_cast<size_t>(num)));
-    return arr;
+    return gc_array_from(Array::linspace(start, stop, static_cast<size_t>(num)));
 }
 
 // Timer management functions moved to goroutine_system.cpp
@@ -594,11 +730,9 @@ extern "C" const char* __dynamic_method_toString(void* obj) {
     // For now, we'll treat this as a simple array toString
     // In a full implementation, this would check object type and call appropriate toString
     if (obj) {
-        Array* array = static_cast<Array*>(obj);
-        std::string str = array->toString();
-        return strdup(str.c_str());
+        return __simple_array_tostring(obj);
     }
-    return strdup("undefined");
+    return static_cast<const char*>(__string_create("undefined"));
 }
 
 } // namespace gots
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <chrono>
 #include <optional>
+#include "slab_allocator.h"
 
 // Forward declare DataType from compiler.h to avoid circular dependency
 namespace gots {
@@ -443,23 +444,61 @@ struct LegacyArray {
     }
 };
 
-struct Promise {
+// Resolved values are read by other goroutines (gc_memory_manager.h)
+extern "C" void __gc_publish(void* obj);
+
+// Slab-allocated and intrusively counted - hold it through a PromiseRef.
+// Integer and pointer results are stored inline, so creating, resolving
+// and awaiting one allocates nothing beyond its slab block
+struct Promise : RefCounted<Promise> {
+    // A waiter's link, embedded in the waiter - then() allocates nothing.
+    // run() may free the continuation
+    struct Continuation {
+        void (*run)(Continuation* self) = nullptr;
+        Continuation* next = nullptr;
+    };
+
     std::atomic<bool> resolved{false};
-    std::shared_ptr<void> value;
-    std::vector<std::function<void()>> callbacks;
+    int64_t scalar = 0;             // Integer and pointer results
+    std::shared_ptr<void> value;    // Any other result type
+    Continuation* continuations = nullptr;  // Most recent first
     std::mutex callback_mutex;
     
+    template<typename T>
+    static constexpr bool is_inline_result() {
+        using ValueType = std::remove_cv_t<std::remove_reference_t<T>>;
+        return std::is_pointer_v<ValueType> || (std::is_integral_v<ValueType> && sizeof(ValueType) <= sizeof(int64_t));
+    }
+    
     template<typename T>
     void resolve(T&& val) {
+        Continuation* ready;
         {
             std::lock_guard<std::mutex> lock(callback_mutex);
-            using ValueType = typename std::remove_reference<T>::type;
-            value = std::make_shared<ValueType>(std::forward<T>(val));
+            using ValueType = std::remove_cv_t<std::remove_reference_t<T>>;
+            if constexpr (is_inline_result<T>()) {
+                __gc_publish((void*)(uintptr_t)val);
+                scalar = (int64_t)(uintptr_t)val;
+            } else {
+                value = std::make_shared<ValueType>(std::forward<T>(val));
+            }
             resolved.store(true);
+            ready = continuations;
+            continuations = nullptr;
         }
         
-        for (auto& callback : callbacks) {
-            callback();
+        // In registration order
+        Continuation* ordered = nullptr;
+        while (ready) {
+            Continuation* next = ready->next;
+            ready->next = ordered;
+            ordered = ready;
+            ready = next;
+        }
+        while (ordered) {
+            Continuation* next = ordered->next;
+            ordered->run(ordered);
+            ordered = next;
         }
     }
     
@@ -468,20 +507,63 @@ struct Promise {
         while (!resolved.load()) {
             std::this_thread::yield();
         }
-        using ValueType = typename std::remove_reference<T>::type;
-        return *static_cast<ValueType*>(value.get());
+        if constexpr (is_inline_result<T>()) {
+            if constexpr (std::is_pointer_v<std::remove_reference_t<T>>) {
+                return reinterpret_cast<T>(static_cast<uintptr_t>(scalar));
+            } else {
+                return static_cast<T>(scalar);
+            }
+        } else {
+            using ValueType = typename std::remove_reference<T>::type;
+            return *static_cast<ValueType*>(value.get());
+        }
     }
     
-    void then(std::function<void()> callback) {
-        std::lock_guard<std::mutex> lock(callback_mutex);
-        if (resolved.load()) {
-            callback();
-        } else {
-            callbacks.push_back(callback);
+    // The stored result of a resolved promise that is not stored inline
+    template<typename T>
+    T& result() {
+        static_assert(!is_inline_result<T>(), "Read inline results with await()");
+        return *static_cast<T*>(value.get());
+    }
+    
+    // Runs `continuation` once resolved - right away if it already is
+    void then(Continuation* continuation) {
+        {
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            if (!resolved.load()) {
+                continuation->next = continuations;
+                continuations = continuation;
+                return;
+            }
         }
+        continuation->run(continuation);
+    }
+    
+    // Block until resolved - parks on a condition variable instead of
+    // spinning like await() does, for results that arrive from I/O
+    void wait() {
+        if (resolved.load()) return;
+        struct WaitState : Continuation {
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool done = false;
+        };
+        WaitState state;
+        state.run = [](Continuation* self) {
+            WaitState* waiter = static_cast<WaitState*>(self);
+            // Notified under the lock - the waiter's frame holds the state
+            std::lock_guard<std::mutex> lock(waiter->mutex);
+            waiter->done = true;
+            waiter->cv.notify_one();
+        };
+        then(&state);
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&state] { return state.done; });
     }
 };
 
+using PromiseRef = Ref<Promise>;
+
 // Forward declaration - using new goroutine system
 namespace gots {
     class GoroutineScheduler;
@@ -558,6 +640,36 @@ struct ObjectInstance {
     }
 };
 
+// Objects from __object_create live on the GC heap (TYPE_OBJECT) and the
+// object id is the payload address. The JIT allocates them inline
+// (CodeGenerator::emit_object_create), so the layout is fixed:
+//   [0] class name  [8] property count  [16] values[count]  then names[count]
+struct GCObjectLayout {
+    static constexpr int32_t CLASS_NAME_OFFSET = 0;
+    static constexpr int32_t COUNT_OFFSET = 8;
+    static constexpr int32_t VALUES_OFFSET = 16;
+
+    static size_t payload_size(int64_t property_count) {
+        return VALUES_OFFSET + 2 * sizeof(int64_t) * static_cast<size_t>(property_count);
+    }
+    static int32_t value_offset(int64_t index) {
+        return VALUES_OFFSET + static_cast<int32_t>(index * sizeof(int64_t));
+    }
+};
+
+// GoTS Arrays - the 1-D float64 arrays simple_array.h's Array models - live
+// on the GC heap as a TYPE_NUMERIC_ARRAY handle whose elements sit in a
+// separate TYPE_NUMERIC_ARRAY_DATA object. Growing replaces the storage
+// through the write barrier, so the handle, and the JIT's pointer to it,
+// never changes. Storage of LOS_OBJECT_SIZE and up lands in the large-object
+// space and its pages go back to the OS once the array dies.
+struct GCArray {
+    int64_t length;
+    int64_t capacity;
+    double* data;  // Null while capacity is 0 - the type's only reference
+};
+static_assert(offsetof(GCArray, data) == 16, "TYPE_NUMERIC_ARRAY's ref_offsets");
+
 // High-Performance Date Implementation
 // JavaScript-compatible Date class with optimized internal representation
 class GoTSDate {
@@ -1,6 +1,7 @@
 #include "runtime.h"
 #include "goroutine_advanced.h"
 #include "goroutine_system.h"
+#include "gc_memory_manager.h"
 #include <iostream>
 
 namespace gots {
@@ -51,7 +52,11 @@ bool __channel_send_int64(void* channel_ptr, int64_t value) {
     if (!channel_ptr) return false;
     
     auto channel = static_cast<Channel<int64_t>*>(channel_ptr);
+    // Queued values are invisible to the GC - heap values stay retained
+    // until received
+    GarbageCollector::instance().retain(reinterpret_cast<void*>(value));
     bool result = channel->send(value);
+    if (!result) GarbageCollector::instance().release(reinterpret_cast<void*>(value));
     
     if (result) {
         std::cout << "DEBUG: Sent value " << value << " to channel" << std::endl;
@@ -68,6 +73,7 @@ bool __channel_receive_int64(void* channel_ptr, int64_t* value) {
     bool result = channel->receive(*value);
     
     if (result) {
+        GarbageCollector::instance().release(reinterpret_cast<void*>(*value));
         std::cout << "DEBUG: Received value " << *value << " from channel" << std::endl;
     }
     
@@ -79,7 +85,9 @@ bool __channel_try_receive_int64(void* channel_ptr, int64_t* value) {
     if (!channel_ptr || !value) return false;
     
     auto channel = static_cast<Channel<int64_t>*>(channel_ptr);
-    return channel->try_receive(*value);
+    bool result = channel->try_receive(*value);
+    if (result) GarbageCollector::instance().release(reinterpret_cast<void*>(*value));
+    return result;
 }
 
 // Close channel
@@ -168,6 +168,11 @@ struct RuntimeObject {
         void* heapSize;
         void* heapUsed;
         void* nextGC;
+        void* stats;            // runtime.gc.stats() -> GCStats snapshot
+        void* setMemoryLimit;   // Soft limit in bytes, 0 for none - returns the previous one
+        void* writeHeapSnapshot;    // Object graph for `gots heapstat` - returns the object count
+        void* setHeapProfileRate;   // Mean bytes between samples, 0 to stop - returns the previous rate
+        void* writeHeapProfile;     // pprof heap profile - returns the stack count
     };
     
     struct LockObject {
@@ -176,6 +181,22 @@ struct RuntimeObject {
         void* create;           // runtime.lock.create() -> new Lock()
     };
     
+    struct WeakObject {
+        static constexpr const char* OBJECT_NAME = "weak";
+        
+        void* ref;              // runtime.weak.ref(target) -> WeakRef
+        void* deref;            // Target, or null once it was collected
+        void* map;              // runtime.weak.map() -> WeakMap, keys held weakly
+        void* get;
+        void* set;
+        void* has;
+        void* remove;
+        void* size;
+        void* registry;         // runtime.weak.registry(cleanup) -> FinalizationRegistry
+        void* registerTarget;   // cleanup(held) runs on a goroutine once target dies
+        void* unregister;       // Cancels the cleanups registered with a token
+    };
+    
     // Runtime object layout - designed for cache efficiency
     TimeObject time;
     ProcessObject process;
@@ -189,6 +210,7 @@ struct RuntimeObject {
     JITObject jit;
     GCObject gc;
     LockObject lock;
+    WeakObject weak;
     
     // Direct function pointers for frequently used operations
     void* eval;
@@ -2,6 +2,13 @@
 #include "runtime.h"
 #include "runtime_object.h"
 #include "lock_system.h"
+#include "netpoller.h"
+#include "async_file_io.h"
+#include "http_server.h"
+#include "http_client.h"
+#include "goroutine_system.h"
+#include "gc_memory_manager.h"
+#include "heap_profile.h"
 
 // Forward declarations for new goroutine system
 extern "C" {
@@ -243,7 +250,7 @@ void* __runtime_process_version() {
 }
 
 // File system syscalls
-int64_t __runtime_fs_open(const char* path, const char* flags, int64_t mode) {
+static int parse_open_flags(const char* flags) {
     int open_flags = 0;
     
     // Parse flags string (Node.js style)
@@ -261,10 +268,16 @@ int64_t __runtime_fs_open(const char* path, const char* flags, int64_t mode) {
         open_flags = O_RDWR | O_CREAT | O_APPEND;
     }
     
-    return open(path, open_flags, static_cast<mode_t>(mode));
+    return open_flags;
+}
+
+int64_t __runtime_fs_open(const char* path, const char* flags, int64_t mode) {
+    return open(path, parse_open_flags(flags), static_cast<mode_t>(mode));
 }
 
 int64_t __runtime_fs_close(int64_t fd) {
+    // The fd number may be reused as soon as it is closed
+    AsyncFileIO::forget_fd(static_cast<int>(fd));
     return close(static_cast<int>(fd));
 }
 
@@ -507,8 +520,34 @@ void __runtime_math_random_seed(int64_t seed) {
 }
 
 // Network syscalls - comprehensive socket and networking operations
+// All sockets are non-blocking and registered with the shared netpoller.
+// A call that would block parks the calling goroutine on the netpoller
+// instead of a kernel wait, so idle connections hold no thread.
+
+// Park until fd is ready in `mode`; false (with errno set) if the caller should give up
+static bool net_wait(int fd, PollMode mode) {
+    NetPoller& poller = NetPoller::instance();
+    switch (poller.wait(poller.open(fd), mode)) {
+        case PollResult::READY:
+            return true;
+        case PollResult::TIMEOUT:
+            errno = ETIMEDOUT;
+            return false;
+        case PollResult::CLOSED:
+            errno = EBADF;
+            return false;
+        default:
+            errno = EAGAIN;
+            return false;
+    }
+}
+
 int64_t __runtime_net_socket(int64_t domain, int64_t type, int64_t protocol) {
-    return socket(static_cast<int>(domain), static_cast<int>(type), static_cast<int>(protocol));
+    int fd = socket(static_cast<int>(domain), static_cast<int>(type) | SOCK_CLOEXEC, static_cast<int>(protocol));
+    if (fd >= 0) {
+        NetPoller::instance().open(fd);
+    }
+    return fd;
 }
 
 bool __runtime_net_bind(int64_t sockfd, const char* address, int64_t port) {
@@ -535,7 +574,16 @@ bool __runtime_net_listen(int64_t sockfd, int64_t backlog) {
 int64_t __runtime_net_accept(int64_t sockfd, void* address) {
     struct sockaddr_in client_addr;
     socklen_t addr_len = sizeof(client_addr);
-    int client_fd = accept(static_cast<int>(sockfd), reinterpret_cast<struct sockaddr*>(&client_addr), &addr_len);
+    int client_fd;
+    while (true) {
+        addr_len = sizeof(client_addr);
+        client_fd = accept4(static_cast<int>(sockfd), reinterpret_cast<struct sockaddr*>(&client_addr), &addr_len, SOCK_CLOEXEC);
+        if (client_fd >= 0) break;
+        if (errno == EINTR) continue;
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && net_wait(static_cast<int>(sockfd), PollMode::READ)) continue;
+        return -1;
+    }
+    NetPoller::instance().open(client_fd);
     
     // Store client address info if requested
     if (address && client_fd >= 0) {
@@ -561,18 +609,68 @@ bool __runtime_net_connect(int64_t sockfd, const char* address, int64_t port) {
         return false;
     }
     
-    return connect(static_cast<int>(sockfd), reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+    int fd = static_cast<int>(sockfd);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        return true;
+    }
+    if (errno != EINPROGRESS && errno != EINTR) {
+        return false;
+    }
+    
+    // Non-blocking connect - wait for writability, then confirm with the peer
+    // address since a freshly registered socket may report a stale edge
+    while (net_wait(fd, PollMode::WRITE)) {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+            return false;
+        }
+        if (error != 0 && error != EINPROGRESS && error != EALREADY && error != EINTR) {
+            errno = error;
+            return false;
+        }
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        if (error == 0 && getpeername(fd, reinterpret_cast<struct sockaddr*>(&peer), &peer_len) == 0) {
+            return true;
+        }
+    }
+    return false;
 }
 
 int64_t __runtime_net_send(int64_t sockfd, const void* buffer, int64_t size, int64_t flags) {
-    return send(static_cast<int>(sockfd), buffer, static_cast<size_t>(size), static_cast<int>(flags));
+    int fd = static_cast<int>(sockfd);
+    while (true) {
+        ssize_t sent = send(fd, buffer, static_cast<size_t>(size), static_cast<int>(flags) | MSG_NOSIGNAL);
+        if (sent >= 0) return sent;
+        if (errno == EINTR) continue;
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && net_wait(fd, PollMode::WRITE)) continue;
+        return -1;
+    }
 }
 
 int64_t __runtime_net_recv(int64_t sockfd, void* buffer, int64_t size, int64_t flags) {
-    return recv(static_cast<int>(sockfd), buffer, static_cast<size_t>(size), static_cast<int>(flags));
+    int fd = static_cast<int>(sockfd);
+    while (true) {
+        ssize_t received = recv(fd, buffer, static_cast<size_t>(size), static_cast<int>(flags));
+        if (received >= 0) return received;
+        if (errno == EINTR) continue;
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && net_wait(fd, PollMode::READ)) continue;
+        return -1;
+    }
+}
+
+bool __runtime_net_set_timeout(int64_t sockfd, int64_t timeout_ms) {
+    PollDesc* desc = NetPoller::instance().open(static_cast<int>(sockfd));
+    if (!desc) return false;
+    desc->timeout_ms.store(timeout_ms > 0 ? timeout_ms : 0, std::memory_order_relaxed);
+    return true;
 }
 
 bool __runtime_net_close(int64_t sockfd) {
+    // Wake anything parked on the socket before the fd number can be reused
+    NetPoller::instance().close(static_cast<int>(sockfd));
+    AsyncFileIO::forget_fd(static_cast<int>(sockfd));
     return close(static_cast<int>(sockfd)) == 0;
 }
 
@@ -697,26 +795,205 @@ void* __runtime_dns_resolveCname(const char* hostname) {
     return __array_create(0);
 }
 
-// Basic HTTP syscalls - simplified HTTP client/server functionality
-void* __runtime_http_request(const char* method, const char* url, void* headers, const void* body, int64_t body_size) {
-    // This is a simplified HTTP client implementation
-    // In a full implementation, this would parse the URL, create socket connections,
-    // format HTTP requests, and return promise objects
+// URL parsing, shared by the HTTP client and the URL syscalls
+struct ParsedURL {
+    std::string protocol;
+    std::string hostname;
+    std::string port;
+    std::string pathname;
+    std::string search;
+    std::string hash;
+};
+
+ParsedURL parse_url_internal(const char* url_str) {
+    ParsedURL url;
+    std::string url_string(url_str);
+    
+    // Find protocol
+    size_t protocol_end = url_string.find("://");
+    if (protocol_end != std::string::npos) {
+        url.protocol = url_string.substr(0, protocol_end);
+        url_string = url_string.substr(protocol_end + 3);
+    }
+    
+    // Find hash
+    size_t hash_pos = url_string.find('#');
+    if (hash_pos != std::string::npos) {
+        url.hash = url_string.substr(hash_pos);
+        url_string = url_string.substr(0, hash_pos);
+    }
     
-    // For now, return a placeholder response object
-    // Real implementation would use libcurl or custom HTTP parser
-    return __string_create("HTTP response placeholder");
+    // Find search/query
+    size_t search_pos = url_string.find('?');
+    if (search_pos != std::string::npos) {
+        url.search = url_string.substr(search_pos);
+        url_string = url_string.substr(0, search_pos);
+    }
+    
+    // Find pathname
+    size_t path_pos = url_string.find('/');
+    if (path_pos != std::string::npos) {
+        url.pathname = url_string.substr(path_pos);
+        url_string = url_string.substr(0, path_pos);
+    } else {
+        url.pathname = "/";
+    }
+    
+    // Parse hostname and port
+    size_t port_pos = url_string.find(':');
+    if (port_pos != std::string::npos) {
+        url.hostname = url_string.substr(0, port_pos);
+        url.port = url_string.substr(port_pos + 1);
+    } else {
+        url.hostname = url_string;
+    }
+    
+    return url;
 }
 
+// HTTP client - blocks the calling goroutine until the response is complete.
+// `headers` is an optional block of "Name: value" lines separated by CRLF or
+// LF. Returns false (after logging) on failure.
+static bool run_http_request(const char* method, const char* url, void* headers, const void* body,
+                             int64_t body_size, HttpClientResponse& response) {
+    if (!url) return false;
+
+    ParsedURL parsed = parse_url_internal(url);
+    if (parsed.protocol != "http" || parsed.hostname.empty()) {
+        std::cerr << "ERROR: Unsupported URL for HTTP request: " << url << std::endl;
+        return false;
+    }
+
+    HttpClientRequest request;
+    request.method = method && *method ? method : "GET";
+    request.host = parsed.hostname;
+    request.port = parsed.port.empty() ? 80 : atoi(parsed.port.c_str());
+    request.target = parsed.pathname + parsed.search;
+    if (body && body_size > 0) {
+        request.body.assign(static_cast<const char*>(body), static_cast<size_t>(body_size));
+    }
+
+    if (headers) {
+        std::string block(static_cast<const char*>(headers));
+        size_t pos = 0;
+        while (pos < block.size()) {
+            size_t end = block.find('\n', pos);
+            if (end == std::string::npos) end = block.size();
+            std::string line = block.substr(pos, end - pos);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                size_t value = line.find_first_not_of(" \t", colon + 1);
+                request.headers.emplace_back(line.substr(0, colon),
+                                             value == std::string::npos ? std::string() : line.substr(value));
+            }
+            pos = end + 1;
+        }
+    }
+
+    response = HttpClient::instance().request(std::move(request));
+    if (!response.ok) {
+        std::cerr << "ERROR: HTTP request to " << url << " failed: " << response.error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Returns the response body as a string, or nullptr on failure. Strings end
+// at their first NUL, so binary bodies should use __runtime_http_request_buffer.
+void* __runtime_http_request(const char* method, const char* url, void* headers, const void* body, int64_t body_size) {
+    HttpClientResponse response;
+    if (!run_http_request(method, url, headers, body, body_size, response)) return nullptr;
+    return __string_create(response.body.c_str());
+}
+
+// Returns the response body as a Buffer of its exact size, or nullptr on failure
+void* __runtime_http_request_buffer(const char* method, const char* url, void* headers, const void* body, int64_t body_size) {
+    HttpClientResponse response;
+    if (!run_http_request(method, url, headers, body, body_size, response)) return nullptr;
+
+    // Sized directly rather than through __runtime_buffer_alloc so an empty
+    // body is an empty Buffer, not a failure
+    size_t size = response.body.size();
+    void* buffer = GenerationalHeap::allocate_fast(size + sizeof(int64_t), TYPE_BUFFER);
+    *reinterpret_cast<int64_t*>(buffer) = static_cast<int64_t>(size);
+    memcpy(static_cast<char*>(buffer) + sizeof(int64_t), response.body.data(), size);
+    return buffer;
+}
+
+// HTTP server - `handler` is a compiled function called as
+// handler(request, response) for every request; it reads the request and
+// fills in the response through the __runtime_http_req_*/res_* accessors.
 void* __runtime_http_create_server(void* handler) {
-    // HTTP server creation - would return server object
-    // Real implementation would create event loop integration
-    return nullptr; // Placeholder
+    if (!handler) return nullptr;
+
+    typedef void (*RequestHandler)(void* request, void* response);
+    RequestHandler callback = reinterpret_cast<RequestHandler>(handler);
+
+    // Handlers run on the server's worker threads, which are not goroutines.
+    // Timers and async handles they create go to the creating goroutine's
+    // event loop, which listen() keeps running
+    int64_t owner_id = current_goroutine ? current_goroutine->get_id() : -1;
+
+    // Servers live for the rest of the process
+    return new HttpServer([callback, owner_id](const HttpRequest& request, HttpResponse& response) {
+        bind_event_loop_owner(owner_id);
+        // The handler may hold heap pointers without ever allocating, so the
+        // collector must stop and scan this thread from its first request
+        GarbageCollector::instance().register_current_thread();
+        callback(const_cast<HttpRequest*>(&request), &response);
+    });
 }
 
 bool __runtime_http_server_listen(void* server, int64_t port, const char* host) {
-    // HTTP server listen - would bind to port and start accepting connections
-    return false; // Placeholder
+    if (!server) return false;
+    return static_cast<HttpServer*>(server)->listen(static_cast<int>(port), host ? host : "0.0.0.0");
+}
+
+void __runtime_http_server_close(void* server) {
+    if (server) {
+        static_cast<HttpServer*>(server)->close();
+    }
+}
+
+static void* string_from_view(std::string_view view) {
+    return __string_create(std::string(view).c_str());
+}
+
+void* __runtime_http_req_method(void* request) {
+    return string_from_view(static_cast<HttpRequest*>(request)->method);
+}
+
+void* __runtime_http_req_url(void* request) {
+    return string_from_view(static_cast<HttpRequest*>(request)->target);
+}
+
+void* __runtime_http_req_header(void* request, const char* name) {
+    std::string_view value = static_cast<HttpRequest*>(request)->header(name);
+    return value.data() ? string_from_view(value) : nullptr;
+}
+
+void* __runtime_http_req_body(void* request) {
+    return string_from_view(static_cast<HttpRequest*>(request)->body);
+}
+
+void __runtime_http_res_status(void* response, int64_t status) {
+    static_cast<HttpResponse*>(response)->set_status(static_cast<int>(status));
+}
+
+void __runtime_http_res_header(void* response, const char* name, const char* value) {
+    static_cast<HttpResponse*>(response)->set_header(name, value);
+}
+
+void __runtime_http_res_end(void* response, const void* body, int64_t body_size) {
+    auto* res = static_cast<HttpResponse*>(response);
+    if (body && body_size > 0) {
+        res->send(std::string(static_cast<const char*>(body), static_cast<size_t>(body_size)));
+    }
+}
+
+bool __runtime_http_res_send_file(void* response, const char* path) {
+    return static_cast<HttpResponse*>(response)->send_file(path);
 }
 
 // Crypto syscalls - secure cryptographic operations
@@ -781,16 +1058,13 @@ void* __runtime_crypto_verify(const char* algorithm, const void* data, int64_t s
 void* __runtime_buffer_alloc(int64_t size) {
     if (size <= 0) return nullptr;
     
-    // Allocate buffer with size header for GoTS Buffer object
-    void* buffer = malloc(static_cast<size_t>(size + sizeof(int64_t)));
-    if (!buffer) return nullptr;
+    // Buffer object on the GC heap with its size header - the data comes
+    // back zeroed
+    void* buffer = GenerationalHeap::allocate_fast(static_cast<size_t>(size) + sizeof(int64_t), TYPE_BUFFER);
     
     // Store size at beginning of buffer
     *reinterpret_cast<int64_t*>(buffer) = size;
     
-    // Zero-initialize the buffer data
-    memset(static_cast<char*>(buffer) + sizeof(int64_t), 0, static_cast<size_t>(size));
-    
     return buffer;
 }
 
@@ -1173,61 +1447,6 @@ bool __runtime_timer_clear_immediate(int64_t id) {
 }
 
 // URL syscalls - URL parsing and manipulation
-struct ParsedURL {
-    std::string protocol;
-    std::string hostname;
-    std::string port;
-    std::string pathname;
-    std::string search;
-    std::string hash;
-};
-
-ParsedURL parse_url_internal(const char* url_str) {
-    ParsedURL url;
-    std::string url_string(url_str);
-    
-    // Find protocol
-    size_t protocol_end = url_string.find("://");
-    if (protocol_end != std::string::npos) {
-        url.protocol = url_string.substr(0, protocol_end);
-        url_string = url_string.substr(protocol_end + 3);
-    }
-    
-    // Find hash
-    size_t hash_pos = url_string.find('#');
-    if (hash_pos != std::string::npos) {
-        url.hash = url_string.substr(hash_pos);
-        url_string = url_string.substr(0, hash_pos);
-    }
-    
-    // Find search/query
-    size_t search_pos = url_string.find('?');
-    if (search_pos != std::string::npos) {
-        url.search = url_string.substr(search_pos);
-        url_string = url_string.substr(0, search_pos);
-    }
-    
-    // Find pathname
-    size_t path_pos = url_string.find('/');
-    if (path_pos != std::string::npos) {
-        url.pathname = url_string.substr(path_pos);
-        url_string = url_string.substr(0, path_pos);
-    } else {
-        url.pathname = "/";
-    }
-    
-    // Parse hostname and port
-    size_t port_pos = url_string.find(':');
-    if (port_pos != std::string::npos) {
-        url.hostname = url_string.substr(0, port_pos);
-        url.port = url_string.substr(port_pos + 1);
-    } else {
-        url.hostname = url_string;
-    }
-    
-    return url;
-}
-
 void* __runtime_url_parse(const char* url, bool parse_query) {
     if (!url) return nullptr;
     
@@ -1577,31 +1796,33 @@ bool __runtime_stream_pipe(void* readable, void* writable, void* options) {
 }
 
 // Async file operations that return promises
+// Each returns a Promise handle - a reference the caller owns - resolving to
+// the same int64 result as the synchronous variant; consume it with
+// __runtime_fs_await. Buffers must stay alive until the promise resolves.
+static void* promise_handle(PromiseRef promise) {
+    return promise.detach();
+}
+
 void* __runtime_fs_open_async(const char* path, const char* flags, int64_t mode) {
-    // Return promise object that resolves with file descriptor
-    // For now, perform synchronous operation and wrap in resolved promise
-    int64_t fd = __runtime_fs_open(path, flags, mode);
-    
-    // Would create actual promise object here
-    return reinterpret_cast<void*>(fd);
+    return promise_handle(AsyncFileIO::instance().open(path, parse_open_flags(flags), static_cast<mode_t>(mode)));
 }
 
 void* __runtime_fs_read_async(int64_t fd, void* buffer, int64_t size) {
-    // Return promise object
-    int64_t bytes_read = __runtime_fs_read(fd, buffer, size);
-    return reinterpret_cast<void*>(bytes_read);
+    return promise_handle(AsyncFileIO::instance().read(static_cast<int>(fd), buffer, static_cast<size_t>(size)));
 }
 
 void* __runtime_fs_write_async(int64_t fd, const void* buffer, int64_t size) {
-    // Return promise object
-    int64_t bytes_written = __runtime_fs_write(fd, buffer, size);
-    return reinterpret_cast<void*>(bytes_written);
+    return promise_handle(AsyncFileIO::instance().write(static_cast<int>(fd), buffer, static_cast<size_t>(size)));
 }
 
 void* __runtime_fs_close_async(int64_t fd) {
-    // Return promise object
-    int64_t result = __runtime_fs_close(fd);
-    return reinterpret_cast<void*>(result);
+    return promise_handle(AsyncFileIO::instance().close(static_cast<int>(fd)));
+}
+
+int64_t __runtime_fs_await(void* handle) {
+    if (!handle) return -1;
+    PromiseRef promise = PromiseRef::adopt(static_cast<Promise*>(handle));
+    return AsyncFileIO::await_result(promise);
 }
 
 // Memory management syscalls
@@ -1610,6 +1831,8 @@ void* __runtime_mem_alloc(int64_t size) {
 }
 
 void __runtime_mem_free(void* ptr) {
+    // GC heap objects are reclaimed by the collector
+    if (GarbageCollector::instance().get_heap().contains(ptr)) return;
     free(ptr);
 }
 
@@ -1623,17 +1846,127 @@ int64_t __runtime_mem_size(void* ptr) {
 }
 
 void __runtime_gc_collect() {
-    // Trigger garbage collection - would integrate with GoTS GC
+    GarbageCollector::instance().request_gc(true);
 }
 
 int64_t __runtime_gc_heap_size() {
-    // Return heap size
-    return 0; // Placeholder
+    return static_cast<int64_t>(GarbageCollector::instance().get_heap().heap_size());
 }
 
 int64_t __runtime_gc_heap_used() {
-    // Return used heap
-    return 0; // Placeholder
+    GenerationalHeap& heap = GarbageCollector::instance().get_heap();
+    return static_cast<int64_t>(heap.young_used() + heap.old_used());
+}
+
+// Old generation occupancy at which the next old collection starts
+int64_t __runtime_gc_next_gc() {
+    return static_cast<int64_t>(GarbageCollector::instance().get_heap().old_gc_trigger());
+}
+
+int64_t __runtime_gc_set_memory_limit(int64_t bytes) {
+    return static_cast<int64_t>(GarbageCollector::instance().set_memory_limit(bytes > 0 ? bytes : 0));
+}
+
+// Objects written, -1 on failure
+int64_t __runtime_gc_write_heap_snapshot(const char* path) {
+    return GarbageCollector::instance().write_heap_snapshot(path);
+}
+
+int64_t __runtime_gc_set_heap_profile_rate(int64_t bytes) {
+    return static_cast<int64_t>(GarbageCollector::instance().set_heap_profile_rate(bytes > 0 ? bytes : 0));
+}
+
+// Stacks written, -1 on failure
+int64_t __runtime_gc_write_heap_profile(const char* path) {
+    HeapProfile profile;
+    if (!GarbageCollector::instance().get_heap_profile(profile)) {
+        std::cerr << "ERROR: No heap profile - set a rate with runtime.gc.setHeapProfileRate first" << std::endl;
+        return -1;
+    }
+    if (!profile.write_pprof(path)) return -1;
+    return static_cast<int64_t>(profile.stacks.size());
+}
+
+// runtime.gc.stats() - a snapshot object; fields are read by name
+void* __runtime_gc_stats() {
+    GarbageCollector::Stats stats = GarbageCollector::instance().get_stats();
+    const std::pair<const char*, size_t> fields[] = {
+        {"youngCollections", stats.young_collections},
+        {"oldCollections", stats.old_collections},
+        {"concurrentMarks", stats.concurrent_marks},
+        {"compactions", stats.old_compactions},
+        {"pauseCount", stats.pause_count},
+        {"pauseP50Us", stats.pause_p50_us},
+        {"pauseP99Us", stats.pause_p99_us},
+        {"pauseMaxUs", stats.pause_max_us},
+        {"pauseTotalMs", stats.total_pause_time_ms},
+        {"allocatedBytes", stats.total_allocated},
+        {"allocBytesPerSec", stats.alloc_bytes_per_sec},
+        {"promotedBytes", stats.promoted_bytes},
+        {"promotedBytesPerSec", stats.promoted_bytes_per_sec},
+        {"freedBytes", stats.total_freed},
+        {"liveBytes", stats.live_objects},
+        {"heapSize", stats.heap_size},
+        {"heapUsed", stats.heap_used},
+        {"largeObjectBytes", stats.large_object_bytes},
+        {"memoryLimit", stats.memory_limit},
+        {"edenSize", stats.eden_size},
+        {"nextGC", stats.old_gc_trigger},
+        {"pretenuredSites", stats.pretenured_sites},
+        {"pretenuredBytes", stats.pretenured_bytes},
+    };
+    int64_t count = sizeof(fields) / sizeof(fields[0]);
+    int64_t object = __object_create("GCStats", count);
+    for (int64_t i = 0; i < count; ++i) {
+        __object_set_property(object, i, static_cast<int64_t>(fields[i].second));
+        __object_set_property_name(object, i, fields[i].first);
+    }
+    return reinterpret_cast<void*>(object);
+}
+
+// Weak reference syscalls - the GC owns the containers, see new_weak_ref
+void* __runtime_weak_ref(void* target) {
+    return GarbageCollector::instance().new_weak_ref(target);
+}
+
+void* __runtime_weak_deref(void* ref) {
+    return GarbageCollector::instance().weak_ref_get(ref);
+}
+
+void* __runtime_weak_map() {
+    return GarbageCollector::instance().new_weak_map();
+}
+
+void* __runtime_weak_get(void* map, void* key) {
+    return GarbageCollector::instance().weak_map_get(map, key);
+}
+
+void __runtime_weak_set(void* map, void* key, void* value) {
+    GarbageCollector::instance().weak_map_set(map, key, value);
+}
+
+bool __runtime_weak_has(void* map, void* key) {
+    return GarbageCollector::instance().weak_map_has(map, key);
+}
+
+bool __runtime_weak_remove(void* map, void* key) {
+    return GarbageCollector::instance().weak_map_delete(map, key);
+}
+
+int64_t __runtime_weak_size(void* map) {
+    return static_cast<int64_t>(GarbageCollector::instance().weak_map_size(map));
+}
+
+void* __runtime_weak_registry(void* callback) {
+    return GarbageCollector::instance().new_finalization_registry(callback);
+}
+
+void __runtime_weak_register(void* registry, void* target, void* held, void* token) {
+    GarbageCollector::instance().finalization_register(registry, target, held, token);
+}
+
+bool __runtime_weak_unregister(void* registry, void* token) {
+    return GarbageCollector::instance().finalization_unregister(registry, token);
 }
 
 // Error syscalls
@@ -1701,10 +2034,16 @@ namespace {
 
 // Lock syscalls - thread-safe locking primitives
 void* __runtime_lock_create() {
+    return __runtime_lock_create_at(nullptr);
+}
+
+// `new Lock()` in compiled code passes its source location, which names
+// the lock in GOTS_LOCK_PROFILE reports
+void* __runtime_lock_create_at(const char* site) {
     // Create a new Lock object and store it in managed storage
     try {
         std::lock_guard<std::mutex> guard(locks_mutex);
-        auto lock = LockFactory::create_lock();
+        auto lock = LockFactory::create_lock(site);
         void* raw_ptr = lock.get();
         managed_locks.push_back(lock);
         return raw_ptr; // Return raw pointer for runtime use
@@ -1736,6 +2075,13 @@ void __runtime_lock_unlock(void* lock_ptr) {
     }
 }
 
+// Called by JIT-inlined unlock() once it has cleared the owner and found
+// waiters recorded in the lock word
+void __runtime_lock_unlock_contended(void* lock_ptr) {
+    if (!lock_ptr) return;
+    static_cast<Lock*>(lock_ptr)->unlock_contended();
+}
+
 bool __runtime_lock_try_lock(void* lock_ptr) {
     if (!lock_ptr) return false;
     
@@ -1772,6 +2118,149 @@ bool __runtime_lock_is_locked_by_current(void* lock_ptr) {
     }
 }
 
+// WaitGroup / Semaphore / RWLock / Barrier syscalls. The JIT inlines
+// WaitGroup.add/done and Semaphore.acquire/release and only calls the
+// *_settle / *_wake / *_acquire entries on their slow paths.
+extern "C++" {
+namespace {
+    std::vector<std::shared_ptr<void>> managed_sync_objects;
+    
+    template <typename T, typename... Args>
+    void* create_sync_object(const char* what, Args... args) {
+        try {
+            auto object = std::make_shared<T>(args...);
+            std::lock_guard<std::mutex> guard(locks_mutex);
+            managed_sync_objects.push_back(object);
+            return object.get();
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: Creating " << what << ": " << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+}
+}
+
+void* __runtime_waitgroup_create() {
+    return create_sync_object<WaitGroup>("WaitGroup");
+}
+
+void __runtime_waitgroup_add(void* wg_ptr, int64_t delta) {
+    if (!wg_ptr) return;
+    try {
+        static_cast<WaitGroup*>(wg_ptr)->add(static_cast<int32_t>(delta));
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: WaitGroup.add: " << e.what() << std::endl;
+    }
+}
+
+// Called by JIT-inlined add()/done() when the count dropped to zero or below
+void __runtime_waitgroup_settle(void* wg_ptr) {
+    if (!wg_ptr) return;
+    try {
+        static_cast<WaitGroup*>(wg_ptr)->settle();
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: WaitGroup.done: " << e.what() << std::endl;
+    }
+}
+
+void __runtime_waitgroup_wait(void* wg_ptr) {
+    if (!wg_ptr) return;
+    static_cast<WaitGroup*>(wg_ptr)->wait();
+}
+
+void* __runtime_semaphore_create(int64_t permits) {
+    return create_sync_object<Semaphore>("Semaphore", static_cast<int32_t>(permits));
+}
+
+void __runtime_semaphore_acquire(void* sem_ptr) {
+    if (!sem_ptr) return;
+    static_cast<Semaphore*>(sem_ptr)->acquire();
+}
+
+bool __runtime_semaphore_try_acquire(void* sem_ptr) {
+    if (!sem_ptr) return false;
+    return static_cast<Semaphore*>(sem_ptr)->try_acquire();
+}
+
+bool __runtime_semaphore_try_acquire_for(void* sem_ptr, int64_t timeout_ms) {
+    if (!sem_ptr) return false;
+    return static_cast<Semaphore*>(sem_ptr)->try_acquire_for(std::chrono::milliseconds(timeout_ms));
+}
+
+void __runtime_semaphore_release(void* sem_ptr) {
+    if (!sem_ptr) return;
+    static_cast<Semaphore*>(sem_ptr)->release();
+}
+
+// Called by JIT-inlined release() after adding the permit, when the
+// semaphore records parked acquirers
+void __runtime_semaphore_wake(void* sem_ptr) {
+    if (!sem_ptr) return;
+    static_cast<Semaphore*>(sem_ptr)->wake_one();
+}
+
+void* __runtime_rwlock_create() {
+    return create_sync_object<RWLock>("RWLock");
+}
+
+void __runtime_rwlock_read_lock(void* rw_ptr) {
+    if (!rw_ptr) return;
+    static_cast<RWLock*>(rw_ptr)->read_lock();
+}
+
+void __runtime_rwlock_read_unlock(void* rw_ptr) {
+    if (!rw_ptr) return;
+    static_cast<RWLock*>(rw_ptr)->read_unlock();
+}
+
+bool __runtime_rwlock_try_read_lock(void* rw_ptr) {
+    if (!rw_ptr) return false;
+    return static_cast<RWLock*>(rw_ptr)->try_read_lock();
+}
+
+void __runtime_rwlock_write_lock(void* rw_ptr) {
+    if (!rw_ptr) return;
+    static_cast<RWLock*>(rw_ptr)->write_lock();
+}
+
+void __runtime_rwlock_write_unlock(void* rw_ptr) {
+    if (!rw_ptr) return;
+    try {
+        static_cast<RWLock*>(rw_ptr)->write_unlock();
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: RWLock.write_unlock: " << e.what() << std::endl;
+    }
+}
+
+bool __runtime_rwlock_try_write_lock(void* rw_ptr) {
+    if (!rw_ptr) return false;
+    return static_cast<RWLock*>(rw_ptr)->try_write_lock();
+}
+
+void* __runtime_barrier_create(int64_t parties) {
+    return create_sync_object<Barrier>("Barrier", static_cast<int32_t>(parties));
+}
+
+bool __runtime_barrier_wait(void* barrier_ptr) {
+    if (!barrier_ptr) return false;
+    return static_cast<Barrier*>(barrier_ptr)->wait();
+}
+
+// Atomic<T> cells - the JIT reads and writes the 8-byte value in place with
+// lock-prefixed instructions. A padded cell owns a whole cache line so that
+// counters updated from different cores never false-share.
+void* __runtime_atomic_create(int64_t initial_bits, int64_t padded) {
+    size_t size = padded ? ATOMIC_CELL_CACHE_LINE : sizeof(int64_t);
+    void* cell = aligned_alloc(size, size);
+    if (!cell) {
+        std::cerr << "ERROR: Failed to allocate atomic cell" << std::endl;
+        return nullptr;
+    }
+    memset(cell, 0, size);
+    *static_cast<int64_t*>(cell) = initial_bits;
+    return cell;
+}
+
 // Additional runtime functions for GoTS-specific features
 void* __runtime_go_spawn(void* func, void* args) {
     // Spawn goroutine
@@ -1826,14 +2315,47 @@ void __runtime_jit_optimize(void* func) {
 
 // Lock syscalls
 void* __runtime_lock_create();
+void* __runtime_lock_create_at(const char* site);
 void __runtime_lock_lock(void* lock_ptr);
 void __runtime_lock_unlock(void* lock_ptr);
+void __runtime_lock_unlock_contended(void* lock_ptr);
 bool __runtime_lock_try_lock(void* lock_ptr);
 bool __runtime_lock_try_lock_for(void* lock_ptr, int64_t timeout_ms);
 bool __runtime_lock_is_locked_by_current(void* lock_ptr);
+void* __runtime_atomic_create(int64_t initial_bits, int64_t padded);
+void* __runtime_waitgroup_create();
+void __runtime_waitgroup_add(void* wg_ptr, int64_t delta);
+void __runtime_waitgroup_settle(void* wg_ptr);
+void __runtime_waitgroup_wait(void* wg_ptr);
+void* __runtime_semaphore_create(int64_t permits);
+void __runtime_semaphore_acquire(void* sem_ptr);
+bool __runtime_semaphore_try_acquire(void* sem_ptr);
+bool __runtime_semaphore_try_acquire_for(void* sem_ptr, int64_t timeout_ms);
+void __runtime_semaphore_release(void* sem_ptr);
+void __runtime_semaphore_wake(void* sem_ptr);
+void* __runtime_rwlock_create();
+void __runtime_rwlock_read_lock(void* rw_ptr);
+void __runtime_rwlock_read_unlock(void* rw_ptr);
+bool __runtime_rwlock_try_read_lock(void* rw_ptr);
+void __runtime_rwlock_write_lock(void* rw_ptr);
+void __runtime_rwlock_write_unlock(void* rw_ptr);
+bool __runtime_rwlock_try_write_lock(void* rw_ptr);
+void* __runtime_barrier_create(int64_t parties);
+bool __runtime_barrier_wait(void* barrier_ptr);
 
 } // extern "C"
 
+// FinalizationRegistry cleanups run on their own goroutine, outside the
+// collection that found the dead target. The closure is invisible to the
+// GC, so the held value stays retained until the callback returns
+static void run_cleanup_on_goroutine(void* callback, void* held) {
+    GarbageCollector::instance().retain(held);
+    GoroutineScheduler::instance().spawn([callback, held]() {
+        reinterpret_cast<void (*)(void*)>(callback)(held);
+        GarbageCollector::instance().release(held);
+    });
+}
+
 // Initialize runtime object (C++ function, not extern "C")
 void initialize_runtime_object() {
     if (global_runtime) return; // Already initialized
@@ -1889,6 +2411,31 @@ void initialize_runtime_object() {
     
     // Initialize lock object function pointers
     global_runtime->lock.create = reinterpret_cast<void*>(__runtime_lock_create);
+
+    // Initialize weak object function pointers
+    global_runtime->weak.ref = reinterpret_cast<void*>(__runtime_weak_ref);
+    global_runtime->weak.deref = reinterpret_cast<void*>(__runtime_weak_deref);
+    global_runtime->weak.map = reinterpret_cast<void*>(__runtime_weak_map);
+    global_runtime->weak.get = reinterpret_cast<void*>(__runtime_weak_get);
+    global_runtime->weak.set = reinterpret_cast<void*>(__runtime_weak_set);
+    global_runtime->weak.has = reinterpret_cast<void*>(__runtime_weak_has);
+    global_runtime->weak.remove = reinterpret_cast<void*>(__runtime_weak_remove);
+    global_runtime->weak.size = reinterpret_cast<void*>(__runtime_weak_size);
+    global_runtime->weak.registry = reinterpret_cast<void*>(__runtime_weak_registry);
+    global_runtime->weak.registerTarget = reinterpret_cast<void*>(__runtime_weak_register);
+    global_runtime->weak.unregister = reinterpret_cast<void*>(__runtime_weak_unregister);
+    GarbageCollector::instance().set_cleanup_runner(run_cleanup_on_goroutine);
+
+    // Initialize gc object function pointers
+    global_runtime->gc.collect = reinterpret_cast<void*>(__runtime_gc_collect);
+    global_runtime->gc.heapSize = reinterpret_cast<void*>(__runtime_gc_heap_size);
+    global_runtime->gc.heapUsed = reinterpret_cast<void*>(__runtime_gc_heap_used);
+    global_runtime->gc.stats = reinterpret_cast<void*>(__runtime_gc_stats);
+    global_runtime->gc.nextGC = reinterpret_cast<void*>(__runtime_gc_next_gc);
+    global_runtime->gc.setMemoryLimit = reinterpret_cast<void*>(__runtime_gc_set_memory_limit);
+    global_runtime->gc.writeHeapSnapshot = reinterpret_cast<void*>(__runtime_gc_write_heap_snapshot);
+    global_runtime->gc.setHeapProfileRate = reinterpret_cast<void*>(__runtime_gc_set_heap_profile_rate);
+    global_runtime->gc.writeHeapProfile = reinterpret_cast<void*>(__runtime_gc_write_heap_profile);
     
     // Register all methods for JIT optimization
     runtime_method_registry["time.now"] = {"time.now", global_runtime->time.now_millis, false, 0};
@@ -1896,6 +2443,26 @@ void initialize_runtime_object() {
     runtime_method_registry["process.pid"] = {"process.pid", global_runtime->process.pid, false, 0};
     runtime_method_registry["process.cwd"] = {"process.cwd", global_runtime->process.cwd, false, 0};
     runtime_method_registry["lock.create"] = {"lock.create", global_runtime->lock.create, false, 0};
+    runtime_method_registry["gc.collect"] = {"gc.collect", global_runtime->gc.collect, false, 0};
+    runtime_method_registry["gc.heapSize"] = {"gc.heapSize", global_runtime->gc.heapSize, false, 0};
+    runtime_method_registry["gc.heapUsed"] = {"gc.heapUsed", global_runtime->gc.heapUsed, false, 0};
+    runtime_method_registry["gc.stats"] = {"gc.stats", global_runtime->gc.stats, false, 0};
+    runtime_method_registry["gc.nextGC"] = {"gc.nextGC", global_runtime->gc.nextGC, false, 0};
+    runtime_method_registry["gc.setMemoryLimit"] = {"gc.setMemoryLimit", global_runtime->gc.setMemoryLimit, false, 1};
+    runtime_method_registry["gc.writeHeapSnapshot"] = {"gc.writeHeapSnapshot", global_runtime->gc.writeHeapSnapshot, false, 1};
+    runtime_method_registry["gc.setHeapProfileRate"] = {"gc.setHeapProfileRate", global_runtime->gc.setHeapProfileRate, false, 1};
+    runtime_method_registry["gc.writeHeapProfile"] = {"gc.writeHeapProfile", global_runtime->gc.writeHeapProfile, false, 1};
+    runtime_method_registry["weak.ref"] = {"weak.ref", global_runtime->weak.ref, false, 1};
+    runtime_method_registry["weak.deref"] = {"weak.deref", global_runtime->weak.deref, false, 1};
+    runtime_method_registry["weak.map"] = {"weak.map", global_runtime->weak.map, false, 0};
+    runtime_method_registry["weak.get"] = {"weak.get", global_runtime->weak.get, false, 2};
+    runtime_method_registry["weak.set"] = {"weak.set", global_runtime->weak.set, false, 3};
+    runtime_method_registry["weak.has"] = {"weak.has", global_runtime->weak.has, false, 2};
+    runtime_method_registry["weak.remove"] = {"weak.remove", global_runtime->weak.remove, false, 2};
+    runtime_method_registry["weak.size"] = {"weak.size", global_runtime->weak.size, false, 1};
+    runtime_method_registry["weak.registry"] = {"weak.registry", global_runtime->weak.registry, false, 1};
+    runtime_method_registry["weak.registerTarget"] = {"weak.registerTarget", global_runtime->weak.registerTarget, false, 4};
+    runtime_method_registry["weak.unregister"] = {"weak.unregister", global_runtime->weak.unregister, false, 2};
     // Add more as needed...
 }
 
@@ -1929,13 +2496,34 @@ void __runtime_register_global() {
     __register_function_fast(reinterpret_cast<void*>(__runtime_fs_close), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_fs_exists), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_fs_readdir), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_fs_open_async), 3, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_fs_read_async), 3, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_fs_write_async), 3, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_fs_close_async), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_fs_await), 1, 0);
     
     // Network functions
     __register_function_fast(reinterpret_cast<void*>(__runtime_net_socket), 3, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_net_bind), 3, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_net_listen), 2, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_net_set_timeout), 2, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_dns_lookup), 1, 0);
     
+    // HTTP functions
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_request), 5, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_request_buffer), 5, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_create_server), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_server_listen), 3, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_server_close), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_req_method), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_req_url), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_req_header), 2, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_req_body), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_res_status), 2, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_res_header), 3, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_res_end), 3, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_http_res_send_file), 2, 0);
+    
     // Buffer functions
     __register_function_fast(reinterpret_cast<void*>(__runtime_buffer_alloc), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_buffer_from_string), 1, 0);
@@ -1962,11 +2550,33 @@ void __runtime_register_global() {
     
     // Lock functions
     __register_function_fast(reinterpret_cast<void*>(__runtime_lock_create), 0, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_lock_create_at), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_lock_lock), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_lock_unlock), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_lock_try_lock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_lock_unlock_contended), 1, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_lock_try_lock_for), 2, 0);
     __register_function_fast(reinterpret_cast<void*>(__runtime_lock_is_locked_by_current), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_atomic_create), 2, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_waitgroup_create), 0, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_waitgroup_add), 2, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_waitgroup_settle), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_waitgroup_wait), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_semaphore_create), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_semaphore_acquire), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_semaphore_try_acquire), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_semaphore_try_acquire_for), 2, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_semaphore_release), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_semaphore_wake), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_create), 0, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_read_lock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_read_unlock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_try_read_lock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_write_lock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_write_unlock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_rwlock_try_write_lock), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_barrier_create), 1, 0);
+    __register_function_fast(reinterpret_cast<void*>(__runtime_barrier_wait), 1, 0);
     
     // Math functions
     __register_function_fast(reinterpret_cast<void*>(__runtime_math_random), 0, 0);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace gots {
@@ -8,6 +9,9 @@ namespace gots {
 // This provides the global 'runtime' object in GoTS with comprehensive system access
 // All high-level implementations (Date, fs, net, etc.) are built in GoTS using these primitives
 
+// Size and alignment of a padded Atomic<T> cell
+constexpr size_t ATOMIC_CELL_CACHE_LINE = 64;
+
 extern "C" {
     // PERFORMANCE NOTE: These syscalls are designed for flat access patterns
     // The GoTS compiler can optimize nested property access (runtime.time.now)
@@ -73,6 +77,7 @@ extern "C" {
     void* __runtime_fs_read_async(int64_t fd, void* buffer, int64_t size);
     void* __runtime_fs_write_async(int64_t fd, const void* buffer, int64_t size);
     void* __runtime_fs_close_async(int64_t fd);
+    int64_t __runtime_fs_await(void* handle);
     
     // Network syscalls
     int64_t __runtime_net_socket(int64_t domain, int64_t type, int64_t protocol);
@@ -82,6 +87,7 @@ extern "C" {
     bool __runtime_net_connect(int64_t sockfd, const char* address, int64_t port);
     int64_t __runtime_net_send(int64_t sockfd, const void* buffer, int64_t size, int64_t flags);
     int64_t __runtime_net_recv(int64_t sockfd, void* buffer, int64_t size, int64_t flags);
+    bool __runtime_net_set_timeout(int64_t sockfd, int64_t timeout_ms);
     bool __runtime_net_close(int64_t sockfd);
     bool __runtime_net_shutdown(int64_t sockfd, int64_t how);
     bool __runtime_net_setsockopt(int64_t sockfd, int64_t level, int64_t optname, const void* optval, int64_t optlen);
@@ -102,8 +108,18 @@ extern "C" {
     
     // HTTP syscalls (basic)
     void* __runtime_http_request(const char* method, const char* url, void* headers, const void* body, int64_t body_size);
+    void* __runtime_http_request_buffer(const char* method, const char* url, void* headers, const void* body, int64_t body_size);
     void* __runtime_http_create_server(void* handler);
     bool __runtime_http_server_listen(void* server, int64_t port, const char* host);
+    void __runtime_http_server_close(void* server);
+    void* __runtime_http_req_method(void* request);
+    void* __runtime_http_req_url(void* request);
+    void* __runtime_http_req_header(void* request, const char* name);
+    void* __runtime_http_req_body(void* request);
+    void __runtime_http_res_status(void* response, int64_t status);
+    void __runtime_http_res_header(void* response, const char* name, const char* value);
+    void __runtime_http_res_end(void* response, const void* body, int64_t body_size);
+    bool __runtime_http_res_send_file(void* response, const char* path);
     
     // Crypto syscalls
     void* __runtime_crypto_random_bytes(int64_t size);
@@ -271,6 +287,12 @@ extern "C" {
     void __runtime_gc_collect();
     int64_t __runtime_gc_heap_size();
     int64_t __runtime_gc_heap_used();
+    void* __runtime_gc_stats();
+    int64_t __runtime_gc_next_gc();
+    int64_t __runtime_gc_set_memory_limit(int64_t bytes);
+    int64_t __runtime_gc_write_heap_snapshot(const char* path);
+    int64_t __runtime_gc_set_heap_profile_rate(int64_t bytes);
+    int64_t __runtime_gc_write_heap_profile(const char* path);
     
     // Error syscalls
     void* __runtime_error_create(const char* message);
@@ -366,14 +388,53 @@ extern "C" {
     double __runtime_math_random();
     void __runtime_math_random_seed(int64_t seed);
     
+    // Weak references - WeakRef, WeakMap and FinalizationRegistry
+    void* __runtime_weak_ref(void* target);
+    void* __runtime_weak_deref(void* ref);
+    void* __runtime_weak_map();
+    void* __runtime_weak_get(void* map, void* key);
+    void __runtime_weak_set(void* map, void* key, void* value);
+    bool __runtime_weak_has(void* map, void* key);
+    bool __runtime_weak_remove(void* map, void* key);
+    int64_t __runtime_weak_size(void* map);
+    void* __runtime_weak_registry(void* callback);
+    void __runtime_weak_register(void* registry, void* target, void* held, void* token);
+    bool __runtime_weak_unregister(void* registry, void* token);
+    
     // Lock syscalls - thread-safe locking primitives
     void* __runtime_lock_create();
+    void* __runtime_lock_create_at(const char* site);
     void __runtime_lock_lock(void* lock_ptr);
     void __runtime_lock_unlock(void* lock_ptr);
+    void __runtime_lock_unlock_contended(void* lock_ptr);
     bool __runtime_lock_try_lock(void* lock_ptr);
     bool __runtime_lock_try_lock_for(void* lock_ptr, int64_t timeout_ms);
     bool __runtime_lock_is_locked_by_current(void* lock_ptr);
     
+    // Atomic<T> cells, operated on inline by the JIT
+    void* __runtime_atomic_create(int64_t initial_bits, int64_t padded);
+    
+    // WaitGroup / Semaphore / RWLock / Barrier - see lock_system.h
+    void* __runtime_waitgroup_create();
+    void __runtime_waitgroup_add(void* wg_ptr, int64_t delta);
+    void __runtime_waitgroup_settle(void* wg_ptr);
+    void __runtime_waitgroup_wait(void* wg_ptr);
+    void* __runtime_semaphore_create(int64_t permits);
+    void __runtime_semaphore_acquire(void* sem_ptr);
+    bool __runtime_semaphore_try_acquire(void* sem_ptr);
+    bool __runtime_semaphore_try_acquire_for(void* sem_ptr, int64_t timeout_ms);
+    void __runtime_semaphore_release(void* sem_ptr);
+    void __runtime_semaphore_wake(void* sem_ptr);
+    void* __runtime_rwlock_create();
+    void __runtime_rwlock_read_lock(void* rw_ptr);
+    void __runtime_rwlock_read_unlock(void* rw_ptr);
+    bool __runtime_rwlock_try_read_lock(void* rw_ptr);
+    void __runtime_rwlock_write_lock(void* rw_ptr);
+    void __runtime_rwlock_write_unlock(void* rw_ptr);
+    bool __runtime_rwlock_try_write_lock(void* rw_ptr);
+    void* __runtime_barrier_create(int64_t parties);
+    bool __runtime_barrier_wait(void* barrier_ptr);
+    
     // Internal debugging
     void* __runtime_heap_snapshot();
     void* __runtime_cpu_profile(int64_t duration_ms);
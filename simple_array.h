@@ -88,6 +88,10 @@ public:
         return shape_.size() == 1;
     }
     
+    const double* data() const {
+        return data_.data();
+    }
+    
     // 1D Array operations (only work for 1D arrays)
     void push(double value) {
         if (!is_1d()) {
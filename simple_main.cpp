@@ -1,5 +1,8 @@
 #include "compiler.h"
 #include "runtime.h"
+#include "gc_memory_manager.h"
+#include "heap_profile.h"
+#include "heap_snapshot.h"
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -20,6 +23,7 @@ extern "C" void __runtime_cleanup();
 
 std::atomic<bool> should_restart(false);
 std::atomic<bool> watch_mode(false);
+std::string heap_profile_path;     // --heap-profile=<path>, written when the program ends
 
 void signal_handler(int signal) {
     if (signal == SIGINT) {
@@ -190,6 +194,13 @@ void run_program(const std::string& filename) {
         std::cout << "DEBUG: Main execution completed, waiting for active work..." << std::endl;
         __runtime_cleanup();
         
+        if (!heap_profile_path.empty()) {
+            HeapProfile profile;
+            if (GarbageCollector::instance().get_heap_profile(profile) && profile.write_pprof(heap_profile_path)) {
+                std::cout << "Heap profile written to " << heap_profile_path << std::endl;
+            }
+        }
+        
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         throw;
@@ -197,6 +208,11 @@ void run_program(const std::string& filename) {
 }
 
 int main(int argc, char* argv[]) {
+    // Offline tools run before anything else starts
+    if (argc > 1 && std::string(argv[1]) == "heapstat") {
+        return heapstat_main(argc - 2, argv + 2);
+    }
+
     // Simplified timer system - no complex initialization needed
     std::cout << "DEBUG: Starting GoTS with simplified timer system" << std::endl;
     
@@ -208,6 +224,9 @@ int main(int argc, char* argv[]) {
         std::string arg = argv[i];
         if (arg == "-w" || arg == "--watch") {
             watch_flag = true;
+        } else if (arg.rfind("--heap-profile=", 0) == 0) {
+            heap_profile_path = arg.substr(15);
+            GarbageCollector::instance().set_heap_profile_rate(GCConfig::HEAP_PROFILE_RATE);
         } else if (arg.find("-") != 0) {
             // This is the filename (not a flag)
             filename = arg;
@@ -217,6 +236,9 @@ int main(int argc, char* argv[]) {
     if (filename.empty()) {
         std::cerr << "Usage: " << argv[0] << " [-w|--watch] <file.gts>" << std::endl;
         std::cerr << "  -w, --watch    Watch for file changes and restart automatically" << std::endl;
+        std::cerr << "  --heap-profile=<path>  Sample allocations and write a pprof heap profile on exit" << std::endl;
+        std::cerr << "       " << argv[0] << " heapstat <snapshot> [--top N]" << std::endl;
+        std::cerr << "  Retained sizes from runtime.gc.writeHeapSnapshot(path)" << std::endl;
         return 1;
     }
     
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+
+namespace gots {
+
+// ============================================================================
+// SLAB ALLOCATOR - per-thread free lists for fixed-size runtime objects
+// ============================================================================
+//
+// Promises, timer nodes and the other small control objects the runtime
+// creates on every spawn, await and timeout are carved out of 64KB slabs
+// mapped straight from the kernel. Each thread keeps a free list of blocks
+// and only touches the shared depot, under a mutex, to refill or drain it in
+// batches - so the steady state allocates and frees without malloc or locks.
+//
+// A block may be freed on any thread; it joins that thread's list. Slabs are
+// never unmapped, the pool stays at its high-water mark. A thread's blocks
+// go back to the depot when it exits.
+
+template <typename T>
+class SlabAllocator {
+public:
+    static void* allocate() {
+        Cache& cache = cache_;
+        if (!cache.head) refill(cache);
+        FreeBlock* block = cache.head;
+        cache.head = block->next;
+        cache.count--;
+        return block;
+    }
+
+    static void deallocate(void* ptr) {
+        if (!ptr) return;
+        Cache& cache = cache_;
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        if (cache.exited) {
+            // Freed by a thread_local destructor after the cache was flushed
+            std::lock_guard<std::mutex> lock(depot_mutex_);
+            block->next = depot_;
+            depot_ = block;
+            depot_count_++;
+            return;
+        }
+        if (!cache.head) register_flusher();
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= 2 * BATCH) drain(cache, BATCH);
+    }
+
+    template <typename... Args>
+    static T* create(Args&&... args) {
+        return new (allocate()) T(std::forward<Args>(args)...);
+    }
+
+    static void destroy(T* object) {
+        if (!object) return;
+        object->~T();
+        deallocate(object);
+    }
+
+    // Slabs mapped so far, for tests and telemetry
+    static size_t slab_count() { return slabs_.load(std::memory_order_relaxed); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t ALIGN = alignof(T) > alignof(FreeBlock) ? alignof(T) : alignof(FreeBlock);
+    static constexpr size_t BLOCK_SIZE =
+        ((sizeof(T) > sizeof(FreeBlock) ? sizeof(T) : sizeof(FreeBlock)) + ALIGN - 1) / ALIGN * ALIGN;
+    static constexpr size_t SLAB_BYTES = 64 * 1024;
+    static constexpr size_t BATCH = 32;  // Blocks moved to or from the depot at once
+
+    static_assert(BLOCK_SIZE <= SLAB_BYTES / BATCH, "SlabAllocator is for small objects");
+
+    // Trivially destructible, so it stays usable while the thread exits
+    struct Cache {
+        FreeBlock* head;
+        size_t count;
+        bool exited;
+    };
+
+    // Returns the thread's blocks to the depot when it exits
+    struct Flusher {
+        ~Flusher() {
+            Cache& cache = cache_;
+            drain(cache, cache.count);
+            cache.exited = true;
+        }
+    };
+
+    static void register_flusher() {
+        static thread_local Flusher flusher;
+        (void)flusher;
+    }
+
+    static void refill(Cache& cache) {
+        if (!cache.exited) register_flusher();
+        {
+            std::lock_guard<std::mutex> lock(depot_mutex_);
+            while (depot_ && cache.count < BATCH) {
+                FreeBlock* block = depot_;
+                depot_ = block->next;
+                depot_count_--;
+                block->next = cache.head;
+                cache.head = block;
+                cache.count++;
+            }
+        }
+        if (cache.head) return;
+
+        void* slab = mmap(nullptr, SLAB_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED) {
+            std::cerr << "ERROR: Cannot map a slab for runtime objects" << std::endl;
+            throw std::bad_alloc();
+        }
+        slabs_.fetch_add(1, std::memory_order_relaxed);
+        // The thread keeps the whole slab - the next refill comes from it
+        uint8_t* bytes = static_cast<uint8_t*>(slab);
+        for (size_t offset = (SLAB_BYTES / BLOCK_SIZE - 1) * BLOCK_SIZE;; offset -= BLOCK_SIZE) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(bytes + offset);
+            block->next = cache.head;
+            cache.head = block;
+            cache.count++;
+            if (offset == 0) break;
+        }
+    }
+
+    static void drain(Cache& cache, size_t blocks) {
+        if (!blocks) return;
+        FreeBlock* first = cache.head;
+        FreeBlock* last = first;
+        for (size_t i = 1; i < blocks; ++i) last = last->next;
+        cache.head = last->next;
+        cache.count -= blocks;
+
+        std::lock_guard<std::mutex> lock(depot_mutex_);
+        last->next = depot_;
+        depot_ = first;
+        depot_count_ += blocks;
+    }
+
+    static inline thread_local Cache cache_ = {nullptr, 0, false};
+    static inline std::mutex depot_mutex_;
+    static inline FreeBlock* depot_ = nullptr;
+    static inline size_t depot_count_ = 0;
+    static inline std::atomic<size_t> slabs_{0};
+};
+
+// Standard allocator over the slabs, for the nodes of node-based containers.
+// Arrays - a hash table's buckets - still come from operator new
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n == 1) return static_cast<T*>(SlabAllocator<T>::allocate());
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+        if (n == 1) {
+            SlabAllocator<T>::deallocate(ptr);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+struct SlabDeleter {
+    void operator()(T* object) const { SlabAllocator<T>::destroy(object); }
+};
+
+// ============================================================================
+// INTRUSIVE REFERENCE COUNTING
+// ============================================================================
+//
+// The count lives in the object instead of a separate shared_ptr control
+// block. Objects start with one reference, owned by the Ref that
+// make_ref returns, and go back to their slab when the last one is dropped.
+
+template <typename T>
+class RefCounted {
+public:
+    void retain() const { refs_.fetch_add(1, std::memory_order_relaxed); }
+    void release() const {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            SlabAllocator<T>::destroy(const_cast<T*>(static_cast<const T*>(this)));
+        }
+    }
+    uint32_t ref_count() const { return refs_.load(std::memory_order_relaxed); }
+
+protected:
+    RefCounted() = default;
+    RefCounted(const RefCounted&) = delete;
+    RefCounted& operator=(const RefCounted&) = delete;
+
+private:
+    mutable std::atomic<uint32_t> refs_{1};
+};
+
+template <typename T>
+class Ref {
+public:
+    Ref() = default;
+    Ref(std::nullptr_t) {}
+    Ref(const Ref& other) : ptr_(other.ptr_) { if (ptr_) ptr_->retain(); }
+    Ref(Ref&& other) noexcept : ptr_(other.ptr_) { other.ptr_ = nullptr; }
+    ~Ref() { if (ptr_) ptr_->release(); }
+
+    Ref& operator=(Ref other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        return *this;
+    }
+
+    // Takes over a reference the caller already holds
+    static Ref adopt(T* ptr) {
+        Ref ref;
+        ref.ptr_ = ptr;
+        return ref;
+    }
+    // Gives up the reference without dropping it
+    T* detach() {
+        T* ptr = ptr_;
+        ptr_ = nullptr;
+        return ptr;
+    }
+
+    T* get() const { return ptr_; }
+    T* operator->() const { return ptr_; }
+    T& operator*() const { return *ptr_; }
+    explicit operator bool() const { return ptr_ != nullptr; }
+    bool operator==(const Ref& other) const { return ptr_ == other.ptr_; }
+    bool operator!=(const Ref& other) const { return ptr_ != other.ptr_; }
+
+private:
+    T* ptr_ = nullptr;
+};
+
+template <typename T, typename... Args>
+Ref<T> make_ref(Args&&... args) {
+    return Ref<T>::adopt(SlabAllocator<T>::create(std::forward<Args>(args)...));
+}
+
+} // namespace gots
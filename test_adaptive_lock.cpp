@@ -0,0 +1,149 @@
+#include "lock_system.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gots;
+
+// Stress, fairness and latency test for the spin-then-futex Lock
+// Build: make && g++ -std=c++17 -O2 -pthread test_adaptive_lock.cpp $(ls *.o | grep -v simple_main.o) -o test_adaptive_lock
+
+template <typename M>
+static double uncontended_ns(M& m, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        m.lock();
+        m.unlock();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main() {
+    std::cout << "=== Testing adaptive Lock ===" << std::endl;
+    int failures = 0;
+
+    // Test 1: Mutual exclusion under heavy contention
+    std::cout << "\nTest 1: Mutual exclusion..." << std::endl;
+    {
+        Lock lock;
+        const int threads = 8;
+        const int iterations = 200000;
+        int64_t counter = 0;
+        std::atomic<int> inside{0};
+        std::atomic<bool> overlap{false};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < iterations; ++i) {
+                    lock.lock();
+                    if (inside.fetch_add(1) != 0) overlap = true;
+                    counter++;
+                    inside.fetch_sub(1);
+                    lock.unlock();
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << threads * iterations << " contended acquisitions in " << ms << " ms" << std::endl;
+        check(counter == int64_t(threads) * iterations && !overlap, "No lost updates, never two owners", failures);
+    }
+
+    // Test 2: Recursion and ownership
+    std::cout << "\nTest 2: Recursion..." << std::endl;
+    {
+        Lock lock;
+        lock.lock();
+        lock.lock();
+        check(lock.try_lock(), "Owner re-acquires with try_lock", failures);
+        lock.unlock();
+        lock.unlock();
+        bool other_blocked = false;
+        std::thread([&]() { other_blocked = !lock.try_lock(); }).join();
+        check(other_blocked && lock.is_locked_by_current(), "Still held after inner unlocks", failures);
+        lock.unlock();
+        bool other_got = false;
+        std::thread([&]() { other_got = lock.try_lock(); if (other_got) lock.unlock(); }).join();
+        check(other_got && !lock.is_locked_by_current(), "Released after matching unlocks", failures);
+
+        bool threw = false;
+        try { lock.unlock(); } catch (const std::runtime_error&) { threw = true; }
+        check(threw, "Unlock by non-owner throws", failures);
+    }
+
+    // Test 3: try_lock_for times out, then succeeds once released
+    std::cout << "\nTest 3: Timed acquisition..." << std::endl;
+    {
+        Lock lock;
+        std::atomic<bool> held{false};
+        std::atomic<bool> release{false};
+        std::thread owner([&]() {
+            lock.lock();
+            held = true;
+            while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            lock.unlock();
+        });
+        while (!held) std::this_thread::yield();
+
+        auto start = std::chrono::steady_clock::now();
+        bool got = lock.try_lock_for(std::chrono::milliseconds(50));
+        double waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        check(!got && waited >= 45, "Timed out after ~50ms", failures);
+
+        std::thread([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            release = true;
+        }).detach();
+        got = lock.try_lock_for(std::chrono::milliseconds(2000));
+        check(got, "Acquired when the owner released", failures);
+        if (got) lock.unlock();
+        owner.join();
+    }
+
+    // Test 4: A parked waiter is not starved by a thread that relocks at once
+    std::cout << "\nTest 4: Starvation..." << std::endl;
+    {
+        Lock lock;
+        std::atomic<bool> stop{false};
+        std::atomic<bool> started{false};
+        std::thread greedy([&]() {
+            while (!stop) {
+                lock.lock();
+                started = true;
+                auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(50);
+                while (std::chrono::steady_clock::now() < until) {}
+                lock.unlock();
+            }
+        });
+        while (!started) std::this_thread::yield();
+
+        auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        double waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        lock.unlock();
+        stop = true;
+        greedy.join();
+        std::cout << "  waiter acquired after " << waited << " ms" << std::endl;
+        check(waited < 100, "Waiter gets the lock within 100ms", failures);
+    }
+
+    // Test 5: Uncontended cost
+    std::cout << "\nTest 5: Uncontended latency..." << std::endl;
+    {
+        Lock lock;
+        std::mutex mutex;
+        double lock_ns = uncontended_ns(lock, 2000000);
+        double mutex_ns = uncontended_ns(mutex, 2000000);
+        std::cout << "  Lock: " << lock_ns << " ns, std::mutex: " << mutex_ns << " ns per lock/unlock" << std::endl;
+        check(lock_ns < 1000, "Uncontended lock/unlock is cheap", failures);
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All adaptive lock tests passed" : "Adaptive lock tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
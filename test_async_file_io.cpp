@@ -0,0 +1,219 @@
+#include "async_file_io.h"
+#include "runtime_syscalls.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace gots;
+
+// Standalone test for io_uring-backed async file I/O (run with GOTS_IO_URING=0
+// to exercise the thread pool fallback)
+// Build: make && g++ -std=c++17 -O2 -pthread test_async_file_io.cpp $(ls *.o | grep -v simple_main.o) -o test_async_file_io
+
+int main() {
+    std::cout << "=== Testing AsyncFileIO ===" << std::endl;
+    int failures = 0;
+    AsyncFileIO& io = AsyncFileIO::instance();
+    std::cout << "Backend: " << (io.using_io_uring() ? "io_uring" : "thread pool") << std::endl;
+
+    char path[] = "/tmp/gots_async_io_XXXXXX";
+    int tmp = mkstemp(path);
+    close(tmp);
+
+    // Test 1: open/write/close then open/read/close round trip
+    std::cout << "\nTest 1: Write then read back..." << std::endl;
+    {
+        const char message[] = "hello from io_uring";
+        int64_t fd = AsyncFileIO::await_result(io.open(path, O_WRONLY | O_TRUNC, 0644));
+        int64_t written = AsyncFileIO::await_result(io.write(static_cast<int>(fd), message, strlen(message)));
+        int64_t closed = AsyncFileIO::await_result(io.close(static_cast<int>(fd)));
+
+        char buf[64] = {0};
+        fd = AsyncFileIO::await_result(io.open(path, O_RDONLY, 0));
+        int64_t n = AsyncFileIO::await_result(io.read(static_cast<int>(fd), buf, sizeof(buf)));
+        AsyncFileIO::await_result(io.close(static_cast<int>(fd)));
+
+        if (written == static_cast<int64_t>(strlen(message)) && closed == 0 &&
+            n == written && strcmp(buf, message) == 0) {
+            std::cout << "✓ Read back \"" << buf << "\"" << std::endl;
+        } else {
+            std::cout << "✗ written=" << written << " closed=" << closed << " read=" << n << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 2: Sequential reads advance the file position; a hot fd gets
+    // promoted to a fixed file partway through without changing results
+    std::cout << "\nTest 2: Sequential reads on a hot descriptor..." << std::endl;
+    {
+        int fd = open(path, O_WRONLY | O_TRUNC);
+        std::string expected;
+        for (int i = 0; i < 64; ++i) expected += static_cast<char>('a' + i % 26);
+        ssize_t w = write(fd, expected.data(), expected.size());
+        (void)w;
+        close(fd);
+
+        fd = static_cast<int>(AsyncFileIO::await_result(io.open(path, O_RDONLY, 0)));
+        std::string got;
+        char c;
+        while (AsyncFileIO::await_result(io.read(fd, &c, 1)) == 1) got += c;
+        AsyncFileIO::await_result(io.close(fd));
+
+        if (got == expected) {
+            std::cout << "✓ " << got.size() << " single-byte reads in order" << std::endl;
+        } else {
+            std::cout << "✗ Got \"" << got << "\"" << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 3: Large read bypasses the registered buffers
+    std::cout << "\nTest 3: Large read..." << std::endl;
+    {
+        std::vector<char> data(AsyncFileIO::REGISTERED_BUFFER_SIZE * 4);
+        for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>(i * 7);
+        int fd = open(path, O_WRONLY | O_TRUNC);
+        ssize_t w = write(fd, data.data(), data.size());
+        (void)w;
+        close(fd);
+
+        std::vector<char> back(data.size());
+        fd = static_cast<int>(AsyncFileIO::await_result(io.open(path, O_RDONLY, 0)));
+        int64_t n = AsyncFileIO::await_result(io.read(fd, back.data(), back.size()));
+        AsyncFileIO::await_result(io.close(fd));
+
+        if (n == static_cast<int64_t>(data.size()) && back == data) {
+            std::cout << "✓ Read " << n << " bytes" << std::endl;
+        } else {
+            std::cout << "✗ Read " << n << " bytes" << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 4: Many goroutines submitting concurrently, more ops than ring entries
+    std::cout << "\nTest 4: Concurrent submissions..." << std::endl;
+    {
+        constexpr int THREADS = 8;
+        constexpr int OPS_PER_THREAD = 200;
+        std::atomic<int> ok{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&] {
+                int fd = static_cast<int>(AsyncFileIO::await_result(io.open(path, O_RDONLY, 0)));
+                std::vector<PromiseRef> pending;
+                char bufs[OPS_PER_THREAD][16];
+                for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                    pending.push_back(io.read(fd, bufs[i], sizeof(bufs[i])));
+                }
+                for (auto& p : pending) {
+                    if (AsyncFileIO::await_result(p) >= 0) ok++;
+                }
+                AsyncFileIO::await_result(io.close(fd));
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        if (ok == THREADS * OPS_PER_THREAD) {
+            std::cout << "✓ " << ok << " reads completed" << std::endl;
+        } else {
+            std::cout << "✗ " << ok << " of " << THREADS * OPS_PER_THREAD << " reads completed" << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 5: Errors resolve to -1
+    std::cout << "\nTest 5: Error results..." << std::endl;
+    {
+        int64_t fd = AsyncFileIO::await_result(io.open("/nonexistent/gots/file", O_RDONLY, 0));
+        char buf[4];
+        int64_t n = AsyncFileIO::await_result(io.read(-1, buf, sizeof(buf)));
+        if (fd == -1 && n == -1) {
+            std::cout << "✓ Failed ops resolve to -1" << std::endl;
+        } else {
+            std::cout << "✗ open=" << fd << " read=" << n << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 6: A hot fd closed synchronously gives up its fixed slot, so the
+    // next file to get that fd number is the one read
+    std::cout << "\nTest 6: Sync close releases the fixed slot..." << std::endl;
+    {
+        char other[] = "/tmp/gots_async_io_XXXXXX";
+        int tmp_other = mkstemp(other);
+        ssize_t w = write(tmp_other, "B", 1);
+        (void)w;
+        close(tmp_other);
+        int fd = open(path, O_WRONLY | O_TRUNC);
+        w = write(fd, "AAAAAAAAAAAAAAAA", 16);
+        close(fd);
+
+        fd = open(path, O_RDONLY);
+        char c = 0;
+        for (uint32_t i = 0; i < AsyncFileIO::HOT_FD_THRESHOLD + 2; ++i) {
+            AsyncFileIO::await_result(io.read(fd, &c, 1));
+        }
+        __runtime_fs_close(fd);
+
+        int reused = open(other, O_RDONLY);
+        c = 0;
+        int64_t n = AsyncFileIO::await_result(io.read(reused, &c, 1));
+        __runtime_fs_close(reused);
+        unlink(other);
+
+        if (reused == fd && n == 1 && c == 'B') {
+            std::cout << "✓ Reused fd " << reused << " reads the new file" << std::endl;
+        } else {
+            std::cout << "✗ fd " << fd << " -> " << reused << ", read " << n << " '" << c << "'" << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 7: Closing a hot fd with a read still pending keeps its slot until
+    // that read completes, so the pending read and the fd's next owner each
+    // see their own file. The thread pool has no slots and runs the read
+    // whenever a worker is free, so this only applies to io_uring.
+    std::cout << "\nTest 7: Pending ops keep a released fixed slot..." << std::endl;
+    if (!io.using_io_uring()) {
+        std::cout << "- Skipped on the thread pool backend" << std::endl;
+    } else {
+        char other[] = "/tmp/gots_async_io_XXXXXX";
+        int tmp_other = mkstemp(other);
+        ssize_t w = write(tmp_other, "B", 1);
+        (void)w;
+        close(tmp_other);
+
+        int fd = open(path, O_RDONLY);
+        char c = 0;
+        for (uint32_t i = 0; i < AsyncFileIO::HOT_FD_THRESHOLD + 2; ++i) {
+            lseek(fd, 0, SEEK_SET);
+            AsyncFileIO::await_result(io.read(fd, &c, 1));
+        }
+        lseek(fd, 0, SEEK_SET);
+        char pending_c = 0;
+        PromiseRef pending = io.read(fd, &pending_c, 1);
+        __runtime_fs_close(fd);
+
+        int reused = open(other, O_RDONLY);
+        char reused_c = 0;
+        int64_t reused_n = AsyncFileIO::await_result(io.read(reused, &reused_c, 1));
+        int64_t pending_n = AsyncFileIO::await_result(pending);
+        __runtime_fs_close(reused);
+        unlink(other);
+
+        if (pending_n == 1 && pending_c == 'A' && reused_n == 1 && reused_c == 'B') {
+            std::cout << "✓ Pending read saw the old file, fd " << reused << " the new one" << std::endl;
+        } else {
+            std::cout << "✗ pending " << pending_n << " '" << pending_c << "', reused "
+                      << reused_n << " '" << reused_c << "'" << std::endl;
+            failures++;
+        }
+    }
+
+    unlink(path);
+    std::cout << "\n" << (failures == 0 ? "All async file I/O tests passed" : "Async file I/O tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Shared by the standalone test_*.cpp programs: reports one expectation and
+// counts it when it fails
+inline bool check(bool ok, const std::string& what, int& failures) {
+    std::cout << (ok ? "✓ " : "✗ ") << what << std::endl;
+    if (!ok) failures++;
+    return ok;
+}
@@ -0,0 +1,974 @@
+#include "compiler.h"
+#include "escape_analysis.h"
+#include "gc_memory_manager.h"
+#include "heap_profile.h"
+#include "heap_snapshot.h"
+#include "runtime.h"
+#include "runtime_syscalls.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace gots;
+
+// Tests for runtime allocation on the generational heap
+// Build: make && g++ -std=c++17 -O2 -pthread test_gc_integration.cpp $(ls *.o | grep -v simple_main.o) -o test_gc_integration
+
+static std::atomic<int> g_finalized{0};
+
+// Allocates garbage until at least `collections` young GCs have run
+static void churn(size_t collections) {
+    GarbageCollector& gc = GarbageCollector::instance();
+    size_t target = gc.get_stats().young_collections + collections;
+    while (gc.get_stats().young_collections < target) {
+        __string_create("garbage garbage garbage garbage garbage garbage");
+    }
+}
+
+static void* install_code(const X86CodeGen& gen) {
+    std::vector<uint8_t> code = gen.get_code();
+    void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memcpy(mem, code.data(), code.size());
+    for (const auto& range : gen.get_gc_restart_ranges()) {
+        GarbageCollector::instance().register_restartable_range(
+            static_cast<uint8_t*>(mem) + range.first, static_cast<uint8_t*>(mem) + range.second);
+    }
+    return mem;
+}
+
+// void* alloc() { return inline TYPE_OBJECT with 3 properties; }
+static void* build_object_allocator() {
+    X86CodeGen gen;
+    gen.emit_byte(0x48); gen.emit_byte(0x83); gen.emit_byte(0xEC); gen.emit_byte(0x08);  // sub rsp, 8
+    gen.emit_object_create("Point", 3);
+    gen.emit_byte(0x48); gen.emit_byte(0x83); gen.emit_byte(0xC4); gen.emit_byte(0x08);  // add rsp, 8
+    gen.emit_byte(0xC3);
+    return install_code(gen);
+}
+
+// build_object_allocator, with its code registered under a function name
+static void* build_profiled_allocator(const char* name) {
+    X86CodeGen gen;
+    gen.emit_byte(0x48); gen.emit_byte(0x83); gen.emit_byte(0xEC); gen.emit_byte(0x08);  // sub rsp, 8
+    gen.emit_object_create("Point", 3);
+    gen.emit_byte(0x48); gen.emit_byte(0x83); gen.emit_byte(0xC4); gen.emit_byte(0x08);  // add rsp, 8
+    gen.emit_byte(0xC3);
+    void* mem = install_code(gen);
+    GarbageCollector::instance().register_code_symbols(mem, gen.get_code().size(), {{0, name}});
+    return mem;
+}
+
+// void store(void* object, void* value) { object.values[1] = value; }
+static void* build_property_store() {
+    X86CodeGen gen;
+    gen.emit_byte(0x48); gen.emit_byte(0x83); gen.emit_byte(0xEC); gen.emit_byte(0x08);  // sub rsp, 8
+    gen.emit_mov_reg_reg(2, 6);  // RDX = value
+    gen.emit_mov_reg_imm(6, 1);  // RSI = property_index
+    gen.emit_object_set_property(1, true);
+    gen.emit_byte(0x48); gen.emit_byte(0x83); gen.emit_byte(0xC4); gen.emit_byte(0x08);  // add rsp, 8
+    gen.emit_byte(0xC3);
+    return install_code(gen);
+}
+
+// Only a masked copy, so no stack word keeps the original address alive
+static uintptr_t g_precise_original = 0;
+static constexpr uintptr_t ADDRESS_MASK = 0x5a5a5a5a5a5a5a5aULL;
+
+// Called from JIT code. Like the -O0 runtime it keeps a frame pointer, which
+// is how the collector finds the JIT frame that called it
+static volatile void* g_helper_frame = nullptr;
+__attribute__((noinline))
+static void collect_from_jit(void* original) {
+    g_precise_original = reinterpret_cast<uintptr_t>(original) ^ ADDRESS_MASK;
+    // Allocate directly, so each runtime frame links straight back to this one
+    GarbageCollector& gc = GarbageCollector::instance();
+    size_t target = gc.get_stats().young_collections + 2;
+    while (gc.get_stats().young_collections < target) {
+        __string_create("garbage garbage garbage garbage garbage garbage");
+    }
+    g_helper_frame = __builtin_frame_address(0);  // Forces an RBP frame around the calls
+}
+
+// void* run() { String s = "precise"; collect_from_jit(s); return s; }
+static void* build_precise_frame() {
+    X86CodeGen gen;
+    TypeInference types;
+    gen.set_function_stack_size(64);
+    types.reset_for_function();
+    GCFrameScope frame(gen, types);
+    int64_t slot = types.allocate_variable("s", DataType::STRING);
+    gen.emit_prologue();
+    gen.emit_mov_reg_imm(7, reinterpret_cast<int64_t>("precise"));  // RDI
+    gen.emit_mov_reg_imm(0, reinterpret_cast<int64_t>(&__string_create));
+    gen.emit_call_reg(0);
+    gen.emit_mov_mem_reg(slot, 0);
+    gen.emit_mov_reg_reg(7, 0);
+    gen.emit_mov_reg_imm(0, reinterpret_cast<int64_t>(&collect_from_jit));
+    gen.emit_call_reg(0);
+    gen.emit_mov_reg_mem(0, slot);
+    gen.emit_epilogue();
+    std::vector<uint8_t> code = gen.get_code();
+    void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memcpy(mem, code.data(), code.size());
+    GarbageCollector::instance().register_stack_maps(mem, gen.get_gc_stack_maps());
+    return mem;
+}
+
+// Test 11 state - what JIT code saw of its frame object
+static bool g_frame_object_ok = false;
+static void inspect_frame_object(void* object, void* value) {
+    uint8_t* payload = static_cast<uint8_t*>(object);
+    ObjectHeader* header = ObjectHeader::from_object(object);
+    g_frame_object_ok = header->is_stack_allocated() && header->type_id == TYPE_OBJECT &&
+                        !GarbageCollector::instance().get_heap().contains(object) &&
+                        strcmp(*reinterpret_cast<const char**>(payload + GCObjectLayout::CLASS_NAME_OFFSET), "Local") == 0 &&
+                        __object_get_property(reinterpret_cast<int64_t>(object), 0) == 0 &&
+                        __object_get_property(reinterpret_cast<int64_t>(object), 1) == reinterpret_cast<int64_t>(value);
+}
+
+// void run(void* value) { Local o (in the frame); o.values[1] = value; inspect_frame_object(o, value); }
+static void* build_frame_object() {
+    X86CodeGen gen;
+    const int64_t stack_size = 128;
+    gen.set_function_stack_size(stack_size);
+    gen.emit_prologue();
+    gen.emit_mov_mem_reg(-48, 7);  // value
+    gen.emit_object_create_in_frame("Local", 2, -48 - stack_size);
+    gen.emit_mov_mem_reg(-56, 0);  // object
+    gen.emit_mov_reg_reg(7, 0);
+    gen.emit_mov_reg_mem(2, -48);
+    gen.emit_mov_reg_imm(6, 1);
+    gen.emit_object_set_property(1, true);
+    gen.emit_mov_reg_mem(7, -56);
+    gen.emit_mov_reg_mem(6, -48);
+    gen.emit_mov_reg_imm(0, reinterpret_cast<int64_t>(&inspect_frame_object));
+    gen.emit_call_reg(0);
+    gen.emit_epilogue();
+    return install_code(gen);
+}
+
+// let <name> = {a: 1}; followed by `use`
+static std::unique_ptr<ASTNode> literal_declaration(const std::string& name) {
+    auto literal = std::make_unique<ObjectLiteral>();
+    literal->properties.emplace_back("a", std::make_unique<NumberLiteral>(1));
+    return std::make_unique<Assignment>(name, std::move(literal));
+}
+
+static std::unique_ptr<ExpressionNode> field_read(const std::string& name, const std::string& property) {
+    return std::make_unique<ExpressionPropertyAccess>(std::make_unique<Identifier>(name), property);
+}
+
+// Large objects go straight to the old generation
+static constexpr size_t OLD_OBJECT_SIZE = 100 * 1024;
+static constexpr int OLD_OBJECTS = 200;
+static void* g_old_roots[OLD_OBJECTS];
+
+static void fill_old_roots(int from, int step) {
+    for (int i = from; i < OLD_OBJECTS; i += step) {
+        g_old_roots[i] = GenerationalHeap::allocate_large_slow(OLD_OBJECT_SIZE, TYPE_BUFFER, false);
+        *static_cast<int64_t*>(g_old_roots[i]) = i;
+    }
+}
+
+// Test 8 state. Static storage is not scanned, and the helper threads are
+// not registered mutators, so only the heap itself can keep these alive
+static constexpr int CHAIN_LENGTH = 100000;
+static constexpr int64_t SATB_SENTINEL = 0x5a7b;
+static void* g_chain_head = nullptr;    // Global root
+static void* g_black_holder = nullptr;  // Global root, allocated during marking
+static void* g_chain_tail = nullptr;
+static uintptr_t g_moved_masked = 0;
+static uintptr_t g_garbage_masked = 0;
+
+// Test 9 state
+static void* g_card_holder = nullptr;   // Global root
+static uintptr_t g_card_young_masked = 0;
+
+// Test 12 state
+static constexpr int LARGE_BUFFERS = 4;
+static constexpr size_t LARGE_BUFFER_SIZE = 16 * 1024 * 1024;
+static void* g_large_buffers[LARGE_BUFFERS];  // Global roots
+static void* g_large_array = nullptr;         // Global root
+static uintptr_t g_large_young_masked = 0;
+
+// Test 15 state
+static constexpr size_t KEEP_OBJECTS = 1024 * 1024;
+static void* g_keep_array = nullptr;          // Global root
+
+// Test 16 state
+static constexpr int SNAPSHOT_STRINGS = 1000;
+static void* g_snapshot_holder = nullptr;     // Global root
+static uintptr_t g_snapshot_array_masked = 0;
+
+// Test 17 state
+static constexpr size_t PROFILE_OBJECTS = 200000;
+static constexpr size_t PROFILE_KEEP = 50000;
+static void* g_profile_keep = nullptr;        // Global root
+
+// Test 18 state
+static void* g_weak_ref = nullptr;            // Global roots
+static void* g_weak_target = nullptr;
+static void* g_weak_map = nullptr;
+static void* g_weak_key = nullptr;
+static void* g_weak_registry = nullptr;
+static void* g_weak_token = nullptr;
+static uintptr_t g_weak_target_masked = 0;
+static std::atomic<int> g_cleanups{0};
+static std::atomic<int> g_cancelled_cleanups{0};
+static std::atomic<int> g_cleanup_runs{0};
+static void count_cleanup(void* held) {
+    if (strcmp(static_cast<char*>(held), "held value") == 0) g_cleanups++;
+    if (strcmp(static_cast<char*>(held), "cancelled") == 0) g_cancelled_cleanups++;
+}
+
+// Resident set size, from /proc
+static size_t resident_bytes() {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    size_t pages = 0, resident = 0;
+    if (fscanf(statm, "%zu %zu", &pages, &resident) != 2) resident = 0;
+    fclose(statm);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Test 10 state
+static void* g_shared_holder = nullptr;  // Global root
+static void* g_private_holder = nullptr; // Retained by its goroutine
+
+static void* old_object(size_t size, uint32_t type_id) {
+    return GenerationalHeap::allocate_large_slow(size, type_id, false);
+}
+
+int main() {
+    std::cout << "=== Testing GC integration ===" << std::endl;
+    int failures = 0;
+    GarbageCollector& gc = GarbageCollector::instance();
+    GenerationalHeap& heap = gc.get_heap();
+
+    // Test 1: Runtime values come from the heap and garbage is reclaimed
+    std::cout << "\nTest 1: Allocation and reclamation..." << std::endl;
+    {
+        char* str = static_cast<char*>(__string_create("hello"));
+        check(heap.contains(str) && strcmp(str, "hello") == 0, "Strings live on the GC heap", failures);
+        int64_t obj = __object_create("Thing", 2);
+        __object_set_property(obj, 1, 42);
+        __object_set_property_name(obj, 1, "answer");
+        check(__object_get_property(obj, 1) == 42 && strcmp(__object_get_property_name(obj, 1), "answer") == 0,
+              "Object properties round-trip", failures);
+        check(__string_intern("lit") == __string_intern("lit"), "Interned strings are shared", failures);
+
+        churn(3);
+        size_t used = heap.young_used() + heap.old_used();
+        check(used < 8 * 1024 * 1024, "Garbage does not accumulate (" + std::to_string(used) + " bytes live)", failures);
+    }
+
+    // Test 2: Values only referenced from the stack survive and do not move
+    std::cout << "\nTest 2: Conservative stack roots..." << std::endl;
+    {
+        volatile char* kept = static_cast<char*>(__string_create("still here"));
+        int64_t obj = __object_create("Holder", 1);
+        __object_set_property(obj, 0, reinterpret_cast<int64_t>(__string_create("nested")));
+        churn(4);
+        check(strcmp(const_cast<char*>(kept), "still here") == 0, "Stack-referenced string intact", failures);
+        check(strcmp(reinterpret_cast<char*>(__object_get_property(obj, 0)), "nested") == 0,
+              "String referenced from an object intact", failures);
+        check(heap.find_object(const_cast<char*>(kept)) != nullptr, "Object still allocated", failures);
+    }
+
+    // Test 3: Threads allocating concurrently are stopped for each collection
+    std::cout << "\nTest 3: Multithreaded stop-the-world..." << std::endl;
+    {
+        const int threads = 4;
+        std::atomic<int> corrupted{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                std::string expected = "worker " + std::to_string(t);
+                for (int i = 0; i < 20000; ++i) {
+                    char* mine = static_cast<char*>(__string_create(expected.c_str()));
+                    __array_create(32);
+                    if (strcmp(mine, expected.c_str()) != 0) corrupted++;
+                }
+            });
+        }
+        size_t before = gc.get_stats().young_collections;
+        for (auto& w : workers) w.join();
+        check(gc.get_stats().young_collections > before, "Collections ran while threads allocated", failures);
+        check(corrupted.load() == 0, "No live string was clobbered", failures);
+    }
+
+    // Test 4: JIT inline allocation
+    std::cout << "\nTest 4: Inline JIT allocation..." << std::endl;
+    {
+        auto alloc = reinterpret_cast<void* (*)()>(build_object_allocator());
+        std::atomic<bool> all_valid{true};
+        size_t before = gc.get_stats().young_collections;
+        // Several threads, so some get stopped part-way through the sequence
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 3; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < 200000; ++i) {
+                    uint8_t* obj = static_cast<uint8_t*>(alloc());
+                    ObjectHeader* header = ObjectHeader::from_object(obj);
+                    if (!heap.contains(obj) || header->type_id != TYPE_OBJECT ||
+                        header->size != GCObjectLayout::payload_size(3) ||
+                        *reinterpret_cast<int64_t*>(obj + GCObjectLayout::COUNT_OFFSET) != 3 ||
+                        __object_get_property(reinterpret_cast<int64_t>(obj), 2) != 0) {
+                        all_valid = false;
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        check(all_valid.load(), "Inline objects have the runtime layout", failures);
+        check(gc.get_stats().young_collections > before, "Inline path refills through the collector", failures);
+    }
+
+    // Test 5: Finalizers run for unreachable objects
+    std::cout << "\nTest 5: Finalizers..." << std::endl;
+    {
+        TypeInfo info;
+        info.name = "Finalized";
+        info.finalizer = [](void*) { g_finalized++; };
+        uint32_t type = gc.get_type_registry().register_type(info);
+        for (int i = 0; i < 100; ++i) {
+            void* obj = GenerationalHeap::allocate_fast(64, type);
+            ObjectHeader::from_object(obj)->flags |= ObjectHeader::HAS_FINALIZER;
+        }
+        churn(2);
+        gc.request_gc(true);
+        check(g_finalized.load() >= 90, "Finalizers ran (" + std::to_string(g_finalized.load()) + " of 100)", failures);
+    }
+
+    // Test 6: Typed reference variables in JIT frames are exact roots
+    std::cout << "\nTest 6: Precise JIT frame slots..." << std::endl;
+    {
+        auto run = reinterpret_cast<void* (*)()>(build_precise_frame());
+        bool moved = true;
+        bool intact = true;
+        for (int i = 0; i < 5; ++i) {
+            char* result = static_cast<char*>(run());
+            moved = moved && reinterpret_cast<uintptr_t>(result) != (g_precise_original ^ ADDRESS_MASK);
+            intact = intact && strcmp(result, "precise") == 0;
+        }
+        check(intact, "Object held only by a frame slot survives", failures);
+        check(moved, "Frame slot was updated when the object moved", failures);
+    }
+
+    // Test 7: Old generation sweeping, free-list reuse and compaction
+    std::cout << "\nTest 7: Old generation free lists and compaction..." << std::endl;
+    {
+        for (int i = 0; i < OLD_OBJECTS; ++i) gc.add_global_root(&g_old_roots[i]);
+        fill_old_roots(0, 1);
+
+        // Every other object dies - the gaps can only be reused, not trimmed
+        for (int i = 1; i < OLD_OBJECTS; i += 2) g_old_roots[i] = nullptr;
+        gc.request_gc(true);
+        gc.decommit_old_generation_tail();
+        size_t freed = heap.old_free_bytes();
+        check(freed >= (OLD_OBJECTS / 2 - 1) * OLD_OBJECT_SIZE,
+              "Sweeping put dead objects on the free lists (" + std::to_string(freed) + " bytes)", failures);
+
+        fill_old_roots(1, 2);
+        check(heap.old_free_bytes() < freed / 4, "Free blocks were reused by new objects", failures);
+
+        for (int i = 1; i < OLD_OBJECTS; i += 2) g_old_roots[i] = nullptr;
+        size_t compactions = gc.get_stats().old_compactions;
+        size_t extent = heap.heap_size();    // Dead objects still in place
+        gc.request_compaction();
+        gc.request_gc(true);
+        bool intact = true;
+        for (int i = 0; i < OLD_OBJECTS; i += 2) {
+            intact = intact && *static_cast<int64_t*>(g_old_roots[i]) == i;
+        }
+        check(gc.get_stats().old_compactions == compactions + 1, "Compaction ran", failures);
+        check(intact, "Roots follow compacted objects", failures);
+        // The gaps were one object wide; after compaction twice that fits in
+        // them - in free blocks left by pinned objects or at the frontier,
+        // which compaction moved down
+        for (int i = 1; i < OLD_OBJECTS; i += 4) {
+            g_old_roots[i] = GenerationalHeap::allocate_large_slow(2 * OLD_OBJECT_SIZE, TYPE_BUFFER, false);
+        }
+        check(heap.heap_size() <= extent + 2 * OLD_OBJECT_SIZE, "Compaction coalesced the free space", failures);
+
+        for (int i = 0; i < OLD_OBJECTS; ++i) gc.remove_global_root(&g_old_roots[i]);
+    }
+
+    // Test 8: Concurrent marking with the SATB barrier. The moved object is
+    // only reachable from the tail of a long chain when marking starts; it
+    // is moved into an object allocated black before the marker gets there
+    std::cout << "\nTest 8: Concurrent old generation marking..." << std::endl;
+    {
+        gc.add_global_root(&g_chain_head);
+        gc.add_global_root(&g_black_holder);
+        void** prev = nullptr;
+        for (int i = 0; i < CHAIN_LENGTH; ++i) {
+            void** node = static_cast<void**>(old_object(2 * sizeof(void*), TYPE_OBJECT));
+            if (prev) prev[0] = node; else g_chain_head = node;
+            prev = node;
+        }
+        g_chain_tail = prev;
+        std::thread([] {
+            void* moved = old_object(OLD_OBJECT_SIZE, TYPE_BUFFER);
+            *static_cast<int64_t*>(moved) = SATB_SENTINEL;
+            static_cast<void**>(g_chain_tail)[0] = moved;
+            g_moved_masked = reinterpret_cast<uintptr_t>(moved) ^ ADDRESS_MASK;
+            void* garbage = old_object(OLD_OBJECT_SIZE, TYPE_BUFFER);
+            *static_cast<int64_t*>(garbage) = SATB_SENTINEL;
+            g_garbage_masked = reinterpret_cast<uintptr_t>(garbage) ^ ADDRESS_MASK;
+        }).join();
+
+        gc.decommit_old_generation_tail();  // The last sweep must be done
+        size_t marks = gc.get_stats().concurrent_marks;
+        gc.request_concurrent_mark();
+        for (int i = 0; i < 20 && !gc_marking_active; ++i) churn(1);
+        check(gc_marking_active, "Marking continues after the young collection", failures);
+
+        std::thread([] {
+            void** tail = static_cast<void**>(g_chain_tail);
+            g_black_holder = old_object(2 * sizeof(void*), TYPE_OBJECT);
+            void** holder = static_cast<void**>(g_black_holder);
+            WriteBarrier::write_ref(holder, &holder[0], tail[0]);
+            WriteBarrier::write_ref(tail, &tail[0], nullptr);
+        }).join();
+
+        for (int i = 0; i < 200 && gc.get_stats().concurrent_marks == marks; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            churn(1);
+        }
+        check(gc.get_stats().concurrent_marks == marks + 1, "Remark finished the concurrent cycle", failures);
+        gc.decommit_old_generation_tail();
+
+        void* moved = reinterpret_cast<void*>(g_moved_masked ^ ADDRESS_MASK);
+        ObjectHeader* header = heap.find_object(moved);
+        check(static_cast<void**>(g_black_holder)[0] == moved && header &&
+              header->type_id == TYPE_BUFFER && *static_cast<int64_t*>(moved) == SATB_SENTINEL,
+              "Object moved behind the marker survived", failures);
+        void* garbage = reinterpret_cast<void*>(g_garbage_masked ^ ADDRESS_MASK);
+        header = heap.find_object(garbage);
+        check(!header || header->type_id != TYPE_BUFFER || *static_cast<int64_t*>(garbage) != SATB_SENTINEL,
+              "Unreachable old object was swept", failures);
+
+        gc.remove_global_root(&g_chain_head);
+        gc.remove_global_root(&g_black_holder);
+    }
+
+    // Test 9: A JIT property store into an old object marks the slot's card, and
+    // young collections find the young object through it
+    std::cout << "\nTest 9: Card marking..." << std::endl;
+    {
+        TypeInfo info;
+        info.name = "CardHolder";
+        info.size = GCObjectLayout::payload_size(2);
+        info.ref_offsets = {static_cast<size_t>(GCObjectLayout::value_offset(0)),
+                            static_cast<size_t>(GCObjectLayout::value_offset(1))};
+        uint32_t holder_type = gc.get_type_registry().register_type(info);
+        auto store = reinterpret_cast<void (*)(void*, void*)>(build_property_store());
+
+        gc.add_global_root(&g_card_holder);
+        g_card_holder = old_object(GCObjectLayout::payload_size(2), holder_type);
+        *reinterpret_cast<int64_t*>(static_cast<uint8_t*>(g_card_holder) + GCObjectLayout::COUNT_OFFSET) = 2;
+        churn(1);
+        // Stores mark the card of the slot
+        void* slot = static_cast<uint8_t*>(g_card_holder) + GCObjectLayout::value_offset(1);
+        check(!heap.is_card_dirty(slot), "Young collection cleaned the old object's card", failures);
+
+        std::thread([store] {
+            void* young = __string_create("referenced from the old generation");
+            store(g_card_holder, young);
+            g_card_young_masked = reinterpret_cast<uintptr_t>(young) ^ ADDRESS_MASK;
+        }).join();
+        check(heap.is_card_dirty(slot), "JIT store marked the card", failures);
+
+        // The held pointer is only ever loaded on a helper thread: a copy on
+        // this stack would pin the young object
+        bool kept = false;
+        churn(1);
+        std::thread([&] {
+            char* held = *reinterpret_cast<char**>(static_cast<uint8_t*>(g_card_holder) +
+                                                   GCObjectLayout::value_offset(1));
+            kept = held != reinterpret_cast<char*>(g_card_young_masked ^ ADDRESS_MASK) &&
+                   strcmp(held, "referenced from the old generation") == 0;
+        }).join();
+        check(kept, "Young object referenced only from the old object was moved and kept", failures);
+
+        store(g_card_holder, nullptr);
+        churn(1);
+        check(!heap.is_card_dirty(slot), "Card cleaned once nothing on it is young", failures);
+        gc.remove_global_root(&g_card_holder);
+    }
+
+    // Test 10: A goroutine's private pages are freed when it completes,
+    // except those holding what it published and what that reaches
+    std::cout << "\nTest 10: Goroutine-private heaps..." << std::endl;
+    {
+        TypeInfo info;
+        info.name = "PrivateHolder";
+        info.size = GCObjectLayout::payload_size(2);
+        info.ref_offsets = {static_cast<size_t>(GCObjectLayout::value_offset(0)),
+                            static_cast<size_t>(GCObjectLayout::value_offset(1))};
+        uint32_t holder_type = gc.get_type_registry().register_type(info);
+        auto store = reinterpret_cast<void (*)(void*, void*)>(build_property_store());
+        auto holder = [holder_type] {
+            void* object = GenerationalHeap::allocate_fast(GCObjectLayout::payload_size(2), holder_type);
+            *reinterpret_cast<int64_t*>(static_cast<uint8_t*>(object) + GCObjectLayout::COUNT_OFFSET) = 2;
+            return object;
+        };
+        auto slot = [](void* object) {
+            return reinterpret_cast<char**>(static_cast<uint8_t*>(object) + GCObjectLayout::value_offset(1));
+        };
+
+        gc.add_global_root(&g_shared_holder);
+        g_shared_holder = old_object(GCObjectLayout::payload_size(2), holder_type);
+        *reinterpret_cast<int64_t*>(static_cast<uint8_t*>(g_shared_holder) + GCObjectLayout::COUNT_OFFSET) = 2;
+        // The goroutine's garbage must fit without a collection
+        gc.set_eden_size(GCConfig::YOUNG_GEN_SIZE);
+        churn(1);
+        GarbageCollector::Stats before = gc.get_stats();
+
+        bool private_allocation = false, same_owner_private = false, store_published = false, send_published = false;
+        std::thread([&] {
+            gc.attach_private_heap();
+            g_private_holder = holder();
+            private_allocation = gc_private_owner(g_private_holder) != 0;
+            for (int i = 0; i < 20000; ++i) __string_create("request-scoped garbage request-scoped garbage");
+
+            void* shared = __string_create("stored into a shared object");
+            store(g_shared_holder, shared);
+            store_published = gc_private_owner(shared) == 0;
+            for (int i = 0; i < 20000; ++i) __string_create("request-scoped garbage request-scoped garbage");
+
+            void* reached = __string_create("reached from a sent object");
+            store(g_private_holder, reached);
+            same_owner_private = gc_private_owner(reached) != 0;
+            // What a channel send does
+            gc.retain(g_private_holder);
+            send_published = gc_private_owner(g_private_holder) == 0 && gc_private_owner(reached) == 0;
+            for (int i = 0; i < 20000; ++i) __string_create("request-scoped garbage request-scoped garbage");
+            gc.release_private_heap();
+        }).join();
+        GarbageCollector::Stats after = gc.get_stats();
+
+        check(private_allocation, "Goroutine allocates from a private page", failures);
+        check(store_published, "JIT store into a shared object published the value", failures);
+        check(same_owner_private, "Store between the goroutine's own objects stays private", failures);
+        check(send_published, "Sending an object published it and what it references", failures);
+        check(after.young_collections == before.young_collections &&
+              after.private_bytes_freed - before.private_bytes_freed >= 4 * GCConfig::YOUNG_PAGE_SIZE,
+              "Unpublished pages freed on completion without a collection", failures);
+
+        churn(2);
+        check(strcmp(*slot(g_shared_holder), "stored into a shared object") == 0 &&
+              strcmp(*slot(g_private_holder), "reached from a sent object") == 0,
+              "Published objects survive the goroutine", failures);
+        gc.release(g_private_holder);
+        gc.remove_global_root(&g_shared_holder);
+        gc.set_eden_size(0);
+    }
+
+    // Test 11: Escape analysis keeps objects that never leave a function
+    // out of the heap
+    std::cout << "\nTest 11: Escape analysis..." << std::endl;
+    {
+        // let p = {a: 1}; let q = {a: 1}; let r = {a: 1}; let s = {a: 1};
+        // print(p.a); print(r.b); print(q); return () => s.a
+        std::vector<std::unique_ptr<ASTNode>> body;
+        for (const char* name : {"p", "q", "r", "s"}) body.push_back(literal_declaration(name));
+        auto print = [](std::unique_ptr<ExpressionNode> arg) {
+            auto call = std::make_unique<FunctionCall>("print");
+            call->arguments.push_back(std::move(arg));
+            return call;
+        };
+        body.push_back(print(field_read("p", "a")));
+        body.push_back(print(field_read("r", "b")));
+        body.push_back(print(std::make_unique<Identifier>("q")));
+        auto closure = std::make_unique<FunctionExpression>();
+        closure->body.push_back(std::make_unique<ReturnStatement>(field_read("s", "a")));
+        body.push_back(std::make_unique<ReturnStatement>(std::move(closure)));
+
+        auto site = [&](size_t i) {
+            return static_cast<const ExpressionNode*>(static_cast<Assignment*>(body[i].get())->value.get());
+        };
+        FunctionEscapeInfo info = EscapeAnalysis::analyze(body, {});
+        const FrameObject* p = info.scalar_variable("p");
+        const FrameObject* r = info.site(site(2));
+        check(p && p->scalar_replaced && p->field_slots.size() == 1, "Literal read only by its own fields is scalar-replaced", failures);
+        check(r && !r->scalar_replaced, "Local literal read by another name is built in the frame", failures);
+        check(!info.site(site(1)) && !info.site(site(3)), "Objects passed to a call or captured by a closure escape", failures);
+        check(info.frame_bytes == 16 + int64_t(sizeof(ObjectHeader) + GCObjectLayout::payload_size(1)),
+              "Frame grows by the frame object and the scalar slot", failures);
+
+        bool unpublished = false;
+        std::thread([&] {
+            gc.attach_private_heap();
+            auto run = reinterpret_cast<void (*)(void*)>(build_frame_object());
+            void* value = __string_create("stored into a frame object");
+            run(value);
+            unpublished = gc_private_owner(value) != 0;
+            gc.release_private_heap();
+        }).join();
+        check(g_frame_object_ok, "Frame object has the runtime layout and takes stores", failures);
+        check(unpublished, "Store into a frame object does not publish the value", failures);
+    }
+
+    // Test 12: Large objects get page spans of their own, and dead ones go
+    // back to the OS at the next old collection
+    std::cout << "\nTest 12: Large-object space..." << std::endl;
+    {
+        for (int i = 0; i < LARGE_BUFFERS; ++i) gc.add_global_root(&g_large_buffers[i]);
+        gc.add_global_root(&g_large_array);
+        gc.request_gc(true);
+        size_t released = gc.get_stats().large_object_bytes_released;
+        size_t rss_before = resident_bytes();
+
+        // Allocated on a helper thread: a copy on this stack would keep a
+        // buffer alive
+        bool own_span = false;
+        uintptr_t first_masked = 0;
+        std::thread([&] {
+            for (int i = 0; i < LARGE_BUFFERS; ++i) {
+                g_large_buffers[i] = __runtime_buffer_alloc(LARGE_BUFFER_SIZE);
+                memset(static_cast<uint8_t*>(g_large_buffers[i]) + sizeof(int64_t), 0x5a, LARGE_BUFFER_SIZE);
+            }
+            uint8_t* first = static_cast<uint8_t*>(g_large_buffers[0]);
+            ObjectHeader* header = heap.find_object(first + LARGE_BUFFER_SIZE / 2);
+            own_span = header && header->get_object_start() == first && heap.in_large_object_space(first) &&
+                       (header->flags & ObjectHeader::IN_OLD_GEN);
+            first_masked = reinterpret_cast<uintptr_t>(first) ^ ADDRESS_MASK;
+        }).join();
+        check(own_span, "Large buffer is an old object in its own span, found from an interior pointer", failures);
+        check(gc.get_stats().large_objects >= LARGE_BUFFERS, "Large objects are counted", failures);
+
+        // A young value stored far into a large array is found through its card
+        g_large_array = __array_create(1024 * 1024);
+        churn(1);
+        std::thread([] {
+            void* young = __string_create("referenced from a large array");
+            void** slots = static_cast<void**>(g_large_array);
+            WriteBarrier::write_ref(g_large_array, &slots[1000000], young);
+            g_large_young_masked = reinterpret_cast<uintptr_t>(young) ^ ADDRESS_MASK;
+        }).join();
+        check(heap.is_card_dirty(static_cast<void**>(g_large_array) + 1000000), "Store marked the large object's card", failures);
+        bool kept = false;
+        churn(2);
+        std::thread([&] {
+            char* held = static_cast<char**>(g_large_array)[1000000];
+            kept = held && strcmp(held, "referenced from a large array") == 0;
+        }).join();
+        check(kept, "Young object referenced only from a large object survived", failures);
+
+        size_t rss_full = resident_bytes();
+        for (int i = 0; i < LARGE_BUFFERS; ++i) g_large_buffers[i] = nullptr;
+        g_large_array = nullptr;
+        gc.request_gc(true);
+        size_t rss_after = resident_bytes();
+        size_t freed = gc.get_stats().large_object_bytes_released - released;
+        check(freed >= LARGE_BUFFERS * LARGE_BUFFER_SIZE,
+              "Dead large objects were released (" + std::to_string(freed) + " bytes)", failures);
+        check(rss_full > rss_before && rss_full - rss_after >= (LARGE_BUFFERS - 1) * LARGE_BUFFER_SIZE,
+              "Resident set shrank from " + std::to_string(rss_full >> 20) + "MB to " +
+              std::to_string(rss_after >> 20) + "MB", failures);
+
+        g_large_buffers[0] = __runtime_buffer_alloc(LARGE_BUFFER_SIZE);
+        check(reinterpret_cast<uintptr_t>(g_large_buffers[0]) == (first_masked ^ ADDRESS_MASK) &&
+              static_cast<uint8_t*>(g_large_buffers[0])[LARGE_BUFFER_SIZE] == 0,
+              "Released span is reused, zeroed", failures);
+
+        for (int i = 0; i < LARGE_BUFFERS; ++i) gc.remove_global_root(&g_large_buffers[i]);
+        gc.remove_global_root(&g_large_array);
+    }
+
+    // Test 13: Telemetry - every pause lands in the histogram, promotion is
+    // counted, and runtime.gc.stats() fields read back by name
+    std::cout << "\nTest 13: GC telemetry..." << std::endl;
+    {
+        churn(3);
+        GarbageCollector::Stats stats = gc.get_stats();
+        check(stats.pause_count == stats.young_collections,
+              "One pause recorded per collection (" + std::to_string(stats.pause_count) + ")", failures);
+        check(stats.pause_p50_us <= stats.pause_p99_us && stats.pause_p99_us <= stats.pause_max_us &&
+              stats.pause_max_us > 0,
+              "p50 " + std::to_string(stats.pause_p50_us) + "us <= p99 " + std::to_string(stats.pause_p99_us) +
+              "us <= max " + std::to_string(stats.pause_max_us) + "us", failures);
+        check(stats.promoted_bytes > 0 && stats.alloc_bytes_per_sec > 0, "Promotion and allocation rates counted", failures);
+
+        void* snapshot = __runtime_gc_stats();
+        int64_t young = reinterpret_cast<int64_t>(__dynamic_get_property(snapshot, "youngCollections"));
+        int64_t p99 = reinterpret_cast<int64_t>(__dynamic_get_property(snapshot, "pauseP99Us"));
+        check(young == static_cast<int64_t>(stats.young_collections) && p99 == static_cast<int64_t>(stats.pause_p99_us),
+              "runtime.gc.stats() fields read by name", failures);
+        check(__dynamic_get_property(snapshot, "noSuchField") == nullptr && __dynamic_get_property(&young, "pauseP99Us") == nullptr,
+              "Unknown names and non-objects read as 0", failures);
+    }
+
+    // Test 14: Eden follows the allocation rate within the young generation;
+    // a soft memory limit shrinks it and pulls the old trigger in
+    std::cout << "\nTest 14: Heap sizing and the soft memory limit..." << std::endl;
+    {
+        size_t previous = gc.set_memory_limit(0);    // cgroup memory.max or GOTS_MEMLIMIT
+        churn(4);
+        size_t eden = heap.eden_size();
+        check(eden >= GCConfig::MIN_EDEN_PAGES * GCConfig::YOUNG_PAGE_SIZE && eden <= GCConfig::YOUNG_GEN_SIZE * 3 / 4,
+              "Adaptive eden within the young generation (" + std::to_string(eden >> 20) + "MB)", failures);
+        check(heap.old_gc_trigger() >= GCConfig::OLD_GC_TRIGGER, "No limit: old trigger at twice live data", failures);
+
+        size_t limit = heap.old_used() + 16 * 1024 * 1024;
+        gc.set_memory_limit(limit);
+        churn(2);
+        check(heap.eden_size() <= 8 * 1024 * 1024 && heap.old_gc_trigger() < limit,
+              "Near the limit: eden " + std::to_string(heap.eden_size() >> 20) + "MB, old trigger " +
+              std::to_string(heap.old_gc_trigger() >> 20) + "MB", failures);
+
+        check(gc.set_memory_limit(0) == limit, "Setting a limit returns the previous one", failures);
+        churn(1);
+        check(heap.old_gc_trigger() >= GCConfig::OLD_GC_TRIGGER, "Limit lifted: old trigger restored", failures);
+        gc.set_memory_limit(previous);
+    }
+
+    // Test 15: A JIT allocation site whose objects outlive young collections
+    // is pretenured; one whose objects die young keeps allocating young
+    std::cout << "\nTest 15: Allocation-site pretenuring..." << std::endl;
+    {
+        auto retained = reinterpret_cast<void* (*)()>(build_object_allocator());
+        auto garbage = reinterpret_cast<void* (*)()>(build_object_allocator());
+        gc.add_global_root(&g_keep_array);
+        g_keep_array = __array_create(KEEP_OBJECTS);
+        void** slots = static_cast<void**>(g_keep_array);
+        size_t sites = gc.get_stats().pretenured_sites;
+
+        // Interleaved, so both sites take their share of TLAB refills
+        size_t kept = 0;
+        void* object = nullptr;
+        for (; kept < KEEP_OBJECTS; ++kept) {
+            object = retained();
+            if (!heap.in_young(object)) break;
+            WriteBarrier::write_ref(g_keep_array, &slots[kept], object);
+            garbage();
+        }
+        check(kept < KEEP_OBJECTS && gc.get_stats().pretenured_sites == sites + 1,
+              "Retaining site pretenured after " + std::to_string(kept) + " objects", failures);
+        ObjectHeader* header = ObjectHeader::from_object(object);
+        check((header->flags & ObjectHeader::IN_OLD_GEN) && header->type_id == TYPE_OBJECT &&
+              *reinterpret_cast<int64_t*>(static_cast<uint8_t*>(object) + GCObjectLayout::COUNT_OFFSET) == 3 &&
+              __object_get_property(reinterpret_cast<int64_t>(object), 2) == 0,
+              "Pretenured object built in the old generation", failures);
+        check(heap.in_young(garbage()), "Site of short-lived objects still allocates young", failures);
+        check(gc.get_stats().pretenured_bytes > 0, "Pretenured bytes counted", failures);
+        g_keep_array = nullptr;
+        gc.remove_global_root(&g_keep_array);
+    }
+
+    // Test 16: A heap snapshot holds the object graph, and the analyzer
+    // finds what each object retains
+    std::cout << "\nTest 16: Heap snapshot and retained sizes..." << std::endl;
+    {
+        gc.add_global_root(&g_snapshot_holder);
+        int64_t holder = __object_create("SnapshotHolder", 1);
+        g_snapshot_holder = reinterpret_cast<void*>(holder);
+        [&]() {
+            // The array is only reachable through the holder
+            void* array = __array_create(SNAPSHOT_STRINGS);
+            void** slots = static_cast<void**>(array);
+            for (int i = 0; i < SNAPSHOT_STRINGS; ++i) {
+                std::string text = "retained string number " + std::to_string(i);
+                WriteBarrier::write_ref(array, &slots[i], __string_create(text.c_str()));
+            }
+            __object_set_property(holder, 0, reinterpret_cast<int64_t>(array));
+            g_snapshot_array_masked = reinterpret_cast<uintptr_t>(array) ^ ADDRESS_MASK;
+        }();
+        churn(2);
+
+        const char* path = "/tmp/gots_test_heap_snapshot.heap";
+        size_t young_before = gc.get_stats().young_collections;
+        int64_t written = __runtime_gc_write_heap_snapshot(path);
+        check(written > SNAPSHOT_STRINGS && gc.get_stats().young_collections == young_before,
+              "Snapshot of " + std::to_string(written) + " objects written without a collection", failures);
+
+        HeapSnapshot snapshot;
+        bool loaded = snapshot.load(path);
+        check(loaded && snapshot.objects.size() == static_cast<size_t>(written) && !snapshot.roots.empty(),
+              "Snapshot loads with its roots", failures);
+        if (loaded) {
+            HeapAnalysis analysis(snapshot);
+            void* array = reinterpret_cast<void*>(g_snapshot_array_masked ^ ADDRESS_MASK);
+            size_t holder_index = snapshot.find(reinterpret_cast<uintptr_t>(g_snapshot_holder));
+            size_t array_index = snapshot.find(reinterpret_cast<uintptr_t>(array));
+            check(holder_index < snapshot.objects.size() && array_index < snapshot.objects.size() &&
+                  snapshot.names[snapshot.objects[holder_index].name] == "SnapshotHolder" &&
+                  snapshot.names[snapshot.objects[array_index].name] == "Array",
+                  "Objects found with their class and type names", failures);
+            if (holder_index < snapshot.objects.size() && array_index < snapshot.objects.size()) {
+                uint64_t strings = 0;
+                size_t string_count = 0;
+                for (size_t i = 0; i < snapshot.objects.size(); ++i) {
+                    if (analysis.dominator[i] == array_index) {
+                        strings += snapshot.objects[i].size;
+                        string_count++;
+                    }
+                }
+                uint64_t array_size = snapshot.objects[array_index].size;
+                // A string still in a register or stack slot is a root of its own
+                check(string_count >= SNAPSHOT_STRINGS - 2 && analysis.retained[array_index] == array_size + strings,
+                      "Array retains its " + std::to_string(string_count) + " strings (" +
+                      std::to_string(analysis.retained[array_index]) + " bytes)", failures);
+                check(analysis.dominator[array_index] == holder_index &&
+                      analysis.retained[holder_index] >= analysis.retained[array_index] + snapshot.objects[holder_index].size,
+                      "Holder dominates the array and retains it", failures);
+            }
+        }
+        unlink(path);
+        check(__runtime_gc_write_heap_snapshot("/nonexistent-dir/snapshot.heap") == -1,
+              "Unwritable path reported", failures);
+        g_snapshot_holder = nullptr;
+        gc.remove_global_root(&g_snapshot_holder);
+    }
+
+    // Test 17: Sampled allocations are attributed to the JIT function that
+    // made them, and leave the in-use counts when they die
+    std::cout << "\nTest 17: Sampling heap profiler..." << std::endl;
+    {
+        auto allocate = reinterpret_cast<void* (*)()>(build_profiled_allocator("profiled_alloc"));
+        size_t previous_rate = gc.set_heap_profile_rate(4096);
+        gc.add_global_root(&g_profile_keep);
+        g_profile_keep = __array_create(PROFILE_KEEP);
+        void** slots = static_cast<void**>(g_profile_keep);
+        size_t object_bytes = 0;
+        for (size_t i = 0; i < PROFILE_OBJECTS; ++i) {
+            void* object = allocate();
+            if (i < PROFILE_KEEP) WriteBarrier::write_ref(g_profile_keep, &slots[i], object);
+            object_bytes = sizeof(ObjectHeader) + ObjectHeader::from_object(object)->size;
+        }
+
+        auto profiled = [](const HeapProfile& profile) -> const HeapProfile::Stack* {
+            for (const auto& stack : profile.stacks) {
+                if (!stack.locations.empty() && profile.locations[stack.locations[0]].function == "profiled_alloc") {
+                    return &stack;
+                }
+            }
+            return nullptr;
+        };
+        HeapProfile profile;
+        const HeapProfile::Stack* stack = gc.get_heap_profile(profile) ? profiled(profile) : nullptr;
+        uint64_t allocated = PROFILE_OBJECTS * object_bytes;
+        check(stack && stack->alloc_bytes > static_cast<int64_t>(allocated / 2) &&
+              stack->alloc_bytes < static_cast<int64_t>(allocated * 2),
+              "Allocations attributed to the JIT function: " +
+              std::to_string(stack ? stack->alloc_bytes : 0) + " of " + std::to_string(allocated) + " bytes", failures);
+        int64_t inuse = stack ? stack->inuse_bytes : 0;
+        check(inuse > 0 && stack->inuse_bytes < stack->alloc_bytes, "Only the kept objects stay in use", failures);
+
+        g_profile_keep = nullptr;
+        churn(2);
+        heap.collect_full();
+        stack = gc.get_heap_profile(profile) ? profiled(profile) : nullptr;
+        check(stack && stack->inuse_bytes < inuse && stack->alloc_bytes > static_cast<int64_t>(allocated / 2),
+              "Dropped objects leave the in-use counts", failures);
+
+        const char* path = "/tmp/gots_test_heap_profile.pb";
+        check(profile.write_pprof(path), "pprof profile written", failures);
+        unlink(path);
+        gc.set_heap_profile_rate(previous_rate);
+        gc.remove_global_root(&g_profile_keep);
+    }
+
+    // Test 18: Weak references are cleared when their target dies, WeakMap
+    // values live as long as their keys, and registries get their cleanups
+    std::cout << "\nTest 18: WeakRef, WeakMap and FinalizationRegistry..." << std::endl;
+    {
+        void** roots[] = {&g_weak_ref, &g_weak_target, &g_weak_map, &g_weak_key, &g_weak_registry, &g_weak_token};
+        for (void** root : roots) gc.add_global_root(root);
+        gc.set_cleanup_runner([](void* callback, void* held) {
+            g_cleanup_runs++;
+            reinterpret_cast<void (*)(void*)>(callback)(held);
+        });
+        // On threads of their own, so no stack slot keeps the dying objects
+        std::thread([] {
+            g_weak_target = __array_create(1);
+            g_weak_target_masked = reinterpret_cast<uintptr_t>(g_weak_target) ^ ADDRESS_MASK;
+            g_weak_ref = GarbageCollector::instance().new_weak_ref(g_weak_target);
+        }).join();
+        churn(2);
+        check(gc.weak_ref_get(g_weak_ref) == g_weak_target &&
+              reinterpret_cast<uintptr_t>(g_weak_target) != (g_weak_target_masked ^ ADDRESS_MASK),
+              "WeakRef follows its live target when it is copied", failures);
+
+        // Values are scanned conservatively and pin their pages from here on
+        std::thread([] {
+            GarbageCollector& gc = GarbageCollector::instance();
+            g_weak_map = gc.new_weak_map();
+            g_weak_key = __array_create(1);
+            gc.weak_map_set(g_weak_map, g_weak_key, __string_create("ephemeron value"));
+            // The value references its own key - the entry is still garbage
+            void* cycle_key = __array_create(1);
+            void* cycle_value = __array_create(2);
+            WriteBarrier::write_ref(cycle_value, &static_cast<void**>(cycle_value)[1], cycle_key);
+            gc.weak_map_set(g_weak_map, cycle_key, cycle_value);
+
+            g_weak_registry = gc.new_finalization_registry(reinterpret_cast<void*>(count_cleanup));
+            g_weak_token = __array_create(1);
+            gc.finalization_register(g_weak_registry, __array_create(1), __string_create("held value"), nullptr);
+            gc.finalization_register(g_weak_registry, __array_create(1), __string_create("cancelled"), g_weak_token);
+        }).join();
+        check(gc.weak_map_size(g_weak_map) == 2, "Both entries stored", failures);
+        check(gc.finalization_unregister(g_weak_registry, g_weak_token) &&
+              !gc.finalization_unregister(g_weak_registry, g_weak_token), "Unregister removes the token's cells", failures);
+
+        churn(2);
+        char* value = static_cast<char*>(gc.weak_map_get(g_weak_map, g_weak_key));
+        check(value && strcmp(value, "ephemeron value") == 0 && gc.weak_map_has(g_weak_map, g_weak_key),
+              "Value only reachable through its live key survived", failures);
+        check(gc.weak_map_size(g_weak_map) == 1, "Entry whose value references its dead key was dropped", failures);
+        check(g_cleanups.load() == 1 && g_cancelled_cleanups.load() == 0 && g_cleanup_runs.load() == 1,
+              "Cleanup delivered the held value through the runner", failures);
+
+        gc.request_compaction();
+        gc.request_gc(true);
+        value = static_cast<char*>(gc.weak_map_get(g_weak_map, g_weak_key));
+        check(gc.weak_ref_get(g_weak_ref) == g_weak_target && value && strcmp(value, "ephemeron value") == 0,
+              "Weak slots survive a full collection with compaction", failures);
+        check(gc.weak_map_delete(g_weak_map, g_weak_key) && !gc.weak_map_has(g_weak_map, g_weak_key) &&
+              gc.weak_map_size(g_weak_map) == 0, "Deleted entry is gone", failures);
+        gc.weak_map_set(g_weak_map, g_weak_key, __string_create("ephemeron value"));
+
+        g_weak_target = nullptr;
+        g_weak_key = nullptr;
+        churn(2);
+        gc.request_gc(true);
+        check(gc.weak_ref_get(g_weak_ref) == nullptr, "WeakRef cleared once its target died", failures);
+        check(gc.weak_map_size(g_weak_map) == 0, "Entry dropped with its key", failures);
+        check(g_cleanups.load() == 1 && g_cancelled_cleanups.load() == 0, "Each cleanup ran once", failures);
+
+        // Handles come from scripts unchecked: null, non-heap, interior and
+        // wrong-type pointers are refused without being dereferenced
+        void* key = __array_create(1);
+        void* not_map = __array_create(4);
+        int64_t on_stack[4] = {};
+        void* bogus[] = {nullptr, on_stack, not_map, static_cast<char*>(g_weak_map) + 8, g_weak_registry};
+        bool refused = true;
+        for (void* map : bogus) {
+            gc.weak_map_set(map, key, key);
+            refused = refused && !gc.weak_map_get(map, key) && !gc.weak_map_has(map, key) &&
+                      !gc.weak_map_delete(map, key) && gc.weak_map_size(map) == 0;
+        }
+        check(refused && gc.weak_map_size(g_weak_map) == 0, "Invalid WeakMap handles are refused", failures);
+        gc.finalization_register(g_weak_map, key, key, key);
+        gc.finalization_register(not_map, key, key, key);
+        check(!gc.finalization_unregister(g_weak_map, key) && !gc.finalization_unregister(nullptr, key) &&
+              !gc.weak_ref_get(not_map) && !gc.weak_ref_get(g_weak_map),
+              "Invalid FinalizationRegistry and WeakRef handles are refused", failures);
+
+        gc.set_cleanup_runner(nullptr);
+        for (void** root : roots) gc.remove_global_root(root);
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All GC integration tests passed" : "GC integration tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
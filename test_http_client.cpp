@@ -0,0 +1,246 @@
+#include "http_client.h"
+#include "http_server.h"
+#include "runtime_syscalls.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace gots;
+
+// Standalone test for the pooled HTTP client against loopback servers
+// Build: make && g++ -std=c++17 -O2 -pthread test_http_client.cpp $(ls *.o | grep -v simple_main.o) -o test_http_client
+
+// Listening socket on an ephemeral loopback port for hand-written responses
+static int raw_listen(int& port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    listen(fd, 16);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static HttpClientRequest make_request(int port, const std::string& target) {
+    HttpClientRequest request;
+    request.host = "127.0.0.1";
+    request.port = port;
+    request.target = target;
+    return request;
+}
+
+int main() {
+    std::cout << "=== Testing HTTP client ===" << std::endl;
+    int failures = 0;
+    HttpClient& client = HttpClient::instance();
+
+    // Test 1: Response parser handles chunked framing split at every byte
+    std::cout << "\nTest 1: Incremental response parsing..." << std::endl;
+    {
+        std::string raw = "HTTP/1.1 100 Continue\r\n\r\n"
+                          "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                          "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nX-Trailer: 1\r\n\r\n";
+        bool all_ok = true;
+        for (size_t split = 1; split < raw.size(); ++split) {
+            HttpResponseParser parser;
+            parser.reset(false);
+            std::string body;
+            auto sink = [&body](const char* data, size_t len) { body.append(data, len); };
+            size_t consumed = 0;
+            auto first = parser.feed(raw.data(), split, consumed, sink);
+            size_t offset = consumed;
+            auto second = parser.feed(raw.data() + offset, raw.size() - offset, consumed, sink);
+            if (first != HttpResponseParser::Status::NEED_MORE || second != HttpResponseParser::Status::COMPLETE ||
+                offset + consumed != raw.size() || parser.status_code() != 200 || body != "hello world") {
+                all_ok = false;
+                std::cout << "  split at " << split << " failed" << std::endl;
+                break;
+            }
+        }
+        check(all_ok, "Every split point parses to the same response", failures);
+    }
+
+    HttpServer server([](const HttpRequest& request, HttpResponse& response) {
+        if (request.path == "/echo") {
+            response.set_header("X-Method", std::string(request.method));
+            response.send(std::string(request.body));
+        } else if (request.path == "/binary") {
+            response.send(std::string("\x89PNG\0\0\x01", 7));
+        } else if (request.path == "/close") {
+            response.close_connection();
+            response.send("bye");
+        } else {
+            response.send("path=" + std::string(request.path));
+        }
+    });
+    if (!server.listen(0, "127.0.0.1")) {
+        std::cerr << "ERROR: listen failed" << std::endl;
+        return 1;
+    }
+    int port = server.port();
+
+    // Test 2: Sequential requests reuse one keep-alive connection
+    std::cout << "\nTest 2: Keep-alive reuse..." << std::endl;
+    {
+        bool all_ok = true;
+        for (int i = 0; i < 20; ++i) {
+            HttpClientResponse response = client.request(make_request(port, "/item/" + std::to_string(i)));
+            all_ok = all_ok && response.ok && response.status == 200 && response.body == "path=/item/" + std::to_string(i);
+        }
+        check(all_ok, "20 sequential GETs succeed", failures);
+        check(client.open_connections("127.0.0.1", port) == 1, "Pool holds a single reused connection", failures);
+
+        HttpClientRequest post = make_request(port, "/echo");
+        post.method = "POST";
+        post.body = "payload";
+        HttpClientResponse response = client.request(post);
+        check(response.ok && response.body == "payload" && response.header("x-method") == "POST",
+              "POST body and response headers round-trip", failures);
+
+        response = client.request(make_request(port, "/close"));
+        check(response.ok && response.body == "bye", "Connection: close response is delivered", failures);
+        for (int i = 0; i < 100 && client.open_connections("127.0.0.1", port) > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        check(client.open_connections("127.0.0.1", port) == 0, "Closed connection leaves the pool", failures);
+    }
+
+    // Test 3: Thousands of concurrent requests from a single thread
+    std::cout << "\nTest 3: Concurrent requests..." << std::endl;
+    {
+        const int count = 2000;
+        client.set_max_connections_per_host(32);
+        std::vector<PromiseRef> promises;
+        promises.reserve(count);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i) {
+            promises.push_back(client.send(make_request(port, "/n/" + std::to_string(i))));
+        }
+        int ok = 0;
+        for (int i = 0; i < count; ++i) {
+            promises[i]->wait();
+            auto* response = &promises[i]->result<HttpClientResponse>();
+            if (response->ok && response->body == "path=/n/" + std::to_string(i)) ok++;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << count << " requests in " << ms << " ms" << std::endl;
+        check(ok == count, "All concurrent responses match their requests", failures);
+        check(client.open_connections("127.0.0.1", port) <= 32, "Per-host connection limit respected", failures);
+    }
+
+    // Test 4: Idle connections are closed after the idle timeout
+    std::cout << "\nTest 4: Idle timeout..." << std::endl;
+    {
+        client.set_idle_timeout_ms(50);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        client.sweep_idle();
+        check(client.idle_connections("127.0.0.1", port) == 0 && client.open_connections("127.0.0.1", port) == 0,
+              "Idle connections swept", failures);
+
+        // No further traffic - the sweep timer closes it on its own
+        HttpClientResponse response = client.request(make_request(port, "/last"));
+        bool pooled = response.ok && client.idle_connections("127.0.0.1", port) == 1;
+        for (int i = 0; i < 200 && client.open_connections("127.0.0.1", port) > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        check(pooled && client.open_connections("127.0.0.1", port) == 0,
+              "Idle connection closed without another request", failures);
+        client.set_idle_timeout_ms(HttpClient::DEFAULT_IDLE_TIMEOUT_MS);
+    }
+
+    // Test 5: Chunked body streamed to on_body as it arrives
+    std::cout << "\nTest 5: Streaming chunked body..." << std::endl;
+    {
+        int raw_port = 0;
+        int listen_fd = raw_listen(raw_port);
+        std::atomic<int> pieces_before_end{0};
+        std::atomic<int> pieces{0};
+        std::atomic<bool> server_done{false};
+        std::string streamed;
+        std::mutex streamed_mutex;
+
+        std::thread peer([&]() {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            char buf[4096];
+            recv(fd, buf, sizeof(buf), 0);
+            std::string head = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+            send(fd, head.data(), head.size(), MSG_NOSIGNAL);
+            for (int i = 0; i < 5; ++i) {
+                std::string chunk = "4\r\npart\r\n";
+                send(fd, chunk.data(), chunk.size(), MSG_NOSIGNAL);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            pieces_before_end.store(pieces.load());
+            server_done.store(true);
+            std::string end = "0\r\n\r\n";
+            send(fd, end.data(), end.size(), MSG_NOSIGNAL);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            close(fd);
+        });
+
+        HttpClientRequest request = make_request(raw_port, "/stream");
+        request.on_body = [&](const char* data, size_t len) {
+            std::lock_guard<std::mutex> lock(streamed_mutex);
+            streamed.append(data, len);
+            pieces++;
+        };
+        HttpClientResponse response = client.request(request);
+        peer.join();
+        close(listen_fd);
+
+        check(response.ok && response.status == 200 && response.body.empty(), "Streamed response completes", failures);
+        check(streamed == "partpartpartpartpart", "Body de-chunked in order", failures);
+        check(pieces_before_end.load() >= 4, "Body pieces delivered before the response ended", failures);
+    }
+
+    // Test 6: Failures resolve with an error instead of hanging
+    std::cout << "\nTest 6: Errors..." << std::endl;
+    {
+        int raw_port = 0;
+        int listen_fd = raw_listen(raw_port);
+        close(listen_fd);  // Nothing listens on this port now
+        HttpClientResponse response = client.request(make_request(raw_port, "/"));
+        check(!response.ok && !response.error.empty(), "Connection refused reported: " + response.error, failures);
+
+        HttpClientRequest bad = make_request(0, "/");
+        bad.host = "no-such-host.invalid";
+        response = client.request(bad);
+        check(!response.ok, "Unresolvable host reported", failures);
+    }
+
+    // Test 7: The string entry point returns text bodies as strings, the
+    // Buffer one returns binary bodies intact
+    std::cout << "\nTest 7: Runtime entry points..." << std::endl;
+    {
+        std::string text_url = "http://127.0.0.1:" + std::to_string(port) + "/hello";
+        void* text = __runtime_http_request("GET", text_url.c_str(), nullptr, nullptr, 0);
+        check(text && std::string(static_cast<const char*>(text)) == "path=/hello",
+              "__runtime_http_request returns the body as a string", failures);
+
+        std::string url = "http://127.0.0.1:" + std::to_string(port) + "/binary";
+        void* buffer = __runtime_http_request_buffer("GET", url.c_str(), nullptr, nullptr, 0);
+        int64_t length = __runtime_buffer_length(buffer);
+        bool intact = buffer && length == 7 &&
+                      memcmp(static_cast<char*>(buffer) + sizeof(int64_t), "\x89PNG\0\0\x01", 7) == 0;
+        check(intact, "All " + std::to_string(length) + " bytes past the NULs returned", failures);
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All HTTP client tests passed" : "HTTP client tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,352 @@
+#include "http_server.h"
+#include "goroutine_system.h"
+#include "runtime_syscalls.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace gots;
+
+// Standalone test for the HTTP/1.1 parser and server over loopback
+// Build: make && g++ -std=c++17 -O2 -pthread test_http_server.cpp $(ls *.o | grep -v simple_main.o) -o test_http_server
+
+static int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval tv = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+// Read until `count` occurrences of `marker` have arrived or the peer closes
+static std::string read_until(int fd, const std::string& marker, int count) {
+    std::string data;
+    char buf[4096];
+    while (true) {
+        int seen = 0;
+        for (size_t pos = data.find(marker); pos != std::string::npos; pos = data.find(marker, pos + 1)) seen++;
+        if (seen >= count) break;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        data.append(buf, static_cast<size_t>(n));
+    }
+    return data;
+}
+
+// Test 10: compiled-style handlers that each set a timer for the goroutine
+// that created the server
+constexpr int TIMER_REQUESTS = 64;
+static void* g_timer_server = nullptr;
+static int64_t g_owner_id = -1;
+static std::thread::id g_owner_thread;
+static std::atomic<int> g_timers_set{0};
+static std::atomic<int> g_timers_fired{0};
+static std::atomic<int> g_timer_faults{0};
+
+static void on_handler_timer() {
+    if (std::this_thread::get_id() != g_owner_thread) g_timer_faults++;
+    // The last one lets the owner's event loop finish
+    if (++g_timers_fired == TIMER_REQUESTS) __runtime_http_server_close(g_timer_server);
+}
+
+static void timer_handler(void* request, void* response) {
+    (void)request;
+    int64_t timer_id = __gots_set_timeout(reinterpret_cast<void*>(on_handler_timer), 5);
+    if (current_goroutine || timer_id < 0 || Goroutine::timer_owner_id(timer_id) != g_owner_id) g_timer_faults++;
+    g_timers_set++;
+    __runtime_http_res_end(response, "ok", 2);
+}
+
+int main() {
+    std::cout << "=== Testing HTTP server ===" << std::endl;
+    int failures = 0;
+
+    // Test 1: Parser handles a request split at every byte boundary
+    std::cout << "\nTest 1: Incremental parsing..." << std::endl;
+    {
+        std::string raw = "POST /submit?x=1 HTTP/1.1\r\nHost: localhost\r\nContent-Length: 5\r\n\r\nhello";
+        bool all_ok = true;
+        for (size_t split = 1; split < raw.size(); ++split) {
+            HttpRequestParser parser;
+            HttpRequest request;
+            size_t consumed = 0;
+            auto first = parser.parse(raw.data(), split, request, consumed);
+            auto second = parser.parse(raw.data(), raw.size(), request, consumed);
+            if (first != HttpRequestParser::Status::INCOMPLETE || second != HttpRequestParser::Status::COMPLETE ||
+                consumed != raw.size() || request.method != "POST" || request.path != "/submit" ||
+                request.query != "x=1" || request.header("HOST") != "localhost" || request.body != "hello") {
+                all_ok = false;
+                std::cout << "  split at " << split << " failed" << std::endl;
+                break;
+            }
+        }
+        check(all_ok, "Every split point parses to the same request", failures);
+    }
+
+    // Test 2: Parser rejects malformed and unsupported requests
+    std::cout << "\nTest 2: Parser errors..." << std::endl;
+    {
+        auto status_of = [](const std::string& raw) {
+            HttpRequestParser parser;
+            HttpRequest request;
+            size_t consumed = 0;
+            if (parser.parse(raw.data(), raw.size(), request, consumed) != HttpRequestParser::Status::ERROR) return 0;
+            return parser.error_status();
+        };
+        check(status_of("GARBAGE\r\n\r\n") == 400, "Malformed request line -> 400", failures);
+        check(status_of("GET / HTTP/2.0\r\n\r\n") == 505, "Unsupported version -> 505", failures);
+        check(status_of("GET / HTTP/1.1\r\nContent-Length: x\r\n\r\n") == 400, "Bad Content-Length -> 400", failures);
+        check(status_of("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n") == 501, "Chunked body -> 501", failures);
+    }
+
+    HttpServer server([](const HttpRequest& request, HttpResponse& response) {
+        if (request.path == "/file") {
+            response.send_file("test_http_server.cpp");
+        } else if (request.path == "/echo") {
+            response.set_header("Content-Type", "text/plain");
+            response.send(std::string(request.body));
+        } else if (request.path == "/throw") {
+            throw std::runtime_error("handler failure");
+        } else {
+            response.send("path=" + std::string(request.path));
+        }
+    }, 4);
+
+    if (!server.listen(0, "127.0.0.1")) {
+        std::cout << "✗ listen failed" << std::endl;
+        return 1;
+    }
+    int port = server.port();
+
+    // Test 3: Keep-alive - several requests on one connection
+    std::cout << "\nTest 3: Keep-alive..." << std::endl;
+    {
+        int fd = connect_to(port);
+        bool ok = fd >= 0;
+        for (int i = 0; ok && i < 3; ++i) {
+            std::string req = "GET /k" + std::to_string(i) + " HTTP/1.1\r\nHost: x\r\n\r\n";
+            send(fd, req.data(), req.size(), 0);
+            std::string resp = read_until(fd, "path=/k" + std::to_string(i), 1);
+            ok = resp.find("HTTP/1.1 200 OK") == 0 && resp.find("Connection: close") == std::string::npos;
+        }
+        close(fd);
+        check(ok, "Three requests answered on one connection", failures);
+    }
+
+    // Test 4: Pipelining - responses come back in request order
+    std::cout << "\nTest 4: Pipelining..." << std::endl;
+    {
+        int fd = connect_to(port);
+        std::string batch;
+        for (int i = 0; i < 20; ++i) {
+            batch += "GET /p" + std::to_string(i) + " HTTP/1.1\r\nHost: x\r\n\r\n";
+        }
+        batch += "POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nping";
+        send(fd, batch.data(), batch.size(), 0);
+        std::string resp = read_until(fd, "ping", 1);  // Only the last response echoes it
+        close(fd);
+
+        bool ordered = true;
+        size_t pos = 0;
+        for (int i = 0; i < 20 && ordered; ++i) {
+            size_t next = resp.find("path=/p" + std::to_string(i), pos);
+            ordered = next != std::string::npos;
+            pos = next;
+        }
+        check(ordered && resp.find("ping", pos) != std::string::npos, "21 pipelined responses in order", failures);
+    }
+
+    // Test 5: sendfile body matches the file, HEAD gets no body
+    std::cout << "\nTest 5: Static file..." << std::endl;
+    {
+        FILE* f = fopen("test_http_server.cpp", "rb");
+        std::string expected;
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) expected.append(buf, n);
+        fclose(f);
+
+        int fd = connect_to(port);
+        std::string req = "GET /file HTTP/1.1\r\nConnection: close\r\n\r\n";
+        send(fd, req.data(), req.size(), 0);
+        std::string resp = read_until(fd, "\x01never", 1);
+        close(fd);
+        size_t body_start = resp.find("\r\n\r\n");
+        check(body_start != std::string::npos && resp.substr(body_start + 4) == expected &&
+              resp.find("Content-Length: " + std::to_string(expected.size())) != std::string::npos,
+              "GET /file returned " + std::to_string(expected.size()) + " bytes", failures);
+
+        fd = connect_to(port);
+        req = "HEAD /file HTTP/1.1\r\nConnection: close\r\n\r\n";
+        send(fd, req.data(), req.size(), 0);
+        resp = read_until(fd, "\x01never", 1);
+        close(fd);
+        check(resp.size() == resp.find("\r\n\r\n") + 4, "HEAD /file has headers only", failures);
+    }
+
+    // Test 6: Errors - bad request closes, handler exception gives 500
+    std::cout << "\nTest 6: Error responses..." << std::endl;
+    {
+        int fd = connect_to(port);
+        std::string req = "NOT-HTTP\r\n\r\n";
+        send(fd, req.data(), req.size(), 0);
+        std::string resp = read_until(fd, "\x01never", 1);
+        close(fd);
+        check(resp.find("HTTP/1.1 400 Bad Request") == 0 && resp.find("Connection: close") != std::string::npos,
+              "Malformed request gets 400 and close", failures);
+
+        fd = connect_to(port);
+        req = "GET /throw HTTP/1.1\r\n\r\n";
+        send(fd, req.data(), req.size(), 0);
+        resp = read_until(fd, "\r\n\r\n", 1);
+        close(fd);
+        check(resp.find("HTTP/1.1 500") == 0, "Throwing handler gets 500", failures);
+    }
+
+    // Test 7: Running out of descriptors pauses accepting; the queued
+    // connection is picked up by the retry timer, not by a new client
+    std::cout << "\nTest 7: Accept retries after EMFILE..." << std::endl;
+    {
+        struct rlimit saved;
+        getrlimit(RLIMIT_NOFILE, &saved);
+        struct rlimit low = saved;
+        low.rlim_cur = std::min<rlim_t>(saved.rlim_cur, 256);
+        setrlimit(RLIMIT_NOFILE, &low);
+
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        std::vector<int> filler;
+        for (int spare = dup(0); spare >= 0; spare = dup(0)) filler.push_back(spare);
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bool connected = connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+        struct timeval tv = {5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        std::string req = "GET /after-emfile HTTP/1.1\r\n\r\n";
+        send(fd, req.data(), req.size(), 0);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(3 * HttpServer::ACCEPT_RETRY_MS));
+        for (int spare : filler) close(spare);
+        setrlimit(RLIMIT_NOFILE, &saved);
+
+        std::string resp = read_until(fd, "path=/after-emfile", 1);
+        close(fd);
+        check(connected && !filler.empty() && resp.find("path=/after-emfile") != std::string::npos,
+              "Backlogged connection served once descriptors free up", failures);
+    }
+
+    // Test 8: A keep-alive connection with no traffic is closed by the server
+    std::cout << "\nTest 8: Idle timeout..." << std::endl;
+    {
+        server.set_idle_timeout_ms(200);
+        int fd = connect_to(port);
+        std::string req = "GET /idle HTTP/1.1\r\n\r\n";
+        send(fd, req.data(), req.size(), 0);
+        std::string resp = read_until(fd, "path=/idle", 1);
+        auto start = std::chrono::steady_clock::now();
+        char c;
+        ssize_t n = recv(fd, &c, 1, 0);
+        auto waited = std::chrono::steady_clock::now() - start;
+        close(fd);
+        server.set_idle_timeout_ms(HttpServer::DEFAULT_IDLE_TIMEOUT_MS);
+        check(resp.find("path=/idle") != std::string::npos && n == 0 &&
+              waited < std::chrono::seconds(2),
+              "Idle keep-alive connection closed by the server", failures);
+    }
+
+    // Test 9: Destroying a server with an open connection and a handler still
+    // running waits for the handler, sends its response and closes
+    std::cout << "\nTest 9: Destroy with live connections..." << std::endl;
+    {
+        auto doomed = std::make_unique<HttpServer>([](const HttpRequest&, HttpResponse& response) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            response.send("slow");
+        }, 2);
+        bool listening = doomed->listen(0, "127.0.0.1");
+        int idle_fd = connect_to(doomed->port());
+        int busy_fd = connect_to(doomed->port());
+        std::string req = "GET /slow HTTP/1.1\r\n\r\n";
+        send(busy_fd, req.data(), req.size(), 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        doomed.reset();
+
+        std::string busy = read_until(busy_fd, "\x01never", 1);
+        char c;
+        ssize_t idle_n = recv(idle_fd, &c, 1, 0);
+        close(busy_fd);
+        close(idle_fd);
+        check(listening && busy.find("slow") != std::string::npos && idle_n == 0,
+              "In-flight response delivered and connections closed", failures);
+    }
+
+    // Test 10: Handlers on several workers call setTimeout at once; every
+    // timer joins the owner goroutine's event loop and fires on its thread
+    std::cout << "\nTest 10: Concurrent handlers setting timers..." << std::endl;
+    {
+        std::atomic<int> timer_port{0};
+        auto owner = GoroutineScheduler::instance().spawn([&timer_port] {
+            g_owner_thread = std::this_thread::get_id();
+            g_owner_id = current_goroutine->get_id();
+            g_timer_server = __runtime_http_create_server(reinterpret_cast<void*>(timer_handler));
+            __runtime_http_server_listen(g_timer_server, 0, "127.0.0.1");
+            timer_port = static_cast<HttpServer*>(g_timer_server)->port();
+        });
+        for (int i = 0; i < 500 && timer_port == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        constexpr int CLIENTS = 8;
+        std::vector<std::thread> clients;
+        for (int c = 0; c < CLIENTS; ++c) {
+            clients.emplace_back([&timer_port] {
+                int fd = connect_to(timer_port);
+                std::string req = "GET /timer HTTP/1.1\r\n\r\n";
+                for (int i = 0; i < TIMER_REQUESTS / CLIENTS; ++i) {
+                    send(fd, req.data(), req.size(), 0);
+                    read_until(fd, "ok", 1);
+                }
+                close(fd);
+            });
+        }
+        for (auto& t : clients) t.join();
+
+        for (int i = 0; i < 500 && owner->get_state() != GoroutineState::COMPLETED; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        check(g_timers_set == TIMER_REQUESTS && g_timers_fired == TIMER_REQUESTS && g_timer_faults == 0,
+              "Every handler's timer fired on the owner goroutine", failures);
+        check(owner->get_state() == GoroutineState::COMPLETED,
+              "Owner goroutine finished once its server closed", failures);
+    }
+
+    // Give workers a moment to notice the closed connections
+    for (int i = 0; i < 100 && server.connection_count() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    check(server.connection_count() == 0, "All connections released", failures);
+
+    std::cout << "\n" << (failures == 0 ? "All HTTP server tests passed" : "HTTP server tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+#include "compiler.h"
+#include "lock_system.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+
+using namespace gots;
+
+// Runs X86CodeGen's inlined lock and atomic sequences as real machine code
+// Build: make && g++ -std=c++17 -O2 -pthread test_jit_lock_fastpath.cpp $(ls *.o | grep -v simple_main.o) -o test_jit_lock_fastpath
+
+extern "C" {
+    void __runtime_lock_lock(void* lock_ptr);
+    void __runtime_lock_unlock(void* lock_ptr);
+    void* __runtime_atomic_create(int64_t initial_bits, int64_t padded);
+}
+
+static void* make_executable(const std::vector<uint8_t>& code) {
+    void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memcpy(mem, code.data(), code.size());
+    return mem;
+}
+
+// void critical(Lock* lock, int64_t* counter) { lock.lock(); ++*counter; lock.unlock(); }
+static void* build_critical_section() {
+    X86CodeGen gen;
+    gen.emit_byte(0x53);                        // push rbx
+    gen.emit_byte(0x41); gen.emit_byte(0x54);   // push r12
+    gen.emit_byte(0x41); gen.emit_byte(0x55);   // push r13 (keeps calls 16-byte aligned)
+    gen.emit_mov_reg_reg(3, 7);                 // rbx = lock
+    gen.emit_mov_reg_reg(12, 6);                // r12 = counter
+    gen.emit_lock_acquire(3);
+    gen.emit_byte(0x49); gen.emit_byte(0xFF); gen.emit_byte(0x04); gen.emit_byte(0x24);  // inc qword [r12]
+    gen.emit_lock_release(3);
+    gen.emit_byte(0x41); gen.emit_byte(0x5D);   // pop r13
+    gen.emit_byte(0x41); gen.emit_byte(0x5C);   // pop r12
+    gen.emit_byte(0x5B);                        // pop rbx
+    gen.emit_byte(0xC3);
+    return make_executable(gen.get_code());
+}
+
+int main() {
+    std::cout << "=== Testing JIT lock fast paths ===" << std::endl;
+    int failures = 0;
+
+    auto critical = reinterpret_cast<void (*)(Lock*, int64_t*)>(build_critical_section());
+
+    // Test 1: Inline fast path leaves the Lock in a consistent state
+    std::cout << "\nTest 1: Uncontended..." << std::endl;
+    {
+        Lock lock;
+        int64_t counter = 0;
+        critical(&lock, &counter);
+        check(counter == 1 && !lock.is_locked_by_current() && lock.try_lock(), "Lock free after inline lock/unlock", failures);
+        lock.unlock();
+
+        // Recursion through the runtime slow path, released inline
+        lock.lock();
+        critical(&lock, &counter);
+        check(counter == 2 && lock.is_locked_by_current(), "Recursive inline acquire keeps outer hold", failures);
+        lock.unlock();
+        check(!lock.is_locked_by_current(), "Outer unlock releases", failures);
+    }
+
+    // Test 2: Contended - slow paths park and wake correctly
+    std::cout << "\nTest 2: Contended..." << std::endl;
+    {
+        Lock lock;
+        int64_t counter = 0;
+        const int threads = 8;
+        const int iterations = 200000;
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < iterations; ++i) critical(&lock, &counter);
+            });
+        }
+        for (auto& w : workers) w.join();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << threads * iterations << " critical sections in " << ms << " ms" << std::endl;
+        check(counter == int64_t(threads) * iterations, "No lost increments", failures);
+        check(lock.try_lock(), "Lock free afterwards", failures);
+        lock.unlock();
+    }
+
+    // Test 3: Inline path vs runtime call
+    std::cout << "\nTest 3: Uncontended cost..." << std::endl;
+    {
+        Lock lock;
+        int64_t counter = 0;
+        const int iterations = 2000000;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) critical(&lock, &counter);
+        double inline_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            __runtime_lock_lock(&lock);
+            counter++;
+            __runtime_lock_unlock(&lock);
+        }
+        double call_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+        std::cout << "  inline: " << inline_ns << " ns, runtime calls: " << call_ns << " ns" << std::endl;
+        check(inline_ns < call_ns, "Inline fast path beats the runtime call", failures);
+    }
+
+    // Test 4: Atomic helpers
+    std::cout << "\nTest 4: Atomics..." << std::endl;
+    {
+        X86CodeGen gen;
+        gen.emit_atomic_fetch_add(7, 6, 0);  // rax = fetch_add(rdi, rsi)
+        gen.emit_byte(0xC3);
+        auto fetch_add = reinterpret_cast<int64_t (*)(int64_t*, int64_t)>(make_executable(gen.get_code()));
+
+        X86CodeGen cas_gen;
+        cas_gen.emit_atomic_compare_exchange(7, 6, 2, 0);  // rax = cas(rdi, expected=rsi, desired=rdx)
+        cas_gen.emit_byte(0xC3);
+        auto cas = reinterpret_cast<int64_t (*)(int64_t*, int64_t, int64_t)>(make_executable(cas_gen.get_code()));
+
+        X86CodeGen store_gen;
+        store_gen.emit_atomic_store(7, 6, static_cast<int>(MemoryOrder::SEQ_CST));
+        store_gen.emit_memory_fence(static_cast<int>(MemoryOrder::SEQ_CST));
+        store_gen.emit_atomic_load(7, 0, static_cast<int>(MemoryOrder::ACQUIRE));
+        store_gen.emit_byte(0xC3);
+        auto store_load = reinterpret_cast<int64_t (*)(int64_t*, int64_t)>(make_executable(store_gen.get_code()));
+
+        int64_t value = 40;
+        int64_t old = fetch_add(&value, 2);
+        check(old == 40 && value == 42, "fetch_add returns the previous value", failures);
+        check(cas(&value, 42, 7) == 1 && value == 7, "compare_exchange succeeds on match", failures);
+        check(cas(&value, 42, 9) == 0 && value == 7, "compare_exchange fails on mismatch", failures);
+        check(store_load(&value, 123) == 123 && value == 123, "store/fence/load round-trip", failures);
+
+        std::atomic<int64_t> shared{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < 100000; ++i) fetch_add(reinterpret_cast<int64_t*>(&shared), 1);
+            });
+        }
+        for (auto& w : workers) w.join();
+        check(shared.load() == 400000, "fetch_add is atomic across threads", failures);
+    }
+
+    // Test 5: Atomic<T> exchange, float64 add and padded cells
+    std::cout << "\nTest 5: Atomic<T> support..." << std::endl;
+    {
+        X86CodeGen gen;
+        gen.emit_atomic_exchange(7, 6, 0);
+        gen.emit_byte(0xC3);
+        auto exchange = reinterpret_cast<int64_t (*)(int64_t*, int64_t)>(make_executable(gen.get_code()));
+
+        // double fadd(double* cell, int64_t value) with JIT int64 <-> float64 conversions
+        X86CodeGen fadd_gen;
+        fadd_gen.emit_mov_reg_reg(0, 6);
+        fadd_gen.emit_int64_to_float64_bits(0);
+        fadd_gen.emit_atomic_fetch_add_float64(7, 0, 0);
+        fadd_gen.emit_float64_bits_to_int64(0);
+        fadd_gen.emit_byte(0xC3);
+        auto fadd = reinterpret_cast<int64_t (*)(double*, int64_t)>(make_executable(fadd_gen.get_code()));
+
+        int64_t value = 5;
+        check(exchange(&value, 9) == 5 && value == 9, "exchange swaps and returns the previous value", failures);
+
+        double total = 1.5;
+        check(fadd(&total, 2) == 1 && total == 3.5, "float64 add returns the truncated previous value", failures);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < 50000; ++i) fadd(&total, 1);
+            });
+        }
+        for (auto& w : workers) w.join();
+        check(total == 200003.5, "float64 add is atomic across threads", failures);
+
+        auto* compact = static_cast<int64_t*>(__runtime_atomic_create(7, 0));
+        auto* padded = static_cast<int64_t*>(__runtime_atomic_create(7, 1));
+        check(*compact == 7 && *padded == 7 && reinterpret_cast<uintptr_t>(padded) % 64 == 0,
+              "Padded cells start on a cache line", failures);
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All JIT lock tests passed" : "JIT lock tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include "netpoller.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace gots;
+
+// Standalone test for the shared netpoller over loopback sockets
+// Build: g++ -std=c++17 -O2 -pthread test_netpoller.cpp netpoller.cpp timer_wheel.cpp -o test_netpoller
+
+static ssize_t poll_recv(int fd, char* buf, size_t len) {
+    while (true) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n >= 0 || errno != EAGAIN) return n;
+        PollResult r = NetPoller::instance().wait(NetPoller::instance().open(fd), PollMode::READ);
+        if (r == PollResult::TIMEOUT) { errno = ETIMEDOUT; return -1; }
+        if (r != PollResult::READY) return -1;
+    }
+}
+
+static int poll_accept(int listen_fd) {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0) { NetPoller::instance().open(fd); return fd; }
+        if (errno != EAGAIN) return -1;
+        if (NetPoller::instance().wait(NetPoller::instance().open(listen_fd), PollMode::READ) != PollResult::READY) return -1;
+    }
+}
+
+int main() {
+    std::cout << "=== Testing NetPoller ===" << std::endl;
+    int failures = 0;
+    NetPoller& poller = NetPoller::instance();
+    if (!poller.available()) {
+        std::cout << "✗ epoll unavailable" << std::endl;
+        return 1;
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    socklen_t addr_len = sizeof(addr);
+    getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    listen(listen_fd, 4096);
+    poller.open(listen_fd);
+
+    // Test 1: Parked accept + recv are woken by readiness edges
+    std::cout << "\nTest 1: Parked accept and recv..." << std::endl;
+    {
+        std::string received;
+        std::thread server([&] {
+            int fd = poll_accept(listen_fd);
+            char buf[64];
+            ssize_t n = poll_recv(fd, buf, sizeof(buf));
+            if (n > 0) received.assign(buf, n);
+            poller.close(fd);
+            close(fd);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        connect(client, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        send(client, "hello", 5, 0);
+        server.join();
+        close(client);
+
+        if (received == "hello") {
+            std::cout << "✓ Received \"" << received << "\"" << std::endl;
+        } else {
+            std::cout << "✗ Received \"" << received << "\"" << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 2: Per-socket timeout is driven by the poller's deadline wheel
+    std::cout << "\nTest 2: Read timeout..." << std::endl;
+    {
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        connect(client, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        int fd = poll_accept(listen_fd);
+        poller.open(fd)->timeout_ms.store(100);
+
+        auto start = std::chrono::steady_clock::now();
+        char buf[16];
+        ssize_t n = poll_recv(fd, buf, sizeof(buf));
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (n < 0 && errno == ETIMEDOUT && elapsed >= 100 && elapsed < 1000) {
+            std::cout << "✓ Timed out after " << elapsed << "ms" << std::endl;
+        } else {
+            std::cout << "✗ recv returned " << n << " after " << elapsed << "ms" << std::endl;
+            failures++;
+        }
+        poller.close(fd);
+        close(fd);
+        close(client);
+    }
+
+    // Test 3: Close wakes a parked reader
+    std::cout << "\nTest 3: Close wakes parked reader..." << std::endl;
+    {
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        connect(client, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        int fd = poll_accept(listen_fd);
+        PollResult result = PollResult::READY;
+        std::thread reader([&] {
+            char buf[16];
+            while (recv(fd, buf, sizeof(buf), 0) < 0 && errno == EAGAIN) {
+                result = poller.wait(poller.open(fd), PollMode::READ);
+                if (result != PollResult::READY) break;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        poller.close(fd);
+        reader.join();
+        close(fd);
+        close(client);
+        if (result == PollResult::CLOSED) {
+            std::cout << "✓ Reader woken with CLOSED" << std::endl;
+        } else {
+            std::cout << "✗ Reader result " << static_cast<int>(result) << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 4: Many idle connections cost no threads
+    std::cout << "\nTest 4: Idle connections..." << std::endl;
+    {
+        constexpr int CONNECTIONS = 4000;
+        std::vector<int> clients, servers;
+        for (int i = 0; i < CONNECTIONS; ++i) {
+            int client = socket(AF_INET, SOCK_STREAM, 0);
+            if (client < 0 || connect(client, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) break;
+            clients.push_back(client);
+            int fd = poll_accept(listen_fd);
+            if (fd < 0) break;
+            servers.push_back(fd);
+        }
+        size_t registered = poller.registered_count();
+
+        // Wake exactly one of them
+        char buf[8];
+        send(clients[CONNECTIONS / 2], "x", 1, 0);
+        ssize_t n = poll_recv(servers[CONNECTIONS / 2], buf, sizeof(buf));
+
+        if (servers.size() == CONNECTIONS && registered >= CONNECTIONS && n == 1) {
+            std::cout << "✓ " << registered << " descriptors registered, one woken" << std::endl;
+        } else {
+            std::cout << "✗ " << servers.size() << " accepted, " << registered << " registered" << std::endl;
+            failures++;
+        }
+        for (int fd : servers) { poller.close(fd); close(fd); }
+        for (int fd : clients) close(fd);
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All netpoller tests passed" : "Netpoller tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#include "async_file_io.h"
+#include "goroutine_system.h"
+#include "runtime.h"
+#include "slab_allocator.h"
+#include "test_check.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace gots;
+
+// Tests for the slab allocator behind Promise, timer nodes and async handles
+// Build: make && g++ -std=c++17 -O2 -pthread test_slab_allocator.cpp $(ls *.o | grep -v simple_main.o) -o test_slab_allocator
+
+// Every operator new in the process is counted. Every form is replaced so
+// each allocation and its delete go through the same malloc/free pair.
+static std::atomic<size_t> g_news{0};
+
+static void* counted_allocate(size_t size, size_t alignment) {
+    g_news.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        ptr = std::malloc(size ? size : 1);
+    } else if (posix_memalign(&ptr, alignment, size ? size : 1) != 0) {
+        ptr = nullptr;
+    }
+    return ptr;
+}
+
+// Not inlined into the operator delete bodies, so GCC doesn't pair the
+// free() with the operator new it can see and warn about a mismatch
+__attribute__((noinline)) static void counted_release(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(size_t size) {
+    if (void* ptr = counted_allocate(size, 0)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    if (void* ptr = counted_allocate(size, 0)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* ptr = counted_allocate(size, static_cast<size_t>(alignment))) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* ptr = counted_allocate(size, static_cast<size_t>(alignment))) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, 0); }
+
+void operator delete(void* ptr) noexcept { counted_release(ptr); }
+void operator delete[](void* ptr) noexcept { counted_release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_release(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { counted_release(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { counted_release(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { counted_release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { counted_release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { counted_release(ptr); }
+
+struct Block {
+    int64_t words[6];
+};
+
+struct Counted : RefCounted<Counted> {
+    static std::atomic<int> live;
+    Counted() { live++; }
+    ~Counted() { live--; }
+};
+std::atomic<int> Counted::live{0};
+
+int main() {
+    std::cout << "=== Testing slab allocator ===" << std::endl;
+    int failures = 0;
+
+    // Test 1: Freed blocks are handed out again before new slabs are mapped
+    std::cout << "\nTest 1: Block reuse..." << std::endl;
+    {
+        std::vector<void*> blocks;
+        std::set<void*> distinct;
+        for (int i = 0; i < 5000; ++i) {
+            blocks.push_back(SlabAllocator<Block>::allocate());
+            distinct.insert(blocks.back());
+        }
+        check(distinct.size() == blocks.size(), "Live blocks are distinct", failures);
+        size_t slabs = SlabAllocator<Block>::slab_count();
+        for (int round = 0; round < 10; ++round) {
+            for (void* block : blocks) SlabAllocator<Block>::deallocate(block);
+            for (void*& block : blocks) block = SlabAllocator<Block>::allocate();
+        }
+        check(SlabAllocator<Block>::slab_count() == slabs,
+              "No slab mapped while recycling (" + std::to_string(slabs) + " slabs)", failures);
+        for (void* block : blocks) SlabAllocator<Block>::deallocate(block);
+    }
+
+    // Test 2: Objects freed on another thread, and by threads that exit,
+    // return to the pool
+    std::cout << "\nTest 2: Cross-thread frees..." << std::endl;
+    {
+        size_t slabs = 0;
+        for (int round = 0; round < 20; ++round) {
+            std::vector<Ref<Counted>> refs;
+            std::thread([&refs] {
+                for (int i = 0; i < 2000; ++i) refs.push_back(make_ref<Counted>());
+            }).join();
+            std::vector<Ref<Counted>> copies = refs;
+            std::thread([&refs] { refs.clear(); }).join();
+            copies.clear();
+            if (round == 1) slabs = SlabAllocator<Counted>::slab_count();
+        }
+        check(Counted::live.load() == 0, "The last reference destroys the object", failures);
+        check(SlabAllocator<Counted>::slab_count() == slabs, "Blocks freed on other threads are reused", failures);
+    }
+
+    // Test 3: Create, resolve from another thread and await - no malloc
+    std::cout << "\nTest 3: Promise round trip without malloc..." << std::endl;
+    {
+        constexpr int ROUNDS = 10000;
+        std::atomic<Promise*> handoff{nullptr};
+        std::atomic<bool> stop{false};
+        std::thread resolver([&] {
+            while (!stop.load()) {
+                Promise* promise = handoff.exchange(nullptr);
+                if (!promise) continue;
+                PromiseRef ref = PromiseRef::adopt(promise);
+                ref->resolve(static_cast<int64_t>(ref->ref_count()));
+            }
+        });
+        auto round_trip = [&](int64_t& sum) {
+            PromiseRef promise = make_ref<Promise>();
+            promise->retain();
+            handoff.store(promise.get());
+            promise->wait();
+            sum += promise->await<int64_t>();
+        };
+        int64_t sum = 0;
+        for (int i = 0; i < 100; ++i) round_trip(sum);
+        size_t before = g_news.load();
+        for (int i = 0; i < ROUNDS; ++i) round_trip(sum);
+        size_t news = g_news.load() - before;
+        stop = true;
+        resolver.join();
+        check(news == 0, std::to_string(news) + " allocations in " + std::to_string(ROUNDS) + " round trips", failures);
+        check(sum == 2 * (ROUNDS + 100), "Every promise resolved with its value", failures);
+    }
+
+    // Test 4: Timers and async handles reuse their slab entries
+    std::cout << "\nTest 4: Timers and async handles without malloc..." << std::endl;
+    {
+        auto goroutine = std::make_shared<Goroutine>(1 << 20, [] {});
+        auto cycle = [&] {
+            int64_t a = goroutine->add_timer(1000, nullptr, false);
+            int64_t b = goroutine->add_timer(5, nullptr, true);
+            int64_t handle = goroutine->add_async_operation(AsyncOpType::CUSTOM_HANDLE);
+            bool cancelled = goroutine->cancel_timer(b) && goroutine->cancel_timer(a);
+            goroutine->complete_async_operation(handle);
+            return cancelled && !goroutine->has_active_operations();
+        };
+        bool ok = true;
+        for (int i = 0; i < 100; ++i) ok = cycle() && ok;
+        size_t before = g_news.load();
+        for (int i = 0; i < 10000; ++i) ok = cycle() && ok;
+        size_t news = g_news.load() - before;
+        check(ok, "Timers cancel and handles complete", failures);
+        check(news == 0, std::to_string(news) + " allocations in 10000 timer and handle cycles", failures);
+    }
+
+    // Test 5: An async read - request, promise and completion - does not
+    // malloc either
+    std::cout << "\nTest 5: Async file read without malloc..." << std::endl;
+    {
+        AsyncFileIO& io = AsyncFileIO::instance();
+        int fd = static_cast<int>(AsyncFileIO::await_result(io.open("/dev/zero", O_RDONLY, 0)));
+        char buf[64];
+        bool ok = fd >= 0;
+        for (int i = 0; i < 100; ++i) ok = AsyncFileIO::await_result(io.read(fd, buf, sizeof(buf))) == sizeof(buf) && ok;
+        size_t before = g_news.load();
+        for (int i = 0; i < 1000; ++i) ok = AsyncFileIO::await_result(io.read(fd, buf, sizeof(buf))) == sizeof(buf) && ok;
+        size_t news = g_news.load() - before;
+        AsyncFileIO::await_result(io.close(fd));
+        check(ok, "Reads completed", failures);
+        if (io.using_io_uring()) {
+            check(news == 0, std::to_string(news) + " allocations in 1000 reads", failures);
+        } else {
+            std::cout << "  (thread pool backend allocates its tasks - " << news << " allocations)" << std::endl;
+        }
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All slab allocator tests passed" : "Slab allocator tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include "compiler.h"
+#include "lock_system.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+
+using namespace gots;
+
+// Tests for WaitGroup, Semaphore, RWLock and Barrier, including the JIT fast paths
+// Build: make && g++ -std=c++17 -O2 -pthread test_sync_primitives.cpp $(ls *.o | grep -v simple_main.o) -o test_sync_primitives
+
+static void* make_executable(const std::vector<uint8_t>& code) {
+    void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memcpy(mem, code.data(), code.size());
+    return mem;
+}
+
+// Wraps a single emitted operation on RDI (and RSI) in push/pop rbx so calls stay aligned
+template <typename Emit>
+static void* build(Emit emit) {
+    X86CodeGen gen;
+    gen.emit_byte(0x53);  // push rbx
+    emit(gen);
+    gen.emit_byte(0x5B);  // pop rbx
+    gen.emit_byte(0xC3);
+    return make_executable(gen.get_code());
+}
+
+int main() {
+    std::cout << "=== Testing sync primitives ===" << std::endl;
+    int failures = 0;
+
+    auto jit_wg_add = reinterpret_cast<void (*)(WaitGroup*, int64_t)>(
+        build([](X86CodeGen& gen) { gen.emit_waitgroup_add(7, 6); }));
+    auto jit_sem_acquire = reinterpret_cast<void (*)(Semaphore*)>(
+        build([](X86CodeGen& gen) { gen.emit_semaphore_acquire(7); }));
+    auto jit_sem_release = reinterpret_cast<void (*)(Semaphore*)>(
+        build([](X86CodeGen& gen) { gen.emit_semaphore_release(7); }));
+
+    // Test 1: WaitGroup fan-in through the inline add/done
+    std::cout << "\nTest 1: WaitGroup..." << std::endl;
+    {
+        WaitGroup wg;
+        const int workers = 16;
+        std::atomic<int> finished{0};
+        jit_wg_add(&wg, workers);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < workers; ++i) {
+            threads.emplace_back([&, i]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5 + i));
+                finished++;
+                jit_wg_add(&wg, -1);
+            });
+        }
+        wg.wait();
+        check(finished.load() == workers && wg.count() == 0, "wait() returns after every done()", failures);
+        for (auto& t : threads) t.join();
+
+        check(wg.wait_for(std::chrono::milliseconds(1)), "wait() on a zero count returns at once", failures);
+        wg.add(1);
+        check(!wg.wait_for(std::chrono::milliseconds(20)), "wait_for() times out while work is outstanding", failures);
+        wg.done();
+
+        bool threw = false;
+        try { wg.done(); } catch (const std::runtime_error&) { threw = true; }
+        check(threw, "done() past zero is reported", failures);
+    }
+
+    // Test 2: Semaphore bounds concurrency
+    std::cout << "\nTest 2: Semaphore..." << std::endl;
+    {
+        Semaphore sem(3);
+        std::atomic<int> inside{0};
+        std::atomic<int> peak{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 12; ++i) {
+            threads.emplace_back([&]() {
+                for (int round = 0; round < 200; ++round) {
+                    jit_sem_acquire(&sem);
+                    int now = inside.fetch_add(1) + 1;
+                    int seen = peak.load();
+                    while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+                    std::this_thread::yield();
+                    inside.fetch_sub(1);
+                    jit_sem_release(&sem);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        check(peak.load() <= 3 && peak.load() > 0, "At most 3 holders at once (peak " + std::to_string(peak.load()) + ")", failures);
+        check(sem.available() == 3, "All permits returned", failures);
+
+        Semaphore empty(0);
+        auto start = std::chrono::steady_clock::now();
+        bool got = empty.try_acquire_for(std::chrono::milliseconds(30));
+        double waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        check(!got && waited >= 25, "try_acquire_for() times out with no permits", failures);
+    }
+
+    // Test 3: RWLock excludes writers from readers and from each other
+    std::cout << "\nTest 3: RWLock..." << std::endl;
+    {
+        RWLock rw;
+        int64_t a = 0, b = 0;  // Writers keep a == b
+        std::atomic<bool> torn{false};
+        std::atomic<bool> stop{false};
+        std::atomic<int64_t> reads{0};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 6; ++i) {
+            readers.emplace_back([&]() {
+                while (!stop) {
+                    rw.read_lock();
+                    if (a != b) torn = true;
+                    rw.read_unlock();
+                    reads++;
+                }
+            });
+        }
+        std::vector<std::thread> writers;
+        for (int i = 0; i < 2; ++i) {
+            writers.emplace_back([&]() {
+                for (int n = 0; n < 2000; ++n) {
+                    rw.write_lock();
+                    a++;
+                    b++;
+                    rw.write_unlock();
+                }
+            });
+        }
+        for (auto& w : writers) w.join();
+        stop = true;
+        for (auto& r : readers) r.join();
+        check(!torn && a == 4000 && b == 4000, "Readers never observe a half-done write", failures);
+        std::cout << "  " << reads.load() << " reads alongside 4000 writes" << std::endl;
+
+        rw.read_lock();
+        bool writer_blocked = false;
+        std::thread([&]() { writer_blocked = !rw.try_write_lock(); }).join();
+        rw.read_unlock();
+        check(writer_blocked, "try_write_lock() fails while a reader holds the lock", failures);
+
+        // A waiting writer turns new readers away
+        rw.read_lock();
+        std::atomic<bool> writer_done{false};
+        std::thread writer([&]() { rw.write_lock(); writer_done = true; rw.write_unlock(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bool new_reader_got_in = false;
+        std::thread([&]() {
+            new_reader_got_in = rw.try_read_lock();
+            if (new_reader_got_in) rw.read_unlock();
+        }).join();
+        rw.read_unlock();
+        writer.join();
+        check(!new_reader_got_in && writer_done, "Pending writer takes precedence over new readers", failures);
+    }
+
+    // Test 4: Barrier phases
+    std::cout << "\nTest 4: Barrier..." << std::endl;
+    {
+        const int parties = 8;
+        const int phases = 200;
+        Barrier barrier(parties);
+        std::atomic<int> arrivals[phases];
+        for (auto& count : arrivals) count = 0;
+        std::atomic<int> serial{0};
+        std::atomic<bool> out_of_phase{false};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < parties; ++i) {
+            threads.emplace_back([&]() {
+                for (int phase = 0; phase < phases; ++phase) {
+                    arrivals[phase]++;
+                    if (barrier.wait()) serial++;
+                    // Everyone has arrived for this phase once released
+                    if (arrivals[phase].load() != parties) out_of_phase = true;
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        check(!out_of_phase, "No party passes before all arrive", failures);
+        check(serial.load() == phases, "Exactly one serial party per phase", failures);
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All sync primitive tests passed" : "Sync primitive tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include "timer_wheel.h"
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace gots;
+
+// Standalone test for the hierarchical timer wheel
+// Build: g++ -std=c++17 -O2 test_timer_wheel.cpp timer_wheel.cpp -o test_timer_wheel
+int main() {
+    std::cout << "=== Testing TimerWheel ===" << std::endl;
+    int failures = 0;
+    auto start = TimerWheel::clock::now();
+
+    // Test 1: Timers across every level fire in order and never early
+    std::cout << "\nTest 1: Expiry order across levels..." << std::endl;
+    {
+        TimerWheel wheel;
+        std::vector<int64_t> delays = {0, 1, 5, 255, 256, 300, 65535, 65536, 70000, 16777216, 20000000};
+        std::vector<std::unique_ptr<TimerNode>> nodes;
+        for (size_t i = 0; i < delays.size(); ++i) {
+            nodes.push_back(std::make_unique<TimerNode>());
+            nodes.back()->id = static_cast<int64_t>(i);
+            wheel.schedule(nodes.back().get(), delays[i]);
+        }
+
+        // Simulate time passing without sleeping
+        std::vector<TimerNode*> expired;
+        int64_t last_expired = -1;
+        for (int64_t ms = 0; ms <= 20100000 && !wheel.empty(); ms += 1 + ms / 1000) {
+            size_t before = expired.size();
+            wheel.advance(start + std::chrono::milliseconds(ms + 1), expired);
+            for (size_t i = before; i < expired.size(); ++i) {
+                int64_t delay = delays[expired[i]->id];
+                if (delay > ms + 1 || expired[i]->id < last_expired) {
+                    std::cout << "✗ Timer " << expired[i]->id << " fired at " << ms << "ms" << std::endl;
+                    failures++;
+                }
+                last_expired = expired[i]->id;
+            }
+            // Wake-up hint must never lag behind the wheel
+            if (!wheel.empty() && wheel.next_wake_time() < start + std::chrono::milliseconds(ms)) {
+                std::cout << "✗ next_wake_time is in the past at " << ms << "ms" << std::endl;
+                failures++;
+                break;
+            }
+        }
+        if (expired.size() == delays.size()) {
+            std::cout << "✓ All " << expired.size() << " timers fired in order" << std::endl;
+        } else {
+            std::cout << "✗ Only " << expired.size() << " of " << delays.size() << " timers fired" << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 2: O(1) cancellation of many timers
+    std::cout << "\nTest 2: Cancel 50k timers..." << std::endl;
+    {
+        TimerWheel wheel;
+        std::mt19937 rng(42);
+        std::vector<std::unique_ptr<TimerNode>> nodes(50000);
+        for (auto& node : nodes) {
+            node = std::make_unique<TimerNode>();
+            wheel.schedule(node.get(), rng() % 120000);
+        }
+
+        auto cancel_start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < nodes.size(); i += 2) {
+            wheel.cancel(nodes[i].get());
+        }
+        auto cancel_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - cancel_start).count();
+
+        std::vector<TimerNode*> expired;
+        wheel.advance(start + std::chrono::milliseconds(200000), expired);
+        if (expired.size() == 25000 && wheel.empty()) {
+            std::cout << "✓ 25000 cancelled in " << cancel_us << "us, 25000 fired" << std::endl;
+        } else {
+            std::cout << "✗ Expected 25000 fired, got " << expired.size() << std::endl;
+            failures++;
+        }
+    }
+
+    // Test 3: Slack coalesces nearby expiries into one tick
+    std::cout << "\nTest 3: Timer slack..." << std::endl;
+    {
+        TimerWheel wheel;
+        wheel.set_slack(50);
+        TimerNode a, b;
+        wheel.schedule(&a, 1001);
+        wheel.schedule(&b, 1037);
+        if (a.expires_tick == b.expires_tick && a.expires_tick % 50 == 0) {
+            std::cout << "✓ Coalesced to tick " << a.expires_tick << std::endl;
+        } else {
+            std::cout << "✗ Not coalesced: " << a.expires_tick << " vs " << b.expires_tick << std::endl;
+            failures++;
+        }
+        wheel.cancel(&a);
+        wheel.cancel(&b);
+    }
+
+    // Test 4: Real time wake-up
+    std::cout << "\nTest 4: Real time wake-up..." << std::endl;
+    {
+        TimerWheel wheel;
+        TimerNode node;
+        auto scheduled = TimerWheel::clock::now();
+        wheel.schedule(&node, 20);
+        std::this_thread::sleep_until(wheel.next_wake_time());
+        std::vector<TimerNode*> expired;
+        wheel.advance(TimerWheel::clock::now(), expired);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            TimerWheel::clock::now() - scheduled).count();
+        if (expired.size() == 1 && elapsed >= 20) {
+            std::cout << "✓ Fired after " << elapsed << "ms" << std::endl;
+        } else {
+            std::cout << "✗ Fired " << expired.size() << " timers after " << elapsed << "ms" << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << "\n" << (failures == 0 ? "All timer wheel tests passed" : "Timer wheel tests FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#include "timer_wheel.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace gots {
+
+static uint64_t default_timer_slack() {
+    static const uint64_t slack = [] {
+        const char* value = std::getenv("GOTS_TIMER_SLACK_MS");
+        if (!value) return uint64_t(0);
+        long long parsed = std::atoll(value);
+        return parsed > 0 ? static_cast<uint64_t>(parsed) : uint64_t(0);
+    }();
+    return slack;
+}
+
+TimerWheel::TimerWheel() : origin_(clock::now()), slack_ticks_(default_timer_slack()) {
+}
+
+uint64_t TimerWheel::tick_for(clock::time_point t) const {
+    if (t <= origin_) return 0;
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(t - origin_).count());
+}
+
+void TimerWheel::schedule(TimerNode* node, int64_t delay_ms) {
+    if (node->is_scheduled()) {
+        unlink(node);
+    }
+
+    uint64_t delay = delay_ms > 0 ? static_cast<uint64_t>(delay_ms) : 0;
+    delay = std::min(delay, MAX_DELAY_TICKS);
+
+    // Round the start up to the next whole tick so timers never fire early
+    auto since_origin = clock::now() - origin_;
+    uint64_t now_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(since_origin).count());
+    uint64_t expires = (now_ns + 999999) / 1000000 + delay;
+
+    // Coalesce with neighbouring timers within the allowed slack
+    uint64_t slack = std::min(slack_ticks_, delay / 8);
+    if (slack > 1) {
+        expires = ((expires + slack - 1) / slack) * slack;
+    }
+
+    node->expires_tick = expires;
+    insert(node);
+}
+
+void TimerWheel::cancel(TimerNode* node) {
+    if (node->is_scheduled()) {
+        unlink(node);
+    }
+}
+
+void TimerWheel::insert(TimerNode* node) {
+    // Overdue timers fire on the next processed tick
+    uint64_t expires = std::max(node->expires_tick, current_tick_);
+    uint64_t delta = std::min(expires - current_tick_, MAX_DELAY_TICKS);
+    expires = current_tick_ + delta;
+
+    size_t level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    size_t index = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+
+    TimerNode& head = levels_[level][index].head;
+    node->level = static_cast<uint8_t>(level);
+    node->prev = head.prev;
+    node->next = &head;
+    head.prev->next = node;
+    head.prev = node;
+
+    level_counts_[level]++;
+    count_++;
+}
+
+void TimerWheel::unlink(TimerNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+
+    level_counts_[node->level]--;
+    count_--;
+}
+
+void TimerWheel::cascade(size_t level, size_t index) {
+    TimerNode& head = levels_[level][index].head;
+    while (head.next != &head) {
+        TimerNode* node = head.next;
+        unlink(node);
+        insert(node);
+    }
+}
+
+void TimerWheel::advance(clock::time_point now, std::vector<TimerNode*>& expired) {
+    uint64_t target = tick_for(now);
+
+    while (current_tick_ <= target) {
+        if (count_ == 0) {
+            current_tick_ = target + 1;
+            break;
+        }
+
+        // Jump over ticks where nothing can expire or cascade
+        size_t empty_levels = 0;
+        while (level_counts_[empty_levels] == 0) {
+            empty_levels++;
+        }
+        if (empty_levels > 0) {
+            uint64_t span_mask = (uint64_t(1) << (SLOT_BITS * empty_levels)) - 1;
+            if (current_tick_ & span_mask) {
+                current_tick_ = std::min((current_tick_ | span_mask) + 1, target + 1);
+                continue;
+            }
+        }
+
+        size_t index = current_tick_ & SLOT_MASK;
+        if (index == 0) {
+            // Level 0 wrapped - pull the next slot of each outer level down
+            for (size_t level = 1; level < LEVELS; ++level) {
+                size_t level_index = (current_tick_ >> (SLOT_BITS * level)) & SLOT_MASK;
+                cascade(level, level_index);
+                if (level_index != 0) break;
+            }
+        }
+
+        TimerNode& head = levels_[0][index].head;
+        while (head.next != &head) {
+            TimerNode* node = head.next;
+            unlink(node);
+            expired.push_back(node);
+        }
+
+        current_tick_++;
+    }
+}
+
+TimerWheel::clock::time_point TimerWheel::next_wake_time() const {
+    uint64_t wake_tick = current_tick_ + MAX_DELAY_TICKS;
+
+    // Level 0 holds everything due in the next 256 ticks - find it exactly
+    if (level_counts_[0] > 0) {
+        for (uint64_t tick = current_tick_; tick < current_tick_ + SLOTS; ++tick) {
+            const TimerNode& head = levels_[0][tick & SLOT_MASK].head;
+            if (head.next != &head) {
+                wake_tick = tick;
+                break;
+            }
+        }
+    }
+
+    // Outer levels only need a wake-up when their next occupied slot cascades
+    for (size_t level = 1; level < LEVELS; ++level) {
+        if (level_counts_[level] == 0) continue;
+
+        uint64_t span = uint64_t(1) << (SLOT_BITS * level);
+        uint64_t boundary = (current_tick_ + span - 1) & ~(span - 1);
+        for (size_t i = 0; i < SLOTS && boundary < wake_tick; ++i, boundary += span) {
+            const TimerNode& head = levels_[level][(boundary >> (SLOT_BITS * level)) & SLOT_MASK].head;
+            if (head.next != &head) {
+                wake_tick = boundary;
+                break;
+            }
+        }
+    }
+
+    return origin_ + std::chrono::milliseconds(wake_tick);
+}
+
+} // namespace gots
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gots {
+
+// ============================================================================
+// HIERARCHICAL TIMER WHEEL - O(1) schedule and cancel
+// ============================================================================
+//
+// Four levels of 256 slots at 1ms resolution cover ~49 days; longer delays
+// are clamped. Timer nodes are intrusive, so cancelling a timer is a
+// doubly-linked-list unlink with no searching and no heap rebuild. Timers
+// parked on the outer levels cascade down as the wheel turns.
+//
+// The wheel is NOT thread safe - the owning Goroutine guards it with its
+// event loop mutex.
+
+struct TimerNode {
+    int64_t id = 0;
+    uint64_t expires_tick = 0;
+    void* function_address = nullptr;  // Use address as stable ID, not function pointer
+    bool is_interval = false;
+    int64_t interval_ms = 0;
+
+    // Intrusive wheel linkage (nullptr when the node is not scheduled)
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    uint8_t level = 0;
+
+    bool is_scheduled() const { return next != nullptr; }
+};
+
+class TimerWheel {
+public:
+    static constexpr unsigned SLOT_BITS = 8;
+    static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr size_t LEVELS = 4;
+    static constexpr uint64_t MAX_DELAY_TICKS = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    using clock = std::chrono::steady_clock;
+
+    TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Coalescing slack in ticks (ms). Expiry times are rounded up to a
+    // multiple of the slack so nearby timers fire in one wake-up. The slack
+    // applied to a timer never exceeds 1/8 of its delay, so short timers keep
+    // their precision. Defaults to GOTS_TIMER_SLACK_MS or 0 (no coalescing).
+    void set_slack(uint64_t slack_ticks) { slack_ticks_ = slack_ticks; }
+    uint64_t get_slack() const { return slack_ticks_; }
+
+    // Schedule a node to expire delay_ms from now
+    void schedule(TimerNode* node, int64_t delay_ms);
+
+    // Unlink a scheduled node - O(1)
+    void cancel(TimerNode* node);
+
+    // Advance the wheel to `now`, appending every expired node (already
+    // unlinked) to `expired` in expiry order
+    void advance(clock::time_point now, std::vector<TimerNode*>& expired);
+
+    // Earliest time the wheel needs to be advanced again. Exact for timers
+    // due within the next 256ms, otherwise the next cascade point. Only valid
+    // when !empty().
+    clock::time_point next_wake_time() const;
+
+    bool empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+
+private:
+    // Sentinel list head per slot
+    struct Slot {
+        TimerNode head;
+        Slot() { head.prev = head.next = &head; }
+    };
+
+    std::array<std::array<Slot, SLOTS>, LEVELS> levels_;
+    std::array<size_t, LEVELS> level_counts_{};
+    size_t count_ = 0;
+
+    clock::time_point origin_;
+    uint64_t current_tick_ = 0;  // Next tick that has not been processed yet
+    uint64_t slack_ticks_ = 0;
+
+    uint64_t tick_for(clock::time_point t) const;
+    void insert(TimerNode* node);
+    void unlink(TimerNode* node);
+    void cascade(size_t level, size_t index);
+};
+
+} // namespace gots
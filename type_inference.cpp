@@ -384,6 +384,7 @@ DataType TypeInference::get_variable_type(const std::string& name) {
 
 void TypeInference::set_variable_offset(const std::string& name, int64_t offset) {
     variable_offsets[name] = offset;
+    frame_slots[offset] = name;
 }
 
 int64_t TypeInference::get_variable_offset(const std::string& name) {
@@ -401,6 +402,7 @@ int64_t TypeInference::allocate_variable(const std::string& name, DataType type)
     if (it != variable_offsets.end()) {
         // Variable already allocated, just update type
         variable_types[name] = type;
+        frame_slots[it->second] = name;
         return it->second;
     }
     
@@ -410,9 +412,48 @@ int64_t TypeInference::allocate_variable(const std::string& name, DataType type)
     
     variable_offsets[name] = offset;
     variable_types[name] = type;
+    frame_slots[offset] = name;
     return offset;
 }
 
+void TypeInference::begin_frame() {
+    frame_slots.clear();
+}
+
+std::vector<int32_t> TypeInference::get_reference_slots() const {
+    std::vector<int32_t> slots;
+    for (const auto& slot : frame_slots) {
+        auto it = variable_types.find(slot.second);
+        if (it == variable_types.end()) continue;
+        switch (it->second) {
+            case DataType::STRING:
+            case DataType::REGEX:
+            case DataType::PROMISE:
+            case DataType::ARRAY:
+            case DataType::CLASS_INSTANCE:
+                slots.push_back(static_cast<int32_t>(slot.first));
+                break;
+            default:
+                // Numbers and untyped values are never treated as references
+                break;
+        }
+    }
+    return slots;
+}
+
+bool TypeInference::is_scalar_type(DataType type) {
+    switch (type) {
+        case DataType::VOID:
+        case DataType::INT8: case DataType::INT16: case DataType::INT32: case DataType::INT64:
+        case DataType::UINT8: case DataType::UINT16: case DataType::UINT32: case DataType::UINT64:
+        case DataType::FLOAT32: case DataType::FLOAT64:
+        case DataType::BOOLEAN:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void TypeInference::enter_scope() {
     // For now, we don't implement nested scopes - just track current offset
 }
@@ -420,10 +420,44 @@ void WasmCodeGen::emit_lock_acquire(int lock_id) { (void)lock_id; }
 void WasmCodeGen::emit_lock_release(int lock_id) { (void)lock_id; }
 void WasmCodeGen::emit_lock_try_acquire(int lock_id, int result_reg) { (void)lock_id; (void)result_reg; }
 void WasmCodeGen::emit_lock_try_acquire_timeout(int lock_id, int timeout_reg, int result_reg) { (void)lock_id; (void)timeout_reg; (void)result_reg; }
+void WasmCodeGen::emit_waitgroup_add(int wg_reg, int delta_reg) { (void)wg_reg; (void)delta_reg; }
+void WasmCodeGen::emit_semaphore_acquire(int sem_reg) { (void)sem_reg; }
+void WasmCodeGen::emit_semaphore_release(int sem_reg) { (void)sem_reg; }
 void WasmCodeGen::emit_atomic_compare_exchange(int ptr_reg, int expected_reg, int desired_reg, int result_reg) { (void)ptr_reg; (void)expected_reg; (void)desired_reg; (void)result_reg; }
 void WasmCodeGen::emit_atomic_fetch_add(int ptr_reg, int value_reg, int result_reg) { (void)ptr_reg; (void)value_reg; (void)result_reg; }
 void WasmCodeGen::emit_atomic_store(int ptr_reg, int value_reg, int ordering) { (void)ptr_reg; (void)value_reg; (void)ordering; }
 void WasmCodeGen::emit_atomic_load(int ptr_reg, int result_reg, int ordering) { (void)ptr_reg; (void)result_reg; (void)ordering; }
 void WasmCodeGen::emit_memory_fence(int fence_type) { (void)fence_type; }
+void WasmCodeGen::emit_atomic_exchange(int ptr_reg, int value_reg, int result_reg) { (void)ptr_reg; (void)value_reg; (void)result_reg; }
+void WasmCodeGen::emit_atomic_fetch_add_float64(int ptr_reg, int value_reg, int result_reg) { (void)ptr_reg; (void)value_reg; (void)result_reg; }
+void WasmCodeGen::emit_int64_to_float64_bits(int reg) { (void)reg; }
+void WasmCodeGen::emit_float64_bits_to_int64(int reg) { (void)reg; }
+
+// No inline TLAB bump in WebAssembly - go through the runtime
+void WasmCodeGen::emit_gc_allocate(size_t payload_size, uint32_t type_id) {
+    emit_mov_reg_imm(7, static_cast<int64_t>(payload_size));
+    emit_mov_reg_imm(6, type_id);
+    emit_mov_reg_imm(2, 0);  // No allocation site - not profiled
+    emit_call("__gc_alloc_slow");
+}
+
+void WasmCodeGen::emit_object_create(const char* class_name, int64_t property_count) {
+    emit_mov_reg_imm(7, reinterpret_cast<int64_t>(class_name));
+    emit_mov_reg_imm(6, property_count);
+    emit_call("__object_create");
+}
+
+// WebAssembly modules do not share the native collector, which is the only
+// one that marks concurrently
+void WasmCodeGen::emit_gc_pre_write_barrier(int object_reg, int32_t field_offset) {
+    (void)object_reg;
+    (void)field_offset;
+}
+
+void WasmCodeGen::emit_object_set_property(int64_t property_index, bool card_mark) {
+    (void)property_index;
+    (void)card_mark;
+    emit_call("__object_set_property");
+}
 
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "compiler.h"
 #include "runtime.h"
+#include "lock_system.h"
+#include "gc_memory_manager.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
@@ -28,6 +30,15 @@ enum X86Register {
 };
 
 void X86CodeGen::emit_prologue() {
+    // Functions are labelled right before their prologue - a user-visible
+    // name is preferred over an internal alias at the same offset
+    const std::string* name = nullptr;
+    for (const auto& label : label_offsets) {
+        if (static_cast<size_t>(label.second) != code.size()) continue;
+        if (!name || (name->compare(0, 2, "__") == 0 && label.first.compare(0, 2, "__") != 0)) name = &label.first;
+    }
+    if (name) function_symbols.push_back({code.size(), *name});
+
     code.push_back(0x55);  // push rbp
     emit_mov_reg_reg(RBP, RSP);  // mov rbp, rsp
     
@@ -266,6 +277,54 @@ extern "C" {
     extern void* __simple_array_slice(void* array, int64_t start, int64_t end, int64_t step);
     extern void* __simple_array_slice_all(void* array);
     extern const char* __dynamic_method_toString(void* obj);
+    extern void* __runtime_weak_ref(void* target);
+    extern void* __runtime_weak_deref(void* ref);
+    extern void* __runtime_weak_map();
+    extern void* __runtime_weak_get(void* map, void* key);
+    extern void __runtime_weak_set(void* map, void* key, void* value);
+    extern bool __runtime_weak_has(void* map, void* key);
+    extern bool __runtime_weak_remove(void* map, void* key);
+    extern int64_t __runtime_weak_size(void* map);
+    extern void* __runtime_weak_registry(void* callback);
+    extern void __runtime_weak_register(void* registry, void* target, void* held, void* token);
+    extern bool __runtime_weak_unregister(void* registry, void* token);
+    extern void* __runtime_lock_create();
+    extern void* __runtime_lock_create_at(const char* site);
+    extern void __runtime_lock_lock(void* lock_ptr);
+    extern void __runtime_lock_unlock(void* lock_ptr);
+    extern void __runtime_lock_unlock_contended(void* lock_ptr);
+    extern bool __runtime_lock_try_lock(void* lock_ptr);
+    extern bool __runtime_lock_try_lock_for(void* lock_ptr, int64_t timeout_ms);
+    extern bool __runtime_lock_is_locked_by_current(void* lock_ptr);
+    extern void* __runtime_atomic_create(int64_t initial_bits, int64_t padded);
+    extern void* __runtime_waitgroup_create();
+    extern void __runtime_waitgroup_add(void* wg_ptr, int64_t delta);
+    extern void __runtime_waitgroup_settle(void* wg_ptr);
+    extern void __runtime_waitgroup_wait(void* wg_ptr);
+    extern void* __runtime_semaphore_create(int64_t permits);
+    extern void __runtime_semaphore_acquire(void* sem_ptr);
+    extern bool __runtime_semaphore_try_acquire(void* sem_ptr);
+    extern bool __runtime_semaphore_try_acquire_for(void* sem_ptr, int64_t timeout_ms);
+    extern void __runtime_semaphore_release(void* sem_ptr);
+    extern void __runtime_semaphore_wake(void* sem_ptr);
+    extern void* __runtime_rwlock_create();
+    extern void __runtime_rwlock_read_lock(void* rw_ptr);
+    extern void __runtime_rwlock_read_unlock(void* rw_ptr);
+    extern bool __runtime_rwlock_try_read_lock(void* rw_ptr);
+    extern void __runtime_rwlock_write_lock(void* rw_ptr);
+    extern void __runtime_rwlock_write_unlock(void* rw_ptr);
+    extern bool __runtime_rwlock_try_write_lock(void* rw_ptr);
+    extern void* __runtime_barrier_create(int64_t parties);
+    extern bool __runtime_barrier_wait(void* barrier_ptr);
+    extern void __runtime_gc_collect();
+    extern int64_t __runtime_gc_heap_size();
+    extern int64_t __runtime_gc_heap_used();
+    extern void* __runtime_gc_stats();
+    extern int64_t __runtime_gc_next_gc();
+    extern int64_t __runtime_gc_set_memory_limit(int64_t bytes);
+    extern int64_t __runtime_gc_write_heap_snapshot(const char* path);
+    extern int64_t __runtime_gc_set_heap_profile_rate(int64_t bytes);
+    extern int64_t __runtime_gc_write_heap_profile(const char* path);
 }
 
 static void initialize_runtime_function_table() {
@@ -302,9 +361,30 @@ static void initialize_runtime_function_table() {
     g_runtime_function_table["__array_create"] = (void*)__array_create;
     g_runtime_function_table["__string_create"] = (void*)__string_create;
     g_runtime_function_table["__string_intern"] = (void*)__string_intern;
+    g_runtime_function_table["__string_create_empty"] = (void*)__string_create_empty;
     g_runtime_function_table["__lookup_function_fast"] = (void*)__lookup_function_fast;
     g_runtime_function_table["__get_executable_memory_base"] = (void*)__get_executable_memory_base;
     
+    // GC heap objects
+    g_runtime_function_table["__gc_alloc_slow"] = (void*)__gc_alloc_slow;
+    g_runtime_function_table["__gc_satb_enqueue"] = (void*)__gc_satb_enqueue;
+    g_runtime_function_table["__gc_publish"] = (void*)__gc_publish;
+    g_runtime_function_table["__object_create"] = (void*)__object_create;
+    g_runtime_function_table["__object_set_property"] = (void*)__object_set_property;
+    g_runtime_function_table["__object_get_property"] = (void*)__object_get_property;
+    g_runtime_function_table["__object_set_property_name"] = (void*)__object_set_property_name;
+    g_runtime_function_table["__object_get_property_name"] = (void*)__object_get_property_name;
+    g_runtime_function_table["__dynamic_get_property"] = (void*)__dynamic_get_property;
+    g_runtime_function_table["__runtime_gc_collect"] = (void*)__runtime_gc_collect;
+    g_runtime_function_table["__runtime_gc_heap_size"] = (void*)__runtime_gc_heap_size;
+    g_runtime_function_table["__runtime_gc_heap_used"] = (void*)__runtime_gc_heap_used;
+    g_runtime_function_table["__runtime_gc_stats"] = (void*)__runtime_gc_stats;
+    g_runtime_function_table["__runtime_gc_next_gc"] = (void*)__runtime_gc_next_gc;
+    g_runtime_function_table["__runtime_gc_set_memory_limit"] = (void*)__runtime_gc_set_memory_limit;
+    g_runtime_function_table["__runtime_gc_write_heap_snapshot"] = (void*)__runtime_gc_write_heap_snapshot;
+    g_runtime_function_table["__runtime_gc_set_heap_profile_rate"] = (void*)__runtime_gc_set_heap_profile_rate;
+    g_runtime_function_table["__runtime_gc_write_heap_profile"] = (void*)__runtime_gc_write_heap_profile;
+    
     // Advanced goroutine functions
     extern void __init_advanced_goroutine_system();
     extern void* __goroutine_alloc_shared(int64_t size);
@@ -349,6 +429,47 @@ static void initialize_runtime_function_table() {
     g_runtime_function_table["__console_log_number"] = (void*)__console_log_number;
     g_runtime_function_table["__dynamic_method_toString"] = (void*)__dynamic_method_toString;
     
+    // Lock slow paths behind the inlined fast paths
+    g_runtime_function_table["__runtime_weak_ref"] = (void*)__runtime_weak_ref;
+    g_runtime_function_table["__runtime_weak_deref"] = (void*)__runtime_weak_deref;
+    g_runtime_function_table["__runtime_weak_map"] = (void*)__runtime_weak_map;
+    g_runtime_function_table["__runtime_weak_get"] = (void*)__runtime_weak_get;
+    g_runtime_function_table["__runtime_weak_set"] = (void*)__runtime_weak_set;
+    g_runtime_function_table["__runtime_weak_has"] = (void*)__runtime_weak_has;
+    g_runtime_function_table["__runtime_weak_remove"] = (void*)__runtime_weak_remove;
+    g_runtime_function_table["__runtime_weak_size"] = (void*)__runtime_weak_size;
+    g_runtime_function_table["__runtime_weak_registry"] = (void*)__runtime_weak_registry;
+    g_runtime_function_table["__runtime_weak_register"] = (void*)__runtime_weak_register;
+    g_runtime_function_table["__runtime_weak_unregister"] = (void*)__runtime_weak_unregister;
+    g_runtime_function_table["__runtime_lock_create"] = (void*)__runtime_lock_create;
+    g_runtime_function_table["__runtime_lock_create_at"] = (void*)__runtime_lock_create_at;
+    g_runtime_function_table["__runtime_lock_lock"] = (void*)__runtime_lock_lock;
+    g_runtime_function_table["__runtime_lock_unlock"] = (void*)__runtime_lock_unlock;
+    g_runtime_function_table["__runtime_lock_unlock_contended"] = (void*)__runtime_lock_unlock_contended;
+    g_runtime_function_table["__runtime_lock_try_lock"] = (void*)__runtime_lock_try_lock;
+    g_runtime_function_table["__runtime_lock_try_lock_for"] = (void*)__runtime_lock_try_lock_for;
+    g_runtime_function_table["__runtime_lock_is_locked_by_current"] = (void*)__runtime_lock_is_locked_by_current;
+    g_runtime_function_table["__runtime_atomic_create"] = (void*)__runtime_atomic_create;
+    g_runtime_function_table["__runtime_waitgroup_create"] = (void*)__runtime_waitgroup_create;
+    g_runtime_function_table["__runtime_waitgroup_add"] = (void*)__runtime_waitgroup_add;
+    g_runtime_function_table["__runtime_waitgroup_settle"] = (void*)__runtime_waitgroup_settle;
+    g_runtime_function_table["__runtime_waitgroup_wait"] = (void*)__runtime_waitgroup_wait;
+    g_runtime_function_table["__runtime_semaphore_create"] = (void*)__runtime_semaphore_create;
+    g_runtime_function_table["__runtime_semaphore_acquire"] = (void*)__runtime_semaphore_acquire;
+    g_runtime_function_table["__runtime_semaphore_try_acquire"] = (void*)__runtime_semaphore_try_acquire;
+    g_runtime_function_table["__runtime_semaphore_try_acquire_for"] = (void*)__runtime_semaphore_try_acquire_for;
+    g_runtime_function_table["__runtime_semaphore_release"] = (void*)__runtime_semaphore_release;
+    g_runtime_function_table["__runtime_semaphore_wake"] = (void*)__runtime_semaphore_wake;
+    g_runtime_function_table["__runtime_rwlock_create"] = (void*)__runtime_rwlock_create;
+    g_runtime_function_table["__runtime_rwlock_read_lock"] = (void*)__runtime_rwlock_read_lock;
+    g_runtime_function_table["__runtime_rwlock_read_unlock"] = (void*)__runtime_rwlock_read_unlock;
+    g_runtime_function_table["__runtime_rwlock_try_read_lock"] = (void*)__runtime_rwlock_try_read_lock;
+    g_runtime_function_table["__runtime_rwlock_write_lock"] = (void*)__runtime_rwlock_write_lock;
+    g_runtime_function_table["__runtime_rwlock_write_unlock"] = (void*)__runtime_rwlock_write_unlock;
+    g_runtime_function_table["__runtime_rwlock_try_write_lock"] = (void*)__runtime_rwlock_try_write_lock;
+    g_runtime_function_table["__runtime_barrier_create"] = (void*)__runtime_barrier_create;
+    g_runtime_function_table["__runtime_barrier_wait"] = (void*)__runtime_barrier_wait;
+    
     g_runtime_table_initialized = true;
 }
 
@@ -380,6 +501,7 @@ void X86CodeGen::emit_call(const std::string& label) {
             // call rax
             code.push_back(0xFF);
             code.push_back(0xD0);
+            record_gc_safepoint();
             return;
         }
     }
@@ -401,6 +523,15 @@ void X86CodeGen::emit_call(const std::string& label) {
         code.push_back(0x00);
         code.push_back(0x00);
     }
+    record_gc_safepoint();
+}
+
+// Every call is a GC safepoint: the collector finds this frame through the
+// return address and reads its reference slots precisely
+void X86CodeGen::record_gc_safepoint() {
+    if (!gc_frame) return;
+    std::vector<int32_t> slots = gc_frame->get_reference_slots();
+    if (!slots.empty()) gc_stack_maps.push_back({code.size(), std::move(slots)});
 }
 
 void X86CodeGen::emit_ret() {
@@ -892,6 +1023,7 @@ void X86CodeGen::emit_call_reg(int reg) {
     }
     code.push_back(0xFF);
     code.push_back(0xD0 | (reg & 7));
+    record_gc_safepoint();
 }
 
 void X86CodeGen::emit_jump_if_equal(const std::string& label) {
@@ -965,6 +1097,7 @@ void X86CodeGen::emit_call_fast(uint16_t func_id) {
     // call rax
     code.push_back(0xFF);
     code.push_back(0xD0);
+    record_gc_safepoint();
 }
 
 void X86CodeGen::emit_goroutine_spawn_fast(uint16_t func_id) {
@@ -1054,15 +1187,682 @@ void X86CodeGen::emit_calculate_function_address_from_offset(size_t function_off
     // Result is now in RAX (the function address)
 }
 
-// Stub implementations for lock methods
-void X86CodeGen::emit_lock_acquire(int lock_id) { (void)lock_id; }
-void X86CodeGen::emit_lock_release(int lock_id) { (void)lock_id; }
-void X86CodeGen::emit_lock_try_acquire(int lock_id, int result_reg) { (void)lock_id; (void)result_reg; }
-void X86CodeGen::emit_lock_try_acquire_timeout(int lock_id, int timeout_reg, int result_reg) { (void)lock_id; (void)timeout_reg; (void)result_reg; }
-void X86CodeGen::emit_atomic_compare_exchange(int ptr_reg, int expected_reg, int desired_reg, int result_reg) { (void)ptr_reg; (void)expected_reg; (void)desired_reg; (void)result_reg; }
-void X86CodeGen::emit_atomic_fetch_add(int ptr_reg, int value_reg, int result_reg) { (void)ptr_reg; (void)value_reg; (void)result_reg; }
-void X86CodeGen::emit_atomic_store(int ptr_reg, int value_reg, int ordering) { (void)ptr_reg; (void)value_reg; (void)ordering; }
-void X86CodeGen::emit_atomic_load(int ptr_reg, int result_reg, int ordering) { (void)ptr_reg; (void)result_reg; (void)ordering; }
-void X86CodeGen::emit_memory_fence(int fence_type) { (void)fence_type; }
+// ============================================================================
+// Lock fast paths and atomics
+// ============================================================================
+//
+// lock()/unlock() are inlined as a single `lock cmpxchg` on the Lock word
+// (see lock_system.h for the layout). Only contention, recursion or misuse
+// reaches the runtime. The owner id is the thread pointer at fs:[0], the
+// same value Lock::current_owner_id() returns.
+
+void X86CodeGen::emit_byte(uint8_t byte) {
+    code.push_back(byte);
+}
+
+void X86CodeGen::emit_u32(uint32_t value) {
+    code.push_back(value & 0xFF);
+    code.push_back((value >> 8) & 0xFF);
+    code.push_back((value >> 16) & 0xFF);
+    code.push_back((value >> 24) & 0xFF);
+}
+
+// REX prefix for `reg` in ModRM.reg and `base` in ModRM.rm - omitted when a
+// 32-bit operation on legacy registers needs none
+static void emit_rex(std::vector<uint8_t>& code, bool wide, int reg, int base) {
+    uint8_t rex = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((base & 8) ? 0x01 : 0);
+    if (rex != 0x40) code.push_back(rex);
+}
+
+// ModRM (+SIB for RSP/R12) addressing [base + disp8]
+static void emit_mem_disp8(std::vector<uint8_t>& code, int reg, int base, int8_t disp) {
+    code.push_back(0x40 | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == RSP) code.push_back(0x24);
+    code.push_back(static_cast<uint8_t>(disp));
+}
+
+// mov reg, fs:[0]
+static void emit_load_thread_pointer(std::vector<uint8_t>& code, int reg) {
+    code.push_back(0x64);
+    code.push_back(0x48 | ((reg & 8) ? 0x04 : 0));
+    code.push_back(0x8B);
+    code.push_back(0x04 | ((reg & 7) << 3));
+    code.push_back(0x25);
+    for (int i = 0; i < 4; i++) code.push_back(0x00);
+}
+
+// lock cmpxchg dword [base + disp], src
+static void emit_lock_cmpxchg32(std::vector<uint8_t>& code, int base, int8_t disp, int src) {
+    code.push_back(0xF0);
+    emit_rex(code, false, src, base);
+    code.push_back(0x0F);
+    code.push_back(0xB1);
+    emit_mem_disp8(code, src, base, disp);
+}
+
+static int next_lock_site() {
+    static int lock_site_counter = 0;
+    return lock_site_counter++;
+}
+
+void X86CodeGen::emit_lock_acquire(int lock_reg) {
+    // The lock profiler has to see every acquisition
+    if (LockProfiler::enabled()) {
+        if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+        emit_call("__runtime_lock_lock");
+        return;
+    }
+    
+    // cmpxchg needs RAX and we use RCX as scratch
+    if (lock_reg == RAX || lock_reg == RCX) {
+        emit_mov_reg_reg(RDI, lock_reg);
+        lock_reg = RDI;
+    }
+    int site = next_lock_site();
+    std::string slow_label = "__lock_acquire_slow_" + std::to_string(site);
+    std::string done_label = "__lock_acquire_done_" + std::to_string(site);
+    
+    // xor eax, eax ; mov ecx, LOCKED ; lock cmpxchg [lock], ecx
+    code.push_back(0x31); code.push_back(0xC0);
+    code.push_back(0xB9); emit_u32(Lock::LOCKED);
+    emit_lock_cmpxchg32(code, lock_reg, Lock::STATE_OFFSET, RCX);
+    emit_jump_if_not_zero(slow_label);
+    
+    // Uncontended: record the owner - mov rcx, fs:[0] ; mov [lock + 8], rcx
+    emit_load_thread_pointer(code, RCX);
+    emit_rex(code, true, RCX, lock_reg);
+    code.push_back(0x89);
+    emit_mem_disp8(code, RCX, lock_reg, Lock::OWNER_OFFSET);
+    emit_jump(done_label);
+    
+    // Held (by someone else, or recursively by us)
+    emit_label(slow_label);
+    if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+    emit_call("__runtime_lock_lock");
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_lock_release(int lock_reg) {
+    if (LockProfiler::enabled()) {
+        if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+        emit_call("__runtime_lock_unlock");
+        return;
+    }
+    
+    if (lock_reg == RAX || lock_reg == RCX) {
+        emit_mov_reg_reg(RDI, lock_reg);
+        lock_reg = RDI;
+    }
+    int site = next_lock_site();
+    std::string checked_label = "__lock_release_checked_" + std::to_string(site);
+    std::string contended_label = "__lock_release_contended_" + std::to_string(site);
+    std::string done_label = "__lock_release_done_" + std::to_string(site);
+    
+    // Owned by us and not recursive? mov rcx, fs:[0] ; cmp [lock + 8], rcx ;
+    // cmp dword [lock + 4], 0 - anything else goes through the full runtime
+    // unlock (which also reports misuse)
+    emit_load_thread_pointer(code, RCX);
+    emit_rex(code, true, RCX, lock_reg);
+    code.push_back(0x39);
+    emit_mem_disp8(code, RCX, lock_reg, Lock::OWNER_OFFSET);
+    emit_jump_if_not_zero(checked_label);
+    emit_rex(code, false, 0, lock_reg);
+    code.push_back(0x83);
+    emit_mem_disp8(code, 7, lock_reg, Lock::RECURSION_OFFSET);
+    code.push_back(0x00);
+    emit_jump_if_not_zero(checked_label);
+    
+    // mov qword [lock + 8], -1
+    emit_rex(code, true, 0, lock_reg);
+    code.push_back(0xC7);
+    emit_mem_disp8(code, 0, lock_reg, Lock::OWNER_OFFSET);
+    emit_u32(0xFFFFFFFF);
+    
+    // mov eax, LOCKED ; xor ecx, ecx ; lock cmpxchg [lock], ecx
+    code.push_back(0xB8); emit_u32(Lock::LOCKED);
+    code.push_back(0x31); code.push_back(0xC9);
+    emit_lock_cmpxchg32(code, lock_reg, Lock::STATE_OFFSET, RCX);
+    emit_jump_if_zero(done_label);
+    
+    // Waiters recorded in the word - wake one
+    if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+    emit_call("__runtime_lock_unlock_contended");
+    emit_jump(done_label);
+    
+    emit_label(checked_label);
+    if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+    emit_call("__runtime_lock_unlock");
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_lock_try_acquire(int lock_reg, int result_reg) {
+    if (lock_reg == RAX || lock_reg == RCX) {
+        emit_mov_reg_reg(RDI, lock_reg);
+        lock_reg = RDI;
+    }
+    if (LockProfiler::enabled()) {
+        if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+        emit_call("__runtime_lock_try_lock");
+        code.push_back(0x0F); code.push_back(0xB6); code.push_back(0xC0);  // movzx eax, al
+        if (result_reg != RAX) emit_mov_reg_reg(result_reg, RAX);
+        return;
+    }
+    int site = next_lock_site();
+    std::string slow_label = "__lock_try_slow_" + std::to_string(site);
+    std::string done_label = "__lock_try_done_" + std::to_string(site);
+    
+    code.push_back(0x31); code.push_back(0xC0);
+    code.push_back(0xB9); emit_u32(Lock::LOCKED);
+    emit_lock_cmpxchg32(code, lock_reg, Lock::STATE_OFFSET, RCX);
+    emit_jump_if_not_zero(slow_label);
+    
+    emit_load_thread_pointer(code, RCX);
+    emit_rex(code, true, RCX, lock_reg);
+    code.push_back(0x89);
+    emit_mem_disp8(code, RCX, lock_reg, Lock::OWNER_OFFSET);
+    code.push_back(0xB8); emit_u32(1);  // mov eax, 1
+    emit_jump(done_label);
+    
+    // Word not free: recursion, or a free-but-contended word
+    emit_label(slow_label);
+    if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+    emit_call("__runtime_lock_try_lock");
+    code.push_back(0x0F); code.push_back(0xB6); code.push_back(0xC0);  // movzx eax, al
+    
+    emit_label(done_label);
+    if (result_reg != RAX) emit_mov_reg_reg(result_reg, RAX);
+}
+
+void X86CodeGen::emit_lock_try_acquire_timeout(int lock_reg, int timeout_reg, int result_reg) {
+    // Waiting with a deadline is always a runtime call
+    if (timeout_reg == RDI && lock_reg != RDI) {
+        emit_mov_reg_reg(R11, RDI);
+        timeout_reg = R11;
+    }
+    if (lock_reg != RDI) emit_mov_reg_reg(RDI, lock_reg);
+    if (timeout_reg != RSI) emit_mov_reg_reg(RSI, timeout_reg);
+    emit_call("__runtime_lock_try_lock_for");
+    code.push_back(0x0F); code.push_back(0xB6); code.push_back(0xC0);  // movzx eax, al
+    if (result_reg != RAX) emit_mov_reg_reg(result_reg, RAX);
+}
+
+void X86CodeGen::emit_waitgroup_add(int wg_reg, int delta_reg) {
+    // new = (lock xadd [wg], delta) + delta; only a count that dropped to
+    // zero or below needs the runtime (wake waiters / report misuse)
+    int site = next_lock_site();
+    std::string done_label = "__waitgroup_add_done_" + std::to_string(site);
+    
+    emit_mov_reg_reg(R10, delta_reg);
+    emit_mov_reg_reg(R11, delta_reg);
+    if (wg_reg != RDI) emit_mov_reg_reg(RDI, wg_reg);
+    
+    // lock xadd dword [rdi], r11d ; add r11d, r10d
+    code.push_back(0xF0);
+    emit_rex(code, false, R11, RDI);
+    code.push_back(0x0F);
+    code.push_back(0xC1);
+    emit_mem_disp8(code, R11, RDI, WaitGroup::COUNT_OFFSET);
+    emit_rex(code, false, R10, R11);
+    code.push_back(0x01);
+    code.push_back(0xC0 | ((R10 & 7) << 3) | (R11 & 7));
+    emit_jump_if_greater(done_label);
+    
+    emit_call("__runtime_waitgroup_settle");
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_semaphore_acquire(int sem_reg) {
+    // Take a permit with one CAS while any are left, else park in the runtime
+    int site = next_lock_site();
+    std::string retry_label = "__semaphore_acquire_retry_" + std::to_string(site);
+    std::string slow_label = "__semaphore_acquire_slow_" + std::to_string(site);
+    std::string done_label = "__semaphore_acquire_done_" + std::to_string(site);
+    
+    if (sem_reg != RDI) emit_mov_reg_reg(RDI, sem_reg);
+    
+    // mov eax, [rdi]
+    code.push_back(0x8B);
+    emit_mem_disp8(code, RAX, RDI, Semaphore::PERMITS_OFFSET);
+    
+    // retry: test eax, eax ; jz slow ; lea ecx, [rax - 1] ; lock cmpxchg [rdi], ecx ; jnz retry
+    emit_label(retry_label);
+    code.push_back(0x85); code.push_back(0xC0);
+    emit_jump_if_zero(slow_label);
+    code.push_back(0x8D); code.push_back(0x48); code.push_back(0xFF);
+    emit_lock_cmpxchg32(code, RDI, Semaphore::PERMITS_OFFSET, RCX);
+    emit_jump_if_not_zero(retry_label);
+    emit_jump(done_label);
+    
+    emit_label(slow_label);
+    emit_call("__runtime_semaphore_acquire");
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_semaphore_release(int sem_reg) {
+    // lock xadd [sem], 1 is a full fence, so the waiter check that follows
+    // cannot miss an acquirer that parked before the permit arrived
+    int site = next_lock_site();
+    std::string done_label = "__semaphore_release_done_" + std::to_string(site);
+    
+    if (sem_reg != RDI) emit_mov_reg_reg(RDI, sem_reg);
+    emit_mov_reg_imm(R11, 1);
+    code.push_back(0xF0);
+    emit_rex(code, false, R11, RDI);
+    code.push_back(0x0F);
+    code.push_back(0xC1);
+    emit_mem_disp8(code, R11, RDI, Semaphore::PERMITS_OFFSET);
+    
+    // cmp dword [rdi + 4], 0 ; jz done
+    code.push_back(0x83);
+    emit_mem_disp8(code, 7, RDI, Semaphore::WAITERS_OFFSET);
+    code.push_back(0x00);
+    emit_jump_if_zero(done_label);
+    
+    emit_call("__runtime_semaphore_wake");
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_atomic_compare_exchange(int ptr_reg, int expected_reg, int desired_reg, int result_reg) {
+    // result = 1 if [ptr] held `expected` and now holds `desired`, else 0.
+    // cmpxchg compares against RAX, so move anything living there aside.
+    if (ptr_reg == RAX) {
+        emit_mov_reg_reg(R10, RAX);
+        ptr_reg = R10;
+    }
+    if (desired_reg == RAX) {
+        emit_mov_reg_reg(R11, RAX);
+        desired_reg = R11;
+    }
+    if (expected_reg != RAX) emit_mov_reg_reg(RAX, expected_reg);
+    
+    // lock cmpxchg qword [ptr], desired
+    code.push_back(0xF0);
+    emit_rex(code, true, desired_reg, ptr_reg);
+    code.push_back(0x0F);
+    code.push_back(0xB1);
+    emit_mem_disp8(code, desired_reg, ptr_reg, 0);
+    
+    // sete al ; movzx result, al
+    emit_sete(RAX);
+    emit_rex(code, false, result_reg, RAX);
+    code.push_back(0x0F);
+    code.push_back(0xB6);
+    code.push_back(0xC0 | ((result_reg & 7) << 3));
+}
+
+void X86CodeGen::emit_atomic_fetch_add(int ptr_reg, int value_reg, int result_reg) {
+    // result = previous [ptr]; lock xadd through R11 so result may alias ptr
+    emit_mov_reg_reg(R11, value_reg);
+    code.push_back(0xF0);
+    emit_rex(code, true, R11, ptr_reg);
+    code.push_back(0x0F);
+    code.push_back(0xC1);
+    emit_mem_disp8(code, R11, ptr_reg, 0);
+    emit_mov_reg_reg(result_reg, R11);
+}
+
+void X86CodeGen::emit_atomic_store(int ptr_reg, int value_reg, int ordering) {
+    if (ordering == static_cast<int>(MemoryOrder::SEQ_CST)) {
+        // xchg is implicitly locked - a store plus full fence
+        emit_mov_reg_reg(R11, value_reg);
+        emit_rex(code, true, R11, ptr_reg);
+        code.push_back(0x87);
+        emit_mem_disp8(code, R11, ptr_reg, 0);
+    } else {
+        // x86 stores already have release semantics
+        emit_rex(code, true, value_reg, ptr_reg);
+        code.push_back(0x89);
+        emit_mem_disp8(code, value_reg, ptr_reg, 0);
+    }
+}
+
+void X86CodeGen::emit_atomic_load(int ptr_reg, int result_reg, int ordering) {
+    // x86 loads already have acquire semantics, and seq_cst stores fence
+    // on the store side, so every ordering is a plain aligned load
+    (void)ordering;
+    emit_rex(code, true, result_reg, ptr_reg);
+    code.push_back(0x8B);
+    emit_mem_disp8(code, result_reg, ptr_reg, 0);
+}
+
+void X86CodeGen::emit_memory_fence(int fence_type) {
+    // Only store->load reordering is visible on x86; acquire and release
+    // fences need no instruction
+    if (fence_type == static_cast<int>(MemoryOrder::SEQ_CST) ||
+        fence_type == static_cast<int>(MemoryOrder::ACQ_REL)) {
+        code.push_back(0x0F);
+        code.push_back(0xAE);
+        code.push_back(0xF0);  // mfence
+    }
+}
+
+void X86CodeGen::emit_atomic_exchange(int ptr_reg, int value_reg, int result_reg) {
+    // xchg with memory is implicitly locked; result = previous [ptr]
+    emit_mov_reg_reg(R11, value_reg);
+    emit_rex(code, true, R11, ptr_reg);
+    code.push_back(0x87);
+    emit_mem_disp8(code, R11, ptr_reg, 0);
+    emit_mov_reg_reg(result_reg, R11);
+}
+
+// movq xmm, r64 (66 REX.W 0F 6E) and movq r64, xmm (66 REX.W 0F 7E)
+static void emit_movq_xmm_reg(std::vector<uint8_t>& code, int xmm, int reg) {
+    code.push_back(0x66);
+    emit_rex(code, true, xmm, reg);
+    code.push_back(0x0F);
+    code.push_back(0x6E);
+    code.push_back(0xC0 | ((xmm & 7) << 3) | (reg & 7));
+}
+
+static void emit_movq_reg_xmm(std::vector<uint8_t>& code, int reg, int xmm) {
+    code.push_back(0x66);
+    emit_rex(code, true, xmm, reg);
+    code.push_back(0x0F);
+    code.push_back(0x7E);
+    code.push_back(0xC0 | ((xmm & 7) << 3) | (reg & 7));
+}
+
+void X86CodeGen::emit_atomic_fetch_add_float64(int ptr_reg, int value_reg, int result_reg) {
+    // No locked FP add exists, so retry a cmpxchg on the bit pattern:
+    //   xmm1 = value
+    //   retry: rax = [ptr]; r11 = bits(double(rax) + xmm1); lock cmpxchg [ptr], r11; jnz retry
+    // result = previous bits
+    static int float_add_site_counter = 0;
+    std::string retry_label = "__atomic_fadd_retry_" + std::to_string(float_add_site_counter++);
+    
+    emit_movq_xmm_reg(code, 1, value_reg);
+    if (ptr_reg != R10) emit_mov_reg_reg(R10, ptr_reg);
+    
+    emit_label(retry_label);
+    emit_rex(code, true, RAX, R10);
+    code.push_back(0x8B);
+    emit_mem_disp8(code, RAX, R10, 0);          // mov rax, [r10]
+    emit_movq_xmm_reg(code, 0, RAX);
+    code.push_back(0xF2);
+    code.push_back(0x0F);
+    code.push_back(0x58);
+    code.push_back(0xC1);                       // addsd xmm0, xmm1
+    emit_movq_reg_xmm(code, R11, 0);
+    code.push_back(0xF0);
+    emit_rex(code, true, R11, R10);
+    code.push_back(0x0F);
+    code.push_back(0xB1);
+    emit_mem_disp8(code, R11, R10, 0);          // lock cmpxchg [r10], r11
+    emit_jump_if_not_zero(retry_label);
+    
+    if (result_reg != RAX) emit_mov_reg_reg(result_reg, RAX);
+}
+
+void X86CodeGen::emit_int64_to_float64_bits(int reg) {
+    // cvtsi2sd xmm0, reg ; movq reg, xmm0
+    code.push_back(0xF2);
+    emit_rex(code, true, 0, reg);
+    code.push_back(0x0F);
+    code.push_back(0x2A);
+    code.push_back(0xC0 | (reg & 7));
+    emit_movq_reg_xmm(code, reg, 0);
+}
+
+void X86CodeGen::emit_float64_bits_to_int64(int reg) {
+    // movq xmm0, reg ; cvttsd2si reg, xmm0
+    emit_movq_xmm_reg(code, 0, reg);
+    code.push_back(0xF2);
+    emit_rex(code, true, reg, 0);
+    code.push_back(0x0F);
+    code.push_back(0x2C);
+    code.push_back(0xC0 | ((reg & 7) << 3));
+}
+
+static int next_gc_alloc_site() {
+    static int gc_alloc_site_counter = 0;
+    return gc_alloc_site_counter++;
+}
+
+// op r64, [base + disp32]
+static void emit_mem_disp32_op(std::vector<uint8_t>& code, uint8_t opcode, int reg, int base, int32_t disp) {
+    emit_rex(code, true, reg, base);
+    code.push_back(opcode);
+    code.push_back(0x80 | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == RSP) code.push_back(0x24);
+    for (int i = 0; i < 4; i++) code.push_back((static_cast<uint32_t>(disp) >> (i * 8)) & 0xFF);
+}
+
+void X86CodeGen::emit_gc_allocate(size_t payload_size, uint32_t type_id) {
+    size_t total = ObjectHeader::align(sizeof(ObjectHeader) + payload_size);
+    int site = next_gc_alloc_site();
+    std::string slow_label = "__gc_alloc_slow_" + std::to_string(site);
+    std::string done_label = "__gc_alloc_done_" + std::to_string(site);
+    uint32_t alloc_site = GarbageCollector::new_allocation_site();
+    
+    if (total <= GCConfig::LARGE_OBJECT_SIZE) {
+        int32_t tlab = GenerationalHeap::tlab_tls_offset();
+        
+        // A pretenured site allocates out of line, in the old generation -
+        // mov r11, &gc_pretenured_sites[site] ; cmp byte [r11], 0 ; jne slow
+        if (alloc_site) {
+            emit_mov_reg_imm(R11, reinterpret_cast<int64_t>(&gc_pretenured_sites[alloc_site]));
+            code.push_back(0x41); code.push_back(0x80); code.push_back(0x3B); code.push_back(0x00);
+            code.push_back(0x0F); code.push_back(0x85);
+            unresolved_jumps.push_back({slow_label, code.size()});
+            emit_u32(0);
+        }
+        
+        // Everything up to the store of the new bump pointer restarts from
+        // the top if the thread is stopped for GC in between
+        size_t restart = code.size();
+        
+        // mov rcx, fs:[0] ; mov rax, [rcx + tlab.current] ;
+        // lea rdx, [rax + total] ; cmp rdx, [rcx + tlab.end] ; ja slow
+        emit_load_thread_pointer(code, RCX);
+        emit_mem_disp32_op(code, 0x8B, RAX, RCX, tlab + TLAB::CURRENT_OFFSET);
+        emit_mem_disp32_op(code, 0x8D, RDX, RAX, static_cast<int32_t>(total));
+        emit_mem_disp32_op(code, 0x3B, RDX, RCX, tlab + TLAB::END_OFFSET);
+        code.push_back(0x0F);
+        code.push_back(0x87);
+        unresolved_jumps.push_back({slow_label, code.size()});
+        emit_u32(0);
+        
+        // Header before the bump - mov dword [rax], size ; mov dword [rax + 4], type_id << 16
+        code.push_back(0xC7); code.push_back(0x00);
+        emit_u32(static_cast<uint32_t>(payload_size));
+        code.push_back(0xC7); code.push_back(0x40); code.push_back(0x04);
+        emit_u32(type_id << 16);
+        gc_restart_ranges.push_back({restart, code.size()});
+        
+        // mov [rcx + tlab.current], rdx ; add rax, 16
+        emit_mem_disp32_op(code, 0x89, RDX, RCX, tlab + TLAB::CURRENT_OFFSET);
+        code.push_back(0x48); code.push_back(0x83); code.push_back(0xC0);
+        code.push_back(sizeof(ObjectHeader));
+        emit_jump(done_label);
+    }
+    
+    // TLAB exhausted (or the object goes straight to the old generation)
+    emit_label(slow_label);
+    emit_mov_reg_imm(RDI, static_cast<int64_t>(payload_size));
+    emit_mov_reg_imm(RSI, type_id);
+    emit_mov_reg_imm(RDX, alloc_site);
+    emit_call("__gc_alloc_slow");
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_object_create(const char* class_name, int64_t property_count) {
+    if (property_count < 0) property_count = 0;
+    emit_gc_allocate(GCObjectLayout::payload_size(property_count), TYPE_OBJECT);
+    
+    // mov rcx, class_name ; mov [rax], rcx ; mov qword [rax + 8], property_count
+    emit_mov_reg_imm(RCX, reinterpret_cast<int64_t>(class_name));
+    emit_rex(code, true, RCX, RAX);
+    code.push_back(0x89);
+    emit_mem_disp8(code, RCX, RAX, GCObjectLayout::CLASS_NAME_OFFSET);
+    emit_rex(code, true, 0, RAX);
+    code.push_back(0xC7);
+    emit_mem_disp8(code, 0, RAX, GCObjectLayout::COUNT_OFFSET);
+    emit_u32(static_cast<uint32_t>(property_count));
+}
+
+void X86CodeGen::emit_object_create_in_frame(const char* class_name, int64_t property_count, int64_t header_offset) {
+    if (property_count < 0) property_count = 0;
+    size_t payload_size = GCObjectLayout::payload_size(property_count);
+    int32_t header = static_cast<int32_t>(header_offset);
+    int32_t payload = header + static_cast<int32_t>(sizeof(ObjectHeader));
+    size_t words = (sizeof(ObjectHeader) + payload_size) / 8;
+    
+    // Zero header and payload - a frame slot holds whatever the last call left
+    code.push_back(0x31); code.push_back(0xC0);             // xor eax, eax
+    if (words > 16) {
+        // lea rdi, [rbp + header] ; mov ecx, words ; rep stosq
+        emit_mem_disp32_op(code, 0x8D, RDI, RBP, header);
+        code.push_back(0xB9);
+        emit_u32(static_cast<uint32_t>(words));
+        code.push_back(0xF3); code.push_back(0x48); code.push_back(0xAB);
+    } else {
+        for (size_t i = 0; i < words; i++) {
+            emit_mem_disp32_op(code, 0x89, RAX, RBP, header + static_cast<int32_t>(i * 8));
+        }
+    }
+    
+    // The header says STACK_ALLOCATED: no card marks, never moved or freed
+    emit_mov_reg_imm(RCX, static_cast<int64_t>(ObjectHeader::make_raw(
+        static_cast<uint32_t>(payload_size), ObjectHeader::STACK_ALLOCATED, TYPE_OBJECT)));
+    emit_mem_disp32_op(code, 0x89, RCX, RBP, header);
+    emit_mov_reg_imm(RCX, reinterpret_cast<int64_t>(class_name));
+    emit_mem_disp32_op(code, 0x89, RCX, RBP, payload + GCObjectLayout::CLASS_NAME_OFFSET);
+    emit_mov_reg_imm(RCX, property_count);
+    emit_mem_disp32_op(code, 0x89, RCX, RBP, payload + GCObjectLayout::COUNT_OFFSET);
+    
+    // lea rax, [rbp + payload]
+    emit_mem_disp32_op(code, 0x8D, RAX, RBP, payload);
+}
+
+void X86CodeGen::emit_gc_pre_write_barrier(int object_reg, int32_t field_offset) {
+    std::string done_label = "__gc_barrier_done_" + std::to_string(next_gc_alloc_site());
+    
+    // mov r11, &gc_marking_active ; cmp byte [r11], 0 ; je done
+    emit_mov_reg_imm(R11, reinterpret_cast<int64_t>(&gc_marking_active));
+    code.push_back(0x41); code.push_back(0x80); code.push_back(0x3B); code.push_back(0x00);
+    emit_jump_if_equal(done_label);
+    
+    // Stores through a null object are reported by the runtime call
+    emit_rex(code, true, object_reg, object_reg);
+    code.push_back(0x85);
+    code.push_back(0xC0 | ((object_reg & 7) << 3) | (object_reg & 7));
+    emit_jump_if_equal(done_label);
+    
+    // Out of line: hand the old value to the collector, keeping the
+    // arguments of the store call that follows
+    code.push_back(0x57);                                   // push rdi
+    code.push_back(0x56);                                   // push rsi
+    code.push_back(0x52);                                   // push rdx
+    code.push_back(0x48); code.push_back(0x83); code.push_back(0xEC); code.push_back(0x08);  // sub rsp, 8
+    emit_mem_disp32_op(code, 0x8B, RDI, object_reg, field_offset);
+    emit_call("__gc_satb_enqueue");
+    code.push_back(0x48); code.push_back(0x83); code.push_back(0xC4); code.push_back(0x08);  // add rsp, 8
+    code.push_back(0x5A);                                   // pop rdx
+    code.push_back(0x5E);                                   // pop rsi
+    code.push_back(0x5F);                                   // pop rdi
+    emit_label(done_label);
+}
+
+void X86CodeGen::emit_object_set_property(int64_t property_index, bool card_mark) {
+    int site = next_gc_alloc_site();
+    std::string slow_label = "__object_store_slow_" + std::to_string(site);
+    std::string join_label = "__object_store_join_" + std::to_string(site);
+    
+    // test rdi, rdi ; je slow ; cmp qword [rdi + count], index ; jle slow
+    code.push_back(0x48); code.push_back(0x85); code.push_back(0xFF);
+    emit_jump_if_equal(slow_label);
+    emit_rex(code, true, 0, RDI);
+    code.push_back(0x81);
+    emit_mem_disp8(code, 7, RDI, GCObjectLayout::COUNT_OFFSET);
+    emit_u32(static_cast<uint32_t>(property_index));
+    code.push_back(0x0F); code.push_back(0x8E);
+    unresolved_jumps.push_back({slow_label, code.size()});
+    emit_u32(0);
+    
+    // Objects in a frame (escape_analysis.h) take neither card marks nor
+    // publication - test byte [rdi - 12], STACK_ALLOCATED ; jnz frame
+    std::string frame_label = "__object_store_frame_" + std::to_string(site);
+    if (card_mark) {
+        code.push_back(0xF6); code.push_back(0x47);
+        code.push_back(static_cast<uint8_t>(-static_cast<int>(sizeof(ObjectHeader)) + 4));
+        code.push_back(ObjectHeader::STACK_ALLOCATED);
+        code.push_back(0x0F); code.push_back(0x85);
+        unresolved_jumps.push_back({frame_label, code.size()});
+        emit_u32(0);
+    }
+    
+    // The store and its card mark restart together if the thread is stopped
+    // for GC in between
+    size_t restart = code.size();
+    if (card_mark) {
+        emit_mov_reg_imm(R11, reinterpret_cast<int64_t>(&gc_card_table_base));
+        code.push_back(0x4D); code.push_back(0x8B); code.push_back(0x1B);  // mov r11, [r11]
+    }
+    emit_rex(code, true, RDX, RDI);
+    code.push_back(0x89);                                   // mov [rdi + offset], rdx
+    code.push_back(0x80 | ((RDX & 7) << 3) | (RDI & 7));
+    emit_u32(static_cast<uint32_t>(GCObjectLayout::value_offset(property_index)));
+    if (card_mark) {
+        code.push_back(0x4C); code.push_back(0x8D); code.push_back(0x97);  // lea r10, [rdi + offset]
+        emit_u32(static_cast<uint32_t>(GCObjectLayout::value_offset(property_index)));
+        code.push_back(0x49); code.push_back(0xC1); code.push_back(0xEA);  // shr r10, CARD_SHIFT
+        code.push_back(static_cast<uint8_t>(GCConfig::CARD_SHIFT));
+        code.push_back(0x43); code.push_back(0xC6); code.push_back(0x04);  // mov byte [r11 + r10], 1
+        code.push_back(0x13); code.push_back(0x01);
+    }
+    gc_restart_ranges.push_back({restart, code.size()});
+    if (card_mark) {
+        // A goroutine-private value stored into anything but an object of
+        // the same goroutine is published. Owners come from the young page
+        // table; old and non-heap addresses have none
+        std::string publish_label = "__object_store_publish_" + std::to_string(site);
+        emit_mov_reg_imm(R11, reinterpret_cast<int64_t>(&gc_young_start));
+        code.push_back(0x4D); code.push_back(0x8B); code.push_back(0x1B);  // mov r11, [r11]
+        code.push_back(0x49); code.push_back(0x89); code.push_back(0xD2);  // mov r10, rdx
+        code.push_back(0x4D); code.push_back(0x29); code.push_back(0xDA);  // sub r10, r11
+        code.push_back(0x49); code.push_back(0x81); code.push_back(0xFA);  // cmp r10, YOUNG_GEN_SIZE
+        emit_u32(static_cast<uint32_t>(GCConfig::YOUNG_GEN_SIZE));
+        code.push_back(0x0F); code.push_back(0x83);                        // jae join
+        unresolved_jumps.push_back({join_label, code.size()});
+        emit_u32(0);
+        code.push_back(0x49); code.push_back(0xC1); code.push_back(0xEA);  // shr r10, YOUNG_PAGE_SHIFT
+        code.push_back(static_cast<uint8_t>(GCConfig::YOUNG_PAGE_SHIFT));
+        emit_mov_reg_imm(RCX, reinterpret_cast<int64_t>(gc_young_page_owner));
+        code.push_back(0x42); code.push_back(0x0F); code.push_back(0xB6);  // movzx ecx, byte [rcx + r10]
+        code.push_back(0x0C); code.push_back(0x11);
+        code.push_back(0x85); code.push_back(0xC9);                        // test ecx, ecx
+        emit_jump_if_equal(join_label);
+        code.push_back(0x49); code.push_back(0x89); code.push_back(0xFA);  // mov r10, rdi
+        code.push_back(0x4D); code.push_back(0x29); code.push_back(0xDA);  // sub r10, r11
+        code.push_back(0x49); code.push_back(0x81); code.push_back(0xFA);  // cmp r10, YOUNG_GEN_SIZE
+        emit_u32(static_cast<uint32_t>(GCConfig::YOUNG_GEN_SIZE));
+        code.push_back(0x0F); code.push_back(0x83);                        // jae publish
+        unresolved_jumps.push_back({publish_label, code.size()});
+        emit_u32(0);
+        code.push_back(0x49); code.push_back(0xC1); code.push_back(0xEA);  // shr r10, YOUNG_PAGE_SHIFT
+        code.push_back(static_cast<uint8_t>(GCConfig::YOUNG_PAGE_SHIFT));
+        emit_mov_reg_imm(R11, reinterpret_cast<int64_t>(gc_young_page_owner));
+        code.push_back(0x43); code.push_back(0x3A); code.push_back(0x0C);  // cmp cl, byte [r11 + r10]
+        code.push_back(0x13);
+        emit_jump_if_equal(join_label);
+        emit_label(publish_label);
+        emit_mov_reg_reg(RDI, RDX);
+        emit_call("__gc_publish");
+    }
+    emit_jump(join_label);
+    
+    if (card_mark) {
+        emit_label(frame_label);
+        emit_rex(code, true, RDX, RDI);
+        code.push_back(0x89);                               // mov [rdi + offset], rdx
+        code.push_back(0x80 | ((RDX & 7) << 3) | (RDI & 7));
+        emit_u32(static_cast<uint32_t>(GCObjectLayout::value_offset(property_index)));
+        emit_jump(join_label);
+    }
+    
+    emit_label(slow_label);
+    emit_call("__object_set_property");
+    emit_label(join_label);
+}
 
 }
\ No newline at end of file